@@ -0,0 +1,629 @@
+/*************************************************************************
+* Copyright (C) 2026 agent <agent@local>
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+*********************************************************************/
+
+/* micro-benchmarks for the application data codec, the RPM ack and
+   NPDU decoders, the TSM invoke ID allocator and the address cache.
+   Prints one comma separated line per case:
+   benchmark,parameter,iterations,ns_per_op
+   where ns_per_op is the best of BENCH_REPEATS timed runs. */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "config.h"
+#include "bacdef.h"
+#include "bacdcode.h"
+#include "bacapp.h"
+#include "bacstr.h"
+#include "npdu.h"
+#include "rpm.h"
+#include "tsm.h"
+#include "address.h"
+
+/* number of timed runs of each case */
+#ifndef BENCH_REPEATS
+#define BENCH_REPEATS 5
+#endif
+/* default number of operations in each timed run */
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS 1000000UL
+#endif
+
+/* runs the case count times */
+typedef void (
+    *bench_function) (
+    void *context,
+    unsigned long count);
+
+/* only the benchmarks whose name starts with this are run */
+static const char *Bench_Filter = NULL;
+/* keeps the results live so the calls are not optimized away */
+static volatile uint32_t Bench_Sink = 0;
+
+static uint8_t Bench_Buffer[MAX_APDU];
+
+static uint64_t bench_clock_ns(
+    void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t) now.tv_sec * 1000000000UL) + now.tv_nsec;
+}
+
+static void bench_run(
+    const char *name,
+    const char *parameter,
+    bench_function function,
+    void *context,
+    unsigned long count)
+{
+    uint64_t start = 0;
+    uint64_t elapsed = 0;
+    uint64_t best = 0;
+    unsigned i = 0;
+
+    if (Bench_Filter &&
+        (strncmp(name, Bench_Filter, strlen(Bench_Filter)) != 0)) {
+        return;
+    }
+    /* warm the caches and the branch predictors */
+    function(context, (count / 10) + 1);
+    for (i = 0; i < BENCH_REPEATS; i++) {
+        start = bench_clock_ns();
+        function(context, count);
+        elapsed = bench_clock_ns() - start;
+        if ((i == 0) || (elapsed < best)) {
+            best = elapsed;
+        }
+    }
+    printf("%s,%s,%lu,%.2f\n", name, parameter, count,
+        (double) best / (double) count);
+    fflush(stdout);
+}
+
+/* application data encode and decode, one case per datatype */
+typedef struct bench_value {
+    const char *name;
+    BACNET_APPLICATION_DATA_VALUE value;
+    int apdu_len;
+    uint8_t apdu[MAX_APDU];
+} BENCH_VALUE;
+
+static BENCH_VALUE Bench_Values[] = {
+    {"null"},
+    {"boolean"},
+    {"unsigned8"},
+    {"unsigned32"},
+    {"signed32"},
+    {"real"},
+    {"double"},
+    {"octet_string16"},
+    {"character_string16"},
+    {"bit_string16"},
+    {"enumerated"},
+    {"date"},
+    {"time"},
+    {"object_id"}
+};
+
+#define BENCH_VALUE_COUNT (sizeof(Bench_Values)/sizeof(Bench_Values[0]))
+
+static void bench_values_init(
+    void)
+{
+    static const BACNET_APPLICATION_TAG tags[BENCH_VALUE_COUNT] = {
+        BACNET_APPLICATION_TAG_NULL,
+        BACNET_APPLICATION_TAG_BOOLEAN,
+        BACNET_APPLICATION_TAG_UNSIGNED_INT,
+        BACNET_APPLICATION_TAG_UNSIGNED_INT,
+        BACNET_APPLICATION_TAG_SIGNED_INT,
+        BACNET_APPLICATION_TAG_REAL,
+        BACNET_APPLICATION_TAG_DOUBLE,
+        BACNET_APPLICATION_TAG_OCTET_STRING,
+        BACNET_APPLICATION_TAG_CHARACTER_STRING,
+        BACNET_APPLICATION_TAG_BIT_STRING,
+        BACNET_APPLICATION_TAG_ENUMERATED,
+        BACNET_APPLICATION_TAG_DATE,
+        BACNET_APPLICATION_TAG_TIME,
+        BACNET_APPLICATION_TAG_OBJECT_ID
+    };
+    uint8_t octets[16] = {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF
+    };
+    BACNET_APPLICATION_DATA_VALUE *value;
+    unsigned i = 0;
+    unsigned bit = 0;
+
+    for (i = 0; i < BENCH_VALUE_COUNT; i++) {
+        value = &Bench_Values[i].value;
+        value->tag = tags[i];
+    }
+    Bench_Values[1].value.type.Boolean = true;
+    Bench_Values[2].value.type.Unsigned_Int = 85;
+    Bench_Values[3].value.type.Unsigned_Int = 0xDEADBEEF;
+    Bench_Values[4].value.type.Signed_Int = -123456789;
+    Bench_Values[5].value.type.Real = 72.5F;
+    Bench_Values[6].value.type.Double = 3.14159265358979;
+    octetstring_init(&Bench_Values[7].value.type.Octet_String, octets,
+        sizeof(octets));
+    characterstring_init_ansi(&Bench_Values[8].value.type.Character_String,
+        "Zone Temperature");
+    bitstring_init(&Bench_Values[9].value.type.Bit_String);
+    for (bit = 0; bit < 16; bit++) {
+        bitstring_set_bit(&Bench_Values[9].value.type.Bit_String,
+            (uint8_t) bit, (bit & 1) ? true : false);
+    }
+    Bench_Values[10].value.type.Enumerated = 85;
+    Bench_Values[11].value.type.Date.year = 2009;
+    Bench_Values[11].value.type.Date.month = 6;
+    Bench_Values[11].value.type.Date.day = 15;
+    Bench_Values[11].value.type.Date.wday = 1;
+    Bench_Values[12].value.type.Time.hour = 23;
+    Bench_Values[12].value.type.Time.min = 59;
+    Bench_Values[12].value.type.Time.sec = 58;
+    Bench_Values[12].value.type.Time.hundredths = 99;
+    Bench_Values[13].value.type.Object_Id.type = OBJECT_ANALOG_INPUT;
+    Bench_Values[13].value.type.Object_Id.instance = 4194302;
+    for (i = 0; i < BENCH_VALUE_COUNT; i++) {
+        Bench_Values[i].apdu_len =
+            bacapp_encode_application_data(&Bench_Values[i].apdu[0],
+            &Bench_Values[i].value);
+    }
+}
+
+static void bench_encode_application_data(
+    void *context,
+    unsigned long count)
+{
+    BENCH_VALUE *bench = (BENCH_VALUE *) context;
+    uint32_t len = 0;
+
+    while (count--) {
+        len +=
+            bacapp_encode_application_data(&Bench_Buffer[0], &bench->value);
+    }
+    Bench_Sink += len;
+}
+
+static void bench_decode_application_data(
+    void *context,
+    unsigned long count)
+{
+    BENCH_VALUE *bench = (BENCH_VALUE *) context;
+    BACNET_APPLICATION_DATA_VALUE value;
+    uint32_t len = 0;
+
+    while (count--) {
+        len +=
+            bacapp_decode_application_data(&bench->apdu[0],
+            (unsigned) bench->apdu_len, &value);
+    }
+    Bench_Sink += len;
+}
+
+/* ReadPropertyMultiple ack with objects times properties REAL values,
+   decoded the way the client handler walks it */
+typedef struct bench_rpm_ack {
+    unsigned objects;
+    unsigned properties;
+    int apdu_len;
+    uint8_t apdu[MAX_APDU];
+} BENCH_RPM_ACK;
+
+static void bench_rpm_ack_init(
+    BENCH_RPM_ACK * bench)
+{
+    BACNET_APPLICATION_DATA_VALUE value;
+    uint8_t application_data[16];
+    int application_data_len = 0;
+    uint8_t *apdu = &bench->apdu[0];
+    int len = 0;
+    unsigned i = 0;
+    unsigned j = 0;
+
+    value.tag = BACNET_APPLICATION_TAG_REAL;
+    len = rpm_ack_encode_apdu_init(&apdu[0], 1);
+    for (i = 0; i < bench->objects; i++) {
+        len +=
+            rpm_ack_encode_apdu_object_begin(&apdu[len],
+            OBJECT_ANALOG_VALUE, i);
+        for (j = 0; j < bench->properties; j++) {
+            len +=
+                rpm_ack_encode_apdu_object_property(&apdu[len],
+                PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+            value.type.Real = (float) (i * 100 + j);
+            application_data_len =
+                bacapp_encode_application_data(&application_data[0],
+                &value);
+            len +=
+                rpm_ack_encode_apdu_object_property_value(&apdu[len],
+                &application_data[0], (unsigned) application_data_len);
+        }
+        len += rpm_ack_encode_apdu_object_end(&apdu[len]);
+    }
+    bench->apdu_len = len;
+}
+
+static void bench_rpm_ack_decode(
+    void *context,
+    unsigned long count)
+{
+    BENCH_RPM_ACK *bench = (BENCH_RPM_ACK *) context;
+    BACNET_APPLICATION_DATA_VALUE value;
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance = 0;
+    BACNET_PROPERTY_ID property;
+    int32_t array_index = 0;
+    uint8_t invoke_id = 0;
+    uint8_t *apdu = NULL;
+    unsigned apdu_len = 0;
+    uint32_t decoded = 0;
+    int len = 0;
+
+    while (count--) {
+        apdu = NULL;
+        apdu_len = 0;
+        rpm_ack_decode_apdu(&bench->apdu[0], bench->apdu_len, &invoke_id,
+            &apdu, &apdu_len);
+        while (apdu_len) {
+            len =
+                rpm_ack_decode_object_id(apdu, apdu_len, &object_type,
+                &object_instance);
+            if (len <= 0) {
+                break;
+            }
+            apdu += len;
+            apdu_len -= len;
+            while (apdu_len) {
+                len = rpm_ack_decode_object_end(apdu, apdu_len);
+                if (len) {
+                    apdu += len;
+                    apdu_len -= len;
+                    break;
+                }
+                len =
+                    rpm_ack_decode_object_property(apdu, apdu_len,
+                    &property, &array_index);
+                if ((len <= 0) || ((unsigned) len >= apdu_len) ||
+                    !decode_is_opening_tag_number(&apdu[len], 4)) {
+                    apdu_len = 0;
+                    break;
+                }
+                apdu += len + 1;
+                apdu_len -= len + 1;
+                while (apdu_len && !decode_is_closing_tag_number(apdu, 4)) {
+                    len =
+                        bacapp_decode_application_data(apdu, apdu_len,
+                        &value);
+                    if (len <= 0) {
+                        apdu_len = 0;
+                        break;
+                    }
+                    apdu += len;
+                    apdu_len -= len;
+                    decoded++;
+                }
+                if (apdu_len) {
+                    apdu++;
+                    apdu_len--;
+                }
+            }
+        }
+    }
+    Bench_Sink += decoded;
+}
+
+/* NPDU header, with and without the routing information */
+typedef struct bench_npdu {
+    int npdu_len;
+    uint8_t npdu[MAX_NPDU];
+} BENCH_NPDU;
+
+static void bench_npdu_init(
+    BENCH_NPDU * bench,
+    bool routed)
+{
+    BACNET_ADDRESS dest;
+    BACNET_ADDRESS src;
+    BACNET_NPDU_DATA npdu_data;
+    unsigned i = 0;
+
+    memset(&dest, 0, sizeof(dest));
+    memset(&src, 0, sizeof(src));
+    if (routed) {
+        dest.net = 2001;
+        dest.len = 1;
+        dest.adr[0] = 0x7F;
+        src.net = 1001;
+        src.len = 6;
+        for (i = 0; i < 6; i++) {
+            src.adr[i] = (uint8_t) (0xC0 + i);
+        }
+    }
+    npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
+    bench->npdu_len = npdu_encode_pdu(&bench->npdu[0], &dest, &src,
+        &npdu_data);
+}
+
+static void bench_npdu_decode(
+    void *context,
+    unsigned long count)
+{
+    BENCH_NPDU *bench = (BENCH_NPDU *) context;
+    BACNET_ADDRESS dest;
+    BACNET_ADDRESS src;
+    BACNET_NPDU_DATA npdu_data;
+    uint32_t len = 0;
+
+    while (count--) {
+        len += npdu_decode(&bench->npdu[0], &dest, &src, &npdu_data);
+    }
+    Bench_Sink += len;
+}
+
+#if (MAX_TSM_TRANSACTIONS)
+/* takes an invoke ID and gives it back, with held IDs in use */
+static void bench_tsm_next_free_invokeID(
+    void *context,
+    unsigned long count)
+{
+    uint8_t invoke_id = 0;
+    uint32_t total = 0;
+
+    (void) context;
+    while (count--) {
+        invoke_id = tsm_next_free_invokeID();
+        tsm_free_invoke_id(invoke_id);
+        total += invoke_id;
+    }
+    Bench_Sink += total;
+}
+
+static void bench_tsm(
+    unsigned long count)
+{
+    static uint8_t held_ids[MAX_TSM_TRANSACTIONS];
+    const unsigned loads[] = {
+        0,
+        MAX_TSM_TRANSACTIONS / 4,
+        MAX_TSM_TRANSACTIONS / 2,
+        (MAX_TSM_TRANSACTIONS * 3) / 4,
+        MAX_TSM_TRANSACTIONS - 1
+    };
+    char parameter[32];
+    unsigned held = 0;
+    unsigned i = 0;
+
+    for (i = 0; i < sizeof(loads) / sizeof(loads[0]); i++) {
+        if ((i > 0) && (loads[i] <= loads[i - 1])) {
+            continue;
+        }
+        while (held < loads[i]) {
+            held_ids[held] = tsm_next_free_invokeID();
+            held++;
+        }
+        sprintf(parameter, "held=%u", held);
+        bench_run("tsm_next_free_invokeID", parameter,
+            bench_tsm_next_free_invokeID, NULL, count);
+    }
+    while (held) {
+        held--;
+        tsm_free_invoke_id(held_ids[held]);
+    }
+}
+#endif
+
+/* address cache with a number of BACnet/IP devices bound */
+typedef struct bench_address {
+    unsigned entries;
+    unsigned next;
+} BENCH_ADDRESS;
+
+static uint32_t bench_address_device_id(
+    unsigned index)
+{
+    /* spread the instances out, the way a site numbers its devices */
+    return 1000 + (index * 97);
+}
+
+static void bench_address_mac(
+    unsigned index,
+    BACNET_ADDRESS * src)
+{
+    memset(src, 0, sizeof(BACNET_ADDRESS));
+    src->mac_len = 6;
+    src->mac[0] = 192;
+    src->mac[1] = 168;
+    src->mac[2] = (uint8_t) (index >> 8);
+    src->mac[3] = (uint8_t) index;
+    src->mac[4] = 0xBA;
+    src->mac[5] = 0xC0;
+}
+
+static void bench_address_add(
+    void *context,
+    unsigned long count)
+{
+    BENCH_ADDRESS *bench = (BENCH_ADDRESS *) context;
+    BACNET_ADDRESS src;
+
+    while (count--) {
+        bench_address_mac(bench->next, &src);
+        address_add(bench_address_device_id(bench->next), MAX_APDU, &src);
+        bench->next++;
+        if (bench->next >= bench->entries) {
+            bench->next = 0;
+        }
+    }
+}
+
+static void bench_address_get_by_device(
+    void *context,
+    unsigned long count)
+{
+    BENCH_ADDRESS *bench = (BENCH_ADDRESS *) context;
+    BACNET_ADDRESS src;
+    unsigned max_apdu = 0;
+    uint32_t found = 0;
+
+    while (count--) {
+        if (address_get_by_device(bench_address_device_id(bench->next),
+                &max_apdu, &src)) {
+            found++;
+        }
+        bench->next++;
+        if (bench->next >= bench->entries) {
+            bench->next = 0;
+        }
+    }
+    Bench_Sink += found;
+}
+
+static void bench_address_get_device_id(
+    void *context,
+    unsigned long count)
+{
+    BENCH_ADDRESS *bench = (BENCH_ADDRESS *) context;
+    BACNET_ADDRESS src;
+    uint32_t device_id = 0;
+    uint32_t found = 0;
+
+    while (count--) {
+        bench_address_mac(bench->next, &src);
+        if (address_get_device_id(&src, &device_id)) {
+            found++;
+        }
+        bench->next++;
+        if (bench->next >= bench->entries) {
+            bench->next = 0;
+        }
+    }
+    Bench_Sink += found;
+}
+
+static void bench_address(
+    unsigned long count)
+{
+    const unsigned sizes[] = {
+        1, 16, 64, MAX_ADDRESS_CACHE
+    };
+    BENCH_ADDRESS bench;
+    BACNET_ADDRESS src;
+    char parameter[32];
+    unsigned i = 0;
+    unsigned j = 0;
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        if ((sizes[i] > MAX_ADDRESS_CACHE) ||
+            ((i > 0) && (sizes[i] <= sizes[i - 1]))) {
+            continue;
+        }
+        address_init();
+        bench.entries = sizes[i];
+        for (j = 0; j < bench.entries; j++) {
+            bench_address_mac(j, &src);
+            address_add(bench_address_device_id(j), MAX_APDU, &src);
+        }
+        sprintf(parameter, "entries=%u", bench.entries);
+        bench.next = 0;
+        bench_run("address_add", parameter, bench_address_add, &bench,
+            count);
+        bench.next = 0;
+        bench_run("address_get_by_device", parameter,
+            bench_address_get_by_device, &bench, count);
+        bench.next = 0;
+        bench_run("address_get_device_id", parameter,
+            bench_address_get_device_id, &bench, count);
+    }
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    static BENCH_RPM_ACK rpm_ack[] = {
+        {1, 1},
+        {1, 10},
+        {1, 50},
+        {10, 10}
+    };
+    BENCH_NPDU npdu[2];
+    unsigned long count = BENCH_ITERATIONS;
+    char parameter[32];
+    unsigned i = 0;
+
+    if ((argc > 1) && (strcmp(argv[1], "--help") == 0)) {
+        printf("Usage: %s [iterations [benchmark-prefix]]\r\n", argv[0]);
+        printf("Prints benchmark,parameter,iterations,ns_per_op for each\r\n"
+            "case, with the best of %u runs.  The default is %lu\r\n"
+            "iterations, and every benchmark.\r\n", BENCH_REPEATS,
+            BENCH_ITERATIONS);
+        return 0;
+    }
+    if (argc > 1) {
+        count = strtoul(argv[1], NULL, 0);
+        if (count == 0) {
+            count = BENCH_ITERATIONS;
+        }
+    }
+    if (argc > 2) {
+        Bench_Filter = argv[2];
+    }
+
+    printf("benchmark,parameter,iterations,ns_per_op\n");
+    bench_values_init();
+    for (i = 0; i < BENCH_VALUE_COUNT; i++) {
+        bench_run("bacapp_encode_application_data", Bench_Values[i].name,
+            bench_encode_application_data, &Bench_Values[i], count);
+    }
+    for (i = 0; i < BENCH_VALUE_COUNT; i++) {
+        bench_run("bacapp_decode_application_data", Bench_Values[i].name,
+            bench_decode_application_data, &Bench_Values[i], count);
+    }
+    for (i = 0; i < sizeof(rpm_ack) / sizeof(rpm_ack[0]); i++) {
+        bench_rpm_ack_init(&rpm_ack[i]);
+        sprintf(parameter, "%ux%u", rpm_ack[i].objects,
+            rpm_ack[i].properties);
+        /* keep the total number of values decoded about the same */
+        bench_run("rpm_ack_decode_apdu", parameter, bench_rpm_ack_decode,
+            &rpm_ack[i], (count / (rpm_ack[i].objects *
+                    rpm_ack[i].properties)) + 1);
+    }
+    bench_npdu_init(&npdu[0], false);
+    bench_run("npdu_decode", "local", bench_npdu_decode, &npdu[0], count);
+    bench_npdu_init(&npdu[1], true);
+    bench_run("npdu_decode", "routed", bench_npdu_decode, &npdu[1], count);
+#if (MAX_TSM_TRANSACTIONS)
+    bench_tsm(count);
+#endif
+    bench_address(count);
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+#Makefile to build the micro-benchmarks
+CC      = gcc
+SRC_DIR = ../../src
+PORT_DIR = ../../ports/linux
+INCLUDES = -I../../include -I$(PORT_DIR) -I.
+DEFINES = -DBIG_ENDIAN=0 -DBACDL_BIP=1 -DBACAPP_ALL
+# build with the same optimization as the code being measured
+OPTIMIZATION = -O2
+
+CFLAGS  = -Wall $(OPTIMIZATION) $(INCLUDES) $(DEFINES)
+
+SRCS = bench.c \
+	$(SRC_DIR)/abort.c \
+	$(SRC_DIR)/address.c \
+	$(SRC_DIR)/apdu.c \
+	$(SRC_DIR)/arena.c \
+	$(SRC_DIR)/bacaddr.c \
+	$(SRC_DIR)/bacapp.c \
+	$(SRC_DIR)/bacdcode.c \
+	$(SRC_DIR)/bacint.c \
+	$(SRC_DIR)/bacreal.c \
+	$(SRC_DIR)/bacstr.c \
+	$(SRC_DIR)/bip.c \
+	$(SRC_DIR)/bvlc.c \
+	$(SRC_DIR)/datetime.c \
+	$(SRC_DIR)/dcc.c \
+	$(SRC_DIR)/memcopy.c \
+	$(SRC_DIR)/npdu.c \
+	$(SRC_DIR)/rpm.c \
+	$(SRC_DIR)/tsm.c \
+	$(PORT_DIR)/bip-init.c
+
+TARGET = bench
+
+all: ${TARGET}
+
+OBJS = ${SRCS:.c=.o}
+
+${TARGET}: ${OBJS}
+	${CC} -pthread -o $@ ${OBJS} -lm
+
+# one CSV line per case: benchmark,parameter,iterations,ns_per_op
+run: ${TARGET}
+	./${TARGET}
+
+.c.o:
+	${CC} -c ${CFLAGS} $*.c -o $@
+
+depend:
+	rm -f .depend
+	${CC} -MM ${CFLAGS} *.c >> .depend
+
+clean:
+	rm -rf core ${TARGET} $(OBJS)
+
+include: .depend
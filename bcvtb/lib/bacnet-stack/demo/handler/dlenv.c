@@ -34,6 +34,38 @@
 #include "datalink.h"
 #include "handlers.h"
 #include "client.h"
+#include "address.h"
+#include "dlenv.h"
+
+/* where the address cache is saved, if anywhere */
+static char *Address_Cache_Save_File = NULL;
+/* seconds between saves, 0 to only save on exit */
+static unsigned long Address_Cache_Save_Interval = 0;
+static unsigned long Address_Cache_Save_Timer = 0;
+
+static void dlenv_address_cache_save(
+    void)
+{
+    if (Address_Cache_Save_File) {
+        if (!address_file_save(Address_Cache_Save_File)) {
+            fprintf(stderr, "Unable to save the address cache to %s\r\n",
+                Address_Cache_Save_File);
+        }
+    }
+}
+
+/* call about once a second with the seconds since the last call */
+void dlenv_maintenance_timer(
+    uint16_t elapsed_seconds)
+{
+    if (Address_Cache_Save_File && Address_Cache_Save_Interval) {
+        Address_Cache_Save_Timer += elapsed_seconds;
+        if (Address_Cache_Save_Timer >= Address_Cache_Save_Interval) {
+            Address_Cache_Save_Timer = 0;
+            dlenv_address_cache_save();
+        }
+    }
+}
 
 void dlenv_init(
     void)
@@ -99,6 +131,20 @@ void dlenv_init(
     if (!datalink_init(getenv("BACNET_IFACE"))) {
         exit(1);
     }
+    /* load the bindings saved by the last run, and save them again
+       on exit so the next run doesn't have to send Who-Is */
+    pEnv = getenv("BACNET_ADDRESS_CACHE_FILE");
+    if (pEnv && pEnv[0]) {
+        address_file_init(pEnv);
+        if (!Address_Cache_Save_File) {
+            Address_Cache_Save_File = pEnv;
+            atexit(dlenv_address_cache_save);
+        }
+        pEnv = getenv("BACNET_ADDRESS_CACHE_SAVE_INTERVAL");
+        if (pEnv) {
+            Address_Cache_Save_Interval = strtoul(pEnv, NULL, 0);
+        }
+    }
 #if defined(BACDL_BIP) && BBMD_ENABLED
     pEnv = getenv("BACNET_BBMD_PORT");
     if (pEnv) {
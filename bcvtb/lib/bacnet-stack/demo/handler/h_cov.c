@@ -55,17 +55,55 @@
 /* note: This COV service only monitors the properties
    of an object that have been specified in the standard.  */
 typedef struct BACnet_COV_Subscription {
-    bool valid;
     BACNET_ADDRESS dest;
     uint32_t subscriberProcessIdentifier;
     BACNET_OBJECT_ID monitoredObjectIdentifier;
     bool issueConfirmedNotifications;   /* optional */
-    uint32_t lifetime;  /* optional */
+    uint32_t lifetime;  /* optional - 0 is indefinite */
+    uint32_t expires;   /* COV_Seconds when it runs out */
     bool send_requested;
+    /* the next subscription to the same object - or the next free
+       one - as index + 1, or 0 at the end */
+    uint16_t next;
 } BACNET_COV_SUBSCRIPTION;
 
-#define MAX_COV_SUBCRIPTIONS 32
-static BACNET_COV_SUBSCRIPTION COV_Subscriptions[MAX_COV_SUBCRIPTIONS];
+/* each object with at least one subscription, so that a change of
+   value only has to visit the subscriptions to its own object */
+typedef struct BACnet_COV_Object {
+    BACNET_OBJECT_ID objectIdentifier;
+    /* the first of its subscriptions, as index + 1 */
+    uint16_t subscriptions;
+    /* the next object in the same hash chain, as index + 1, or 0 */
+    uint16_t next;
+    /* the soonest one of its subscriptions runs out, or 0 for never */
+    uint32_t expires;
+    /* one of its subscriptions has send_requested */
+    bool send_requested;
+} BACNET_COV_OBJECT;
+
+#ifndef MAX_COV_SUBSCRIPTIONS
+#define MAX_COV_SUBSCRIPTIONS 1024
+#endif
+#ifndef MAX_COV_OBJECTS
+#define MAX_COV_OBJECTS MAX_COV_SUBSCRIPTIONS
+#endif
+#if (MAX_COV_SUBSCRIPTIONS > 65535) || (MAX_COV_OBJECTS > 65535)
+#error MAX_COV_SUBSCRIPTIONS and MAX_COV_OBJECTS must fit in 16 bits
+#endif
+/* number of hash chains for finding the monitored object */
+#ifndef COV_OBJECT_HASH_SIZE
+#define COV_OBJECT_HASH_SIZE 256
+#endif
+static BACNET_COV_SUBSCRIPTION COV_Subscriptions[MAX_COV_SUBSCRIPTIONS];
+/* how many have ever been used, and those since freed, as index + 1 */
+static uint16_t COV_Subscription_Used;
+static uint16_t COV_Subscription_Free;
+/* the monitored objects are kept packed at the front */
+static BACNET_COV_OBJECT COV_Objects[MAX_COV_OBJECTS];
+static unsigned COV_Object_Count;
+static uint16_t COV_Object_Hash[COV_OBJECT_HASH_SIZE];
+/* seconds counted by handler_cov_task */
+static uint32_t COV_Seconds;
 
 /*
 BACnetCOVSubscription ::= SEQUENCE {
@@ -94,6 +132,19 @@ TimeRemaining [3] Unsigned,
 COVIncrement [4] REAL OPTIONAL
 */
 
+static uint32_t cov_time_remaining(
+    BACNET_COV_SUBSCRIPTION * cov_subscription)
+{
+    uint32_t seconds = 0;
+
+    if (cov_subscription->lifetime &&
+        (cov_subscription->expires > COV_Seconds)) {
+        seconds = cov_subscription->expires - COV_Seconds;
+    }
+
+    return seconds;
+}
+
 static int cov_encode_subscription(
     uint8_t * apdu,
     int max_apdu,
@@ -169,7 +220,7 @@ static int cov_encode_subscription(
     /* TimeRemaining [3] Unsigned, */
     len =
         encode_context_unsigned(&apdu[apdu_len], 3,
-        cov_subscription->lifetime);
+        cov_time_remaining(cov_subscription));
     apdu_len += len;
 
     return apdu_len;
@@ -182,17 +233,20 @@ int handler_cov_encode_subscriptions(
     int len = 0;
     int apdu_len = 0;
     unsigned index = 0;
+    uint16_t next = 0;
 
     if (apdu) {
-        for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-            if (COV_Subscriptions[index].valid) {
+        for (index = 0; index < COV_Object_Count; index++) {
+            next = COV_Objects[index].subscriptions;
+            while (next) {
                 len =
                     cov_encode_subscription(&apdu[apdu_len],
-                    max_apdu - apdu_len, &COV_Subscriptions[index]);
+                    max_apdu - apdu_len, &COV_Subscriptions[next - 1]);
                 apdu_len += len;
                 if (apdu_len > max_apdu) {
                     return -2;
                 }
+                next = COV_Subscriptions[next - 1].next;
             }
         }
     }
@@ -203,19 +257,180 @@ int handler_cov_encode_subscriptions(
 void handler_cov_init(
     void)
 {
-    unsigned index = 0;
+    memset(COV_Subscriptions, 0, sizeof(COV_Subscriptions));
+    COV_Subscription_Used = 0;
+    COV_Subscription_Free = 0;
+    COV_Object_Count = 0;
+    memset(COV_Object_Hash, 0, sizeof(COV_Object_Hash));
+    COV_Seconds = 0;
+}
+
+/* returns the new subscription as index + 1, or 0 if there are none */
+static uint16_t cov_subscription_alloc(
+    void)
+{
+    uint16_t next = 0;
+
+    if (COV_Subscription_Free) {
+        next = COV_Subscription_Free;
+        COV_Subscription_Free = COV_Subscriptions[next - 1].next;
+    } else if (COV_Subscription_Used < MAX_COV_SUBSCRIPTIONS) {
+        COV_Subscription_Used++;
+        next = COV_Subscription_Used;
+    }
+
+    return next;
+}
+
+static void cov_subscription_free(
+    uint16_t next)
+{
+    COV_Subscriptions[next - 1].next = COV_Subscription_Free;
+    COV_Subscription_Free = next;
+}
+
+static unsigned cov_object_hash(
+    BACNET_OBJECT_ID * object_id)
+{
+    return ((((unsigned) object_id->type) << 22) ^ object_id->instance) %
+        COV_OBJECT_HASH_SIZE;
+}
+
+/* returns the index of the monitored object, or -1 if nobody
+   has subscribed to it */
+static int cov_object_find(
+    BACNET_OBJECT_ID * object_id)
+{
+    uint16_t next = 0;
+    BACNET_COV_OBJECT *cov_object = NULL;
+
+    next = COV_Object_Hash[cov_object_hash(object_id)];
+    while (next) {
+        cov_object = &COV_Objects[next - 1];
+        if ((cov_object->objectIdentifier.type == object_id->type) &&
+            (cov_object->objectIdentifier.instance == object_id->instance)) {
+            return next - 1;
+        }
+        next = cov_object->next;
+    }
+
+    return -1;
+}
+
+/* returns the index of the new monitored object, or -1 if full */
+static int cov_object_add(
+    BACNET_OBJECT_ID * object_id)
+{
+    unsigned hash = 0;
+    BACNET_COV_OBJECT *cov_object = NULL;
+
+    if (COV_Object_Count >= MAX_COV_OBJECTS) {
+        return -1;
+    }
+    hash = cov_object_hash(object_id);
+    cov_object = &COV_Objects[COV_Object_Count];
+    cov_object->objectIdentifier.type = object_id->type;
+    cov_object->objectIdentifier.instance = object_id->instance;
+    cov_object->subscriptions = 0;
+    cov_object->expires = 0;
+    cov_object->send_requested = false;
+    cov_object->next = COV_Object_Hash[hash];
+    COV_Object_Count++;
+    COV_Object_Hash[hash] = (uint16_t) COV_Object_Count;
+
+    return COV_Object_Count - 1;
+}
+
+/* finds the hash chain link that points at the monitored object */
+static uint16_t *cov_object_link(
+    unsigned index)
+{
+    uint16_t *link = NULL;
+
+    link = &COV_Object_Hash[cov_object_hash(&COV_Objects[index].
+            objectIdentifier)];
+    while (*link && (*link != (index + 1))) {
+        link = &COV_Objects[*link - 1].next;
+    }
+
+    return link;
+}
+
+/* forgets an object without subscriptions - the last one is
+   moved into its place to keep them packed */
+static void cov_object_remove(
+    unsigned index)
+{
+    unsigned last = COV_Object_Count - 1;
+    uint16_t *link = NULL;
+
+    link = cov_object_link(index);
+    *link = COV_Objects[index].next;
+    if (index != last) {
+        link = cov_object_link(last);
+        *link = (uint16_t) (index + 1);
+        COV_Objects[index] = COV_Objects[last];
+    }
+    COV_Object_Count--;
+}
+
+/* works out when the next of its subscriptions runs out */
+static void cov_object_expires_update(
+    BACNET_COV_OBJECT * cov_object)
+{
+    uint16_t next = 0;
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
+
+    cov_object->expires = 0;
+    next = cov_object->subscriptions;
+    while (next) {
+        cov_subscription = &COV_Subscriptions[next - 1];
+        if (cov_subscription->lifetime && (!cov_object->expires ||
+                (cov_subscription->expires < cov_object->expires))) {
+            cov_object->expires = cov_subscription->expires;
+        }
+        next = cov_subscription->next;
+    }
+}
+
+/* drops the subscriptions that have run out */
+static void cov_object_expire(
+    BACNET_COV_OBJECT * cov_object)
+{
+    uint16_t *link = NULL;
+    uint16_t next = 0;
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
 
-    for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-        COV_Subscriptions[index].valid = false;
-        COV_Subscriptions[index].dest.mac_len = 0;
-        COV_Subscriptions[index].subscriberProcessIdentifier = 0;
-        COV_Subscriptions[index].monitoredObjectIdentifier.type =
-            OBJECT_ANALOG_INPUT;
-        COV_Subscriptions[index].monitoredObjectIdentifier.instance = 0;
-        COV_Subscriptions[index].issueConfirmedNotifications = false;
-        COV_Subscriptions[index].lifetime = 0;
-        COV_Subscriptions[index].send_requested = false;
+    link = &cov_object->subscriptions;
+    while (*link) {
+        next = *link;
+        cov_subscription = &COV_Subscriptions[next - 1];
+        if (cov_subscription->lifetime &&
+            (cov_subscription->expires <= COV_Seconds)) {
+#if 0
+            fprintf(stderr, "COVtask: subscription[%u] expired\n",
+                (unsigned) (next - 1));
+#endif
+            *link = cov_subscription->next;
+            cov_subscription_free(next);
+        } else {
+            link = &cov_subscription->next;
+        }
     }
+    cov_object_expires_update(cov_object);
+}
+
+static void cov_subscription_set(
+    BACNET_COV_SUBSCRIPTION * cov_subscription,
+    BACNET_ADDRESS * src,
+    BACNET_SUBSCRIBE_COV_DATA * cov_data)
+{
+    bacnet_address_copy(&cov_subscription->dest, src);
+    cov_subscription->issueConfirmedNotifications =
+        cov_data->issueConfirmedNotifications;
+    cov_subscription->lifetime = cov_data->lifetime;
+    cov_subscription->expires = COV_Seconds + cov_data->lifetime;
+    cov_subscription->send_requested = true;
 }
 
 static bool cov_list_subscribe(
@@ -224,71 +439,78 @@ static bool cov_list_subscribe(
     BACNET_ERROR_CLASS * error_class,
     BACNET_ERROR_CODE * error_code)
 {
-    bool existing_entry = false;
-    int index;
-    int first_invalid_index = -1;
-    bool found = true;
-
-    /* unable to subscribe - resources? */
-    /* unable to cancel subscription - other? */
-
-    /* existing? - match Object ID and Process ID */
-    for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-        if (COV_Subscriptions[index].valid) {
-            if ((COV_Subscriptions[index].monitoredObjectIdentifier.type ==
-                    cov_data->monitoredObjectIdentifier.type) &&
-                (COV_Subscriptions[index].monitoredObjectIdentifier.instance ==
-                    cov_data->monitoredObjectIdentifier.instance) &&
-                (COV_Subscriptions[index].subscriberProcessIdentifier ==
-                    cov_data->subscriberProcessIdentifier)) {
-                existing_entry = true;
+    int index = 0;
+    uint16_t *link = NULL;
+    uint16_t next = 0;
+    BACNET_COV_OBJECT *cov_object = NULL;
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
+
+    index = cov_object_find(&cov_data->monitoredObjectIdentifier);
+    if (index >= 0) {
+        /* existing? - match Process ID and subscriber */
+        cov_object = &COV_Objects[index];
+        link = &cov_object->subscriptions;
+        while (*link) {
+            next = *link;
+            cov_subscription = &COV_Subscriptions[next - 1];
+            if ((cov_subscription->subscriberProcessIdentifier ==
+                    cov_data->subscriberProcessIdentifier) &&
+                bacnet_address_same(&cov_subscription->dest, src)) {
                 if (cov_data->cancellationRequest) {
-                    COV_Subscriptions[index].valid = false;
+                    *link = cov_subscription->next;
+                    cov_subscription_free(next);
+                    if (!cov_object->subscriptions) {
+                        cov_object_remove((unsigned) index);
+                    } else {
+                        cov_object_expires_update(cov_object);
+                    }
                 } else {
-                    bacnet_address_copy(&COV_Subscriptions[index].dest, src);
-                    COV_Subscriptions[index].issueConfirmedNotifications =
-                        cov_data->issueConfirmedNotifications;
-                    COV_Subscriptions[index].lifetime = cov_data->lifetime;
-                    COV_Subscriptions[index].send_requested = true;
+                    cov_subscription_set(cov_subscription, src, cov_data);
+                    cov_object_expires_update(cov_object);
+                    cov_object->send_requested = true;
                 }
-                break;
-            }
-        } else {
-            if (first_invalid_index < 0) {
-                first_invalid_index = index;
+                return true;
             }
+            link = &cov_subscription->next;
         }
     }
-    if (!existing_entry && (first_invalid_index >= 0) &&
-        (!cov_data->cancellationRequest)) {
-        index = first_invalid_index;
-        found = true;
-        COV_Subscriptions[index].valid = true;
-        bacnet_address_copy(&COV_Subscriptions[index].dest, src);
-        COV_Subscriptions[index].monitoredObjectIdentifier.type =
-            cov_data->monitoredObjectIdentifier.type;
-        COV_Subscriptions[index].monitoredObjectIdentifier.instance =
-            cov_data->monitoredObjectIdentifier.instance;
-        COV_Subscriptions[index].subscriberProcessIdentifier =
-            cov_data->subscriberProcessIdentifier;
-        COV_Subscriptions[index].issueConfirmedNotifications =
-            cov_data->issueConfirmedNotifications;
-        COV_Subscriptions[index].lifetime = cov_data->lifetime;
-        COV_Subscriptions[index].send_requested = true;
-    } else if (!existing_entry) {
-        if (first_invalid_index < 0) {
-            /* Out of resources */
-            *error_class = ERROR_CLASS_RESOURCES;
-            *error_code = ERROR_CODE_OTHER;
-        } else {
-            /* Unable to cancel request - valid object not subscribed */
-            *error_class = ERROR_CLASS_OBJECT;
-            *error_code = ERROR_CODE_OTHER;
+    if (cov_data->cancellationRequest) {
+        /* Unable to cancel request - valid object not subscribed */
+        *error_class = ERROR_CLASS_OBJECT;
+        *error_code = ERROR_CODE_OTHER;
+        return false;
+    }
+    if (index < 0) {
+        index = cov_object_add(&cov_data->monitoredObjectIdentifier);
+    }
+    next = 0;
+    if (index >= 0) {
+        next = cov_subscription_alloc();
+        if (!next && !COV_Objects[index].subscriptions) {
+            cov_object_remove((unsigned) index);
         }
-        found = false;
     }
+    if (!next) {
+        /* Out of resources */
+        *error_class = ERROR_CLASS_RESOURCES;
+        *error_code = ERROR_CODE_OTHER;
+        return false;
+    }
+    cov_object = &COV_Objects[index];
+    cov_subscription = &COV_Subscriptions[next - 1];
+    cov_subscription->monitoredObjectIdentifier.type =
+        cov_data->monitoredObjectIdentifier.type;
+    cov_subscription->monitoredObjectIdentifier.instance =
+        cov_data->monitoredObjectIdentifier.instance;
+    cov_subscription->subscriberProcessIdentifier =
+        cov_data->subscriberProcessIdentifier;
+    cov_subscription_set(cov_subscription, src, cov_data);
+    cov_subscription->next = cov_object->subscriptions;
+    cov_object->subscriptions = next;
+    cov_object_expires_update(cov_object);
+    cov_object->send_requested = true;
 
-    return found;
+    return true;
 }
 
 static bool cov_send_request(
@@ -320,7 +542,7 @@ static bool cov_send_request(
         cov_subscription->monitoredObjectIdentifier.type;
     cov_data.monitoredObjectIdentifier.instance =
         cov_subscription->monitoredObjectIdentifier.instance;
-    cov_data.timeRemaining = cov_subscription->lifetime;
+    cov_data.timeRemaining = cov_time_remaining(cov_subscription);
     /* encode the value list */
     cov_data.listOfValues = &value_list[0];
     value_list[0].next = &value_list[1];
@@ -331,6 +553,21 @@ static bool cov_send_request(
                 (cov_subscription->monitoredObjectIdentifier.instance,
                 &value_list[0]);
             break;
+        case OBJECT_ANALOG_INPUT:
+            Analog_Input_Encode_Value_List
+                (cov_subscription->monitoredObjectIdentifier.instance,
+                &value_list[0]);
+            break;
+        case OBJECT_ANALOG_OUTPUT:
+            Analog_Output_Encode_Value_List
+                (cov_subscription->monitoredObjectIdentifier.instance,
+                &value_list[0]);
+            break;
+        case OBJECT_ANALOG_VALUE:
+            Analog_Value_Encode_Value_List
+                (cov_subscription->monitoredObjectIdentifier.instance,
+                &value_list[0]);
+            break;
         default:
             goto COV_FAILED;
     }
@@ -366,54 +603,85 @@ static bool cov_send_request(
     return status;
 }
 
+/* returns true, and clears the flag, if the object has changed
+   enough to notify its subscribers */
+static bool cov_object_changed(
+    BACNET_OBJECT_ID * object_id)
+{
+    bool status = false;
+
+    switch (object_id->type) {
+        case OBJECT_BINARY_INPUT:
+            if (Binary_Input_Change_Of_Value(object_id->instance)) {
+                Binary_Input_Change_Of_Value_Clear(object_id->instance);
+                status = true;
+            }
+            break;
+        case OBJECT_ANALOG_INPUT:
+            if (Analog_Input_Change_Of_Value(object_id->instance)) {
+                Analog_Input_Change_Of_Value_Clear(object_id->instance);
+                status = true;
+            }
+            break;
+        case OBJECT_ANALOG_OUTPUT:
+            if (Analog_Output_Change_Of_Value(object_id->instance)) {
+                Analog_Output_Change_Of_Value_Clear(object_id->instance);
+                status = true;
+            }
+            break;
+        case OBJECT_ANALOG_VALUE:
+            if (Analog_Value_Change_Of_Value(object_id->instance)) {
+                Analog_Value_Change_Of_Value_Clear(object_id->instance);
+                status = true;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return status;
+}
+
 /* note: worst case tasking: MS/TP with the ability to send only
    one notification per task cycle */
 void handler_cov_task(
     uint32_t elapsed_seconds)
 {
-    int index;
-    uint32_t lifetime_seconds;
-    BACNET_OBJECT_ID object_id;
-    bool status = false;
-
+    unsigned index = 0;
+    uint16_t next = 0;
+    bool changed = false;
+    BACNET_COV_OBJECT *cov_object = NULL;
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
 
-    /* existing? - match Object ID and Process ID */
-    for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-        if (COV_Subscriptions[index].valid) {
-            /* handle timeouts */
-            lifetime_seconds = COV_Subscriptions[index].lifetime;
-            if (lifetime_seconds >= elapsed_seconds) {
-                COV_Subscriptions[index].lifetime -= elapsed_seconds;
-#if 0
-                fprintf(stderr, "COVtask: subscription[%d].lifetime=%d\n",
-                    index, COV_Subscriptions[index].lifetime);
-#endif
-            } else {
-                COV_Subscriptions[index].lifetime = 0;
+    COV_Seconds += elapsed_seconds;
+    /* each monitored object is visited once, however many
+       subscriptions it has */
+    while (index < COV_Object_Count) {
+        cov_object = &COV_Objects[index];
+        /* handle timeouts */
+        if (cov_object->expires && (cov_object->expires <= COV_Seconds)) {
+            cov_object_expire(cov_object);
+            if (!cov_object->subscriptions) {
+                /* another object moves into this index */
+                cov_object_remove(index);
+                continue;
             }
-            if (COV_Subscriptions[index].lifetime == 0) {
-                COV_Subscriptions[index].valid = false;
-            }
-            /* handle COV notifications */
-            object_id.type =
-                COV_Subscriptions[index].monitoredObjectIdentifier.type;
-            object_id.instance =
-                COV_Subscriptions[index].monitoredObjectIdentifier.instance;
-            switch (object_id.type) {
-                case OBJECT_BINARY_INPUT:
-                    if (Binary_Input_Change_Of_Value(object_id.instance)) {
-                        COV_Subscriptions[index].send_requested = true;
-                        Binary_Input_Change_Of_Value_Clear(object_id.instance);
-                    }
-                    break;
-                default:
-                    break;
-            }
-            if (COV_Subscriptions[index].send_requested) {
-                status = cov_send_request(&COV_Subscriptions[index]);
-                COV_Subscriptions[index].send_requested = false;
+        }
+        /* handle COV notifications */
+        changed = cov_object_changed(&cov_object->objectIdentifier);
+        if (changed || cov_object->send_requested) {
+            cov_object->send_requested = false;
+            next = cov_object->subscriptions;
+            while (next) {
+                cov_subscription = &COV_Subscriptions[next - 1];
+                if (changed || cov_subscription->send_requested) {
+                    cov_send_request(cov_subscription);
+                    cov_subscription->send_requested = false;
+                }
+                next = cov_subscription->next;
             }
         }
+        index++;
     }
 }
 
@@ -424,23 +692,38 @@ static bool cov_subscribe(
     BACNET_ERROR_CODE * error_code)
 {
     bool status = false;        /* return value */
+    bool valid = false;
 
     switch (cov_data->monitoredObjectIdentifier.type) {
         case OBJECT_BINARY_INPUT:
-            if (Binary_Input_Valid_Instance
-                (cov_data->monitoredObjectIdentifier.instance)) {
-                status =
-                    cov_list_subscribe(src, cov_data, error_class, error_code);
-            } else {
-                *error_class = ERROR_CLASS_OBJECT;
-                *error_code = ERROR_CODE_UNKNOWN_OBJECT;
-            }
+            valid =
+                Binary_Input_Valid_Instance(cov_data->
+                monitoredObjectIdentifier.instance);
+            break;
+        case OBJECT_ANALOG_INPUT:
+            valid =
+                Analog_Input_Valid_Instance(cov_data->
+                monitoredObjectIdentifier.instance);
+            break;
+        case OBJECT_ANALOG_OUTPUT:
+            valid =
+                Analog_Output_Valid_Instance(cov_data->
+                monitoredObjectIdentifier.instance);
+            break;
+        case OBJECT_ANALOG_VALUE:
+            valid =
+                Analog_Value_Valid_Instance(cov_data->
+                monitoredObjectIdentifier.instance);
             break;
         default:
-            *error_class = ERROR_CLASS_OBJECT;
-            *error_code = ERROR_CODE_UNKNOWN_OBJECT;
             break;
     }
+    if (valid) {
+        status = cov_list_subscribe(src, cov_data, error_class, error_code);
+    } else {
+        *error_class = ERROR_CLASS_OBJECT;
+        *error_code = ERROR_CODE_UNKNOWN_OBJECT;
+    }
 
     return status;
 }
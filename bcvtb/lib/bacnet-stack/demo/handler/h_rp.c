@@ -36,8 +36,7 @@
 #include "npdu.h"
 #include "abort.h"
 #include "rp.h"
-
-static uint8_t Temp_Buf[MAX_APDU] = { 0 };
+#include "tsm.h"
 
 static read_property_function Read_Property[MAX_BACNET_OBJECT_TYPE];
 
@@ -104,17 +103,18 @@ void handler_read_property(
     BACNET_ERROR_CLASS error_class = ERROR_CLASS_OBJECT;
     BACNET_ERROR_CODE error_code = ERROR_CODE_UNKNOWN_OBJECT;
     BACNET_ADDRESS my_address;
+    uint8_t *temp_buf = NULL;
 
     /* encode the NPDU portion of the packet */
     datalink_get_my_address(&my_address);
     npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
     pdu_len =
-        npdu_encode_pdu(&Handler_Transmit_Buffer[0], src, &my_address,
+        npdu_encode_pdu(&Handler_Segmented_Buffer[0], src, &my_address,
         &npdu_data);
     if (service_data->segmented_message) {
         /* we don't support segmentation - send an abort */
         len =
-            abort_encode_apdu(&Handler_Transmit_Buffer[pdu_len],
+            abort_encode_apdu(&Handler_Segmented_Buffer[pdu_len],
             service_data->invoke_id, ABORT_REASON_SEGMENTATION_NOT_SUPPORTED,
             true);
 #if PRINT_ENABLED
@@ -131,7 +131,7 @@ void handler_read_property(
     if (len < 0) {
         /* bad decoding - send an abort */
         len =
-            abort_encode_apdu(&Handler_Transmit_Buffer[pdu_len],
+            abort_encode_apdu(&Handler_Segmented_Buffer[pdu_len],
             service_data->invoke_id, ABORT_REASON_OTHER, true);
 #if PRINT_ENABLED
         fprintf(stderr, "RP: Bad Encoding.  Sending Abort!\n");
@@ -139,30 +139,55 @@ void handler_read_property(
         goto RP_ABORT;
     }
 
+    temp_buf = apdu_arena_alloc(MAX_SEGMENTED_APDU);
+    if (!temp_buf) {
+        len =
+            abort_encode_apdu(&Handler_Segmented_Buffer[pdu_len],
+            service_data->invoke_id, ABORT_REASON_BUFFER_OVERFLOW, true);
+#if PRINT_ENABLED
+        fprintf(stderr, "RP: No scratch buffer.  Sending Abort!\n");
+#endif
+        goto RP_ABORT;
+    }
+
     /* assume that there is an error */
     error = true;
     len =
-        Encode_Property_APDU(&Temp_Buf[0], data.object_type,
+        Encode_Property_APDU(&temp_buf[0], data.object_type,
         data.object_instance, data.object_property, data.array_index,
         &error_class, &error_code);
     if (len >= 0) {
         /* encode the APDU portion of the packet */
-        data.application_data = &Temp_Buf[0];
+        data.application_data = &temp_buf[0];
         data.application_data_len = len;
         /* FIXME: probably need a length limitation sent with encode */
         len =
-            rp_ack_encode_apdu(&Handler_Transmit_Buffer[pdu_len],
+            rp_ack_encode_apdu(&Handler_Segmented_Buffer[pdu_len],
             service_data->invoke_id, &data);
+        error = false;
+        if (len > apdu_max_response(service_data)) {
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+            if (tsm_segmented_complex_ack_send(src, &npdu_data,
+                    service_data, &Handler_Segmented_Buffer[pdu_len], len)) {
 #if PRINT_ENABLED
-        fprintf(stderr, "RP: Sending Ack!\n");
+                fprintf(stderr, "RP: Sending Segmented Ack!\n");
+#endif
+                return;
+            }
+#endif
+            len = -2;
+            error = true;
+        }
+#if PRINT_ENABLED
+        if (!error)
+            fprintf(stderr, "RP: Sending Ack!\n");
 #endif
-        error = false;
     }
     if (error) {
         if (len == -2) {
             /* BACnet APDU too small to fit data, so proper response is Abort */
             len =
-                abort_encode_apdu(&Handler_Transmit_Buffer[pdu_len],
+                abort_encode_apdu(&Handler_Segmented_Buffer[pdu_len],
                 service_data->invoke_id,
                 ABORT_REASON_SEGMENTATION_NOT_SUPPORTED, true);
 #if PRINT_ENABLED
@@ -170,7 +195,7 @@ void handler_read_property(
 #endif
         } else {
             len =
-                bacerror_encode_apdu(&Handler_Transmit_Buffer[pdu_len],
+                bacerror_encode_apdu(&Handler_Segmented_Buffer[pdu_len],
                 service_data->invoke_id, SERVICE_CONFIRMED_READ_PROPERTY,
                 error_class, error_code);
 #if PRINT_ENABLED
@@ -181,7 +206,7 @@ void handler_read_property(
   RP_ABORT:
     pdu_len += len;
     bytes_sent =
-        datalink_send_pdu(src, &npdu_data, &Handler_Transmit_Buffer[0],
+        datalink_send_pdu(src, &npdu_data, &Handler_Segmented_Buffer[0],
         pdu_len);
 #if PRINT_ENABLED
     if (bytes_sent <= 0)
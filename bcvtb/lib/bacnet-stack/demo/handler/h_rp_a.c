@@ -45,14 +45,13 @@
 static void PrintReadPropertyData(
     BACNET_READ_PROPERTY_DATA * data)
 {
-    BACNET_APPLICATION_DATA_VALUE value;        /* for decode value data */
-    int len = 0;
-    uint8_t *application_data;
-    int application_data_len;
+    BACNET_APPLICATION_DATA_ITERATOR iterator;
+    BACNET_APPLICATION_DATA_VIEW view;  /* for the value data, in place */
     bool first_value = true;
     bool print_brace = false;
+    bool print_comma = false;
 
-    if (data) {
+    if (data && (data->application_data_len >= 0)) {
 #if 0
         if (data->array_index == BACNET_ARRAY_ALL)
             fprintf(stderr, "%s #%u %s\n",
@@ -66,34 +65,25 @@ static void PrintReadPropertyData(
                 bactext_property_name(data->object_property),
                 data->array_index);
 #endif
-        application_data = data->application_data;
-        application_data_len = data->application_data_len;
-        /* FIXME: what if application_data_len is bigger than 255? */
-        /* value? need to loop until all of the len is gone... */
-        for (;;) {
-            len =
-                bacapp_decode_application_data(application_data,
-                (uint8_t) application_data_len, &value);
-            if (first_value && (len < application_data_len)) {
+        bacapp_iterator_init(&iterator, data->application_data,
+            (uint32_t) data->application_data_len);
+        while (bacapp_iterator_next(&iterator, &view)) {
+            if (first_value) {
                 first_value = false;
+                if (bacapp_iterator_more(&iterator)) {
 #if PRINT_ENABLED
-                fprintf(stdout, "{");
+                    fprintf(stdout, "{");
 #endif
-                print_brace = true;
-            }
-            bacapp_print_value(stdout, &value, data->object_property);
-            if (len) {
-                if (len < application_data_len) {
-                    application_data += len;
-                    application_data_len -= len;
-                    /* there's more! */
+                    print_brace = true;
+                }
+            } else if (print_comma && !view.closing) {
+                /* there's more! */
 #if PRINT_ENABLED
-                    fprintf(stdout, ",");
+                fprintf(stdout, ",");
 #endif
-                } else
-                    break;
-            } else
-                break;
+            }
+            bacapp_print_view(stdout, &view, data->object_property);
+            print_comma = !view.opening;
         }
 #if PRINT_ENABLED
         if (print_brace)
@@ -38,8 +38,7 @@
 #include "abort.h"
 #include "rpm.h"
 #include "handlers.h"
-
-static uint8_t Temp_Buf[MAX_APDU] = { 0 };
+#include "tsm.h"
 
 static rpm_property_lists_function RPM_Lists[MAX_BACNET_OBJECT_TYPE];
 
@@ -172,8 +171,10 @@ static unsigned RPM_Object_Property_Count(
 }
 
 /* Encode the RPM property returning the length of the encoding,
-   or 0 if there is no room to fit the encoding.  */
+   or 0 if there is no room to fit the encoding.
+   The value is encoded in temp_buf first, which holds MAX_SEGMENTED_APDU. */
 int RPM_Encode_Property(
+    uint8_t * temp_buf,
     uint8_t * apdu,
     uint16_t offset,
     uint16_t max_apdu,
@@ -189,23 +190,23 @@ int RPM_Encode_Property(
     BACNET_ERROR_CODE error_code = ERROR_CODE_UNKNOWN_OBJECT;
 
     len =
-        rpm_ack_encode_apdu_object_property(&Temp_Buf[0], object_property,
+        rpm_ack_encode_apdu_object_property(&temp_buf[0], object_property,
         array_index);
-    copy_len = memcopy(&apdu[0], &Temp_Buf[0], offset, len, max_apdu);
+    copy_len = memcopy(&apdu[0], &temp_buf[0], offset, len, max_apdu);
     if (copy_len == 0) {
         return 0;
     }
     apdu_len += len;
     len =
-        Encode_Property_APDU(&Temp_Buf[0], object_type, object_instance,
+        Encode_Property_APDU(&temp_buf[0], object_type, object_instance,
         object_property, array_index, &error_class, &error_code);
     if (len < 0) {
         /* error was returned - encode that for the response */
         len =
-            rpm_ack_encode_apdu_object_property_error(&Temp_Buf[0],
+            rpm_ack_encode_apdu_object_property_error(&temp_buf[0],
             error_class, error_code);
         copy_len =
-            memcopy(&apdu[0], &Temp_Buf[0], offset + apdu_len, len, max_apdu);
+            memcopy(&apdu[0], &temp_buf[0], offset + apdu_len, len, max_apdu);
         if (copy_len == 0) {
             return 0;
         }
@@ -213,7 +214,7 @@ int RPM_Encode_Property(
         /* enough room to fit the property value and tags */
         len =
             rpm_ack_encode_apdu_object_property_value(&apdu[offset + apdu_len],
-            &Temp_Buf[0], len);
+            &temp_buf[0], len);
     } else {
         /* not enough room - abort! */
         return 0;
@@ -242,6 +243,7 @@ void handler_read_property_multiple(
     int npdu_len = 0;
     BACNET_PROPERTY_ID object_property;
     int32_t array_index = 0;
+    uint8_t *temp_buf = NULL;
 
     /* jps_debug - see if we are utilizing all the buffer */
     /* memset(&Handler_Transmit_Buffer[0], 0xff, sizeof(Handler_Transmit_Buffer)); */
@@ -249,22 +251,32 @@ void handler_read_property_multiple(
     datalink_get_my_address(&my_address);
     npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
     npdu_len =
-        npdu_encode_pdu(&Handler_Transmit_Buffer[0], src, &my_address,
+        npdu_encode_pdu(&Handler_Segmented_Buffer[0], src, &my_address,
         &npdu_data);
     if (service_data->segmented_message) {
         apdu_len =
-            abort_encode_apdu(&Handler_Transmit_Buffer[npdu_len],
+            abort_encode_apdu(&Handler_Segmented_Buffer[npdu_len],
             service_data->invoke_id, ABORT_REASON_SEGMENTATION_NOT_SUPPORTED,
             true);
 #if PRINT_ENABLED
         printf("RPM: Segmented message. Sending Abort!\r\n");
+#endif
+        goto RPM_ABORT;
+    }
+    temp_buf = apdu_arena_alloc(MAX_SEGMENTED_APDU);
+    if (!temp_buf) {
+        apdu_len =
+            abort_encode_apdu(&Handler_Segmented_Buffer[npdu_len],
+            service_data->invoke_id, ABORT_REASON_BUFFER_OVERFLOW, true);
+#if PRINT_ENABLED
+        printf("RPM: No scratch buffer. Sending Abort!\r\n");
 #endif
         goto RPM_ABORT;
     }
     /* decode apdu request & encode apdu reply
        encode complex ack, invoke id, service choice */
     apdu_len =
-        rpm_ack_encode_apdu_init(&Handler_Transmit_Buffer[npdu_len],
+        rpm_ack_encode_apdu_init(&Handler_Segmented_Buffer[npdu_len],
         service_data->invoke_id);
     do {
         len =
@@ -279,13 +291,13 @@ void handler_read_property_multiple(
                 service_len - decode_len);
             if (len == 1) {
                 decode_len++;
-                len = rpm_ack_encode_apdu_object_end(&Temp_Buf[0]);
+                len = rpm_ack_encode_apdu_object_end(&temp_buf[0]);
                 copy_len =
-                    memcopy(&Handler_Transmit_Buffer[npdu_len], &Temp_Buf[0],
-                    apdu_len, len, sizeof(Handler_Transmit_Buffer));
+                    memcopy(&Handler_Segmented_Buffer[npdu_len], &temp_buf[0],
+                    apdu_len, len, MAX_SEGMENTED_APDU);
                 if (!copy_len) {
                     apdu_len =
-                        abort_encode_apdu(&Handler_Transmit_Buffer[npdu_len],
+                        abort_encode_apdu(&Handler_Segmented_Buffer[npdu_len],
                         service_data->invoke_id,
                         ABORT_REASON_SEGMENTATION_NOT_SUPPORTED, true);
                     goto RPM_ABORT;
@@ -294,21 +306,21 @@ void handler_read_property_multiple(
                 }
             } else {
                 apdu_len =
-                    abort_encode_apdu(&Handler_Transmit_Buffer[npdu_len],
+                    abort_encode_apdu(&Handler_Segmented_Buffer[npdu_len],
                     service_data->invoke_id, ABORT_REASON_OTHER, true);
                 goto RPM_ABORT;
             }
             break;
         }
         len =
-            rpm_ack_encode_apdu_object_begin(&Temp_Buf[0], object_type,
+            rpm_ack_encode_apdu_object_begin(&temp_buf[0], object_type,
             object_instance);
         copy_len =
-            memcopy(&Handler_Transmit_Buffer[npdu_len], &Temp_Buf[0], apdu_len,
-            len, sizeof(Handler_Transmit_Buffer));
+            memcopy(&Handler_Segmented_Buffer[npdu_len], &temp_buf[0], apdu_len,
+            len, MAX_SEGMENTED_APDU);
         if (!copy_len) {
             apdu_len =
-                abort_encode_apdu(&Handler_Transmit_Buffer[npdu_len],
+                abort_encode_apdu(&Handler_Segmented_Buffer[npdu_len],
                 service_data->invoke_id,
                 ABORT_REASON_SEGMENTATION_NOT_SUPPORTED, true);
             goto RPM_ABORT;
@@ -329,14 +341,14 @@ void handler_read_property_multiple(
                     service_len - decode_len);
                 if (len == 1) {
                     decode_len++;
-                    len = rpm_ack_encode_apdu_object_end(&Temp_Buf[0]);
+                    len = rpm_ack_encode_apdu_object_end(&temp_buf[0]);
                     copy_len =
-                        memcopy(&Handler_Transmit_Buffer[npdu_len],
-                        &Temp_Buf[0], apdu_len, len,
-                        sizeof(Handler_Transmit_Buffer));
+                        memcopy(&Handler_Segmented_Buffer[npdu_len],
+                        &temp_buf[0], apdu_len, len,
+                        MAX_SEGMENTED_APDU);
                     if (!copy_len) {
                         apdu_len =
-                            abort_encode_apdu(&Handler_Transmit_Buffer
+                            abort_encode_apdu(&Handler_Segmented_Buffer
                             [npdu_len], service_data->invoke_id,
                             ABORT_REASON_SEGMENTATION_NOT_SUPPORTED, true);
                         goto RPM_ABORT;
@@ -345,7 +357,7 @@ void handler_read_property_multiple(
                     }
                 } else {
                     apdu_len =
-                        abort_encode_apdu(&Handler_Transmit_Buffer[npdu_len],
+                        abort_encode_apdu(&Handler_Segmented_Buffer[npdu_len],
                         service_data->invoke_id, ABORT_REASON_OTHER, true);
                     goto RPM_ABORT;
                 }
@@ -369,14 +381,15 @@ void handler_read_property_multiple(
                 if (property_count == 0) {
                     /* handle the error code - but use the special property */
                     len =
-                        RPM_Encode_Property(&Handler_Transmit_Buffer[0],
-                        npdu_len + apdu_len, MAX_APDU, object_type,
+                        RPM_Encode_Property(temp_buf,
+                        &Handler_Segmented_Buffer[0], npdu_len + apdu_len,
+                        npdu_len + MAX_SEGMENTED_APDU, object_type,
                         object_instance, object_property, array_index);
                     if (len > 0) {
                         apdu_len += len;
                     } else {
                         apdu_len =
-                            abort_encode_apdu(&Handler_Transmit_Buffer
+                            abort_encode_apdu(&Handler_Segmented_Buffer
                             [npdu_len], service_data->invoke_id,
                             ABORT_REASON_SEGMENTATION_NOT_SUPPORTED, true);
                         goto RPM_ABORT;
@@ -387,14 +400,15 @@ void handler_read_property_multiple(
                             RPM_Object_Property(&property_list,
                             special_object_property, index);
                         len =
-                            RPM_Encode_Property(&Handler_Transmit_Buffer[0],
-                            npdu_len + apdu_len, MAX_APDU, object_type,
+                            RPM_Encode_Property(temp_buf,
+                            &Handler_Segmented_Buffer[0], npdu_len + apdu_len,
+                            npdu_len + MAX_SEGMENTED_APDU, object_type,
                             object_instance, object_property, array_index);
                         if (len > 0) {
                             apdu_len += len;
                         } else {
                             apdu_len =
-                                abort_encode_apdu(&Handler_Transmit_Buffer
+                                abort_encode_apdu(&Handler_Segmented_Buffer
                                 [npdu_len], service_data->invoke_id,
                                 ABORT_REASON_SEGMENTATION_NOT_SUPPORTED, true);
                             goto RPM_ABORT;
@@ -404,15 +418,15 @@ void handler_read_property_multiple(
             } else {
                 /* handle an individual property */
                 len =
-                    RPM_Encode_Property(&Handler_Transmit_Buffer[0],
-                    npdu_len + apdu_len, sizeof(Handler_Transmit_Buffer),
-                    object_type, object_instance, object_property,
-                    array_index);
+                    RPM_Encode_Property(temp_buf,
+                    &Handler_Segmented_Buffer[0], npdu_len + apdu_len,
+                    npdu_len + MAX_SEGMENTED_APDU, object_type,
+                    object_instance, object_property, array_index);
                 if (len > 0) {
                     apdu_len += len;
                 } else {
                     apdu_len =
-                        abort_encode_apdu(&Handler_Transmit_Buffer[npdu_len],
+                        abort_encode_apdu(&Handler_Segmented_Buffer[npdu_len],
                         service_data->invoke_id,
                         ABORT_REASON_SEGMENTATION_NOT_SUPPORTED, true);
                     goto RPM_ABORT;
@@ -423,9 +437,25 @@ void handler_read_property_multiple(
             break;
         }
     } while (1);
+    /* an ack too big for the client goes in segments, if it can */
+    if (apdu_len > apdu_max_response(service_data)) {
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+        if (tsm_segmented_complex_ack_send(src, &npdu_data, service_data,
+                &Handler_Segmented_Buffer[npdu_len], apdu_len)) {
+#if PRINT_ENABLED
+            printf("RPM: Sending Segmented Ack!\r\n");
+#endif
+            return;
+        }
+#endif
+        apdu_len =
+            abort_encode_apdu(&Handler_Segmented_Buffer[npdu_len],
+            service_data->invoke_id, ABORT_REASON_SEGMENTATION_NOT_SUPPORTED,
+            true);
+    }
   RPM_ABORT:
     pdu_len = apdu_len + npdu_len;
     bytes_sent =
-        datalink_send_pdu(src, &npdu_data, &Handler_Transmit_Buffer[0],
+        datalink_send_pdu(src, &npdu_data, &Handler_Segmented_Buffer[0],
         pdu_len);
 }
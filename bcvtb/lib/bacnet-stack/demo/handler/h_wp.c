@@ -36,6 +36,7 @@
 #include "npdu.h"
 #include "abort.h"
 #include "wp.h"
+#include "handlers.h"
 
 static write_property_function Write_Property[MAX_BACNET_OBJECT_TYPE];
 
@@ -48,6 +49,25 @@ void handler_write_property_object_set(
     }
 }
 
+bool Object_Write_Property(
+    BACNET_WRITE_PROPERTY_DATA * wp_data,
+    BACNET_ERROR_CLASS * error_class,
+    BACNET_ERROR_CODE * error_code)
+{
+    write_property_function wp_function = NULL;
+
+    if (wp_data->object_type < MAX_BACNET_OBJECT_TYPE) {
+        wp_function = Write_Property[wp_data->object_type];
+    }
+    if (wp_function) {
+        return wp_function(wp_data, error_class, error_code);
+    }
+    *error_class = ERROR_CLASS_OBJECT;
+    *error_code = ERROR_CODE_UNKNOWN_OBJECT;
+
+    return false;
+}
+
 void handler_write_property(
     uint8_t * service_request,
     uint16_t service_len,
@@ -62,7 +82,6 @@ void handler_write_property(
     BACNET_ERROR_CODE error_code = ERROR_CODE_UNKNOWN_OBJECT;
     int bytes_sent = 0;
     BACNET_ADDRESS my_address;
-    write_property_function wp_function = NULL;
 
     /* encode the NPDU portion of the packet */
     datalink_get_my_address(&my_address);
@@ -103,33 +122,20 @@ void handler_write_property(
 #endif
         goto WP_ABORT;
     }
-    if (wp_data.object_type < MAX_BACNET_OBJECT_TYPE) {
-        wp_function = Write_Property[wp_data.object_type];
-    }
-    if (wp_function) {
-        if (wp_function(&wp_data, &error_class, &error_code)) {
-            len =
-                encode_simple_ack(&Handler_Transmit_Buffer[pdu_len],
-                service_data->invoke_id, SERVICE_CONFIRMED_WRITE_PROPERTY);
-#if PRINT_ENABLED
-            fprintf(stderr, "WP: Sending Simple Ack!\n");
-#endif
-        } else {
-            len =
-                bacerror_encode_apdu(&Handler_Transmit_Buffer[pdu_len],
-                service_data->invoke_id, SERVICE_CONFIRMED_WRITE_PROPERTY,
-                error_class, error_code);
+    if (Object_Write_Property(&wp_data, &error_class, &error_code)) {
+        len =
+            encode_simple_ack(&Handler_Transmit_Buffer[pdu_len],
+            service_data->invoke_id, SERVICE_CONFIRMED_WRITE_PROPERTY);
 #if PRINT_ENABLED
-            fprintf(stderr, "WP: Sending Error!\n");
+        fprintf(stderr, "WP: Sending Simple Ack!\n");
 #endif
-        }
     } else {
         len =
             bacerror_encode_apdu(&Handler_Transmit_Buffer[pdu_len],
             service_data->invoke_id, SERVICE_CONFIRMED_WRITE_PROPERTY,
             error_class, error_code);
 #if PRINT_ENABLED
-        fprintf(stderr, "WP: Sending Unknown Object Error!\n");
+        fprintf(stderr, "WP: Sending Error!\n");
 #endif
     }
   WP_ABORT:
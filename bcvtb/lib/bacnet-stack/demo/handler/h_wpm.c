@@ -0,0 +1,147 @@
+/**************************************************************************
+*
+* Copyright (C) 2026 agent <agent@local>
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+*********************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include "config.h"
+#include "txbuf.h"
+#include "bacdef.h"
+#include "bacdcode.h"
+#include "apdu.h"
+#include "npdu.h"
+#include "abort.h"
+#include "wpm.h"
+#include "handlers.h"
+
+/* Writes each property in the order it was requested, and
+   stops at the first one that fails, as the service requires.
+   The writes before the failure are not undone. */
+void handler_write_property_multiple(
+    uint8_t * service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS * src,
+    BACNET_CONFIRMED_SERVICE_DATA * service_data)
+{
+    BACNET_WRITE_PROPERTY_DATA wp_data;
+    int len = 0;
+    int pdu_len = 0;
+    unsigned offset = 0;
+    BACNET_NPDU_DATA npdu_data;
+    BACNET_ERROR_CLASS error_class = ERROR_CLASS_OBJECT;
+    BACNET_ERROR_CODE error_code = ERROR_CODE_UNKNOWN_OBJECT;
+    int bytes_sent = 0;
+    BACNET_ADDRESS my_address;
+
+    /* encode the NPDU portion of the packet */
+    datalink_get_my_address(&my_address);
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    pdu_len =
+        npdu_encode_pdu(&Handler_Transmit_Buffer[0], src, &my_address,
+        &npdu_data);
+#if PRINT_ENABLED
+    fprintf(stderr, "WPM: Received Request!\n");
+#endif
+    if (service_data->segmented_message) {
+        len =
+            abort_encode_apdu(&Handler_Transmit_Buffer[pdu_len],
+            service_data->invoke_id, ABORT_REASON_SEGMENTATION_NOT_SUPPORTED,
+            true);
+#if PRINT_ENABLED
+        fprintf(stderr, "WPM: Segmented message.  Sending Abort!\n");
+#endif
+        goto WPM_ABORT;
+    }
+    /* there is at least one object, with at least one property */
+    do {
+        len =
+            wpm_decode_object_id(&service_request[offset],
+            service_len - offset, &wp_data);
+        if (len <= 0) {
+            goto WPM_BAD_ENCODING;
+        }
+        offset += len;
+        do {
+            len =
+                wpm_decode_object_property(&service_request[offset],
+                service_len - offset, &wp_data);
+            if (len <= 0) {
+                goto WPM_BAD_ENCODING;
+            }
+            offset += len;
+#if PRINT_ENABLED
+            fprintf(stderr,
+                "WPM: type=%u instance=%u property=%u priority=%u index=%d\n",
+                wp_data.object_type, wp_data.object_instance,
+                wp_data.object_property, wp_data.priority,
+                wp_data.array_index);
+#endif
+            if (!Object_Write_Property(&wp_data, &error_class, &error_code)) {
+                len =
+                    wpm_error_ack_encode_apdu(&Handler_Transmit_Buffer
+                    [pdu_len], service_data->invoke_id, &wp_data,
+                    error_class, error_code);
+#if PRINT_ENABLED
+                fprintf(stderr, "WPM: Sending Error!\n");
+#endif
+                goto WPM_ABORT;
+            }
+            if (offset >= service_len) {
+                goto WPM_BAD_ENCODING;
+            }
+            len =
+                wpm_decode_object_end(&service_request[offset],
+                service_len - offset);
+        } while (len == 0);
+        offset += len;
+    } while (offset < service_len);
+    len =
+        encode_simple_ack(&Handler_Transmit_Buffer[pdu_len],
+        service_data->invoke_id, SERVICE_CONFIRMED_WRITE_PROP_MULTIPLE);
+#if PRINT_ENABLED
+    fprintf(stderr, "WPM: Sending Simple Ack!\n");
+#endif
+    goto WPM_ABORT;
+  WPM_BAD_ENCODING:
+    /* bad decoding or something we didn't understand - send an abort */
+    len =
+        abort_encode_apdu(&Handler_Transmit_Buffer[pdu_len],
+        service_data->invoke_id, ABORT_REASON_OTHER, true);
+#if PRINT_ENABLED
+    fprintf(stderr, "WPM: Bad Encoding. Sending Abort!\n");
+#endif
+  WPM_ABORT:
+    pdu_len += len;
+    bytes_sent =
+        datalink_send_pdu(src, &npdu_data, &Handler_Transmit_Buffer[0],
+        pdu_len);
+#if PRINT_ENABLED
+    if (bytes_sent <= 0)
+        fprintf(stderr, "WPM: Failed to send PDU (%s)!\n", strerror(errno));
+#endif
+
+    return;
+}
@@ -36,11 +36,15 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <memory.h>
+#include "arena.h"
 #include "keylist.h"
 #include "objects.h"
 
 /* list of devices */
 static OS_Keylist Device_List = NULL;
+/* memory for the devices in the list */
+static BACNET_POOL Device_Pool =
+    POOL_INITIALIZER(sizeof(OBJECT_DEVICE_T), 16);
 
 void objects_init(
     void)
@@ -82,7 +86,7 @@ OBJECT_DEVICE_T *objects_device_new(
         if (pDevice) {
             memset(pDevice, 0, sizeof(OBJECT_DEVICE_T));
         } else {
-            pDevice = calloc(1, sizeof(OBJECT_DEVICE_T));
+            pDevice = pool_alloc(&Device_Pool);
             if (pDevice) {
                 pDevice->Object_Identifier.type = OBJECT_DEVICE;
                 pDevice->Object_Identifier.instance = device_instance;
@@ -113,8 +117,8 @@ OBJECT_DEVICE_T *objects_device_delete(
                 pDevice->Object_Identifier.instance);
             if (pDevice->Object_List) {
                 do {
-                    pObject =
-                        Keylist_Data_Delete_By_Index(pDevice->Object_List, 0);
+                    /* from the end, so no nodes are moved */
+                    pObject = Keylist_Data_Pop(pDevice->Object_List);
                     /* free any dynamic memory used */
                     if (pObject) {
                         free(pObject);
@@ -122,7 +126,7 @@ OBJECT_DEVICE_T *objects_device_delete(
                 } while (pObject);
                 Keylist_Delete(pDevice->Object_List);
             }
-            free(pDevice);
+            pool_free(&Device_Pool, pDevice);
         }
     }
     return pDevice;
@@ -0,0 +1,682 @@
+/**************************************************************************
+*
+* Copyright (C) 2026 agent <agent@local>
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+*********************************************************************/
+
+/* confirmed client requests kept in flight together */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "config.h"
+#include "bacdef.h"
+#include "bacenum.h"
+#include "address.h"
+#include "bacaddr.h"
+#include "tsm.h"
+#include "apdu.h"
+#include "rp.h"
+#include "rpm.h"
+#include "wpm.h"
+#include "pipeline.h"
+/* some demo stuff needed */
+#include "handlers.h"
+#include "client.h"
+#include "txbuf.h"
+
+/* marks the end of a list of requests */
+#define PIPELINE_NONE MAX_PIPELINE_REQUESTS
+
+typedef enum {
+    PIPELINE_REQUEST_SEND,
+    PIPELINE_REQUEST_READ_PROPERTY,
+    PIPELINE_REQUEST_READ_PROPERTY_MULTIPLE,
+    PIPELINE_REQUEST_WRITE_PROPERTY_MULTIPLE
+} PIPELINE_REQUEST_TYPE;
+
+typedef struct pipeline_request {
+    PIPELINE_REQUEST_TYPE type;
+    /* index into Pipeline_Devices */
+    unsigned device;
+    uint8_t invoke_id;
+    /* where the request was sent, which the reply must come from */
+    BACNET_ADDRESS dest;
+    /* next request in the device queue, the free list or the
+       in flight list */
+    unsigned next;
+    /* previous request in the in flight list */
+    unsigned prev;
+    pipeline_send_function send;
+    pipeline_complete_function complete;
+    void *context;
+    union {
+        BACNET_READ_PROPERTY_DATA rpdata;
+        BACNET_READ_ACCESS_DATA *read_access_data;
+        BACNET_WRITE_ACCESS_DATA *write_access_data;
+    } type_data;
+} PIPELINE_REQUEST;
+
+typedef struct pipeline_device {
+    bool in_use;
+    uint32_t device_id;
+    /* 0 uses the default window */
+    unsigned window;
+    unsigned in_flight;
+    /* requests waiting to be sent, oldest first */
+    unsigned head;
+    unsigned tail;
+    /* milliseconds left to bind, 0 if no Who-Is is outstanding */
+    uint32_t bind_timer;
+    /* the Who-Is went unanswered */
+    bool bind_failed;
+    /* when the device was last given a request, for reusing the
+       least recently used slot once they are all taken */
+    unsigned long last_used;
+} PIPELINE_DEVICE;
+
+static PIPELINE_REQUEST Pipeline_List[MAX_PIPELINE_REQUESTS];
+static PIPELINE_DEVICE Pipeline_Devices[MAX_PIPELINE_DEVICES];
+/* request in flight for each invoke ID, PIPELINE_NONE if none */
+static unsigned Pipeline_Invoke_ID[256];
+/* requests waiting for a reply, so they aren't looked for */
+static unsigned Pipeline_In_Flight = PIPELINE_NONE;
+static unsigned long Pipeline_Use_Count = 0;
+static unsigned Pipeline_Free = PIPELINE_NONE;
+static unsigned Pipeline_Count = 0;
+static unsigned Pipeline_Window = PIPELINE_WINDOW_DEFAULT;
+/* device to start from, so that all devices get a turn */
+static unsigned Pipeline_Next_Device = 0;
+
+static PIPELINE_DEVICE *pipeline_device_find(
+    uint32_t device_id,
+    bool create)
+{
+    unsigned i = 0;
+    PIPELINE_DEVICE *device = NULL;
+    PIPELINE_DEVICE *free_device = NULL;
+    PIPELINE_DEVICE *idle_device = NULL;
+
+    for (i = 0; i < MAX_PIPELINE_DEVICES; i++) {
+        device = &Pipeline_Devices[i];
+        if (device->in_use) {
+            if (device->device_id == device_id)
+                return device;
+            /* nothing queued or in flight */
+            if ((device->head == PIPELINE_NONE) && !device->in_flight &&
+                (!idle_device ||
+                    (device->last_used < idle_device->last_used)))
+                idle_device = device;
+        } else if (!free_device) {
+            free_device = device;
+        }
+    }
+    if (!free_device)
+        free_device = idle_device;
+    if (create && free_device) {
+        memset(free_device, 0, sizeof(PIPELINE_DEVICE));
+        free_device->in_use = true;
+        free_device->device_id = device_id;
+        free_device->head = PIPELINE_NONE;
+        free_device->tail = PIPELINE_NONE;
+        return free_device;
+    }
+
+    return NULL;
+}
+
+static unsigned pipeline_device_window(
+    PIPELINE_DEVICE * device)
+{
+    if (device->window)
+        return device->window;
+
+    return Pipeline_Window;
+}
+
+static void pipeline_request_free(
+    unsigned index)
+{
+    Pipeline_List[index].complete = NULL;
+    Pipeline_List[index].next = Pipeline_Free;
+    Pipeline_Free = index;
+    Pipeline_Count--;
+}
+
+/* frees the request, then calls its completion function,
+   which may queue more requests */
+static void pipeline_request_complete(
+    unsigned index,
+    PIPELINE_RESULT * result)
+{
+    PIPELINE_REQUEST *request = &Pipeline_List[index];
+    pipeline_complete_function complete = request->complete;
+    void *context = request->context;
+
+    result->device_id = Pipeline_Devices[request->device].device_id;
+    result->invoke_id = request->invoke_id;
+    pipeline_request_free(index);
+    if (complete)
+        complete(result, context);
+}
+
+/* takes the request off the invoke ID table, or returns
+   PIPELINE_NONE if the invoke ID isn't one of ours, or the reply
+   didn't come from the device that the request was sent to */
+static unsigned pipeline_request_landed(
+    uint8_t invoke_id,
+    BACNET_ADDRESS * src)
+{
+    unsigned index = Pipeline_Invoke_ID[invoke_id];
+    PIPELINE_REQUEST *request = NULL;
+
+    if (index != PIPELINE_NONE) {
+        request = &Pipeline_List[index];
+        if (src && !bacnet_address_same(&request->dest, src))
+            return PIPELINE_NONE;
+        Pipeline_Invoke_ID[invoke_id] = PIPELINE_NONE;
+        Pipeline_Devices[request->device].in_flight--;
+        if (request->prev != PIPELINE_NONE)
+            Pipeline_List[request->prev].next = request->next;
+        else
+            Pipeline_In_Flight = request->next;
+        if (request->next != PIPELINE_NONE)
+            Pipeline_List[request->next].prev = request->prev;
+        request->next = PIPELINE_NONE;
+        request->prev = PIPELINE_NONE;
+    }
+
+    return index;
+}
+
+static bool pipeline_request_add(
+    uint32_t device_id,
+    PIPELINE_REQUEST_TYPE type,
+    pipeline_send_function send,
+    pipeline_complete_function complete,
+    void *context,
+    unsigned *index)
+{
+    PIPELINE_DEVICE *device = NULL;
+    PIPELINE_REQUEST *request = NULL;
+
+    if ((Pipeline_Free == PIPELINE_NONE) || (device_id > BACNET_MAX_INSTANCE))
+        return false;
+    device = pipeline_device_find(device_id, true);
+    if (!device)
+        return false;
+    device->last_used = ++Pipeline_Use_Count;
+    *index = Pipeline_Free;
+    request = &Pipeline_List[*index];
+    Pipeline_Free = request->next;
+    Pipeline_Count++;
+    request->type = type;
+    request->device = (unsigned) (device - &Pipeline_Devices[0]);
+    request->invoke_id = 0;
+    request->next = PIPELINE_NONE;
+    request->send = send;
+    request->complete = complete;
+    request->context = context;
+    if (device->tail == PIPELINE_NONE)
+        device->head = *index;
+    else
+        Pipeline_List[device->tail].next = *index;
+    device->tail = *index;
+
+    return true;
+}
+
+void pipeline_ack_handler(
+    uint8_t * service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS * src,
+    BACNET_CONFIRMED_SERVICE_ACK_DATA * service_data)
+{
+    PIPELINE_RESULT result;
+    unsigned index;
+
+    index = pipeline_request_landed(service_data->invoke_id, src);
+    if (index != PIPELINE_NONE) {
+        memset(&result, 0, sizeof(result));
+        result.status = PIPELINE_STATUS_ACK;
+        result.service_request = service_request;
+        result.service_len = service_len;
+        result.service_data = service_data;
+        pipeline_request_complete(index, &result);
+    }
+}
+
+void pipeline_simple_ack_handler(
+    BACNET_ADDRESS * src,
+    uint8_t invoke_id)
+{
+    PIPELINE_RESULT result;
+    unsigned index;
+
+    index = pipeline_request_landed(invoke_id, src);
+    if (index != PIPELINE_NONE) {
+        memset(&result, 0, sizeof(result));
+        result.status = PIPELINE_STATUS_SIMPLE_ACK;
+        pipeline_request_complete(index, &result);
+    }
+}
+
+void pipeline_error_handler(
+    BACNET_ADDRESS * src,
+    uint8_t invoke_id,
+    BACNET_ERROR_CLASS error_class,
+    BACNET_ERROR_CODE error_code)
+{
+    PIPELINE_RESULT result;
+    unsigned index;
+
+    index = pipeline_request_landed(invoke_id, src);
+    if (index != PIPELINE_NONE) {
+        memset(&result, 0, sizeof(result));
+        result.status = PIPELINE_STATUS_ERROR;
+        result.error_class = error_class;
+        result.error_code = error_code;
+        pipeline_request_complete(index, &result);
+    }
+}
+
+/* WritePropertyMultiple-Error, which names the first failed write */
+static void pipeline_wpm_error_handler(
+    BACNET_ADDRESS * src,
+    uint8_t invoke_id,
+    uint8_t * service_request,
+    uint16_t service_len)
+{
+    PIPELINE_RESULT result;
+    BACNET_WRITE_PROPERTY_DATA wpdata;
+    unsigned index;
+    int len;
+
+    index = pipeline_request_landed(invoke_id, src);
+    if (index != PIPELINE_NONE) {
+        memset(&result, 0, sizeof(result));
+        result.status = PIPELINE_STATUS_ERROR;
+        result.error_class = ERROR_CLASS_SERVICES;
+        result.error_code = ERROR_CODE_OTHER;
+        len =
+            wpm_error_ack_decode_service_request(service_request,
+            service_len, &wpdata, &result.error_class, &result.error_code);
+        if (len > 0)
+            result.first_failed = &wpdata;
+        pipeline_request_complete(index, &result);
+    }
+}
+
+void pipeline_abort_handler(
+    BACNET_ADDRESS * src,
+    uint8_t invoke_id,
+    uint8_t abort_reason,
+    bool server)
+{
+    PIPELINE_RESULT result;
+    unsigned index;
+
+    (void) server;
+    index = pipeline_request_landed(invoke_id, src);
+    if (index != PIPELINE_NONE) {
+        memset(&result, 0, sizeof(result));
+        result.status = PIPELINE_STATUS_ABORT;
+        result.reason = abort_reason;
+        pipeline_request_complete(index, &result);
+    }
+}
+
+void pipeline_reject_handler(
+    BACNET_ADDRESS * src,
+    uint8_t invoke_id,
+    uint8_t reject_reason)
+{
+    PIPELINE_RESULT result;
+    unsigned index;
+
+    index = pipeline_request_landed(invoke_id, src);
+    if (index != PIPELINE_NONE) {
+        memset(&result, 0, sizeof(result));
+        result.status = PIPELINE_STATUS_REJECT;
+        result.reason = reject_reason;
+        pipeline_request_complete(index, &result);
+    }
+}
+
+void pipeline_init(
+    void)
+{
+    unsigned i = 0;
+
+    memset(Pipeline_Devices, 0, sizeof(Pipeline_Devices));
+    for (i = 0; i < 256; i++) {
+        Pipeline_Invoke_ID[i] = PIPELINE_NONE;
+    }
+    for (i = 0; i < MAX_PIPELINE_REQUESTS; i++) {
+        Pipeline_List[i].complete = NULL;
+        Pipeline_List[i].next = i + 1;
+    }
+    Pipeline_Free = 0;
+    Pipeline_Count = 0;
+    Pipeline_In_Flight = PIPELINE_NONE;
+    Pipeline_Use_Count = 0;
+    Pipeline_Next_Device = 0;
+    apdu_set_confirmed_ack_handler(SERVICE_CONFIRMED_READ_PROPERTY,
+        pipeline_ack_handler);
+    apdu_set_confirmed_ack_handler(SERVICE_CONFIRMED_READ_PROP_MULTIPLE,
+        pipeline_ack_handler);
+    apdu_set_confirmed_simple_ack_handler(SERVICE_CONFIRMED_WRITE_PROPERTY,
+        pipeline_simple_ack_handler);
+    apdu_set_confirmed_simple_ack_handler
+        (SERVICE_CONFIRMED_WRITE_PROP_MULTIPLE, pipeline_simple_ack_handler);
+    apdu_set_error_handler(SERVICE_CONFIRMED_READ_PROPERTY,
+        pipeline_error_handler);
+    apdu_set_error_handler(SERVICE_CONFIRMED_READ_PROP_MULTIPLE,
+        pipeline_error_handler);
+    apdu_set_error_handler(SERVICE_CONFIRMED_WRITE_PROPERTY,
+        pipeline_error_handler);
+    apdu_set_complex_error_handler(SERVICE_CONFIRMED_WRITE_PROP_MULTIPLE,
+        pipeline_wpm_error_handler);
+    apdu_set_abort_handler(pipeline_abort_handler);
+    apdu_set_reject_handler(pipeline_reject_handler);
+}
+
+void pipeline_window_default_set(
+    unsigned window)
+{
+    if (window)
+        Pipeline_Window = window;
+    else
+        Pipeline_Window = PIPELINE_WINDOW_DEFAULT;
+}
+
+bool pipeline_window_set(
+    uint32_t device_id,
+    unsigned window)
+{
+    PIPELINE_DEVICE *device = NULL;
+
+    device = pipeline_device_find(device_id, true);
+    if (device) {
+        device->last_used = ++Pipeline_Use_Count;
+        device->window = window;
+        return true;
+    }
+
+    return false;
+}
+
+bool pipeline_send(
+    uint32_t device_id,
+    pipeline_send_function send,
+    pipeline_complete_function complete,
+    void *context)
+{
+    unsigned index = 0;
+
+    if (!send)
+        return false;
+
+    return pipeline_request_add(device_id, PIPELINE_REQUEST_SEND, send,
+        complete, context, &index);
+}
+
+bool pipeline_read_property(
+    uint32_t device_id,
+    BACNET_READ_PROPERTY_DATA * rpdata,
+    pipeline_complete_function complete,
+    void *context)
+{
+    unsigned index = 0;
+
+    if (!rpdata)
+        return false;
+    if (!pipeline_request_add(device_id, PIPELINE_REQUEST_READ_PROPERTY, NULL,
+            complete, context, &index))
+        return false;
+    Pipeline_List[index].type_data.rpdata = *rpdata;
+
+    return true;
+}
+
+bool pipeline_read_property_multiple(
+    uint32_t device_id,
+    BACNET_READ_ACCESS_DATA * read_access_data,
+    pipeline_complete_function complete,
+    void *context)
+{
+    unsigned index = 0;
+
+    if (!read_access_data)
+        return false;
+    if (!pipeline_request_add(device_id,
+            PIPELINE_REQUEST_READ_PROPERTY_MULTIPLE, NULL, complete, context,
+            &index))
+        return false;
+    Pipeline_List[index].type_data.read_access_data = read_access_data;
+
+    return true;
+}
+
+bool pipeline_write_property_multiple(
+    uint32_t device_id,
+    BACNET_WRITE_ACCESS_DATA * write_access_data,
+    pipeline_complete_function complete,
+    void *context)
+{
+    unsigned index = 0;
+
+    if (!write_access_data)
+        return false;
+    if (!pipeline_request_add(device_id,
+            PIPELINE_REQUEST_WRITE_PROPERTY_MULTIPLE, NULL, complete, context,
+            &index))
+        return false;
+    Pipeline_List[index].type_data.write_access_data = write_access_data;
+
+    return true;
+}
+
+unsigned pipeline_count(
+    void)
+{
+    return Pipeline_Count;
+}
+
+void pipeline_timer_milliseconds(
+    uint16_t milliseconds)
+{
+    unsigned i = 0;
+    PIPELINE_DEVICE *device = NULL;
+
+    for (i = 0; i < MAX_PIPELINE_DEVICES; i++) {
+        device = &Pipeline_Devices[i];
+        if (device->in_use && device->bind_timer) {
+            if (device->bind_timer > milliseconds) {
+                device->bind_timer -= milliseconds;
+            } else {
+                device->bind_timer = 0;
+                device->bind_failed = true;
+            }
+        }
+    }
+}
+
+static uint8_t pipeline_request_send(
+    PIPELINE_REQUEST * request,
+    uint32_t device_id)
+{
+    uint8_t invoke_id = 0;
+    BACNET_READ_PROPERTY_DATA *rpdata = NULL;
+
+    switch (request->type) {
+        case PIPELINE_REQUEST_READ_PROPERTY:
+            rpdata = &request->type_data.rpdata;
+            invoke_id =
+                Send_Read_Property_Request(device_id, rpdata->object_type,
+                rpdata->object_instance, rpdata->object_property,
+                rpdata->array_index);
+            break;
+        case PIPELINE_REQUEST_READ_PROPERTY_MULTIPLE:
+            invoke_id =
+                Send_Read_Property_Multiple_Request(&Handler_Transmit_Buffer
+                [0], sizeof(Handler_Transmit_Buffer), device_id,
+                request->type_data.read_access_data);
+            break;
+        case PIPELINE_REQUEST_WRITE_PROPERTY_MULTIPLE:
+            invoke_id =
+                Send_Write_Property_Multiple_Request(&Handler_Transmit_Buffer
+                [0], sizeof(Handler_Transmit_Buffer), device_id,
+                request->type_data.write_access_data);
+            break;
+        case PIPELINE_REQUEST_SEND:
+        default:
+            invoke_id = request->send(device_id, request->context);
+            break;
+    }
+
+    return invoke_id;
+}
+
+/* completes every queued request of the device with the status */
+static void pipeline_device_flush(
+    PIPELINE_DEVICE * device,
+    PIPELINE_STATUS status)
+{
+    PIPELINE_RESULT result;
+    unsigned index = device->head;
+    unsigned next = 0;
+
+    /* the completion functions may queue more */
+    device->head = PIPELINE_NONE;
+    device->tail = PIPELINE_NONE;
+    while (index != PIPELINE_NONE) {
+        next = Pipeline_List[index].next;
+        memset(&result, 0, sizeof(result));
+        result.status = status;
+        pipeline_request_complete(index, &result);
+        index = next;
+    }
+}
+
+/* returns true if a request was taken off the device queue */
+static bool pipeline_device_task(
+    PIPELINE_DEVICE * device)
+{
+    PIPELINE_REQUEST *request = NULL;
+    PIPELINE_RESULT result;
+    BACNET_ADDRESS dest;
+    unsigned max_apdu = 0;
+    unsigned index = 0;
+    uint8_t invoke_id = 0;
+
+    if (device->head == PIPELINE_NONE)
+        return false;
+    if (device->in_flight >= pipeline_device_window(device))
+        return false;
+    if (!address_bind_request(device->device_id, &max_apdu, &dest)) {
+        if (device->bind_failed) {
+            device->bind_failed = false;
+            pipeline_device_flush(device, PIPELINE_STATUS_NOT_BOUND);
+            return true;
+        }
+        if (!device->bind_timer) {
+            Send_WhoIs(device->device_id, device->device_id);
+            device->bind_timer = (uint32_t) apdu_timeout() * apdu_retries();
+            if (!device->bind_timer)
+                device->bind_timer = 1;
+        }
+        return false;
+    }
+    device->bind_timer = 0;
+    device->bind_failed = false;
+    index = device->head;
+    request = &Pipeline_List[index];
+    device->head = request->next;
+    if (device->head == PIPELINE_NONE)
+        device->tail = PIPELINE_NONE;
+    request->next = PIPELINE_NONE;
+    request->prev = PIPELINE_NONE;
+    invoke_id = pipeline_request_send(request, device->device_id);
+    if (invoke_id) {
+        request->invoke_id = invoke_id;
+        bacnet_address_copy(&request->dest, &dest);
+        Pipeline_Invoke_ID[invoke_id] = index;
+        device->in_flight++;
+        request->next = Pipeline_In_Flight;
+        if (Pipeline_In_Flight != PIPELINE_NONE)
+            Pipeline_List[Pipeline_In_Flight].prev = index;
+        Pipeline_In_Flight = index;
+    } else {
+        memset(&result, 0, sizeof(result));
+        result.status = PIPELINE_STATUS_SEND_FAILED;
+        pipeline_request_complete(index, &result);
+    }
+
+    return true;
+}
+
+void pipeline_task(
+    void)
+{
+    PIPELINE_RESULT result;
+    unsigned i = 0;
+    unsigned index = 0;
+    unsigned next = 0;
+    unsigned device = 0;
+    uint8_t invoke_id = 0;
+    bool busy = true;
+
+    /* requests that the TSM gave up on, or that were answered
+       by a service that isn't routed here */
+    for (index = Pipeline_In_Flight; index != PIPELINE_NONE; index = next) {
+        next = Pipeline_List[index].next;
+        invoke_id = Pipeline_List[index].invoke_id;
+        memset(&result, 0, sizeof(result));
+        if (tsm_invoke_id_failed(invoke_id)) {
+            tsm_free_invoke_id(invoke_id);
+            result.status = PIPELINE_STATUS_TIMEOUT;
+        } else if (tsm_invoke_id_free(invoke_id)) {
+            result.status = PIPELINE_STATUS_UNKNOWN;
+        } else {
+            continue;
+        }
+        pipeline_request_landed(invoke_id, NULL);
+        pipeline_request_complete(index, &result);
+    }
+    /* one request per device per pass, so a busy device
+       doesn't hold up the others */
+    while (busy) {
+        busy = false;
+        for (i = 0; i < MAX_PIPELINE_DEVICES; i++) {
+            if (!tsm_transaction_available())
+                return;
+            device = (Pipeline_Next_Device + i) % MAX_PIPELINE_DEVICES;
+            if (!Pipeline_Devices[device].in_use)
+                continue;
+            if (pipeline_device_task(&Pipeline_Devices[device]))
+                busy = true;
+        }
+        Pipeline_Next_Device =
+            (Pipeline_Next_Device + 1) % MAX_PIPELINE_DEVICES;
+    }
+}
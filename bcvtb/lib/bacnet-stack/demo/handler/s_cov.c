@@ -39,6 +39,7 @@
 #include "cov.h"
 /* some demo stuff needed */
 #include "handlers.h"
+#include "txbuf.h"
 
 int ucov_notify_encode_pdu(
     uint8_t * buffer,
@@ -75,3 +76,63 @@ int Send_UCOV_Notify(
 
     return bytes_sent;
 }
+
+/* returns invoke id of 0 if device is not bound or no tsm available */
+uint8_t Send_COV_Subscribe(
+    uint32_t device_id,
+    BACNET_SUBSCRIBE_COV_DATA * cov_data)
+{
+    BACNET_ADDRESS dest;
+    BACNET_ADDRESS my_address;
+    unsigned max_apdu = 0;
+    uint8_t invoke_id = 0;
+    bool status = false;
+    int len = 0;
+    int pdu_len = 0;
+    int bytes_sent = 0;
+    BACNET_NPDU_DATA npdu_data;
+
+    if (!dcc_communication_enabled())
+        return 0;
+
+    /* is the device bound? */
+    status = address_get_by_device(device_id, &max_apdu, &dest);
+    /* is there a tsm available? */
+    if (status)
+        invoke_id = tsm_next_free_invokeID();
+    if (invoke_id) {
+        /* encode the NPDU portion of the packet */
+        datalink_get_my_address(&my_address);
+        npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
+        pdu_len =
+            npdu_encode_pdu(&Handler_Transmit_Buffer[0], &dest, &my_address,
+            &npdu_data);
+        /* encode the APDU portion of the packet */
+        len =
+            cov_subscribe_encode_adpu(&Handler_Transmit_Buffer[pdu_len],
+            invoke_id, cov_data);
+        pdu_len += len;
+        if ((unsigned) pdu_len < max_apdu) {
+            tsm_set_confirmed_unsegmented_transaction(invoke_id, &dest,
+                &npdu_data, &Handler_Transmit_Buffer[0], (uint16_t) pdu_len);
+            bytes_sent =
+                datalink_send_pdu(&dest, &npdu_data,
+                &Handler_Transmit_Buffer[0], pdu_len);
+#if PRINT_ENABLED
+            if (bytes_sent <= 0)
+                fprintf(stderr, "Failed to Send SubscribeCOV Request (%s)!\n",
+                    strerror(errno));
+#endif
+        } else {
+            tsm_free_invoke_id(invoke_id);
+            invoke_id = 0;
+#if PRINT_ENABLED
+            fprintf(stderr,
+                "Failed to Send SubscribeCOV Request "
+                "(exceeds destination maximum APDU)!\n");
+#endif
+        }
+    }
+
+    return invoke_id;
+}
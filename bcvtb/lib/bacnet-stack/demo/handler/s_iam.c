@@ -56,7 +56,7 @@ int iam_encode_pdu(
     /* encode the APDU portion of the packet */
     len =
         iam_encode_apdu(&buffer[pdu_len], Device_Object_Instance_Number(),
-        MAX_APDU, SEGMENTATION_NONE, Device_Vendor_Identifier());
+        MAX_APDU, Device_Segmentation_Supported(), Device_Vendor_Identifier());
     pdu_len += len;
 
     return pdu_len;
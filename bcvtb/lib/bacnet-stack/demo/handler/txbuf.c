@@ -28,3 +28,6 @@
 #include "datalink.h"
 
 uint8_t Handler_Transmit_Buffer[MAX_PDU] = { 0 };
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+uint8_t Handler_Segmented_Buffer[MAX_NPDU + MAX_SEGMENTED_APDU] = { 0 };
+#endif
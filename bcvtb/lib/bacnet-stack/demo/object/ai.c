@@ -31,13 +31,22 @@
 #include "bacdef.h"
 #include "bacdcode.h"
 #include "bacenum.h"
+#include "cov.h"
 #include "config.h"     /* the custom stuff */
+#include "ai.h"
 
 #ifndef MAX_ANALOG_INPUTS
 #define MAX_ANALOG_INPUTS 7
 #endif
 
 static float Present_Value[MAX_ANALOG_INPUTS];
+/* the value last sent in a COV notification */
+static float Prior_Value[MAX_ANALOG_INPUTS];
+/* how far the value must move from it before the next one */
+static float COV_Increment[MAX_ANALOG_INPUTS];
+/* Change of Value flag */
+static bool Change_Of_Value[MAX_ANALOG_INPUTS];
+static bool Analog_Input_Initialized = false;
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Properties_Required[] = {
@@ -54,6 +63,7 @@ static const int Properties_Required[] = {
 
 static const int Properties_Optional[] = {
     PROP_DESCRIPTION,
+    PROP_COV_INCREMENT,
     -1
 };
 
@@ -85,6 +95,7 @@ void Analog_Input_Property_Lists(
 bool Analog_Input_Valid_Instance(
     uint32_t object_instance)
 {
+    Analog_Input_Init();
     if (object_instance < MAX_ANALOG_INPUTS)
         return true;
 
@@ -96,6 +107,7 @@ bool Analog_Input_Valid_Instance(
 unsigned Analog_Input_Count(
     void)
 {
+    Analog_Input_Init();
     return MAX_ANALOG_INPUTS;
 }
 
@@ -105,6 +117,7 @@ unsigned Analog_Input_Count(
 uint32_t Analog_Input_Index_To_Instance(
     unsigned index)
 {
+    Analog_Input_Init();
     return index;
 }
 
@@ -124,11 +137,96 @@ void Analog_Input_Present_Value_Set(
     uint32_t object_instance,
     float value)
 {
+    float delta = 0.0;
+
+    Analog_Input_Init();
     if (object_instance < MAX_ANALOG_INPUTS) {
         Present_Value[object_instance] = value;
+        delta = value - Prior_Value[object_instance];
+        if (delta < 0.0)
+            delta = -delta;
+        if ((delta > 0.0) && (delta >= COV_Increment[object_instance])) {
+            Change_Of_Value[object_instance] = true;
+        }
+    }
+}
+
+float Analog_Input_COV_Increment(
+    uint32_t object_instance)
+{
+    float value = 0.0;
+
+    Analog_Input_Init();
+    if (object_instance < MAX_ANALOG_INPUTS) {
+        value = COV_Increment[object_instance];
+    }
+
+    return value;
+}
+
+void Analog_Input_COV_Increment_Set(
+    uint32_t object_instance,
+    float value)
+{
+    Analog_Input_Init();
+    if (object_instance < MAX_ANALOG_INPUTS) {
+        COV_Increment[object_instance] = value;
+    }
+}
+
+bool Analog_Input_Change_Of_Value(
+    uint32_t object_instance)
+{
+    bool status = false;
+
+    if (object_instance < MAX_ANALOG_INPUTS) {
+        status = Change_Of_Value[object_instance];
+    }
+
+    return status;
+}
+
+/* the value being sent becomes the one the next change is measured from */
+void Analog_Input_Change_Of_Value_Clear(
+    uint32_t object_instance)
+{
+    if (object_instance < MAX_ANALOG_INPUTS) {
+        Change_Of_Value[object_instance] = false;
+        Prior_Value[object_instance] = Present_Value[object_instance];
     }
 }
 
+bool Analog_Input_Encode_Value_List(
+    uint32_t object_instance,
+    BACNET_PROPERTY_VALUE * value_list)
+{
+    value_list->propertyIdentifier = PROP_PRESENT_VALUE;
+    value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+    value_list->value.context_specific = false;
+    value_list->value.tag = BACNET_APPLICATION_TAG_REAL;
+    value_list->value.type.Real = Analog_Input_Present_Value(object_instance);
+    value_list->priority = BACNET_NO_PRIORITY;
+
+    value_list = value_list->next;
+
+    value_list->propertyIdentifier = PROP_STATUS_FLAGS;
+    value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+    value_list->value.context_specific = false;
+    value_list->value.tag = BACNET_APPLICATION_TAG_BIT_STRING;
+    bitstring_init(&value_list->value.type.Bit_String);
+    bitstring_set_bit(&value_list->value.type.Bit_String, STATUS_FLAG_IN_ALARM,
+        false);
+    bitstring_set_bit(&value_list->value.type.Bit_String, STATUS_FLAG_FAULT,
+        false);
+    bitstring_set_bit(&value_list->value.type.Bit_String,
+        STATUS_FLAG_OVERRIDDEN, false);
+    bitstring_set_bit(&value_list->value.type.Bit_String,
+        STATUS_FLAG_OUT_OF_SERVICE, false);
+    value_list->priority = BACNET_NO_PRIORITY;
+
+    return true;
+}
+
 char *Analog_Input_Name(
     uint32_t object_instance)
 {
@@ -197,6 +295,11 @@ int Analog_Input_Encode_Property_APDU(
         case PROP_UNITS:
             apdu_len = encode_application_enumerated(&apdu[0], UNITS_PERCENT);
             break;
+        case PROP_COV_INCREMENT:
+            apdu_len =
+                encode_application_real(&apdu[0],
+                Analog_Input_COV_Increment(object_instance));
+            break;
         case 9997:
             apdu_len = encode_application_real(&apdu[0], (float) 90.510);
             break;
@@ -220,6 +323,14 @@ int Analog_Input_Encode_Property_APDU(
 void Analog_Input_Init(
     void)
 {
+    unsigned i;
+
+    if (!Analog_Input_Initialized) {
+        Analog_Input_Initialized = true;
+        for (i = 0; i < MAX_ANALOG_INPUTS; i++) {
+            COV_Increment[i] = 1.0;
+        }
+    }
 }
 
 #ifdef TEST
@@ -256,6 +367,34 @@ void testAnalogInput(
     return;
 }
 
+void testAnalogInputCOV(
+    Test * pTest)
+{
+    /* the default, without anything calling Analog_Input_Init() */
+    ct_test(pTest, Analog_Input_COV_Increment(0) == 1.0);
+    Analog_Input_COV_Increment_Set(0, 2.0);
+    Analog_Input_Init();
+    ct_test(pTest, Analog_Input_COV_Increment(0) == 2.0);
+    Analog_Input_Present_Value_Set(0, 1.5);
+    ct_test(pTest, !Analog_Input_Change_Of_Value(0));
+    Analog_Input_Present_Value_Set(0, 2.5);
+    ct_test(pTest, Analog_Input_Change_Of_Value(0));
+    Analog_Input_Change_Of_Value_Clear(0);
+    ct_test(pTest, !Analog_Input_Change_Of_Value(0));
+    /* measured from 2.5 now, in either direction */
+    Analog_Input_Present_Value_Set(0, 4.0);
+    ct_test(pTest, !Analog_Input_Change_Of_Value(0));
+    Analog_Input_Present_Value_Set(0, 0.5);
+    ct_test(pTest, Analog_Input_Change_Of_Value(0));
+    /* any change at all, with no increment */
+    Analog_Input_Change_Of_Value_Clear(0);
+    Analog_Input_COV_Increment_Set(0, 0.0);
+    Analog_Input_Present_Value_Set(0, 0.5);
+    ct_test(pTest, !Analog_Input_Change_Of_Value(0));
+    Analog_Input_Present_Value_Set(0, 0.501);
+    ct_test(pTest, Analog_Input_Change_Of_Value(0));
+}
+
 #ifdef TEST_ANALOG_INPUT
 int main(
     void)
@@ -267,6 +406,8 @@ int main(
     /* individual tests */
     rc = ct_addTestFunction(pTest, testAnalogInput);
     assert(rc);
+    rc = ct_addTestFunction(pTest, testAnalogInputCOV);
+    assert(rc);
 
     ct_setStream(pTest, stdout);
     ct_run(pTest);
@@ -52,10 +52,19 @@ static uint8_t Analog_Output_Level[MAX_ANALOG_OUTPUTS][BACNET_MAX_PRIORITY];
 /* Writable out-of-service allows others to play with our Present Value */
 /* without changing the physical output */
 static bool Analog_Output_Out_Of_Service[MAX_ANALOG_OUTPUTS];
+/* the value last sent in a COV notification */
+static float Analog_Output_Prior_Value[MAX_ANALOG_OUTPUTS];
+/* how far the value must move from it before the next one */
+static float Analog_Output_Increment[MAX_ANALOG_OUTPUTS];
+/* Change of Value flag */
+static bool Analog_Output_Changed[MAX_ANALOG_OUTPUTS];
 
 /* we need to have our arrays initialized before answering any calls */
 static bool Analog_Output_Initialized = false;
 
+static void Analog_Output_COV_Detect(
+    unsigned index);
+
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Properties_Required[] = {
     PROP_OBJECT_IDENTIFIER,
@@ -73,6 +82,7 @@ static const int Properties_Required[] = {
 
 static const int Properties_Optional[] = {
     PROP_DESCRIPTION,
+    PROP_COV_INCREMENT,
     -1
 };
 
@@ -108,6 +118,7 @@ void Analog_Output_Init(
             for (j = 0; j < BACNET_MAX_PRIORITY; j++) {
                 Analog_Output_Level[i][j] = AO_LEVEL_NULL;
             }
+            Analog_Output_Increment[i] = 1.0;
         }
     }
 
@@ -120,6 +131,7 @@ void Analog_Output_Init(
 bool Analog_Output_Valid_Instance(
     uint32_t object_instance)
 {
+    Analog_Output_Init();
     if (object_instance < MAX_ANALOG_OUTPUTS)
         return true;
 
@@ -131,6 +143,7 @@ bool Analog_Output_Valid_Instance(
 unsigned Analog_Output_Count(
     void)
 {
+    Analog_Output_Init();
     return MAX_ANALOG_OUTPUTS;
 }
 
@@ -140,6 +153,7 @@ unsigned Analog_Output_Count(
 uint32_t Analog_Output_Index_To_Instance(
     unsigned index)
 {
+    Analog_Output_Init();
     return index;
 }
 
@@ -151,6 +165,7 @@ unsigned Analog_Output_Instance_To_Index(
 {
     unsigned index = MAX_ANALOG_OUTPUTS;
 
+    Analog_Output_Init();
     if (object_instance < MAX_ANALOG_OUTPUTS)
         index = object_instance;
 
@@ -211,6 +226,7 @@ bool Analog_Output_Present_Value_Set(
             (priority != 6 /* reserved */ ) &&
             (value >= 0.0) && (value <= 100.0)) {
             Analog_Output_Level[index][priority - 1] = (uint8_t) value;
+            Analog_Output_COV_Detect(index);
             /* Note: you could set the physical output here to the next
                highest priority, or to the relinquish default if no
                priorities are set.
@@ -236,6 +252,7 @@ bool Analog_Output_Present_Value_Relinquish(
         if (priority && (priority <= BACNET_MAX_PRIORITY) &&
             (priority != 6 /* reserved */ )) {
             Analog_Output_Level[index][priority - 1] = AO_LEVEL_NULL;
+            Analog_Output_COV_Detect(index);
             /* Note: you could set the physical output here to the next
                highest priority, or to the relinquish default if no
                priorities are set.
@@ -249,6 +266,116 @@ bool Analog_Output_Present_Value_Relinquish(
     return status;
 }
 
+/* flags a change of value once the present value has moved
+   COV_Increment or more from the value last sent */
+static void Analog_Output_COV_Detect(
+    unsigned index)
+{
+    float value = 0.0;
+
+    value =
+        Analog_Output_Present_Value(Analog_Output_Index_To_Instance(index));
+    value -= Analog_Output_Prior_Value[index];
+    if (value < 0.0)
+        value = -value;
+    if ((value > 0.0) && (value >= Analog_Output_Increment[index])) {
+        Analog_Output_Changed[index] = true;
+    }
+}
+
+float Analog_Output_COV_Increment(
+    uint32_t object_instance)
+{
+    float value = 0.0;
+    unsigned index = 0;
+
+    index = Analog_Output_Instance_To_Index(object_instance);
+    if (index < MAX_ANALOG_OUTPUTS) {
+        value = Analog_Output_Increment[index];
+    }
+
+    return value;
+}
+
+void Analog_Output_COV_Increment_Set(
+    uint32_t object_instance,
+    float value)
+{
+    unsigned index = 0;
+
+    index = Analog_Output_Instance_To_Index(object_instance);
+    if (index < MAX_ANALOG_OUTPUTS) {
+        Analog_Output_Increment[index] = value;
+    }
+}
+
+bool Analog_Output_Change_Of_Value(
+    uint32_t object_instance)
+{
+    bool status = false;
+    unsigned index = 0;
+
+    index = Analog_Output_Instance_To_Index(object_instance);
+    if (index < MAX_ANALOG_OUTPUTS) {
+        status = Analog_Output_Changed[index];
+    }
+
+    return status;
+}
+
+/* the value being sent becomes the one the next change is measured from */
+void Analog_Output_Change_Of_Value_Clear(
+    uint32_t object_instance)
+{
+    unsigned index = 0;
+
+    index = Analog_Output_Instance_To_Index(object_instance);
+    if (index < MAX_ANALOG_OUTPUTS) {
+        Analog_Output_Changed[index] = false;
+        Analog_Output_Prior_Value[index] =
+            Analog_Output_Present_Value(object_instance);
+    }
+}
+
+bool Analog_Output_Encode_Value_List(
+    uint32_t object_instance,
+    BACNET_PROPERTY_VALUE * value_list)
+{
+    unsigned index = 0;
+    bool out_of_service = false;
+
+    index = Analog_Output_Instance_To_Index(object_instance);
+    if (index < MAX_ANALOG_OUTPUTS) {
+        out_of_service = Analog_Output_Out_Of_Service[index];
+    }
+    value_list->propertyIdentifier = PROP_PRESENT_VALUE;
+    value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+    value_list->value.context_specific = false;
+    value_list->value.tag = BACNET_APPLICATION_TAG_REAL;
+    value_list->value.type.Real =
+        Analog_Output_Present_Value(object_instance);
+    value_list->priority = BACNET_NO_PRIORITY;
+
+    value_list = value_list->next;
+
+    value_list->propertyIdentifier = PROP_STATUS_FLAGS;
+    value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+    value_list->value.context_specific = false;
+    value_list->value.tag = BACNET_APPLICATION_TAG_BIT_STRING;
+    bitstring_init(&value_list->value.type.Bit_String);
+    bitstring_set_bit(&value_list->value.type.Bit_String, STATUS_FLAG_IN_ALARM,
+        false);
+    bitstring_set_bit(&value_list->value.type.Bit_String, STATUS_FLAG_FAULT,
+        false);
+    bitstring_set_bit(&value_list->value.type.Bit_String,
+        STATUS_FLAG_OVERRIDDEN, false);
+    bitstring_set_bit(&value_list->value.type.Bit_String,
+        STATUS_FLAG_OUT_OF_SERVICE, out_of_service);
+    value_list->priority = BACNET_NO_PRIORITY;
+
+    return true;
+}
+
 /* note: the object name must be unique within this device */
 char *Analog_Output_Name(
     uint32_t object_instance)
@@ -372,6 +499,10 @@ int Analog_Output_Encode_Property_APDU(
                 }
             }
             break;
+        case PROP_COV_INCREMENT:
+            real_value = Analog_Output_COV_Increment(object_instance);
+            apdu_len = encode_application_real(&apdu[0], real_value);
+            break;
         case PROP_RELINQUISH_DEFAULT:
             real_value = AO_RELINQUISH_DEFAULT;
             apdu_len = encode_application_real(&apdu[0], real_value);
@@ -448,6 +579,10 @@ bool Analog_Output_Write_Property(
             if (value.tag == BACNET_APPLICATION_TAG_BOOLEAN) {
                 object_index =
                     Analog_Output_Instance_To_Index(wp_data->object_instance);
+                if (Analog_Output_Out_Of_Service[object_index] !=
+                    value.type.Boolean) {
+                    Analog_Output_Changed[object_index] = true;
+                }
                 Analog_Output_Out_Of_Service[object_index] =
                     value.type.Boolean;
                 status = true;
@@ -456,6 +591,21 @@ bool Analog_Output_Write_Property(
                 *error_code = ERROR_CODE_INVALID_DATA_TYPE;
             }
             break;
+        case PROP_COV_INCREMENT:
+            if (value.tag == BACNET_APPLICATION_TAG_REAL) {
+                if (value.type.Real >= 0.0) {
+                    Analog_Output_COV_Increment_Set(wp_data->object_instance,
+                        value.type.Real);
+                    status = true;
+                } else {
+                    *error_class = ERROR_CLASS_PROPERTY;
+                    *error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+                }
+            } else {
+                *error_class = ERROR_CLASS_PROPERTY;
+                *error_code = ERROR_CODE_INVALID_DATA_TYPE;
+            }
+            break;
         default:
             *error_class = ERROR_CLASS_PROPERTY;
             *error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
@@ -499,6 +649,29 @@ void testAnalogOutput(
     return;
 }
 
+void testAnalogOutputCOV(
+    Test * pTest)
+{
+    /* the default, without anything calling Analog_Output_Init() */
+    ct_test(pTest, Analog_Output_COV_Increment(0) == 1.0);
+    ct_test(pTest, Analog_Output_Present_Value_Set(0, 10.0, 16));
+    ct_test(pTest, Analog_Output_Change_Of_Value(0));
+    Analog_Output_Change_Of_Value_Clear(0);
+    /* a higher priority takes over the present value */
+    ct_test(pTest, Analog_Output_Present_Value_Set(0, 10.0, 8));
+    ct_test(pTest, !Analog_Output_Change_Of_Value(0));
+    Analog_Output_COV_Increment_Set(0, 5.0);
+    /* a late Analog_Output_Init() leaves it alone */
+    Analog_Output_Init();
+    ct_test(pTest, Analog_Output_COV_Increment(0) == 5.0);
+    ct_test(pTest, Analog_Output_Present_Value_Set(0, 14.0, 8));
+    ct_test(pTest, !Analog_Output_Change_Of_Value(0));
+    ct_test(pTest, Analog_Output_Present_Value_Set(0, 15.0, 8));
+    ct_test(pTest, Analog_Output_Change_Of_Value(0));
+    Analog_Output_Change_Of_Value_Clear(0);
+    ct_test(pTest, !Analog_Output_Change_Of_Value(0));
+}
+
 #ifdef TEST_ANALOG_OUTPUT
 int main(
     void)
@@ -510,6 +683,8 @@ int main(
     /* individual tests */
     rc = ct_addTestFunction(pTest, testAnalogOutput);
     assert(rc);
+    rc = ct_addTestFunction(pTest, testAnalogOutputCOV);
+    assert(rc);
 
     ct_setStream(pTest, stdout);
     ct_run(pTest);
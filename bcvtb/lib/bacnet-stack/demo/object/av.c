@@ -50,10 +50,19 @@ static uint8_t Analog_Value_Level[MAX_ANALOG_VALUES][BACNET_MAX_PRIORITY];
 /* Writable out-of-service allows others to play with our Present Value */
 /* without changing the physical output */
 static bool Analog_Value_Out_Of_Service[MAX_ANALOG_VALUES];
+/* the value last sent in a COV notification */
+static float Analog_Value_Prior_Value[MAX_ANALOG_VALUES];
+/* how far the value must move from it before the next one */
+static float Analog_Value_Increment[MAX_ANALOG_VALUES];
+/* Change of Value flag */
+static bool Analog_Value_Changed[MAX_ANALOG_VALUES];
 
 /* we need to have our arrays initialized before answering any calls */
 static bool Analog_Value_Initialized = false;
 
+static void Analog_Value_COV_Detect(
+    unsigned index);
+
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Analog_Value_Properties_Required[] = {
     PROP_OBJECT_IDENTIFIER,
@@ -69,6 +78,7 @@ static const int Analog_Value_Properties_Required[] = {
 
 static const int Analog_Value_Properties_Optional[] = {
     PROP_DESCRIPTION,
+    PROP_COV_INCREMENT,
     PROP_PRIORITY_ARRAY,
     PROP_RELINQUISH_DEFAULT,
     -1
@@ -106,6 +116,7 @@ void Analog_Value_Init(
             for (j = 0; j < BACNET_MAX_PRIORITY; j++) {
                 Analog_Value_Level[i][j] = ANALOG_LEVEL_NULL;
             }
+            Analog_Value_Increment[i] = 1.0;
         }
     }
 
@@ -174,6 +185,7 @@ bool Analog_Value_Present_Value_Set(
             (priority != 6 /* reserved */ ) &&
             (value >= 0.0) && (value <= 100.0)) {
             Analog_Value_Level[index][priority - 1] = (uint8_t) value;
+            Analog_Value_COV_Detect(index);
             /* Note: you could set the physical output here to the next
                highest priority, or to the relinquish default if no
                priorities are set.
@@ -208,6 +220,116 @@ float Analog_Value_Present_Value(
     return value;
 }
 
+/* flags a change of value once the present value has moved
+   COV_Increment or more from the value last sent */
+static void Analog_Value_COV_Detect(
+    unsigned index)
+{
+    float value = 0.0;
+
+    value =
+        Analog_Value_Present_Value(Analog_Value_Index_To_Instance(index));
+    value -= Analog_Value_Prior_Value[index];
+    if (value < 0.0)
+        value = -value;
+    if ((value > 0.0) && (value >= Analog_Value_Increment[index])) {
+        Analog_Value_Changed[index] = true;
+    }
+}
+
+float Analog_Value_COV_Increment(
+    uint32_t object_instance)
+{
+    float value = 0.0;
+    unsigned index = 0;
+
+    index = Analog_Value_Instance_To_Index(object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        value = Analog_Value_Increment[index];
+    }
+
+    return value;
+}
+
+void Analog_Value_COV_Increment_Set(
+    uint32_t object_instance,
+    float value)
+{
+    unsigned index = 0;
+
+    index = Analog_Value_Instance_To_Index(object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        Analog_Value_Increment[index] = value;
+    }
+}
+
+bool Analog_Value_Change_Of_Value(
+    uint32_t object_instance)
+{
+    bool status = false;
+    unsigned index = 0;
+
+    index = Analog_Value_Instance_To_Index(object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        status = Analog_Value_Changed[index];
+    }
+
+    return status;
+}
+
+/* the value being sent becomes the one the next change is measured from */
+void Analog_Value_Change_Of_Value_Clear(
+    uint32_t object_instance)
+{
+    unsigned index = 0;
+
+    index = Analog_Value_Instance_To_Index(object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        Analog_Value_Changed[index] = false;
+        Analog_Value_Prior_Value[index] =
+            Analog_Value_Present_Value(object_instance);
+    }
+}
+
+bool Analog_Value_Encode_Value_List(
+    uint32_t object_instance,
+    BACNET_PROPERTY_VALUE * value_list)
+{
+    unsigned index = 0;
+    bool out_of_service = false;
+
+    index = Analog_Value_Instance_To_Index(object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        out_of_service = Analog_Value_Out_Of_Service[index];
+    }
+    value_list->propertyIdentifier = PROP_PRESENT_VALUE;
+    value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+    value_list->value.context_specific = false;
+    value_list->value.tag = BACNET_APPLICATION_TAG_REAL;
+    value_list->value.type.Real =
+        Analog_Value_Present_Value(object_instance);
+    value_list->priority = BACNET_NO_PRIORITY;
+
+    value_list = value_list->next;
+
+    value_list->propertyIdentifier = PROP_STATUS_FLAGS;
+    value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+    value_list->value.context_specific = false;
+    value_list->value.tag = BACNET_APPLICATION_TAG_BIT_STRING;
+    bitstring_init(&value_list->value.type.Bit_String);
+    bitstring_set_bit(&value_list->value.type.Bit_String, STATUS_FLAG_IN_ALARM,
+        false);
+    bitstring_set_bit(&value_list->value.type.Bit_String, STATUS_FLAG_FAULT,
+        false);
+    bitstring_set_bit(&value_list->value.type.Bit_String,
+        STATUS_FLAG_OVERRIDDEN, false);
+    bitstring_set_bit(&value_list->value.type.Bit_String,
+        STATUS_FLAG_OUT_OF_SERVICE, out_of_service);
+    value_list->priority = BACNET_NO_PRIORITY;
+
+    return true;
+}
+
 /* note: the object name must be unique within this device */
 char *Analog_Value_Name(
     uint32_t object_instance)
@@ -331,6 +453,10 @@ int Analog_Value_Encode_Property_APDU(
                 }
             }
 
+            break;
+        case PROP_COV_INCREMENT:
+            real_value = Analog_Value_COV_Increment(object_instance);
+            apdu_len = encode_application_real(&apdu[0], real_value);
             break;
         case PROP_RELINQUISH_DEFAULT:
             real_value = ANALOG_RELINQUISH_DEFAULT;
@@ -398,6 +524,7 @@ bool Analog_Value_Write_Property(
                 if (priority && (priority <= BACNET_MAX_PRIORITY)) {
                     priority--;
                     Analog_Value_Level[object_index][priority] = level;
+                    Analog_Value_COV_Detect(object_index);
                     /* Note: you could set the physical output here to the next
                        highest priority, or to the relinquish default if no
                        priorities are set.
@@ -418,6 +545,10 @@ bool Analog_Value_Write_Property(
             if (value.tag == BACNET_APPLICATION_TAG_BOOLEAN) {
                 object_index =
                     Analog_Value_Instance_To_Index(wp_data->object_instance);
+                if (Analog_Value_Out_Of_Service[object_index] !=
+                    value.type.Boolean) {
+                    Analog_Value_Changed[object_index] = true;
+                }
                 Analog_Value_Out_Of_Service[object_index] = value.type.Boolean;
                 status = true;
             } else {
@@ -425,6 +556,21 @@ bool Analog_Value_Write_Property(
                 *error_code = ERROR_CODE_INVALID_DATA_TYPE;
             }
             break;
+        case PROP_COV_INCREMENT:
+            if (value.tag == BACNET_APPLICATION_TAG_REAL) {
+                if (value.type.Real >= 0.0) {
+                    Analog_Value_COV_Increment_Set(wp_data->object_instance,
+                        value.type.Real);
+                    status = true;
+                } else {
+                    *error_class = ERROR_CLASS_PROPERTY;
+                    *error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+                }
+            } else {
+                *error_class = ERROR_CLASS_PROPERTY;
+                *error_code = ERROR_CODE_INVALID_DATA_TYPE;
+            }
+            break;
         default:
             *error_class = ERROR_CLASS_PROPERTY;
             *error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
@@ -468,6 +614,26 @@ void testAnalog_Value(
     return;
 }
 
+void testAnalog_ValueCOV(
+    Test * pTest)
+{
+    Analog_Value_Init();
+    ct_test(pTest, Analog_Value_COV_Increment(0) == 1.0);
+    ct_test(pTest, Analog_Value_Present_Value_Set(0, 10.0, 16));
+    ct_test(pTest, Analog_Value_Change_Of_Value(0));
+    Analog_Value_Change_Of_Value_Clear(0);
+    /* a higher priority takes over the present value */
+    ct_test(pTest, Analog_Value_Present_Value_Set(0, 10.0, 8));
+    ct_test(pTest, !Analog_Value_Change_Of_Value(0));
+    Analog_Value_COV_Increment_Set(0, 5.0);
+    ct_test(pTest, Analog_Value_Present_Value_Set(0, 14.0, 8));
+    ct_test(pTest, !Analog_Value_Change_Of_Value(0));
+    ct_test(pTest, Analog_Value_Present_Value_Set(0, 15.0, 8));
+    ct_test(pTest, Analog_Value_Change_Of_Value(0));
+    Analog_Value_Change_Of_Value_Clear(0);
+    ct_test(pTest, !Analog_Value_Change_Of_Value(0));
+}
+
 #ifdef TEST_ANALOG_VALUE
 int main(
     void)
@@ -479,6 +645,8 @@ int main(
     /* individual tests */
     rc = ct_addTestFunction(pTest, testAnalog_Value);
     assert(rc);
+    rc = ct_addTestFunction(pTest, testAnalog_ValueCOV);
+    assert(rc);
 
     ct_setStream(pTest, stdout);
     ct_run(pTest);
@@ -60,6 +60,14 @@ void Device_Object_Function_Set(
     }
 }
 
+/* The object list can go out in segments.  Leave room for the
+   ReadProperty or ReadPropertyMultiple ack around it. */
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+#define DEVICE_OBJECT_LIST_MAX (MAX_SEGMENTED_APDU - 32)
+#else
+#define DEVICE_OBJECT_LIST_MAX MAX_APDU
+#endif
+
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Device_Properties_Required[] = {
     PROP_OBJECT_IDENTIFIER,
@@ -80,6 +88,10 @@ static const int Device_Properties_Required[] = {
     PROP_SEGMENTATION_SUPPORTED,
     PROP_APDU_TIMEOUT,
     PROP_NUMBER_OF_APDU_RETRIES,
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+    PROP_MAX_SEGMENTS_ACCEPTED,
+    PROP_APDU_SEGMENT_TIMEOUT,
+#endif
 #if defined(BACDL_MSTP)
     PROP_MAX_MASTER,
     PROP_MAX_INFO_FRAMES,
@@ -138,8 +150,8 @@ static char Description[16] = "server";
 /* Protocol_Services_Supported - dynamically generated */
 /* Protocol_Object_Types_Supported - in RP encoding */
 /* Object_List - dynamically generated */
-/* static BACNET_SEGMENTATION Segmentation_Supported = SEGMENTATION_NONE; */
-/* static uint8_t Max_Segments_Accepted = 0; */
+/* Segmentation_Supported - from MAX_SEGMENTS_ACCEPTED */
+/* Max_Segments_Accepted - MAX_SEGMENTS_ACCEPTED, constant */
 /* VT_Classes_Supported */
 /* Active_VT_Sessions */
 BACNET_TIME Local_Time; /* rely on OS, if there is one */
@@ -354,7 +366,11 @@ uint8_t Device_Protocol_Revision(
 BACNET_SEGMENTATION Device_Segmentation_Supported(
     void)
 {
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+    return SEGMENTATION_BOTH;
+#else
     return SEGMENTATION_NONE;
+#endif
 }
 
 uint8_t Device_Database_Revision(
@@ -640,7 +656,7 @@ int Device_Encode_Property_APDU(
                         apdu_len += len;
                         /* assume next one is the same size as this one */
                         /* can we all fit into the APDU? */
-                        if ((apdu_len + len) >= MAX_APDU) {
+                        if ((apdu_len + len) >= DEVICE_OBJECT_LIST_MAX) {
                             /* reject message */
                             apdu_len = -2;
                             break;
@@ -680,6 +696,16 @@ int Device_Encode_Property_APDU(
         case PROP_NUMBER_OF_APDU_RETRIES:
             apdu_len = encode_application_unsigned(&apdu[0], apdu_retries());
             break;
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+        case PROP_MAX_SEGMENTS_ACCEPTED:
+            apdu_len =
+                encode_application_unsigned(&apdu[0], MAX_SEGMENTS_ACCEPTED);
+            break;
+        case PROP_APDU_SEGMENT_TIMEOUT:
+            /* the TSM uses the APDU timeout for segments */
+            apdu_len = encode_application_unsigned(&apdu[0], apdu_timeout());
+            break;
+#endif
         case PROP_DEVICE_ADDRESS_BINDING:
             /* FIXME: the real max apdu remaining should be passed into function */
             apdu_len = address_list_encode(&apdu[0], MAX_APDU);
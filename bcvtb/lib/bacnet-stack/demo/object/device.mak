@@ -21,6 +21,7 @@ SRCS = device.c \
 	$(SRC_DIR)/bactext.c \
 	$(SRC_DIR)/indtext.c \
 	$(SRC_DIR)/apdu.c \
+	$(SRC_DIR)/arena.c \
 	$(SRC_DIR)/dcc.c \
 	$(SRC_DIR)/version.c \
 	$(TEST_DIR)/ctest.c
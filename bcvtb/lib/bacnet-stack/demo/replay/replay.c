@@ -0,0 +1,667 @@
+/*************************************************************************
+* Copyright (C) 2026 agent <agent@local>
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+*********************************************************************/
+
+/* replays MS/TP and BACnet/IP traffic from pcapng or libpcap capture
+   files through the MS/TP receive state machine or the BVLC header,
+   and into npdu_handler() of a simple server, either as fast as it
+   will go or at the pace of the capture.  Replies are counted but
+   not sent anywhere.  Prints the frames per second, and the number
+   of APDUs and the time spent in npdu_handler() for each service. */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "config.h"
+#include "bacdef.h"
+#include "bacenum.h"
+#include "bactext.h"
+#include "npdu.h"
+#include "apdu.h"
+#include "handlers.h"
+#include "datalink.h"
+#include "device.h"
+#include "mstp.h"
+#include "rs485.h"
+#include "pcapng.h"
+#include "ai.h"
+#include "ao.h"
+#include "av.h"
+#include "bi.h"
+#include "bo.h"
+#include "bv.h"
+
+/* frames kept in memory, so the file isn't read while timing */
+typedef struct replay_frame {
+    uint16_t link_type;
+    uint16_t length;
+    uint32_t offset;    /* of the frame data in Frame_Data */
+    uint64_t timestamp;
+} REPLAY_FRAME;
+
+/* time spent in npdu_handler() for one kind of APDU */
+typedef struct replay_stats {
+    unsigned long count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} REPLAY_STATS;
+
+static REPLAY_FRAME *Frames = NULL;
+static unsigned long Frame_Count = 0;
+static unsigned long Frame_Limit = 0;
+static uint8_t *Frame_Data = NULL;
+static uint32_t Frame_Data_Size = 0;
+static uint32_t Frame_Data_Limit = 0;
+
+static REPLAY_STATS Confirmed_Stats[MAX_BACNET_CONFIRMED_SERVICE];
+static REPLAY_STATS Unconfirmed_Stats[MAX_BACNET_UNCONFIRMED_SERVICE];
+/* everything else, by PDU type, and network layer messages */
+static REPLAY_STATS PDU_Type_Stats[16];
+static REPLAY_STATS Network_Stats;
+static unsigned long APDU_Count = 0;
+static unsigned long Invalid_Count = 0;
+static unsigned long Reply_Count = 0;
+static unsigned long Reply_Bytes = 0;
+
+/* the BACnet/IP datalink isn't built, so neither is bip.h */
+#if !defined(BVLL_TYPE_BACNET_IP)
+#define BVLL_TYPE_BACNET_IP (0x81)
+#endif
+
+/* UDP port of the BACnet/IP traffic */
+static uint16_t BIP_Port = 0xBAC0;
+static uint8_t PDU_Buffer[MAX_MPDU];
+
+/* local MS/TP port, fed one octet at a time */
+static volatile struct mstp_port_struct_t MSTP_Port;
+static uint8_t RxBuffer[MAX_MPDU];
+static uint8_t TxBuffer[MAX_MPDU];
+
+static uint64_t replay_clock_ns(
+    void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t) now.tv_sec * 1000000000UL) + now.tv_nsec;
+}
+
+/* the datalink: replies are counted and dropped */
+int datalink_send_pdu(
+    BACNET_ADDRESS * dest,
+    BACNET_NPDU_DATA * npdu_data,
+    uint8_t * pdu,
+    unsigned pdu_len)
+{
+    (void) dest;
+    (void) npdu_data;
+    (void) pdu;
+    Reply_Count++;
+    Reply_Bytes += pdu_len;
+
+    return (int) pdu_len;
+}
+
+uint16_t datalink_receive(
+    BACNET_ADDRESS * src,
+    uint8_t * pdu,
+    uint16_t max_pdu,
+    unsigned timeout)
+{
+    (void) src;
+    (void) pdu;
+    (void) max_pdu;
+    (void) timeout;
+
+    return 0;
+}
+
+void datalink_cleanup(
+    void)
+{
+}
+
+void datalink_get_broadcast_address(
+    BACNET_ADDRESS * dest)
+{
+    if (dest) {
+        memset(dest, 0, sizeof(*dest));
+        dest->net = BACNET_BROADCAST_NETWORK;
+    }
+}
+
+void datalink_get_my_address(
+    BACNET_ADDRESS * my_address)
+{
+    if (my_address) {
+        memset(my_address, 0, sizeof(*my_address));
+        my_address->mac_len = 1;
+        my_address->mac[0] = MSTP_Port.This_Station;
+    }
+}
+
+/* the MS/TP receive state machine only needs these to link */
+uint16_t MSTP_Put_Receive(
+    volatile struct mstp_port_struct_t *mstp_port)
+{
+    (void) mstp_port;
+
+    return 0;
+}
+
+uint16_t MSTP_Get_Send(
+    volatile struct mstp_port_struct_t * mstp_port,
+    unsigned timeout)
+{
+    (void) mstp_port;
+    (void) timeout;
+
+    return 0;
+}
+
+uint16_t MSTP_Get_Reply(
+    volatile struct mstp_port_struct_t * mstp_port,
+    unsigned timeout)
+{
+    (void) mstp_port;
+    (void) timeout;
+
+    return 0;
+}
+
+void RS485_Send_Frame(
+    volatile struct mstp_port_struct_t *mstp_port,
+    uint8_t * buffer,
+    uint16_t nbytes)
+{
+    (void) mstp_port;
+    (void) buffer;
+    (void) nbytes;
+}
+
+/* the octets of a captured frame arrive back to back, but the line
+   is silent between frames */
+static uint16_t Silence_Time;
+
+static uint16_t Timer_Silence(
+    void)
+{
+    return Silence_Time;
+}
+
+static void Timer_Silence_Reset(
+    void)
+{
+    Silence_Time = 0;
+}
+
+static void replay_server_init(
+    uint32_t device_id)
+{
+    Device_Set_Object_Instance_Number(device_id);
+    Device_Init();
+    Device_Object_Function_Set(OBJECT_ANALOG_INPUT, Analog_Input_Count,
+        Analog_Input_Index_To_Instance, Analog_Input_Name);
+    Device_Object_Function_Set(OBJECT_ANALOG_OUTPUT, Analog_Output_Count,
+        Analog_Output_Index_To_Instance, Analog_Output_Name);
+    Device_Object_Function_Set(OBJECT_ANALOG_VALUE, Analog_Value_Count,
+        Analog_Value_Index_To_Instance, Analog_Value_Name);
+    Device_Object_Function_Set(OBJECT_BINARY_INPUT, Binary_Input_Count,
+        Binary_Input_Index_To_Instance, Binary_Input_Name);
+    Device_Object_Function_Set(OBJECT_BINARY_OUTPUT, Binary_Output_Count,
+        Binary_Output_Index_To_Instance, Binary_Output_Name);
+    Device_Object_Function_Set(OBJECT_BINARY_VALUE, Binary_Value_Count,
+        Binary_Value_Index_To_Instance, Binary_Value_Name);
+    handler_read_property_object_set(OBJECT_DEVICE,
+        Device_Encode_Property_APDU, Device_Valid_Object_Instance_Number);
+    handler_read_property_object_set(OBJECT_ANALOG_INPUT,
+        Analog_Input_Encode_Property_APDU, Analog_Input_Valid_Instance);
+    handler_read_property_object_set(OBJECT_ANALOG_OUTPUT,
+        Analog_Output_Encode_Property_APDU, Analog_Output_Valid_Instance);
+    handler_read_property_object_set(OBJECT_ANALOG_VALUE,
+        Analog_Value_Encode_Property_APDU, Analog_Value_Valid_Instance);
+    handler_read_property_object_set(OBJECT_BINARY_INPUT,
+        Binary_Input_Encode_Property_APDU, Binary_Input_Valid_Instance);
+    handler_read_property_object_set(OBJECT_BINARY_OUTPUT,
+        Binary_Output_Encode_Property_APDU, Binary_Output_Valid_Instance);
+    handler_read_property_object_set(OBJECT_BINARY_VALUE,
+        Binary_Value_Encode_Property_APDU, Binary_Value_Valid_Instance);
+    handler_write_property_object_set(OBJECT_DEVICE, Device_Write_Property);
+    handler_write_property_object_set(OBJECT_ANALOG_OUTPUT,
+        Analog_Output_Write_Property);
+    handler_write_property_object_set(OBJECT_ANALOG_VALUE,
+        Analog_Value_Write_Property);
+    handler_write_property_object_set(OBJECT_BINARY_OUTPUT,
+        Binary_Output_Write_Property);
+    handler_write_property_object_set(OBJECT_BINARY_VALUE,
+        Binary_Value_Write_Property);
+    handler_read_property_multiple_list_set(OBJECT_DEVICE,
+        Device_Property_Lists);
+    handler_read_property_multiple_list_set(OBJECT_ANALOG_INPUT,
+        Analog_Input_Property_Lists);
+    handler_read_property_multiple_list_set(OBJECT_ANALOG_OUTPUT,
+        Analog_Output_Property_Lists);
+    handler_read_property_multiple_list_set(OBJECT_ANALOG_VALUE,
+        Analog_Value_Property_Lists);
+    handler_read_property_multiple_list_set(OBJECT_BINARY_INPUT,
+        Binary_Input_Property_Lists);
+    handler_read_property_multiple_list_set(OBJECT_BINARY_OUTPUT,
+        Binary_Output_Property_Lists);
+    handler_read_property_multiple_list_set(OBJECT_BINARY_VALUE,
+        Binary_Value_Property_Lists);
+    apdu_set_unrecognized_service_handler_handler
+        (handler_unrecognized_service);
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_WHO_IS,
+        handler_who_is);
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_WHO_HAS,
+        handler_who_has);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_READ_PROPERTY,
+        handler_read_property);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_READ_PROP_MULTIPLE,
+        handler_read_property_multiple);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_WRITE_PROPERTY,
+        handler_write_property);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_WRITE_PROP_MULTIPLE,
+        handler_write_property_multiple);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_SUBSCRIBE_COV,
+        handler_cov_subscribe);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_READ_RANGE,
+        handler_read_range);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_DEVICE_COMMUNICATION_CONTROL,
+        handler_device_communication_control);
+}
+
+static void replay_mstp_init(
+    void)
+{
+    MSTP_Port.InputBuffer = &RxBuffer[0];
+    MSTP_Port.InputBufferSize = sizeof(RxBuffer);
+    MSTP_Port.OutputBuffer = &TxBuffer[0];
+    MSTP_Port.OutputBufferSize = sizeof(TxBuffer);
+    MSTP_Port.This_Station = 127;
+    MSTP_Port.Nmax_info_frames = 1;
+    MSTP_Port.Nmax_master = 127;
+    MSTP_Port.SilenceTimer = Timer_Silence;
+    MSTP_Port.SilenceTimerReset = Timer_Silence_Reset;
+    MSTP_Init(&MSTP_Port);
+    /* take the frames for every station */
+    MSTP_Port.Lurking = true;
+}
+
+/* the statistics that the APDU behind the NPDU counts against */
+static REPLAY_STATS *replay_stats(
+    uint8_t * pdu,
+    uint16_t pdu_len)
+{
+    BACNET_ADDRESS dest;
+    BACNET_NPDU_DATA npdu_data;
+    uint8_t *apdu;
+    uint8_t pdu_type;
+    int offset;
+
+    offset = npdu_decode(pdu, &dest, NULL, &npdu_data);
+    if ((offset <= 0) || (offset >= pdu_len) ||
+        npdu_data.network_layer_message) {
+        return &Network_Stats;
+    }
+    apdu = &pdu[offset];
+    pdu_type = apdu[0] & 0xF0;
+    if ((pdu_type == PDU_TYPE_CONFIRMED_SERVICE_REQUEST) &&
+        ((pdu_len - offset) >= 4)) {
+        /* segmented requests have two more octets before the choice */
+        if ((apdu[0] & BIT3) && ((pdu_len - offset) >= 6)) {
+            if (apdu[5] < MAX_BACNET_CONFIRMED_SERVICE) {
+                return &Confirmed_Stats[apdu[5]];
+            }
+        } else if (apdu[3] < MAX_BACNET_CONFIRMED_SERVICE) {
+            return &Confirmed_Stats[apdu[3]];
+        }
+    } else if ((pdu_type == PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST) &&
+        ((pdu_len - offset) >= 2)) {
+        if (apdu[1] < MAX_BACNET_UNCONFIRMED_SERVICE) {
+            return &Unconfirmed_Stats[apdu[1]];
+        }
+    }
+
+    return &PDU_Type_Stats[pdu_type >> 4];
+}
+
+static void replay_npdu(
+    BACNET_ADDRESS * src,
+    uint8_t * pdu,
+    uint16_t pdu_len)
+{
+    REPLAY_STATS *stats;
+    uint64_t start, elapsed;
+
+    stats = replay_stats(pdu, pdu_len);
+    start = replay_clock_ns();
+    npdu_handler(src, pdu, pdu_len);
+    elapsed = replay_clock_ns() - start;
+    stats->count++;
+    stats->total_ns += elapsed;
+    if (elapsed > stats->max_ns) {
+        stats->max_ns = elapsed;
+    }
+    APDU_Count++;
+}
+
+/* lets the line go quiet for longer than Tframe_abort, so a frame that
+   was cut short in the capture is dropped as invalid rather than
+   swallowing the octets of the frames after it */
+static void replay_mstp_silence(
+    void)
+{
+    Silence_Time = UINT16_MAX;
+    MSTP_Port.DataAvailable = false;
+    MSTP_Receive_Frame_FSM(&MSTP_Port);
+    if (MSTP_Port.ReceivedInvalidFrame) {
+        MSTP_Port.ReceivedInvalidFrame = false;
+        Invalid_Count++;
+    }
+}
+
+static void replay_mstp(
+    const uint8_t * data,
+    uint16_t length)
+{
+    BACNET_ADDRESS src;
+    uint16_t i;
+
+    replay_mstp_silence();
+    for (i = 0; i < length; i++) {
+        MSTP_Port.DataRegister = data[i];
+        MSTP_Port.DataAvailable = true;
+        MSTP_Receive_Frame_FSM(&MSTP_Port);
+        if (MSTP_Port.ReceivedValidFrame) {
+            MSTP_Port.ReceivedValidFrame = false;
+            if (((MSTP_Port.FrameType ==
+                        FRAME_TYPE_BACNET_DATA_EXPECTING_REPLY) ||
+                    (MSTP_Port.FrameType ==
+                        FRAME_TYPE_BACNET_DATA_NOT_EXPECTING_REPLY)) &&
+                MSTP_Port.DataLength) {
+                memset(&src, 0, sizeof(src));
+                src.mac_len = 1;
+                src.mac[0] = MSTP_Port.SourceAddress;
+                replay_npdu(&src, MSTP_Port.InputBuffer,
+                    MSTP_Port.DataLength);
+            }
+        } else if (MSTP_Port.ReceivedInvalidFrame) {
+            MSTP_Port.ReceivedInvalidFrame = false;
+            Invalid_Count++;
+        }
+    }
+}
+
+/* takes the BVLC header off a BACnet/IP datagram in an Ethernet
+   frame, the way bvlc_receive() does for the datagrams it reads */
+static void replay_bip(
+    const uint8_t * data,
+    uint16_t length)
+{
+    BACNET_ADDRESS src;
+    const uint8_t *ip = &data[14];
+    const uint8_t *udp;
+    const uint8_t *bvlc;
+    unsigned ip_len, udp_len, bvlc_len, npdu_offset;
+
+    if ((length < (14 + 20 + 8 + 4)) || (data[12] != 0x08) ||
+        (data[13] != 0x00)) {
+        return;
+    }
+    ip_len = (ip[0] & 0x0F) * 4;
+    if (((ip[0] >> 4) != 4) || (ip[9] != 17) ||
+        (length < (14 + ip_len + 8 + 4))) {
+        return;
+    }
+    udp = &ip[ip_len];
+    if ((((udp[0] << 8) | udp[1]) != BIP_Port) &&
+        (((udp[2] << 8) | udp[3]) != BIP_Port)) {
+        return;
+    }
+    udp_len = (udp[4] << 8) | udp[5];
+    if ((udp_len < (8 + 4)) || ((14 + ip_len + udp_len) > length)) {
+        return;
+    }
+    bvlc = &udp[8];
+    bvlc_len = (bvlc[2] << 8) | bvlc[3];
+    if ((bvlc[0] != BVLL_TYPE_BACNET_IP) || (bvlc_len > (udp_len - 8))) {
+        return;
+    }
+    memset(&src, 0, sizeof(src));
+    src.mac_len = 6;
+    if ((bvlc[1] == BVLC_ORIGINAL_UNICAST_NPDU) ||
+        (bvlc[1] == BVLC_ORIGINAL_BROADCAST_NPDU)) {
+        memcpy(&src.mac[0], &ip[12], 4);
+        memcpy(&src.mac[4], &udp[0], 2);
+        npdu_offset = 4;
+    } else if ((bvlc[1] == BVLC_FORWARDED_NPDU) && (bvlc_len > 10)) {
+        /* the original source is in the BVLC header */
+        memcpy(&src.mac[0], &bvlc[4], 6);
+        npdu_offset = 10;
+    } else {
+        return;
+    }
+    if ((bvlc_len <= npdu_offset) ||
+        ((bvlc_len - npdu_offset) > sizeof(PDU_Buffer))) {
+        return;
+    }
+    /* the handlers get a copy, so the capture can be replayed again */
+    memcpy(PDU_Buffer, &bvlc[npdu_offset], bvlc_len - npdu_offset);
+    replay_npdu(&src, PDU_Buffer, (uint16_t) (bvlc_len - npdu_offset));
+}
+
+static bool replay_load(
+    const char *filename)
+{
+    PCAPNG_READER reader;
+    PCAPNG_PACKET packet;
+    REPLAY_FRAME *frames;
+    uint8_t *data;
+    unsigned long skipped = 0;
+
+    if (!pcapng_reader_open(&reader, filename)) {
+        fprintf(stderr, "replay: %s is not a pcap or pcapng file\n",
+            filename);
+        return false;
+    }
+    while (pcapng_reader_next(&reader, &packet)) {
+        if (((packet.link_type != PCAPNG_LINKTYPE_BACNET_MS_TP) &&
+                (packet.link_type != PCAPNG_LINKTYPE_ETHERNET)) ||
+            (packet.length > 0xFFFF)) {
+            skipped++;
+            continue;
+        }
+        if (Frame_Count == Frame_Limit) {
+            Frame_Limit = Frame_Limit ? (Frame_Limit * 2) : 1024;
+            frames = realloc(Frames, Frame_Limit * sizeof(REPLAY_FRAME));
+            if (!frames) {
+                break;
+            }
+            Frames = frames;
+        }
+        while ((Frame_Data_Size + packet.length) > Frame_Data_Limit) {
+            Frame_Data_Limit =
+                Frame_Data_Limit ? (Frame_Data_Limit * 2) : 65536;
+            data = realloc(Frame_Data, Frame_Data_Limit);
+            if (!data) {
+                pcapng_reader_close(&reader);
+                return false;
+            }
+            Frame_Data = data;
+        }
+        Frames[Frame_Count].link_type = packet.link_type;
+        Frames[Frame_Count].length = (uint16_t) packet.length;
+        Frames[Frame_Count].offset = Frame_Data_Size;
+        Frames[Frame_Count].timestamp = packet.timestamp;
+        memcpy(&Frame_Data[Frame_Data_Size], packet.data, packet.length);
+        Frame_Data_Size += packet.length;
+        Frame_Count++;
+    }
+    pcapng_reader_close(&reader);
+    if (skipped) {
+        fprintf(stderr, "replay: %lu frames of other link types skipped\n",
+            skipped);
+    }
+
+    return true;
+}
+
+/* replays every frame once; with pace, each frame waits for the
+   time since the first frame that it had in the capture */
+static void replay_run(
+    bool pace)
+{
+    struct timespec wake;
+    uint64_t start;
+    uint64_t due;
+    unsigned long i;
+
+    start = replay_clock_ns();
+    for (i = 0; i < Frame_Count; i++) {
+        if (pace && (Frames[i].timestamp > Frames[0].timestamp)) {
+            due = start + (Frames[i].timestamp - Frames[0].timestamp);
+            wake.tv_sec = due / 1000000000UL;
+            wake.tv_nsec = due % 1000000000UL;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL);
+        }
+        if (Frames[i].link_type == PCAPNG_LINKTYPE_BACNET_MS_TP) {
+            replay_mstp(&Frame_Data[Frames[i].offset], Frames[i].length);
+        } else {
+            replay_bip(&Frame_Data[Frames[i].offset], Frames[i].length);
+        }
+    }
+    /* so that nothing of this pass carries over into the next one */
+    replay_mstp_silence();
+}
+
+static void replay_print_stats(
+    const char *service,
+    REPLAY_STATS * stats)
+{
+    if (stats->count) {
+        printf("%s,%lu,%lu,%lu\n", service, stats->count,
+            (unsigned long) (stats->total_ns / stats->count),
+            (unsigned long) stats->max_ns);
+    }
+}
+
+static void replay_report(
+    unsigned long frames,
+    uint64_t elapsed)
+{
+    static const char *pdu_type_names[16] = {
+        "confirmed-request", "unconfirmed-request", "simple-ack",
+        "complex-ack", "segment-ack", "error", "reject", "abort",
+        "unknown-8", "unknown-9", "unknown-10", "unknown-11",
+        "unknown-12", "unknown-13", "unknown-14", "unknown-15"
+    };
+    double seconds = elapsed / 1e9;
+    unsigned i;
+
+    printf("frames,apdus,invalid_frames,replies,reply_octets,seconds,"
+        "frames_per_second\n");
+    printf("%lu,%lu,%lu,%lu,%lu,%.6f,%.0f\n", frames, APDU_Count,
+        Invalid_Count, Reply_Count, Reply_Bytes, seconds,
+        (seconds > 0) ? (frames / seconds) : 0.0);
+    printf("service,apdus,mean_ns,max_ns\n");
+    for (i = 0; i < MAX_BACNET_CONFIRMED_SERVICE; i++) {
+        replay_print_stats(bactext_confirmed_service_name(i),
+            &Confirmed_Stats[i]);
+    }
+    for (i = 0; i < MAX_BACNET_UNCONFIRMED_SERVICE; i++) {
+        replay_print_stats(bactext_unconfirmed_service_name(i),
+            &Unconfirmed_Stats[i]);
+    }
+    for (i = 0; i < 16; i++) {
+        replay_print_stats(pdu_type_names[i], &PDU_Type_Stats[i]);
+    }
+    replay_print_stats("network-layer", &Network_Stats);
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    unsigned long repeat = 1;
+    unsigned long device_id = 260001;
+    unsigned long i = 0;
+    uint64_t elapsed = 0;
+    bool pace = false;
+    int argi = 0;
+    int files = 0;
+
+    if ((argc < 2) || (strcmp(argv[1], "--help") == 0)) {
+        printf("Usage: %s [--pace] [--repeat count] [--device instance]\r\n"
+            "    [--port udp-port] capture-file...\r\n", argv[0]);
+        printf("Replays the MS/TP and BACnet/IP frames of pcapng or\r\n"
+            "libpcap files into a simple server, as fast as it can or\r\n"
+            "with --pace at the rate they were captured.  --repeat\r\n"
+            "replays the frames count times.  The device instance\r\n"
+            "defaults to %lu and the UDP port to 47808.\r\n", device_id);
+        return 0;
+    }
+    for (argi = 1; argi < argc; argi++) {
+        if (strcmp(argv[argi], "--pace") == 0) {
+            pace = true;
+        } else if ((strcmp(argv[argi], "--repeat") == 0) &&
+            ((argi + 1) < argc)) {
+            argi++;
+            repeat = strtoul(argv[argi], NULL, 0);
+        } else if ((strcmp(argv[argi], "--device") == 0) &&
+            ((argi + 1) < argc)) {
+            argi++;
+            device_id = strtoul(argv[argi], NULL, 0);
+        } else if ((strcmp(argv[argi], "--port") == 0) &&
+            ((argi + 1) < argc)) {
+            argi++;
+            BIP_Port = (uint16_t) strtoul(argv[argi], NULL, 0);
+        } else {
+            if (!replay_load(argv[argi])) {
+                return 1;
+            }
+            files++;
+        }
+    }
+    if (!files) {
+        fprintf(stderr, "replay: no capture file\n");
+        return 1;
+    }
+    replay_server_init(device_id);
+    replay_mstp_init();
+    for (i = 0; i < repeat; i++) {
+        uint64_t start = replay_clock_ns();
+
+        replay_run(pace);
+        elapsed += replay_clock_ns() - start;
+    }
+    replay_report(Frame_Count * repeat, elapsed);
+    free(Frames);
+    free(Frame_Data);
+
+    return 0;
+}
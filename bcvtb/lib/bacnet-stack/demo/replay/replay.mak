@@ -0,0 +1,98 @@
+#Makefile to build the capture replay tool
+CC      = gcc
+SRC_DIR = ../../src
+PORT_DIR = ../../ports/linux
+HANDLER_DIR = ../handler
+OBJECT_DIR = ../object
+INCLUDES = -I../../include -I$(PORT_DIR) -I$(OBJECT_DIR) -I.
+# the replay tool is the datalink, so none of the real ones are built;
+# it takes the largest APDU of the datalinks that it replays
+DEFINES = -DBIG_ENDIAN=0 -DBACDL_TEST=1 -DMAX_APDU=1476 -DBACAPP_ALL \
+	-DBACTEXT_PRINT_ENABLED
+# build with the same optimization as the code being measured
+OPTIMIZATION = -O2
+
+CFLAGS  = -Wall $(OPTIMIZATION) $(INCLUDES) $(DEFINES)
+
+SRCS = replay.c \
+	$(SRC_DIR)/abort.c \
+	$(SRC_DIR)/address.c \
+	$(SRC_DIR)/apdu.c \
+	$(SRC_DIR)/arena.c \
+	$(SRC_DIR)/bacaddr.c \
+	$(SRC_DIR)/bacapp.c \
+	$(SRC_DIR)/bacdcode.c \
+	$(SRC_DIR)/bacerror.c \
+	$(SRC_DIR)/bacint.c \
+	$(SRC_DIR)/bacreal.c \
+	$(SRC_DIR)/bacstr.c \
+	$(SRC_DIR)/bactext.c \
+	$(SRC_DIR)/cov.c \
+	$(SRC_DIR)/crc.c \
+	$(SRC_DIR)/datetime.c \
+	$(SRC_DIR)/dcc.c \
+	$(SRC_DIR)/iam.c \
+	$(SRC_DIR)/ihave.c \
+	$(SRC_DIR)/indtext.c \
+	$(SRC_DIR)/memcopy.c \
+	$(SRC_DIR)/mstp.c \
+	$(SRC_DIR)/mstptext.c \
+	$(SRC_DIR)/npdu.c \
+	$(SRC_DIR)/pcapng.c \
+	$(SRC_DIR)/reject.c \
+	$(SRC_DIR)/readrange.c \
+	$(SRC_DIR)/ringbuf.c \
+	$(SRC_DIR)/rp.c \
+	$(SRC_DIR)/rpm.c \
+	$(SRC_DIR)/tsm.c \
+	$(SRC_DIR)/version.c \
+	$(SRC_DIR)/whohas.c \
+	$(SRC_DIR)/whois.c \
+	$(SRC_DIR)/wp.c \
+	$(SRC_DIR)/wpm.c \
+	$(HANDLER_DIR)/h_cov.c \
+	$(HANDLER_DIR)/h_dcc.c \
+	$(HANDLER_DIR)/h_npdu.c \
+	$(HANDLER_DIR)/h_rp.c \
+	$(HANDLER_DIR)/h_rpm.c \
+	$(HANDLER_DIR)/h_rr.c \
+	$(HANDLER_DIR)/h_whohas.c \
+	$(HANDLER_DIR)/h_whois.c \
+	$(HANDLER_DIR)/h_wp.c \
+	$(HANDLER_DIR)/h_wpm.c \
+	$(HANDLER_DIR)/noserv.c \
+	$(HANDLER_DIR)/s_iam.c \
+	$(HANDLER_DIR)/s_ihave.c \
+	$(HANDLER_DIR)/txbuf.c \
+	$(OBJECT_DIR)/device.c \
+	$(OBJECT_DIR)/ai.c \
+	$(OBJECT_DIR)/ao.c \
+	$(OBJECT_DIR)/av.c \
+	$(OBJECT_DIR)/bi.c \
+	$(OBJECT_DIR)/bo.c \
+	$(OBJECT_DIR)/bv.c
+
+TARGET = replay
+
+all: ${TARGET}
+
+OBJS = ${SRCS:.c=.o}
+
+${TARGET}: ${OBJS}
+	${CC} -pthread -o $@ ${OBJS} -lm
+
+# replay a capture: make -f replay.mak run CAPTURE=site.pcapng
+run: ${TARGET}
+	./${TARGET} ${CAPTURE}
+
+.c.o:
+	${CC} -c ${CFLAGS} $*.c -o $@
+
+depend:
+	rm -f .depend
+	${CC} -MM ${CFLAGS} *.c >> .depend
+
+clean:
+	rm -rf core ${TARGET} $(OBJS)
+
+include: .depend
@@ -101,6 +101,12 @@ extern "C" {
     void address_cache_timer(
         uint16_t uSeconds);
 
+    void address_file_init(
+        const char *pFilename);
+
+    bool address_file_save(
+        const char *pFilename);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
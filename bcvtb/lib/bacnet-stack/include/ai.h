@@ -28,6 +28,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "bacdef.h"
+#include "cov.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -78,6 +79,19 @@ extern "C" {
     void Analog_Input_Present_Value_Set(
         uint32_t object_instance,
         float value);
+    float Analog_Input_COV_Increment(
+        uint32_t object_instance);
+    void Analog_Input_COV_Increment_Set(
+        uint32_t object_instance,
+        float value);
+
+    bool Analog_Input_Change_Of_Value(
+        uint32_t object_instance);
+    void Analog_Input_Change_Of_Value_Clear(
+        uint32_t object_instance);
+    bool Analog_Input_Encode_Value_List(
+        uint32_t object_instance,
+        BACNET_PROPERTY_VALUE * value_list);
     void Analog_Input_Init(
         void);
 
@@ -85,6 +99,8 @@ extern "C" {
 #include "ctest.h"
     void testAnalogInput(
         Test * pTest);
+    void testAnalogInputCOV(
+        Test * pTest);
 #endif
 
 #ifdef __cplusplus
@@ -30,6 +30,7 @@
 #include "bacdef.h"
 #include "bacerror.h"
 #include "wp.h"
+#include "cov.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -61,6 +62,18 @@ extern "C" {
     bool Analog_Output_Present_Value_Relinquish(
         uint32_t object_instance,
         unsigned priority);
+    float Analog_Output_COV_Increment(
+        uint32_t object_instance);
+    void Analog_Output_COV_Increment_Set(
+        uint32_t object_instance,
+        float value);
+    bool Analog_Output_Change_Of_Value(
+        uint32_t object_instance);
+    void Analog_Output_Change_Of_Value_Clear(
+        uint32_t object_instance);
+    bool Analog_Output_Encode_Value_List(
+        uint32_t object_instance,
+        BACNET_PROPERTY_VALUE * value_list);
 
     char *Analog_Output_Name(
         uint32_t object_instance);
@@ -101,6 +114,8 @@ extern "C" {
 #include "ctest.h"
     void testAnalogOutput(
         Test * pTest);
+    void testAnalogOutputCOV(
+        Test * pTest);
 #endif
 
 #ifdef __cplusplus
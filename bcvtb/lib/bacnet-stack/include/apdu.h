@@ -36,6 +36,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
 #include "bacdef.h"
 #include "bacenum.h"
 
@@ -119,6 +120,16 @@ extern "C" {
         BACNET_ERROR_CLASS error_class,
         BACNET_ERROR_CODE error_code);
 
+/* error reply function for the services whose error says more than
+   the error class and code, such as WritePropertyMultiple-Error.
+   It gets the error after the service choice, undecoded. */
+    typedef void (
+        *complex_error_function) (
+        BACNET_ADDRESS * src,
+        uint8_t invoke_id,
+        uint8_t * service_request,
+        uint16_t service_len);
+
 /* generic abort reply function */
     typedef void (
         *abort_function) (
@@ -162,6 +173,11 @@ extern "C" {
         BACNET_CONFIRMED_SERVICE service_choice,
         error_function pFunction);
 
+/* used instead of the error handler of the service, if set */
+    void apdu_set_complex_error_handler(
+        BACNET_CONFIRMED_SERVICE service_choice,
+        complex_error_function pFunction);
+
     void apdu_set_abort_handler(
         abort_function pFunction);
 
@@ -175,6 +191,9 @@ extern "C" {
         uint8_t * service_choice,
         uint8_t ** service_request,
         uint16_t * service_request_len);
+/* the largest APDU that the client takes in an answer, up to ours */
+    uint16_t apdu_max_response(
+        BACNET_CONFIRMED_SERVICE_DATA * service_data);
 
     uint16_t apdu_timeout(
         void);
@@ -190,6 +209,15 @@ extern "C" {
         uint8_t * apdu, /* APDU data */
         uint16_t pdu_len);      /* for confirmed messages */
 
+/* scratch memory for the service handlers, good until apdu_handler()
+   returns.  Returns NULL if the request arena is used up. */
+    void *apdu_arena_alloc(
+        size_t size);
+/* empties the request arena - apdu_handler() does this after each
+   APDU, so only call it when calling a service handler directly */
+    void apdu_arena_reset(
+        void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,96 @@
+/**************************************************************************
+*
+* Copyright (C) 2026 agent <agent@local>
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+*********************************************************************/
+
+/* Functional Description: Arena and pool allocators.
+   An arena hands out scratch memory from one block and gives it all
+   back at once with arena_reset(), so per-request decode and encode
+   buffers need neither static storage nor malloc() and free().
+   A pool hands out fixed size blocks, such as list nodes, and keeps
+   freed blocks on a free list to be handed out again. */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct bacnet_arena {
+    uint8_t *buffer;    /* block of memory that allocations come from */
+    size_t size;        /* size, in bytes, of the block */
+    size_t used;        /* number of bytes handed out since the reset */
+} BACNET_ARENA;
+
+struct pool_chunk;
+struct pool_block;
+
+typedef struct bacnet_pool {
+    size_t block_size;  /* size, in bytes, of each block */
+    unsigned chunk_blocks;      /* blocks to malloc at a time */
+    struct pool_chunk *chunks;  /* memory from malloc, for pool_destroy */
+    struct pool_block *free_list;       /* blocks ready to hand out */
+} BACNET_POOL;
+
+/* static initializer for a pool of blocks of size bytes */
+#define POOL_INITIALIZER(size, blocks) { (size), (blocks), NULL, NULL }
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    void arena_init(
+        BACNET_ARENA * arena,
+        void *buffer,
+        size_t size);
+    /* returns size bytes, suitably aligned but not cleared,
+       or NULL if the arena does not have room */
+    void *arena_alloc(
+        BACNET_ARENA * arena,
+        size_t size);
+    /* hands back every allocation made since the last reset */
+    void arena_reset(
+        BACNET_ARENA * arena);
+    size_t arena_used(
+        BACNET_ARENA * arena);
+
+    void pool_init(
+        BACNET_POOL * pool,
+        size_t block_size,
+        unsigned chunk_blocks);
+    /* returns a cleared block, or NULL if malloc() fails */
+    void *pool_alloc(
+        BACNET_POOL * pool);
+    /* puts the block back on the free list of the pool */
+    void pool_free(
+        BACNET_POOL * pool,
+        void *block);
+    /* frees the memory of the pool - all of its blocks are invalid */
+    void pool_destroy(
+        BACNET_POOL * pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -30,6 +30,7 @@
 #include "bacdef.h"
 #include "bacerror.h"
 #include "wp.h"
+#include "cov.h"
 
 #ifndef MAX_ANALOG_VALUES
 #define MAX_ANALOG_VALUES 4
@@ -70,6 +71,18 @@ extern "C" {
         uint8_t priority);
     float Analog_Value_Present_Value(
         uint32_t object_instance);
+    float Analog_Value_COV_Increment(
+        uint32_t object_instance);
+    void Analog_Value_COV_Increment_Set(
+        uint32_t object_instance,
+        float value);
+    bool Analog_Value_Change_Of_Value(
+        uint32_t object_instance);
+    void Analog_Value_Change_Of_Value_Clear(
+        uint32_t object_instance);
+    bool Analog_Value_Encode_Value_List(
+        uint32_t object_instance,
+        BACNET_PROPERTY_VALUE * value_list);
 
     void Analog_Value_Init(
         void);
@@ -78,6 +91,8 @@ extern "C" {
 #include "ctest.h"
     void testAnalog_Value(
         Test * pTest);
+    void testAnalog_ValueCOV(
+        Test * pTest);
 #endif
 
 #ifdef __cplusplus
@@ -117,6 +117,56 @@ typedef struct BACnet_Property_Value {
     struct BACnet_Property_Value *next;
 } BACNET_PROPERTY_VALUE;
 
+/* one tag and its data, where it is in the encoded buffer */
+struct BACnet_Application_Data_View;
+typedef struct BACnet_Application_Data_View {
+    bool context_specific;      /* true if context specific data */
+    bool opening;       /* opening tag of constructed data */
+    bool closing;       /* closing tag of constructed data */
+    uint8_t tag;        /* application tag data type, or context tag */
+    uint32_t len_value_type;    /* length, or value of an application BOOLEAN */
+    uint8_t *data;      /* the content octets, after the tag */
+    uint32_t data_len;  /* number of content octets */
+} BACNET_APPLICATION_DATA_VIEW;
+
+/* walks encoded data one tag at a time without copying it */
+struct BACnet_Application_Data_Iterator;
+typedef struct BACnet_Application_Data_Iterator {
+    uint8_t *apdu;
+    uint32_t apdu_len;
+    uint32_t offset;    /* of the next tag */
+    bool malformed;     /* set if a tag or its data ran past apdu_len */
+} BACNET_APPLICATION_DATA_ITERATOR;
+
+/* A value in a few octets, for holding many of them: the scalars are
+   kept in place, and octet and character strings point to their
+   octets somewhere else - in the buffer they were decoded from, or in
+   storage given by the caller - which must outlive the value. */
+struct BACnet_Compact_Value;
+typedef struct BACnet_Compact_Value {
+    bool context_specific;      /* true if context specific data */
+    uint8_t context_tag;        /* only used for context specific data */
+    uint8_t tag;        /* application tag data type */
+    union {
+        bool Boolean;
+        uint32_t Unsigned_Int;
+        int32_t Signed_Int;
+        float Real;
+        double Double;
+        uint32_t Enumerated;
+        BACNET_DATE Date;
+        BACNET_TIME Time;
+        BACNET_OBJECT_ID Object_Id;
+        BACNET_BIT_STRING Bit_String;
+        /* OCTET_STRING and CHARACTER_STRING */
+        struct {
+            uint8_t *value;
+            uint32_t length;
+            uint8_t encoding;   /* for a CHARACTER_STRING */
+        } String;
+    } type;
+} BACNET_COMPACT_VALUE;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -171,6 +221,47 @@ extern "C" {
         unsigned max_apdu_len,
         BACNET_PROPERTY_ID property);
 
+    void bacapp_iterator_init(
+        BACNET_APPLICATION_DATA_ITERATOR * iterator,
+        uint8_t * apdu,
+        uint32_t apdu_len);
+
+    /* returns false at the end of the data, or if it is malformed */
+    bool bacapp_iterator_next(
+        BACNET_APPLICATION_DATA_ITERATOR * iterator,
+        BACNET_APPLICATION_DATA_VIEW * view);
+
+    /* true if there are more tags after the one last returned */
+    bool bacapp_iterator_more(
+        BACNET_APPLICATION_DATA_ITERATOR * iterator);
+
+    /* copies an application tagged view into value, for when the
+       whole value is needed */
+    bool bacapp_view_decode(
+        BACNET_APPLICATION_DATA_VIEW * view,
+        BACNET_APPLICATION_DATA_VALUE * value);
+
+    /* copies the string octets into storage, and returns the number of
+       octets of it used, or -1 if they don't fit */
+    int bacapp_compact_from_value(
+        BACNET_COMPACT_VALUE * compact,
+        BACNET_APPLICATION_DATA_VALUE * value,
+        uint8_t * storage,
+        uint32_t storage_size);
+
+    /* the strings point into the buffer the view points into */
+    bool bacapp_compact_from_view(
+        BACNET_COMPACT_VALUE * compact,
+        BACNET_APPLICATION_DATA_VIEW * view);
+
+    bool bacapp_compact_to_value(
+        BACNET_COMPACT_VALUE * compact,
+        BACNET_APPLICATION_DATA_VALUE * value);
+
+    int bacapp_compact_encode_application_data(
+        uint8_t * apdu,
+        BACNET_COMPACT_VALUE * compact);
+
 #if PRINT_ENABLED
 #define BACAPP_PRINT_ENABLED
 #else
@@ -188,9 +279,14 @@ extern "C" {
         FILE * stream,
         BACNET_APPLICATION_DATA_VALUE * value,
         BACNET_PROPERTY_ID property);
+    bool bacapp_print_view(
+        FILE * stream,
+        BACNET_APPLICATION_DATA_VIEW * view,
+        BACNET_PROPERTY_ID property);
 #else
 #define bacapp_parse_application_data(x,y,z) {(void)x;(void)y;(void)z;}
 #define bacapp_print_value(x,y,z) {(void)x;(void)y;(void)z;}
+#define bacapp_print_view(x,y,z) {(void)x;(void)y;(void)z;}
 #endif
 
 #ifdef TEST
@@ -204,6 +300,10 @@ extern "C" {
         Test * pTest);
     void testBACnetApplicationData(
         Test * pTest);
+    void testBACnetApplicationDataIterator(
+        Test * pTest);
+    void testBACnetCompactValue(
+        Test * pTest);
 #endif
 
 #ifdef __cplusplus
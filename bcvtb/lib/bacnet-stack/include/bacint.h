@@ -37,6 +37,21 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include "config.h"
+
+#if BACNET_FAST_CODEC
+/* swaps a value between host order and the big-endian order of an APDU.
+   The argument is evaluated more than once. */
+#if BACNET_BIG_ENDIAN
+#define BACNET_ORDER16(x) (x)
+#define BACNET_ORDER32(x) (x)
+#else
+#define BACNET_ORDER16(x) ((uint16_t) (((x) << 8) | ((x) >> 8)))
+#define BACNET_ORDER32(x) \
+    (((x) << 24) | (((x) & 0xff00UL) << 8) | \
+    (((x) >> 8) & 0xff00UL) | ((x) >> 24))
+#endif
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -81,6 +81,25 @@ extern "C" {
         uint8_t * pdu,  /* any data to be sent - may be null */
         unsigned pdu_len);      /* number of bytes of data */
 
+    /* sends the header and the data behind it as one datagram,
+       without copying them together first where the port can */
+    /* returns number of bytes sent on success, negative on failure */
+    int bip_send_mpdu(
+        struct sockaddr_in *dest,       /* destination in network order */
+        uint8_t * header,       /* BVLC header */
+        uint16_t header_len,
+        uint8_t * pdu,  /* any data to be sent - may be null */
+        uint16_t pdu_len);
+    /* sends the same header and data to each of the destinations */
+    /* returns the number of datagrams sent */
+    int bip_send_mpdu_multiple(
+        struct sockaddr_in *dest,       /* destinations in network order */
+        unsigned dest_count,
+        uint8_t * header,       /* BVLC header */
+        uint16_t header_len,
+        uint8_t * pdu,  /* any data to be sent - may be null */
+        uint16_t pdu_len);
+
     /* receives a BACnet/IP packet */
     /* returns the number of octets in the PDU, or zero on failure */
     uint16_t bip_receive(
@@ -88,6 +107,32 @@ extern "C" {
         uint8_t * pdu,  /* PDU data */
         uint16_t max_pdu,       /* amount of space available in the PDU  */
         unsigned timeout);      /* milliseconds to wait for a packet */
+    /* same, but the NPDU is left at *npdu behind the BVLC header,
+       in pdu or in the port's receive ring, instead of being moved
+       to the start of the buffer.  It is good until the next receive. */
+    uint16_t bip_receive_in_place(
+        BACNET_ADDRESS * src,   /* source address */
+        uint8_t * pdu,  /* BVLC header and NPDU */
+        uint16_t max_pdu,       /* amount of space available in the PDU  */
+        unsigned timeout,       /* milliseconds to wait for a packet */
+        uint8_t ** npdu);
+
+    /* waits for one datagram on the BACnet/IP socket, BVLC header and
+       all.  *datagram points at it: in buf, or where the port already
+       holds it until the next call. */
+    /* returns the number of octets, or zero on timeout or failure */
+    int bip_receive_datagram(
+        uint8_t * buf,
+        uint16_t max_len,
+        uint8_t ** datagram,
+        struct sockaddr_in *sin,        /* source of the datagram */
+        unsigned timeout);      /* milliseconds to wait for a datagram */
+    /* true if datagrams were already taken from the socket and
+       will be returned without waiting - select() won't see them */
+    bool bip_receive_pending(
+        void);
+    void bip_receive_cleanup(
+        void);
 
     /* use host byte order for setting */
     void bip_set_port(
@@ -63,6 +63,14 @@ extern "C" {
         uint8_t * npdu, /* returns the NPDU */
         uint16_t max_npdu,      /* amount of space available in the NPDU  */
         unsigned timeout);      /* number of milliseconds to wait for a packet */
+    /* same, but the NPDU is left at *npdu_start, in npdu or in the
+       port's receive ring, until the next receive */
+    uint16_t bvlc_receive_in_place(
+        BACNET_ADDRESS * src,   /* returns the source address */
+        uint8_t * npdu, /* returns the BVLC header and NPDU */
+        uint16_t max_npdu,      /* amount of space available in the NPDU  */
+        unsigned timeout,       /* number of milliseconds to wait for a packet */
+        uint8_t ** npdu_start);
 
     int bvlc_send_pdu(
         BACNET_ADDRESS * dest,  /* destination address */
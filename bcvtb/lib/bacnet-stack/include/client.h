@@ -34,6 +34,7 @@
 #include "bacapp.h"
 #include "bacenum.h"
 #include "rpm.h"
+#include "wpm.h"
 #include "cov.h"
 #include "event.h"
 #include "lso.h"
@@ -80,6 +81,10 @@ extern "C" {
         BACNET_ADDRESS * dest,
         BACNET_NPDU_DATA * npdu_data,
         BACNET_COV_DATA * cov_data);
+/* returns the invoke ID for confirmed request, or 0 if failed */
+    uint8_t Send_COV_Subscribe(
+        uint32_t device_id,
+        BACNET_SUBSCRIBE_COV_DATA * cov_data);
 
 /* returns the invoke ID for confirmed request, or 0 if failed */
     uint8_t Send_Read_Property_Request(
@@ -103,6 +108,12 @@ extern "C" {
         BACNET_APPLICATION_DATA_VALUE * object_value,
         uint8_t priority,
         int32_t array_index);
+/* returns the invoke ID for confirmed request, or 0 if failed */
+    uint8_t Send_Write_Property_Multiple_Request(
+        uint8_t * pdu,
+        size_t max_pdu,
+        uint32_t device_id,     /* destination device */
+        BACNET_WRITE_ACCESS_DATA * write_access_data);
 
 /* returns the invoke ID for confirmed request, or 0 if failed */
     uint8_t Send_Reinitialize_Device_Request(
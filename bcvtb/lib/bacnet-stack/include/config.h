@@ -51,6 +51,21 @@
 #if !defined(BIG_ENDIAN)
 #define BIG_ENDIAN 0
 #endif
+/* Some C libraries define BIG_ENDIAN too, as 4321, and their headers
+   can redefine it after this one, so the codecs use this copy. */
+#if BIG_ENDIAN
+#define BACNET_BIG_ENDIAN 1
+#else
+#define BACNET_BIG_ENDIAN 0
+#endif
+
+/* The integer, real and tag codecs load and store multi-octet values
+   a word at a time and decode the first octet of a tag with a table.
+   Define as 0 to use the octet at a time code, for example on
+   processors where a 4 octet memcpy() is a library call. */
+#if !defined(BACNET_FAST_CODEC)
+#define BACNET_FAST_CODEC 1
+#endif
 
 /* Define your Vendor Identifier assigned by ASHRAE */
 #if !defined(BACNET_VENDOR_ID)
@@ -85,6 +100,55 @@
 #if !defined(MAX_TSM_TRANSACTIONS)
 #define MAX_TSM_TRANSACTIONS 255
 #endif
+/* Segmented messages are sent and received by the TSM. */
+/* This is the number of segments we accept in one message, */
+/* from 2..255, or 1 to not do segmentation. */
+/* Each segmented transaction holds MAX_APDU times this many octets, */
+/* so a port turns it on with -DMAX_SEGMENTS_ACCEPTED=32 or similar. */
+#if !defined(MAX_SEGMENTS_ACCEPTED)
+#define MAX_SEGMENTS_ACCEPTED 1
+#endif
+/* the number of segmented messages that can be sent or */
+/* received at the same time - each needs a MAX_SEGMENTED_APDU buffer */
+#if !defined(MAX_SEGMENTED_TRANSACTIONS)
+#define MAX_SEGMENTED_TRANSACTIONS 4
+#endif
+/* the most segments sent or received before waiting for a SegmentACK */
+#if !defined(MAX_SEGMENT_WINDOW)
+#define MAX_SEGMENT_WINDOW 16
+#endif
+/* the largest APDU service data, put back together */
+#define MAX_SEGMENTED_APDU (MAX_APDU * MAX_SEGMENTS_ACCEPTED)
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+#if (!MAX_TSM_TRANSACTIONS)
+#error Segmentation requires MAX_TSM_TRANSACTIONS
+#endif
+#if (MAX_SEGMENTS_ACCEPTED > 255)
+#error MAX_SEGMENTS_ACCEPTED must fit in a segment sequence number
+#endif
+#if (MAX_SEGMENTED_APDU > 65535)
+#error MAX_SEGMENTED_APDU must fit in 16 bits
+#endif
+#if ((MAX_SEGMENT_WINDOW < 1) || (MAX_SEGMENT_WINDOW > 127))
+#error MAX_SEGMENT_WINDOW must be from 1..127
+#endif
+#endif
+/* The service handlers take their scratch buffers from an arena that
+   apdu_handler() empties after each APDU.  It holds one reassembled
+   APDU, or one APDU without segmentation, plus room for the decoded
+   request. */
+#if !defined(MAX_REQUEST_ARENA)
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+#define MAX_REQUEST_ARENA (MAX_SEGMENTED_APDU + MAX_APDU)
+#else
+#define MAX_REQUEST_ARENA (MAX_APDU + MAX_APDU)
+#endif
+#endif
+/* Define as the thread local storage class of your compiler, such as
+   __thread, to give each thread that calls apdu_handler() an arena. */
+#if !defined(BACNET_THREAD_LOCAL)
+#define BACNET_THREAD_LOCAL
+#endif
 /* The address cache is used for binding to BACnet devices */
 /* The number of entries corresponds to the number of */
 /* devices that might respond to an I-Am on the network. */
@@ -48,6 +48,10 @@ extern "C" {
     uint16_t CRC_Calc_Data(
         uint8_t dataValue,
         uint16_t crcValue);
+    uint16_t CRC_Calc_Data_Block(
+        const uint8_t * data,
+        size_t length,
+        uint16_t crcValue);
 
 #ifdef __cplusplus
 }
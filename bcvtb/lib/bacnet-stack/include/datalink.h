@@ -75,9 +75,11 @@
 #if defined(BBMD_ENABLED) && BBMD_ENABLED
 #define datalink_send_pdu bvlc_send_pdu
 #define datalink_receive bvlc_receive
+#define datalink_receive_in_place bvlc_receive_in_place
 #else
 #define datalink_send_pdu bip_send_pdu
 #define datalink_receive bip_receive
+#define datalink_receive_in_place bip_receive_in_place
 #endif
 #define datalink_cleanup bip_cleanup
 #define datalink_get_broadcast_address bip_get_broadcast_address
@@ -118,4 +120,11 @@ extern "C" {
 }
 #endif /* __cplusplus */
 #endif
+
+/* datalinks that can't leave the NPDU where it was received
+   return it at the start of the buffer */
+#ifndef datalink_receive_in_place
+#define datalink_receive_in_place(src, pdu, max_pdu, timeout, npdu) \
+    ((*(npdu) = (pdu)), datalink_receive(src, pdu, max_pdu, timeout))
+#endif
 #endif
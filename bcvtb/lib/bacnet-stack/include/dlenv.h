@@ -25,12 +25,16 @@
 #ifndef DLENV_H
 #define DLENV_H
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
 
     void dlenv_init(
         void);
+    void dlenv_maintenance_timer(
+        uint16_t elapsed_seconds);
 
 #ifdef __cplusplus
 }
@@ -57,6 +57,9 @@ typedef struct fifo_buffer_t FIFO_BUFFER;
 extern "C" {
 #endif /* __cplusplus */
 
+    unsigned FIFO_Count(
+        FIFO_BUFFER const *b);
+
     bool FIFO_Empty(
         FIFO_BUFFER const *b);
 
@@ -75,6 +78,14 @@ extern "C" {
         uint8_t * data_bytes,
         unsigned count);
 
+    uint8_t *FIFO_Reserve(
+        FIFO_BUFFER * b,
+        unsigned *count);
+
+    bool FIFO_Commit(
+        FIFO_BUFFER * b,
+        unsigned count);
+
     void FIFO_Flush(
         FIFO_BUFFER * b);
 
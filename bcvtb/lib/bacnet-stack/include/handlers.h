@@ -34,6 +34,7 @@
 #include "rp.h"
 #include "rpm.h"
 #include "wp.h"
+#include "wpm.h"
 #include "getevent.h"
 
 
@@ -99,6 +100,20 @@ extern "C" {
         BACNET_OBJECT_TYPE object_type,
         write_property_function pFunction);
 
+    /* Writes the property using the function set for its object type,
+       or sets the error, and returns false */
+    /* resides in h_wp.c */
+    bool Object_Write_Property(
+        BACNET_WRITE_PROPERTY_DATA * wp_data,
+        BACNET_ERROR_CLASS * error_class,
+        BACNET_ERROR_CODE * error_code);
+
+    void handler_write_property_multiple(
+        uint8_t * service_request,
+        uint16_t service_len,
+        BACNET_ADDRESS * src,
+        BACNET_CONFIRMED_SERVICE_DATA * service_data);
+
     void handler_atomic_read_file(
         uint8_t * service_request,
         uint16_t service_len,
@@ -44,6 +44,18 @@ typedef struct {
     const char *pString;        /* text pair - use NULL to end the list */
 } INDTEXT_DATA;
 
+/* sorted views of an INDTEXT_DATA list, for a binary search instead of
+   a walk through the list.  They are built on the first search, so
+   declare one for each list with INDTEXT_INDEX_INITIALIZER(list). */
+typedef struct {
+    INDTEXT_DATA *data_list;    /* the list that is indexed */
+    unsigned count;     /* number of elements in the list */
+    INDTEXT_DATA **by_string;   /* sorted by case insensitive text */
+    INDTEXT_DATA **by_index;    /* sorted by index */
+} INDTEXT_INDEX;
+
+#define INDTEXT_INDEX_INITIALIZER(list) { (list), 0, NULL, NULL }
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -99,6 +111,31 @@ extern "C" {
     unsigned indtext_count(
         INDTEXT_DATA * data_list);
 
+/* the same searches, using the sorted views of the list.
+   If there is no memory for them, the list is searched instead. */
+    bool indtext_index_by_string(
+        INDTEXT_INDEX * data_index,
+        const char *search_name,
+        unsigned *found_index);
+    bool indtext_index_by_istring(
+        INDTEXT_INDEX * data_index,
+        const char *search_name,
+        unsigned *found_index);
+    unsigned indtext_index_by_istring_default(
+        INDTEXT_INDEX * data_index,
+        const char *search_name,
+        unsigned default_index);
+    const char *indtext_index_by_index_default(
+        INDTEXT_INDEX * data_index,
+        unsigned index,
+        const char *default_name);
+    const char *indtext_index_by_index_split_default(
+        INDTEXT_INDEX * data_index,
+        unsigned index,
+        unsigned split_index,
+        const char *before_split_default_name,
+        const char *default_name);
+
 
 #if !defined(__BORLANDC__) && !defined(_MSC_VER)
     int stricmp(
@@ -110,6 +147,8 @@ extern "C" {
 #include "ctest.h"
     void testIndexText(
         Test * pTest);
+    void testIndexTextIndex(
+        Test * pTest);
 #endif
 
 #ifdef __cplusplus
@@ -39,6 +39,8 @@
 /* This is a key sorted linked list data library that */
 /* uses a key or index to access the data. */
 /* If the keys are duplicated, they can be added into the list like FIFO */
+/* where the newest node of a key is first, and is the one that is */
+/* found and deleted by that key. */
 
 /* list data and datatype */
 struct Keylist_Node {
@@ -50,6 +52,9 @@ typedef struct Keylist {
     struct Keylist_Node **array;        /* array of nodes */
     int count;  /* number of nodes in this list - more effecient than loop */
     int size;   /* number of available nodes on this list - can grow or shrink */
+    struct Keylist_Node **table;        /* hash table of the nodes by key */
+    int table_size;     /* number of slots in the table - a power of 2 */
+    int table_bits;     /* log2 of table_size */
 } KEYLIST_TYPE;
 typedef KEYLIST_TYPE *OS_Keylist;
 
@@ -0,0 +1,134 @@
+/**************************************************************************
+*
+* Copyright (C) 2026 agent <agent@local>
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+*********************************************************************/
+
+/* Functional Description: pcapng capture file writer and reader.
+   Writes packets from one or more link layers, such as MS/TP and
+   Ethernet, to a pcapng file with nanosecond timestamps.  The file
+   is written through a large stdio buffer, and can be rotated into
+   a new file, with the same interfaces, when it reaches a size.
+   Reads packets back from pcapng files and from libpcap files. */
+
+#ifndef PCAPNG_H
+#define PCAPNG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/* link layer header types, from the tcpdump.org list */
+#define PCAPNG_LINKTYPE_ETHERNET 1
+#define PCAPNG_LINKTYPE_BACNET_MS_TP 165
+
+/* number of link layers that one capture file can hold */
+#if !defined(PCAPNG_MAX_INTERFACES)
+#define PCAPNG_MAX_INTERFACES 4
+#endif
+/* size of the stdio buffer for the capture file */
+#if !defined(PCAPNG_BUFFER_SIZE)
+#define PCAPNG_BUFFER_SIZE 65536
+#endif
+#define PCAPNG_MAX_FILENAME 256
+
+typedef struct pcapng_writer {
+    FILE *file;
+    char base_name[PCAPNG_MAX_FILENAME];
+    char file_name[PCAPNG_MAX_FILENAME + 12];
+    unsigned file_number;       /* 0 for the first file, then 1, 2... */
+    uint32_t max_file_size;     /* rotate at this size, or 0 to not */
+    uint32_t file_size;         /* bytes written to the current file */
+    uint32_t file_packets;      /* packets written to the current file */
+    unsigned interface_count;
+    uint16_t link_type[PCAPNG_MAX_INTERFACES];
+    uint32_t snaplen[PCAPNG_MAX_INTERFACES];
+} PCAPNG_WRITER;
+
+typedef struct pcapng_reader {
+    FILE *file;
+    bool pcapng;        /* false for a libpcap file */
+    bool swapped;       /* written in the other byte order */
+    /* libpcap: the link type, and nanoseconds per fraction tick */
+    uint16_t link_type;
+    uint32_t fraction_ns;
+    /* pcapng: the interfaces of the current section */
+    unsigned interface_count;
+    uint16_t if_link_type[PCAPNG_MAX_INTERFACES];
+    uint8_t if_tsresol[PCAPNG_MAX_INTERFACES];
+    uint8_t *buffer;    /* the block or record last read */
+    size_t buffer_size;
+} PCAPNG_READER;
+
+typedef struct pcapng_packet {
+    uint16_t link_type;
+    uint64_t timestamp; /* nanoseconds since 1970-01-01 00:00:00 UTC */
+    const uint8_t *data;        /* valid until the next packet is read */
+    uint32_t length;    /* octets captured */
+    uint32_t original_length;   /* octets on the wire */
+} PCAPNG_PACKET;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    /* creates the file, or with max_file_size, the first of the
+       files name, name.1, name.2, and so on */
+    bool pcapng_writer_open(
+        PCAPNG_WRITER * writer,
+        const char *filename,
+        uint32_t max_file_size);
+    /* returns the interface number for the packets of the link type,
+       or -1 if there are already PCAPNG_MAX_INTERFACES */
+    int pcapng_writer_add_interface(
+        PCAPNG_WRITER * writer,
+        uint16_t link_type,
+        uint32_t snaplen);
+    /* timestamp is in nanoseconds since 1970-01-01 00:00:00 UTC */
+    bool pcapng_writer_packet(
+        PCAPNG_WRITER * writer,
+        unsigned interface_id,
+        uint64_t timestamp,
+        const uint8_t * data,
+        uint32_t length);
+    /* writes out the buffer to the file */
+    void pcapng_writer_flush(
+        PCAPNG_WRITER * writer);
+    void pcapng_writer_close(
+        PCAPNG_WRITER * writer);
+
+    /* opens a pcapng or libpcap file, in either byte order */
+    bool pcapng_reader_open(
+        PCAPNG_READER * reader,
+        const char *filename);
+    /* returns false at the end of the file, or at a damaged block */
+    bool pcapng_reader_next(
+        PCAPNG_READER * reader,
+        PCAPNG_PACKET * packet);
+    void pcapng_reader_close(
+        PCAPNG_READER * reader);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
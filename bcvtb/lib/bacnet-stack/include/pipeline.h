@@ -0,0 +1,181 @@
+/**************************************************************************
+*
+* Copyright (C) 2026 agent <agent@local>
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+*********************************************************************/
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+#include "bacdef.h"
+#include "bacenum.h"
+#include "apdu.h"
+#include "rp.h"
+#include "rpm.h"
+#include "wpm.h"
+
+/* Client requests that are queued per device and kept in flight
+   together, up to a window per device and the free TSM slots.
+   The completion function is called once for every request that
+   was accepted, from pipeline_task() or from the APDU handlers. */
+
+/* number of requests that can be queued or in flight */
+#ifndef MAX_PIPELINE_REQUESTS
+#define MAX_PIPELINE_REQUESTS 1024
+#endif
+/* number of devices that can have requests queued */
+#ifndef MAX_PIPELINE_DEVICES
+#define MAX_PIPELINE_DEVICES MAX_ADDRESS_CACHE
+#endif
+/* requests in flight to one device unless set otherwise */
+#ifndef PIPELINE_WINDOW_DEFAULT
+#define PIPELINE_WINDOW_DEFAULT 4
+#endif
+
+typedef enum {
+    PIPELINE_STATUS_ACK,
+    PIPELINE_STATUS_SIMPLE_ACK,
+    PIPELINE_STATUS_ERROR,
+    PIPELINE_STATUS_ABORT,
+    PIPELINE_STATUS_REJECT,
+    /* no reply after all the retries */
+    PIPELINE_STATUS_TIMEOUT,
+    /* the device did not answer the Who-Is */
+    PIPELINE_STATUS_NOT_BOUND,
+    /* the request could not be encoded or sent */
+    PIPELINE_STATUS_SEND_FAILED,
+    /* the reply was for a service the pipeline has no handler for */
+    PIPELINE_STATUS_UNKNOWN
+} PIPELINE_STATUS;
+
+typedef struct pipeline_result {
+    PIPELINE_STATUS status;
+    uint32_t device_id;
+    uint8_t invoke_id;
+    /* PIPELINE_STATUS_ACK: the service ack data, valid only
+       during the call */
+    uint8_t *service_request;
+    uint16_t service_len;
+    BACNET_CONFIRMED_SERVICE_ACK_DATA *service_data;
+    /* PIPELINE_STATUS_ERROR */
+    BACNET_ERROR_CLASS error_class;
+    BACNET_ERROR_CODE error_code;
+    /* PIPELINE_STATUS_ERROR of WritePropertyMultiple: the object,
+       property and array index of the first write that failed, or
+       NULL if the error didn't say, valid only during the call */
+    BACNET_WRITE_PROPERTY_DATA *first_failed;
+    /* PIPELINE_STATUS_ABORT and PIPELINE_STATUS_REJECT */
+    uint8_t reason;
+} PIPELINE_RESULT;
+
+/* sends a confirmed request to the bound device and returns the
+   invoke ID, or 0 if it was not sent */
+typedef uint8_t(
+    *pipeline_send_function) (
+    uint32_t device_id,
+    void *context);
+
+typedef void (
+    *pipeline_complete_function) (
+    PIPELINE_RESULT * result,
+    void *context);
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* sets the ack, error, abort and reject handlers for ReadProperty,
+   ReadPropertyMultiple, WriteProperty and WritePropertyMultiple */
+    void pipeline_init(
+        void);
+/* for other services, set these as the service handlers */
+    void pipeline_ack_handler(
+        uint8_t * service_request,
+        uint16_t service_len,
+        BACNET_ADDRESS * src,
+        BACNET_CONFIRMED_SERVICE_ACK_DATA * service_data);
+    void pipeline_simple_ack_handler(
+        BACNET_ADDRESS * src,
+        uint8_t invoke_id);
+    void pipeline_error_handler(
+        BACNET_ADDRESS * src,
+        uint8_t invoke_id,
+        BACNET_ERROR_CLASS error_class,
+        BACNET_ERROR_CODE error_code);
+    void pipeline_abort_handler(
+        BACNET_ADDRESS * src,
+        uint8_t invoke_id,
+        uint8_t abort_reason,
+        bool server);
+    void pipeline_reject_handler(
+        BACNET_ADDRESS * src,
+        uint8_t invoke_id,
+        uint8_t reject_reason);
+
+/* a window of 0 uses the default */
+    void pipeline_window_default_set(
+        unsigned window);
+    bool pipeline_window_set(
+        uint32_t device_id,
+        unsigned window);
+
+/* returns false if the request could not be queued */
+    bool pipeline_send(
+        uint32_t device_id,
+        pipeline_send_function send,
+        pipeline_complete_function complete,
+        void *context);
+    bool pipeline_read_property(
+        uint32_t device_id,
+        BACNET_READ_PROPERTY_DATA * rpdata,
+        pipeline_complete_function complete,
+        void *context);
+/* read_access_data must be kept until the request completes */
+    bool pipeline_read_property_multiple(
+        uint32_t device_id,
+        BACNET_READ_ACCESS_DATA * read_access_data,
+        pipeline_complete_function complete,
+        void *context);
+/* write_access_data must be kept until the request completes */
+    bool pipeline_write_property_multiple(
+        uint32_t device_id,
+        BACNET_WRITE_ACCESS_DATA * write_access_data,
+        pipeline_complete_function complete,
+        void *context);
+
+/* number of requests queued or in flight */
+    unsigned pipeline_count(
+        void);
+/* times out the device bindings - call with tsm_timer_milliseconds */
+    void pipeline_timer_milliseconds(
+        uint16_t milliseconds);
+/* sends what the windows allow and completes the requests that
+   timed out - call from the main loop */
+    void pipeline_task(
+        void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -150,18 +150,18 @@ extern "C" {
         unsigned apdu_len,
         BACNET_PROPERTY_ID * object_property,
         int32_t * array_index);
-#ifdef TEST
-#include "ctest.h"
-    int rpm_decode_apdu(
+    int rpm_ack_decode_apdu(
         uint8_t * apdu,
-        unsigned apdu_len,
+        int apdu_len,   /* total length of the apdu */
         uint8_t * invoke_id,
         uint8_t ** service_request,
         unsigned *service_request_len);
 
-    int rpm_ack_decode_apdu(
+#ifdef TEST
+#include "ctest.h"
+    int rpm_decode_apdu(
         uint8_t * apdu,
-        int apdu_len,   /* total length of the apdu */
+        unsigned apdu_len,
         uint8_t * invoke_id,
         uint8_t ** service_request,
         unsigned *service_request_len);
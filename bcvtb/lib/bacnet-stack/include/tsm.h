@@ -39,6 +39,7 @@
 #include <stddef.h>
 #include "bacdef.h"
 #include "npdu.h"
+#include "apdu.h"
 
 /* note: TSM functionality is optional - only needed if we are 
    doing client requests */
@@ -50,6 +51,7 @@ typedef enum {
     TSM_STATE_AWAIT_CONFIRMATION,
     TSM_STATE_AWAIT_RESPONSE,
     TSM_STATE_SEGMENTED_REQUEST,
+    TSM_STATE_SEGMENTED_RESPONSE,
     TSM_STATE_SEGMENTED_CONFIRMATION
 } BACNET_TSM_STATE;
 
@@ -59,24 +61,15 @@ typedef enum {
 typedef struct BACnet_TSM_Data {
     /* used to count APDU retries */
     uint8_t RetryCount;
-    /* used to count segment retries */
-    /*uint8_t SegmentRetryCount;  */
-    /* used to control APDU retries and the acceptance of server replies */
-    /*bool SentAllSegments;  */
-    /* stores the sequence number of the last segment received in order */
-    /*uint8_t LastSequenceNumber; */
-    /* stores the sequence number of the first segment of */
-    /* a sequence of segments that fill a window */
-    /*uint8_t InitialSequenceNumber; */
-    /* stores the current window size */
-    /*uint8_t ActualWindowSize; */
-    /* stores the window size proposed by the segment sender */
-    /*uint8_t ProposedWindowSize;  */
-    /*  used to perform timeout on PDU segments */
-    /*uint8_t SegmentTimer; */
+    /* the segment variables are kept with the segmented message
+       buffers in tsm.c, since only a few transactions need them */
     /* used to perform timeout on Confirmed Requests */
-    /* in milliseconds */
-    uint16_t RequestTimer;
+    /* the TSM clock time, in milliseconds, when it times out */
+    uint32_t RequestTimer;
+    /* the other transactions in the same timer wheel bucket,
+       as index + 1 into the table, or 0 for none */
+    uint8_t TimerNext;
+    uint8_t TimerPrev;
     /* unique id */
     uint8_t InvokeID;
     /* state that the TSM is in */
@@ -126,6 +119,45 @@ extern "C" {
     bool tsm_invoke_id_failed(
         uint8_t invokeID);
 
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+/* sends a ComplexACK that is too big for the client's max APDU
+   in segments.  apdu holds the whole unsegmented ComplexACK.
+   returns false if the client or our buffers don't allow it. */
+    bool tsm_segmented_complex_ack_send(
+        BACNET_ADDRESS * dest,
+        BACNET_NPDU_DATA * npdu_data,
+        BACNET_CONFIRMED_SERVICE_DATA * service_data,
+        uint8_t * apdu,
+        uint16_t apdu_len);
+/* puts the segments of a ComplexACK back together.  returns true,
+   with the whole service data, when the last segment is in. */
+    bool tsm_segmented_complex_ack_received(
+        BACNET_ADDRESS * src,
+        BACNET_CONFIRMED_SERVICE_ACK_DATA * service_data,
+        uint8_t service_choice,
+        uint8_t ** service_request,
+        uint16_t * service_request_len);
+/* puts the segments of a confirmed request back together.  returns
+   true, with the whole service data, when the last segment is in. */
+    bool tsm_segmented_request_received(
+        BACNET_ADDRESS * src,
+        BACNET_CONFIRMED_SERVICE_DATA * service_data,
+        uint8_t service_choice,
+        uint8_t ** service_request,
+        uint16_t * service_request_len);
+/* a SegmentACK from a client, for the segments we send */
+    void tsm_segment_ack_received(
+        BACNET_ADDRESS * src,
+        uint8_t invokeID,
+        uint8_t sequence_number,
+        uint8_t actual_window_size,
+        bool nak);
+/* an Abort from a client, for the segments we send or receive */
+    void tsm_segmented_abort_received(
+        BACNET_ADDRESS * src,
+        uint8_t invokeID);
+#endif
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
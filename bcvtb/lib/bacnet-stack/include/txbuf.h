@@ -31,5 +31,11 @@
 #include "datalink.h"
 
 extern uint8_t Handler_Transmit_Buffer[MAX_PDU];
+/* for answers that may be sent in segments */
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+extern uint8_t Handler_Segmented_Buffer[MAX_NPDU + MAX_SEGMENTED_APDU];
+#else
+#define Handler_Segmented_Buffer Handler_Transmit_Buffer
+#endif
 
 #endif
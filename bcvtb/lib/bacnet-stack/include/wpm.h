@@ -0,0 +1,142 @@
+/*####COPYRIGHTBEGIN####
+ -------------------------------------------
+ Copyright (C) 2026 agent <agent@local>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to:
+ The Free Software Foundation, Inc.
+ 59 Temple Place - Suite 330
+ Boston, MA  02111-1307, USA.
+
+ As a special exception, if other files instantiate templates or
+ use macros or inline functions from this file, or you compile
+ this file and link it with other works to produce a work based
+ on this file, this file does not by itself cause the resulting
+ work to be covered by the GNU General Public License. However
+ the source code for this file must still be made available in
+ accordance with section (3) of the GNU General Public License.
+
+ This exception does not invalidate any other reasons why a work
+ based on this file might be covered by the GNU General Public
+ License.
+ -------------------------------------------
+####COPYRIGHTEND####*/
+#ifndef WPM_H
+#define WPM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "bacenum.h"
+#include "bacdef.h"
+#include "bacapp.h"
+#include "wp.h"
+
+struct BACnet_Write_Access_Data;
+typedef struct BACnet_Write_Access_Data {
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    /* simple linked list of values */
+    BACNET_PROPERTY_VALUE *listOfProperties;
+    struct BACnet_Write_Access_Data *next;
+} BACNET_WRITE_ACCESS_DATA;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* encode functions */
+/* Start with the Init function, and then add an object,
+ then add its properties, and then end the object.
+ Continue to add objects and properties as needed
+ until the APDU is full.*/
+
+/* WPM */
+    int wpm_encode_apdu_init(
+        uint8_t * apdu,
+        uint8_t invoke_id);
+
+    int wpm_encode_apdu_object_begin(
+        uint8_t * apdu,
+        BACNET_OBJECT_TYPE object_type,
+        uint32_t object_instance);
+
+/* the object type and instance of wpdata are not used */
+    int wpm_encode_apdu_object_property(
+        uint8_t * apdu,
+        BACNET_WRITE_PROPERTY_DATA * wpdata);
+
+    int wpm_encode_apdu_object_end(
+        uint8_t * apdu);
+
+/* returns 0 if it doesn't fit in max_apdu */
+    int wpm_encode_apdu(
+        uint8_t * apdu,
+        size_t max_apdu,
+        uint8_t invoke_id,
+        BACNET_WRITE_ACCESS_DATA * write_access_data);
+
+/* decode the object portion of the service request only -
+   sets the object type and instance of wpdata */
+    int wpm_decode_object_id(
+        uint8_t * apdu,
+        unsigned apdu_len,
+        BACNET_WRITE_PROPERTY_DATA * wpdata);
+
+/* is this the end of this object property list? */
+    int wpm_decode_object_end(
+        uint8_t * apdu,
+        unsigned apdu_len);
+
+/* decode the object property portion of the service request only -
+   sets the property, array index, value and priority of wpdata */
+    int wpm_decode_object_property(
+        uint8_t * apdu,
+        unsigned apdu_len,
+        BACNET_WRITE_PROPERTY_DATA * wpdata);
+
+/* WritePropertyMultiple-Error, with the first write that failed */
+    int wpm_error_ack_encode_apdu(
+        uint8_t * apdu,
+        uint8_t invoke_id,
+        BACNET_WRITE_PROPERTY_DATA * wpdata,
+        BACNET_ERROR_CLASS error_class,
+        BACNET_ERROR_CODE error_code);
+
+/* decode a WritePropertyMultiple-Error after the service choice -
+   sets the object type and instance, property and array index of
+   wpdata to the first failed write */
+    int wpm_error_ack_decode_service_request(
+        uint8_t * apdu,
+        unsigned apdu_len,
+        BACNET_WRITE_PROPERTY_DATA * wpdata,
+        BACNET_ERROR_CLASS * error_class,
+        BACNET_ERROR_CODE * error_code);
+
+#ifdef TEST
+#include "ctest.h"
+    int wpm_decode_apdu(
+        uint8_t * apdu,
+        unsigned apdu_len,
+        uint8_t * invoke_id,
+        uint8_t ** service_request,
+        unsigned *service_request_len);
+
+    void testWritePropertyMultiple(
+        Test * pTest);
+#endif
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
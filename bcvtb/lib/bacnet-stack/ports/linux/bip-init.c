@@ -32,14 +32,186 @@
  -------------------------------------------
 ####COPYRIGHTEND####*/
 
+#define _GNU_SOURCE     /* for recvmmsg() and sendmmsg() */
 #include <stdint.h>     /* for standard integer types uint8_t etc. */
 #include <stdbool.h>    /* for the standard bool type. */
 #include "bacdcode.h"
 #include "bip.h"
 #include "net.h"
+#if BIP_RECVMMSG
+#include <sys/epoll.h>
+#endif
 
 bool BIP_Debug = false;
 
+#if BIP_RECVMMSG
+/* Datagrams are drained from the socket in batches, up to
+   BIP_RECEIVE_RING_SIZE per recvmmsg() call, and handed out one at a
+   time.  The next batch is only read once this one has been used up,
+   so the same buffers are reused from the start of the ring. */
+static uint8_t Receive_Buffer[BIP_RECEIVE_RING_SIZE][MAX_MPDU];
+static struct sockaddr_in Receive_Address[BIP_RECEIVE_RING_SIZE];
+static struct iovec Receive_IOV[BIP_RECEIVE_RING_SIZE];
+static struct mmsghdr Receive_Message[BIP_RECEIVE_RING_SIZE];
+/* next datagram to hand out, and the number left in the ring */
+static unsigned Receive_Head;
+static unsigned Receive_Count;
+/* waits for the socket to become readable */
+static int Receive_Epoll_FD = -1;
+
+static bool bip_receive_epoll(
+    void)
+{
+    struct epoll_event event;
+
+    if (Receive_Epoll_FD >= 0)
+        return true;
+    Receive_Epoll_FD = epoll_create(1);
+    if (Receive_Epoll_FD < 0)
+        return false;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = bip_socket();
+    if (epoll_ctl(Receive_Epoll_FD, EPOLL_CTL_ADD, bip_socket(),
+            &event) < 0) {
+        close(Receive_Epoll_FD);
+        Receive_Epoll_FD = -1;
+        return false;
+    }
+
+    return true;
+}
+
+/* takes whatever is waiting on the socket, without blocking */
+static int bip_receive_batch(
+    void)
+{
+    unsigned i;
+    int count;
+
+    for (i = 0; i < BIP_RECEIVE_RING_SIZE; i++) {
+        Receive_IOV[i].iov_base = &Receive_Buffer[i][0];
+        Receive_IOV[i].iov_len = MAX_MPDU;
+        Receive_Message[i].msg_hdr.msg_name = &Receive_Address[i];
+        Receive_Message[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        Receive_Message[i].msg_hdr.msg_iov = &Receive_IOV[i];
+        Receive_Message[i].msg_hdr.msg_iovlen = 1;
+        Receive_Message[i].msg_hdr.msg_control = NULL;
+        Receive_Message[i].msg_hdr.msg_controllen = 0;
+        Receive_Message[i].msg_hdr.msg_flags = 0;
+        Receive_Message[i].msg_len = 0;
+    }
+    count =
+        recvmmsg(bip_socket(), Receive_Message, BIP_RECEIVE_RING_SIZE,
+        MSG_DONTWAIT, NULL);
+    if (count > 0) {
+        Receive_Head = 0;
+        Receive_Count = (unsigned) count;
+    }
+
+    return count;
+}
+
+/* hands back the datagram where recvmmsg() left it in the ring,
+   rather than copying it into buf */
+int bip_receive_datagram(
+    uint8_t * buf,
+    uint16_t max_len,
+    uint8_t ** datagram,
+    struct sockaddr_in *sin,
+    unsigned timeout)
+{
+    struct epoll_event event;
+    int received_bytes = 0;
+
+    *datagram = buf;
+    if (Receive_Count == 0) {
+        /* under load the next batch is usually waiting already,
+           so only wait when the socket is empty */
+        if (bip_receive_batch() <= 0) {
+            if (!bip_receive_epoll())
+                return 0;
+            if (epoll_wait(Receive_Epoll_FD, &event, 1, (int) timeout) <= 0)
+                return 0;
+            if (bip_receive_batch() <= 0)
+                return 0;
+        }
+    }
+    received_bytes = (int) Receive_Message[Receive_Head].msg_len;
+    if (received_bytes > max_len)
+        received_bytes = max_len;
+    *datagram = &Receive_Buffer[Receive_Head][0];
+    *sin = Receive_Address[Receive_Head];
+    Receive_Head++;
+    Receive_Count--;
+
+    return received_bytes;
+}
+
+bool bip_receive_pending(
+    void)
+{
+    return (Receive_Count > 0);
+}
+
+void bip_receive_cleanup(
+    void)
+{
+    if (Receive_Epoll_FD >= 0)
+        close(Receive_Epoll_FD);
+    Receive_Epoll_FD = -1;
+    Receive_Head = 0;
+    Receive_Count = 0;
+}
+#endif
+
+#if BIP_SENDMMSG
+int bip_send_mpdu_multiple(
+    struct sockaddr_in *dest,
+    unsigned dest_count,
+    uint8_t * header,
+    uint16_t header_len,
+    uint8_t * pdu,
+    uint16_t pdu_len)
+{
+    struct iovec iov[2];
+    struct mmsghdr msg[BIP_SEND_BATCH_SIZE];
+    unsigned count = 0;
+    unsigned i = 0;
+    int status = 0;
+    int sent = 0;
+
+    /* every datagram is gathered from the same header and data */
+    iov[0].iov_base = header;
+    iov[0].iov_len = header_len;
+    iov[1].iov_base = pdu;
+    iov[1].iov_len = pdu ? pdu_len : 0;
+    while (dest_count > 0) {
+        count = dest_count;
+        if (count > BIP_SEND_BATCH_SIZE)
+            count = BIP_SEND_BATCH_SIZE;
+        memset(msg, 0, count * sizeof(struct mmsghdr));
+        for (i = 0; i < count; i++) {
+            msg[i].msg_hdr.msg_name = &dest[i];
+            msg[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+            msg[i].msg_hdr.msg_iov = &iov[0];
+            msg[i].msg_hdr.msg_iovlen = 2;
+        }
+        status = sendmmsg(bip_socket(), msg, count, 0);
+        if (status > 0) {
+            sent += status;
+        } else {
+            /* the first one failed - skip it, like sendto() would */
+            status = 1;
+        }
+        dest += status;
+        dest_count -= (unsigned) status;
+    }
+
+    return sent;
+}
+#endif
+
 /* gets an IP address by name, where name can be a
    string that is an IP address in dotted form, or
    a name that is a domain name
@@ -0,0 +1,255 @@
+/*####COPYRIGHTBEGIN####
+ -------------------------------------------
+ Copyright (C) 2026 agent <agent@local>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to:
+ The Free Software Foundation, Inc.
+ 59 Temple Place - Suite 330
+ Boston, MA  02111-1307
+ USA.
+
+ As a special exception, if other files instantiate templates or
+ use macros or inline functions from this file, or you compile
+ this file and link it with other works to produce a work based
+ on this file, this file does not by itself cause the resulting
+ work to be covered by the GNU General Public License. However
+ the source code for this file must still be made available in
+ accordance with section (3) of the GNU General Public License.
+
+ This exception does not invalidate any other reasons why a work
+ based on this file might be covered by the GNU General Public
+ License.
+ -------------------------------------------
+####COPYRIGHTEND####*/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+/* OS specific include*/
+#include "net.h"
+#include <poll.h>
+/* local includes */
+#include "pcapng.h"
+
+/* Records the BACnet/IP traffic on a network interface in a pcapng
+   file, as whole Ethernet frames.  A packet socket sees the frames
+   going both ways without taking any of them away from the BACnet
+   devices on this host, so the capture needs no second interface. */
+
+static PCAPNG_WRITER Capture;
+static uint8_t Rx_Buf[65536];
+static int Capture_Socket = -1;
+
+static int network_init(
+    const char *name,
+    bool * loopback)
+{
+    struct ifreq ifr;
+    struct sockaddr_ll sll;
+    int sockfd;
+
+    /* check to see if we are being run as root */
+    if (getuid() != 0) {
+        fprintf(stderr, "Requires root priveleges.\n");
+        return -1;
+    }
+    sockfd = socket(PF_PACKET, SOCK_RAW, htons(ETH_P_IP));
+    if (sockfd == -1) {
+        perror("Unable to create socket");
+        return sockfd;
+    }
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, name, sizeof(ifr.ifr_name) - 1);
+    if (ioctl(sockfd, SIOCGIFFLAGS, &ifr) == -1) {
+        perror("Unable to get interface flags");
+        close(sockfd);
+        return -1;
+    }
+    *loopback = (ifr.ifr_flags & IFF_LOOPBACK) ? true : false;
+    if (ioctl(sockfd, SIOCGIFINDEX, &ifr) == -1) {
+        perror("Unable to get interface index");
+        close(sockfd);
+        return -1;
+    }
+    memset(&sll, 0, sizeof(sll));
+    sll.sll_family = AF_PACKET;
+    sll.sll_ifindex = ifr.ifr_ifindex;
+    sll.sll_protocol = htons(ETH_P_IP);
+    if (bind(sockfd, (struct sockaddr *) &sll, sizeof(sll)) == -1) {
+        perror("Unable to bind socket");
+        close(sockfd);
+        return -1;
+    }
+
+    return sockfd;
+}
+
+/* true if the Ethernet frame holds a UDP datagram to or from port */
+static bool bip_frame(
+    const uint8_t * frame,
+    int len,
+    uint16_t port)
+{
+    const uint8_t *ip = &frame[14];
+    const uint8_t *udp;
+    unsigned ip_len;
+
+    if (len < (14 + 20 + 8)) {
+        return false;
+    }
+    if ((frame[12] != 0x08) || (frame[13] != 0x00)) {
+        return false;
+    }
+    ip_len = (ip[0] & 0x0F) * 4;
+    if (((ip[0] >> 4) != 4) || (ip[9] != IPPROTO_UDP) ||
+        (len < (int) (14 + ip_len + 8))) {
+        return false;
+    }
+    /* only the first fragment has the UDP header */
+    if (((ip[6] & 0x1F) | ip[7]) != 0) {
+        return false;
+    }
+    udp = &ip[ip_len];
+    if ((((udp[0] << 8) | udp[1]) != port) &&
+        (((udp[2] << 8) | udp[3]) != port)) {
+        return false;
+    }
+
+    return true;
+}
+
+static void cleanup(
+    void)
+{
+    pcapng_writer_close(&Capture);
+    if (Capture_Socket != -1) {
+        close(Capture_Socket);
+        Capture_Socket = -1;
+    }
+}
+
+static void sig_int(
+    int signo)
+{
+    (void) signo;
+
+    cleanup();
+    exit(0);
+}
+
+void signal_init(
+    void)
+{
+    signal(SIGINT, sig_int);
+    signal(SIGHUP, sig_int);
+    signal(SIGTERM, sig_int);
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    char *my_interface = "eth0";
+    char *capture_name = "bip.pcapng";
+    unsigned long capture_size = 0;
+    uint16_t port = 0xBAC0;
+    uint32_t packet_count = 0;
+    struct sockaddr_ll sll;
+    socklen_t sll_len;
+    struct pollfd fds;
+    struct timespec now;
+    bool loopback = false;
+    char *pEnv = NULL;
+    int argi = 0;
+    int len = 0;
+
+    if ((argc > 1) && (strcmp(argv[1], "--help") == 0)) {
+        printf("bipsnap [network] [--file name] [--size bytes]\r\n"
+            "Captures BACnet/IP packets from a network interface\r\n"
+            "and writes them to a pcapng file.\r\n" "\r\n"
+            "Command line options:\r\n" "[network] - network interface.\r\n"
+            "    defaults to eth0.\r\n"
+            "--file name - pcapng file.  defaults to bip.pcapng.\r\n"
+            "--size bytes - start a new file, name.1, name.2 and so on,\r\n"
+            "    when the file would grow past this size.\r\n"
+            "The UDP port is BACNET_IP_PORT, or 47808 if not set.\r\n" "");
+        return 0;
+    }
+    for (argi = 1; argi < argc; argi++) {
+        if ((strcmp(argv[argi], "--file") == 0) && ((argi + 1) < argc)) {
+            argi++;
+            capture_name = argv[argi];
+        } else if ((strcmp(argv[argi], "--size") == 0) &&
+            ((argi + 1) < argc)) {
+            argi++;
+            capture_size = strtoul(argv[argi], NULL, 0);
+        } else {
+            my_interface = argv[argi];
+        }
+    }
+    pEnv = getenv("BACNET_IP_PORT");
+    if (pEnv) {
+        port = (uint16_t) strtol(pEnv, NULL, 0);
+    }
+    Capture_Socket = network_init(my_interface, &loopback);
+    if (Capture_Socket == -1) {
+        return 1;
+    }
+    if (!pcapng_writer_open(&Capture, capture_name, capture_size)) {
+        fprintf(stderr, "bipsnap: failed to open %s: %s\n", capture_name,
+            strerror(errno));
+        cleanup();
+        return 1;
+    }
+    pcapng_writer_add_interface(&Capture, PCAPNG_LINKTYPE_ETHERNET, 0);
+    fprintf(stdout, "bipsnap: capturing UDP port %u on %s to %s.\n",
+        (unsigned) port, my_interface, capture_name);
+    fflush(stdout);
+    signal_init();
+    atexit(cleanup);
+    fds.fd = Capture_Socket;
+    fds.events = POLLIN;
+    for (;;) {
+        if (poll(&fds, 1, 1000) <= 0) {
+            /* quiet: keep the file up to date */
+            pcapng_writer_flush(&Capture);
+            continue;
+        }
+        sll_len = sizeof(sll);
+        len = recvfrom(Capture_Socket, Rx_Buf, sizeof(Rx_Buf), 0,
+            (struct sockaddr *) &sll, &sll_len);
+        clock_gettime(CLOCK_REALTIME, &now);
+        /* the loopback interface shows each frame going out and
+           again coming in */
+        if (loopback && (sll.sll_pkttype == PACKET_OUTGOING)) {
+            continue;
+        }
+        if ((len > 0) && bip_frame(Rx_Buf, len, port)) {
+            pcapng_writer_packet(&Capture, 0,
+                ((uint64_t) now.tv_sec * 1000000000ULL) + now.tv_nsec,
+                Rx_Buf, (uint32_t) len);
+            packet_count++;
+            if (!(packet_count % 100)) {
+                fprintf(stdout, "\r%lu packets",
+                    (unsigned long) packet_count);
+                fflush(stdout);
+            }
+        }
+    }
+
+    return 0;
+}
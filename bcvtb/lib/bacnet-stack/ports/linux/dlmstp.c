@@ -37,6 +37,9 @@
 #include "bits.h"
 /* OS Specific include */
 #include "net.h"
+#include <poll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
 
 /* Number of MS/TP Packets Rx/Tx */
 uint16_t MSTP_Packets = 0;
@@ -47,9 +50,9 @@ static DLMSTP_PACKET Transmit_Packet;
 /* mechanism to wait for a packet */
 static pthread_cond_t Receive_Packet_Flag;
 static pthread_mutex_t Receive_Packet_Mutex;
-/* mechanism to wait for a frame in state machine */
-static pthread_cond_t Received_Frame_Flag;
-static pthread_mutex_t Received_Frame_Mutex;
+/* mechanism to wait for a frame or a timeout in state machine */
+static int Received_Frame_Event = -1;
+static int Master_Timer = -1;
 /* local MS/TP port data - shared with RS-485 */
 static volatile struct mstp_port_struct_t MSTP_Port;
 /* buffers needed by mstp port struct */
@@ -59,49 +62,61 @@ static uint8_t RxBuffer[MAX_MPDU];
 /* that a node must wait for a station to begin replying to a */
 /* confirmed request: 255 milliseconds. (Implementations may use */
 /* larger values for this timeout, not to exceed 300 milliseconds.) */
-static uint8_t Treply_timeout = 260;
+static uint16_t Treply_timeout = 260;
 /* The minimum time without a DataAvailable or ReceiveError event that a */
 /* node must wait for a remote node to begin using a token or replying to */
 /* a Poll For Master frame: 20 milliseconds. (Implementations may use */
 /* larger values for this timeout, not to exceed 100 milliseconds.) */
 static uint8_t Tusage_timeout = 50;
 /* Timer that indicates line silence - and functions */
-static uint16_t SilenceTime;
-#define INCREMENT_AND_LIMIT_UINT16(x) {if (x < 0xFFFF) x++;}
-static uint16_t Timer_Silence(
+/* The silence time is computed from the monotonic clock when it is
+   read, so no thread has to tick it and setting the wall clock
+   does not disturb the token timing. */
+static volatile unsigned long Silence_Start;
+
+static unsigned long Timer_Milliseconds(
     void)
 {
-    return SilenceTime;
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((unsigned long) now.tv_sec * 1000UL) +
+        ((unsigned long) now.tv_nsec / 1000000UL);
 }
 
-static void Timer_Silence_Reset(
+static uint16_t Timer_Silence(
     void)
 {
-    SilenceTime = 0;
+    unsigned long elapsed;
+
+    elapsed = Timer_Milliseconds() - Silence_Start;
+    if (elapsed > 0xFFFF) {
+        elapsed = 0xFFFF;
+    }
+
+    return (uint16_t) elapsed;
 }
 
-void dlmstp_millisecond_timer(
+static void Timer_Silence_Reset(
     void)
 {
-    INCREMENT_AND_LIMIT_UINT16(SilenceTime);
+    Silence_Start = Timer_Milliseconds();
 }
 
+/* absolute time on the monotonic clock, for conditions
+   created with pthread_condattr_setclock(CLOCK_MONOTONIC) */
 void get_abstime(
     struct timespec *abstime,
     unsigned long milliseconds)
 {
-    struct timeval tp;
-    unsigned long seconds;
-
-    gettimeofday(&tp, NULL);
-
-    abstime->tv_sec = tp.tv_sec;
-    abstime->tv_nsec = tp.tv_usec * 1000;
-    seconds = milliseconds / 1000;
-    abstime->tv_sec += seconds;
-    abstime->tv_nsec += ((milliseconds - (seconds * 1000)) * (1000 * 1000));
-    seconds = abstime->tv_nsec / (1000 * 1000 * 1000);
-    abstime->tv_sec += seconds;
+    clock_gettime(CLOCK_MONOTONIC, abstime);
+    abstime->tv_sec += milliseconds / 1000;
+    abstime->tv_nsec += (milliseconds % 1000) * 1000000L;
+    if (abstime->tv_nsec >= 1000000000L) {
+        abstime->tv_sec++;
+        abstime->tv_nsec -= 1000000000L;
+    }
 }
 
 void dlmstp_reinit(
@@ -116,10 +131,16 @@ void dlmstp_reinit(
 void dlmstp_cleanup(
     void)
 {
-    pthread_cond_destroy(&Received_Frame_Flag);
     pthread_cond_destroy(&Receive_Packet_Flag);
-    pthread_mutex_destroy(&Received_Frame_Mutex);
     pthread_mutex_destroy(&Receive_Packet_Mutex);
+    if (Master_Timer != -1) {
+        close(Master_Timer);
+        Master_Timer = -1;
+    }
+    if (Received_Frame_Event != -1) {
+        close(Received_Frame_Event);
+        Received_Frame_Event = -1;
+    }
 }
 
 /* returns number of bytes sent on success, zero on failure */
@@ -193,6 +214,8 @@ static void *dlmstp_receive_fsm_task(
     void *pArg)
 {
     bool received_frame;
+    uint64_t event = 1;
+    ssize_t written;
 
     (void) pArg;
     for (;;) {
@@ -205,7 +228,9 @@ static void *dlmstp_receive_fsm_task(
                 received_frame = MSTP_Port.ReceivedValidFrame ||
                     MSTP_Port.ReceivedInvalidFrame;
                 if (received_frame) {
-                    pthread_cond_signal(&Received_Frame_Flag);
+                    written = write(Received_Frame_Event, &event,
+                        sizeof(event));
+                    (void) written;
                     break;
                 }
             } while (MSTP_Port.DataAvailable);
@@ -215,11 +240,46 @@ static void *dlmstp_receive_fsm_task(
     return NULL;
 }
 
+/* sleeps until a frame arrives or the line has been silent
+   for the given time, whichever comes first */
+static void dlmstp_master_fsm_wait(
+    unsigned long milliseconds)
+{
+    struct itimerspec timeout;
+    struct pollfd fds[2];
+    unsigned long silence;
+    uint64_t count;
+    ssize_t bytes;
+
+    silence = Timer_Silence();
+    if (silence >= milliseconds) {
+        return;
+    }
+    milliseconds -= silence;
+    timeout.it_interval.tv_sec = 0;
+    timeout.it_interval.tv_nsec = 0;
+    timeout.it_value.tv_sec = milliseconds / 1000;
+    timeout.it_value.tv_nsec = (milliseconds % 1000) * 1000000L;
+    timerfd_settime(Master_Timer, 0, &timeout, NULL);
+    fds[0].fd = Received_Frame_Event;
+    fds[0].events = POLLIN;
+    fds[1].fd = Master_Timer;
+    fds[1].events = POLLIN;
+    if (poll(fds, 2, -1) > 0) {
+        if (fds[0].revents & POLLIN) {
+            bytes = read(Received_Frame_Event, &count, sizeof(count));
+        }
+        if (fds[1].revents & POLLIN) {
+            bytes = read(Master_Timer, &count, sizeof(count));
+        }
+        (void) bytes;
+    }
+}
+
 static void *dlmstp_master_fsm_task(
     void *pArg)
 {
     unsigned long milliseconds = 0;
-    struct timespec abstime;
 
     (void) pArg;
     for (;;) {
@@ -237,11 +297,10 @@ static void *dlmstp_master_fsm_task(
                 milliseconds = 0;
                 break;
         }
-        if (milliseconds) {
-            get_abstime(&abstime, milliseconds);
+        if (milliseconds && !MSTP_Port.ReceivedValidFrame &&
+            !MSTP_Port.ReceivedInvalidFrame) {
             /* we want an OS effecient way to wait for a frame */
-            pthread_cond_timedwait(&Received_Frame_Flag, &Received_Frame_Mutex,
-                &abstime);
+            dlmstp_master_fsm_wait(milliseconds);
         }
         MSTP_Master_Node_FSM(&MSTP_Port);
     }
@@ -249,23 +308,6 @@ static void *dlmstp_master_fsm_task(
     return NULL;
 }
 
-static void *dlmstp_milliseconds_task(
-    void *pArg)
-{
-    struct timespec timeOut, remains;
-
-    (void) pArg;
-    timeOut.tv_sec = 0;
-    timeOut.tv_nsec = 1000000;  /* 1 millisecond */
-
-    for (;;) {
-        nanosleep(&timeOut, &remains);
-        dlmstp_millisecond_timer();
-    }
-
-    return NULL;
-}
-
 void dlmstp_fill_bacnet_address(
     BACNET_ADDRESS * src,
     uint8_t mstp_address)
@@ -630,35 +672,39 @@ bool dlmstp_init(
     char *ifname)
 {
     unsigned long hThread = 0;
+    pthread_condattr_t attr;
     int rv = 0;
 
     /* initialize packet queue */
     Receive_Packet.ready = false;
     Receive_Packet.pdu_len = 0;
-    rv = pthread_cond_init(&Receive_Packet_Flag, NULL);
-    if (rv == -1) {
+    /* timed waits use the monotonic clock - see get_abstime() */
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    rv = pthread_cond_init(&Receive_Packet_Flag, &attr);
+    pthread_condattr_destroy(&attr);
+    if (rv != 0) {
         fprintf(stderr,
             "MS/TP Interface: %s\n cannot allocate PThread Condition.\n",
             ifname);
         exit(1);
     }
-    rv = pthread_cond_init(&Received_Frame_Flag, NULL);
-    if (rv == -1) {
+    rv = pthread_mutex_init(&Receive_Packet_Mutex, NULL);
+    if (rv != 0) {
         fprintf(stderr,
-            "MS/TP Interface: %s\n cannot allocate PThread Condition.\n",
-            ifname);
+            "MS/TP Interface: %s\n cannot allocate PThread Mutex.\n", ifname);
         exit(1);
     }
-    rv = pthread_mutex_init(&Receive_Packet_Mutex, NULL);
-    if (rv == -1) {
+    Received_Frame_Event = eventfd(0, 0);
+    if (Received_Frame_Event == -1) {
         fprintf(stderr,
-            "MS/TP Interface: %s\n cannot allocate PThread Mutex.\n", ifname);
+            "MS/TP Interface: %s\n cannot allocate frame event.\n", ifname);
         exit(1);
     }
-    rv = pthread_mutex_init(&Received_Frame_Mutex, NULL);
-    if (rv == -1) {
+    Master_Timer = timerfd_create(CLOCK_MONOTONIC, 0);
+    if (Master_Timer == -1) {
         fprintf(stderr,
-            "MS/TP Interface: %s\n cannot allocate PThread Mutex.\n", ifname);
+            "MS/TP Interface: %s\n cannot allocate timer.\n", ifname);
         exit(1);
     }
     /* initialize hardware */
@@ -711,10 +757,7 @@ bool dlmstp_init(
     fprintf(stderr, "MS/TP Max_Info_Frames: %u\n", MSTP_Port.Nmax_info_frames);
 #endif
     /* start the threads */
-    rv = pthread_create(&hThread, NULL, dlmstp_milliseconds_task, NULL);
-    if (rv != 0) {
-        fprintf(stderr, "Failed to start timer task\n");
-    }
+    Timer_Silence_Reset();
     rv = pthread_create(&hThread, NULL, dlmstp_receive_fsm_task, NULL);
     if (rv != 0) {
         fprintf(stderr, "Failed to start recive FSM task\n");
@@ -9,7 +9,8 @@ CFLAGS  = -Wall $(INCLUDES) $(DEFINES) -g
 SRCS = rs485.c \
 	dlmstp.c \
 	../../mstp.c \
-	../../crc.c
+	../../crc.c \
+	../../src/fifo.c
 
 OBJS = ${SRCS:.c=.o}
 
@@ -45,8 +45,10 @@
 #include "rs485.h"
 #include "crc.h"
 #include "mstp.h"
+#include "dlmstp.h"
 #include "mstptext.h"
 #include "bacint.h"
+#include "pcapng.h"
 
 #ifndef max
 #define max(a,b) (((a) (b)) ? (a) : (b))
@@ -58,40 +60,40 @@ static volatile struct mstp_port_struct_t MSTP_Port;
 /* buffers needed by mstp port struct */
 static uint8_t RxBuffer[MAX_MPDU];
 static uint8_t TxBuffer[MAX_MPDU];
-static uint16_t SilenceTime;
-#define INCREMENT_AND_LIMIT_UINT16(x) {if (x < 0xFFFF) x++;}
-static uint16_t Timer_Silence(
-    void)
-{
-    return SilenceTime;
-}
+/* capture file, when one is given instead of a network interface */
+static PCAPNG_WRITER Capture;
+static bool Capture_File;
+/* Timer that indicates line silence, from the monotonic clock */
+static unsigned long Silence_Start;
 
-static void Timer_Silence_Reset(
+static unsigned long Timer_Milliseconds(
     void)
 {
-    SilenceTime = 0;
-}
+    struct timespec now;
 
-static void dlmstp_millisecond_timer(
-    void)
-{
-    INCREMENT_AND_LIMIT_UINT16(SilenceTime);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((unsigned long) now.tv_sec * 1000UL) +
+        ((unsigned long) now.tv_nsec / 1000000UL);
 }
 
-void *milliseconds_task(
-    void *pArg)
+static uint16_t Timer_Silence(
+    void)
 {
-    struct timespec timeOut, remains;
-
-    timeOut.tv_sec = 0;
-    timeOut.tv_nsec = 10000000; /* 1 milliseconds */
+    unsigned long elapsed;
 
-    for (;;) {
-        nanosleep(&timeOut, &remains);
-        dlmstp_millisecond_timer();
+    elapsed = Timer_Milliseconds() - Silence_Start;
+    if (elapsed > 0xFFFF) {
+        elapsed = 0xFFFF;
     }
 
-    return NULL;
+    return (uint16_t) elapsed;
+}
+
+static void Timer_Silence_Reset(
+    void)
+{
+    Silence_Start = Timer_Milliseconds();
 }
 
 /* functions used by the MS/TP state machine to put or get data */
@@ -219,10 +221,51 @@ static void snap_received_packet(
     write(sockfd, &mtu[0], mtu_len);
 }
 
+/* write the frame, as received on the wire, to the capture file */
+static void capture_received_packet(
+    volatile struct mstp_port_struct_t *mstp_port)
+{
+    static uint8_t frame[8 + MAX_MPDU + 2];
+    uint16_t frame_len = 8;
+    uint16_t max_data = 0;
+    struct timespec now;
+
+    frame[0] = 0x55;
+    frame[1] = 0xFF;
+    frame[2] = mstp_port->FrameType;
+    frame[3] = mstp_port->DestinationAddress;
+    frame[4] = mstp_port->SourceAddress;
+    frame[5] = HI_BYTE(mstp_port->DataLength);
+    frame[6] = LO_BYTE(mstp_port->DataLength);
+    frame[7] = mstp_port->HeaderCRCActual;
+    if (mstp_port->DataLength) {
+        max_data = min(mstp_port->InputBufferSize, mstp_port->DataLength);
+        memcpy(&frame[8], mstp_port->InputBuffer, max_data);
+        frame[8 + max_data] = mstp_port->DataCRCActualMSB;
+        frame[8 + max_data + 1] = mstp_port->DataCRCActualLSB;
+        frame_len += (max_data + 2);
+    }
+    clock_gettime(CLOCK_REALTIME, &now);
+    pcapng_writer_packet(&Capture, 0,
+        ((uint64_t) now.tv_sec * 1000000000ULL) + now.tv_nsec, frame,
+        frame_len);
+}
+
+static void received_packet(
+    volatile struct mstp_port_struct_t *mstp_port,
+    int sockfd)
+{
+    if (Capture_File) {
+        capture_received_packet(mstp_port);
+    } else {
+        snap_received_packet(mstp_port, sockfd);
+    }
+}
 
 static void cleanup(
     void)
 {
+    pcapng_writer_close(&Capture);
 }
 
 #if (!defined(_WIN32))
@@ -252,20 +295,19 @@ int main(
     volatile struct mstp_port_struct_t *mstp_port;
     long my_baud = 38400;
     uint32_t packet_count = 0;
-#if defined(_WIN32)
-    unsigned long hThread = 0;
-    uint32_t arg_value = 0;
-#else
-    int rc = 0;
-    pthread_t hThread;
-#endif
+    uint32_t last_count = 0;
     int sockfd = -1;
     char *my_interface = "eth0";
+    char *capture_name = NULL;
+    unsigned long capture_size = 0;
+    int argi = 0;
+    int positional = 0;
 
     /* mimic our pointer in the state machine */
     mstp_port = &MSTP_Port;
     if ((argc > 1) && (strcmp(argv[1], "--help") == 0)) {
-        printf("mstsnap [serial] [baud] [network]\r\n"
+        printf("mstsnap [serial] [baud] [network] [--file name]"
+            " [--size bytes]\r\n"
             "Captures MS/TP packets from a serial interface\r\n"
             "and sends them to a network interface using SNAP \r\n"
             "protocol packets (mimics Cimetrics U+4 packet).\r\n" "\r\n"
@@ -273,22 +315,47 @@ int main(
             "    defaults to /dev/ttyUSB0.\r\n"
             "[baud] - baud rate.  9600, 19200, 38400, 57600, 115200\r\n"
             "    defaults to 38400.\r\n" "[network] - network interface.\r\n"
-            "    defaults to eth0.\r\n" "");
+            "    defaults to eth0.\r\n"
+            "--file name - write the packets to a pcapng file\r\n"
+            "    instead of a network interface.\r\n"
+            "--size bytes - start a new file, name.1, name.2 and so on,\r\n"
+            "    when the file would grow past this size.\r\n" "");
         return 0;
     }
-    /* initialize our interface */
-    if (argc > 1) {
-        RS485_Set_Interface(argv[1]);
-    }
-    if (argc > 2) {
-        my_baud = strtol(argv[2], NULL, 0);
-    }
-    if (argc > 3) {
-        my_interface = argv[3];
+    for (argi = 1; argi < argc; argi++) {
+        if ((strcmp(argv[argi], "--file") == 0) && ((argi + 1) < argc)) {
+            argi++;
+            capture_name = argv[argi];
+        } else if ((strcmp(argv[argi], "--size") == 0) &&
+            ((argi + 1) < argc)) {
+            argi++;
+            capture_size = strtoul(argv[argi], NULL, 0);
+        } else {
+            positional++;
+            if (positional == 1) {
+                /* initialize our interface */
+                RS485_Set_Interface(argv[argi]);
+            } else if (positional == 2) {
+                my_baud = strtol(argv[argi], NULL, 0);
+            } else if (positional == 3) {
+                my_interface = argv[argi];
+            }
+        }
     }
-    sockfd = network_init(my_interface, ETH_P_ALL);
-    if (sockfd == -1) {
-        return 1;
+    if (capture_name) {
+        if (!pcapng_writer_open(&Capture, capture_name, capture_size)) {
+            fprintf(stderr, "mstpsnap: failed to open %s: %s\n",
+                capture_name, strerror(errno));
+            return 1;
+        }
+        pcapng_writer_add_interface(&Capture, PCAPNG_LINKTYPE_BACNET_MS_TP,
+            0);
+        Capture_File = true;
+    } else {
+        sockfd = network_init(my_interface, ETH_P_ALL);
+        if (sockfd == -1) {
+            return 1;
+        }
     }
     RS485_Set_Baud_Rate(my_baud);
     RS485_Initialize();
@@ -306,15 +373,9 @@ int main(
     fprintf(stdout, "mstpcap: Using %s for capture at %ld bps.\n",
         RS485_Interface(), (long) RS485_Get_Baud_Rate());
 #if defined(_WIN32)
-    hThread = _beginthread(milliseconds_task, 4096, &arg_value);
-    if (hThread == 0) {
-        fprintf(stderr, "Failed to start timer task\n");
-    }
     (void) SetThreadPriority(GetCurrentThread(),
         THREAD_PRIORITY_TIME_CRITICAL);
 #else
-    /* start our MilliSec task */
-    rc = pthread_create(&hThread, NULL, milliseconds_task, NULL);
     signal_init();
 #endif
     atexit(cleanup);
@@ -325,17 +386,19 @@ int main(
         /* process the data portion of the frame */
         if (mstp_port->ReceivedValidFrame) {
             mstp_port->ReceivedValidFrame = false;
-            snap_received_packet(mstp_port, sockfd);
+            received_packet(mstp_port, sockfd);
             packet_count++;
         } else if (mstp_port->ReceivedInvalidFrame) {
             mstp_port->ReceivedInvalidFrame = false;
             fprintf(stderr, "ReceivedInvalidFrame\n");
-            snap_received_packet(mstp_port, sockfd);
+            received_packet(mstp_port, sockfd);
             packet_count++;
         }
-        if (!(packet_count % 100)) {
-            fprintf(stdout, "\r%hu packets", packet_count);
+        if ((packet_count != last_count) && !(packet_count % 100)) {
+            fprintf(stdout, "\r%lu packets", (unsigned long) packet_count);
+            fflush(stdout);
         }
+        last_count = packet_count;
     }
 
     return 0;
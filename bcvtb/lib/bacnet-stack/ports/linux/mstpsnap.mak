@@ -40,7 +40,9 @@ SRCS = mstpsnap.c \
 	${BACNET_SOURCE_DIR}/mstptext.c \
 	${BACNET_SOURCE_DIR}/debug.c \
 	${BACNET_SOURCE_DIR}/indtext.c \
-	${BACNET_SOURCE_DIR}/crc.c
+	${BACNET_SOURCE_DIR}/crc.c \
+	${BACNET_SOURCE_DIR}/pcapng.c \
+	${BACNET_SOURCE_DIR}/fifo.c
 
 OBJS = ${SRCS:.c=.o}
 
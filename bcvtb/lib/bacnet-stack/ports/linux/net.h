@@ -94,4 +94,25 @@
 #include <sys/ioctl.h>
 #include <netdb.h>
 
+/* BACnet/IP receive drains the socket with recvmmsg() - see bip-init.c */
+#ifndef BIP_RECVMMSG
+#define BIP_RECVMMSG 1
+#endif
+/* BACnet/IP send gathers the BVLC header and NPDU with sendmsg() */
+#ifndef BIP_SENDMSG
+#define BIP_SENDMSG 1
+#endif
+/* BACnet/IP forwarding sends to a list of peers with sendmmsg() */
+#ifndef BIP_SENDMMSG
+#define BIP_SENDMMSG 1
+#endif
+/* datagrams given to the kernel per sendmmsg() call */
+#ifndef BIP_SEND_BATCH_SIZE
+#define BIP_SEND_BATCH_SIZE 64
+#endif
+/* datagrams taken from the socket per recvmmsg() call */
+#ifndef BIP_RECEIVE_RING_SIZE
+#define BIP_RECEIVE_RING_SIZE 32
+#endif
+
 #endif
@@ -36,6 +36,10 @@
 /* The module handles sending data out the RS-485 port */
 /* and handles receiving data from the RS-485 port. */
 /* Customize this file for your specific hardware */
+#if defined(TEST) && !defined(_GNU_SOURCE)
+/* posix_openpt() and friends, for the pseudo-terminal test */
+#define _GNU_SOURCE
+#endif
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -49,10 +53,13 @@
 #include <fcntl.h>
 #include <termios.h>
 #include <unistd.h>
-#include <sched.h>
+#include <time.h>
+#include <poll.h>
+#include <errno.h>
 
 /* Local includes */
 #include "mstp.h"
+#include "fifo.h"
 
 /* Posix serial programming reference:
 http://www.easysw.com/~mike/serial/serial.html */
@@ -67,6 +74,20 @@ static unsigned int RS485_Baud = B38400;
 static char *RS485_Port_Name = "/dev/ttyUSB0";
 /* serial I/O settings */
 static struct termios RS485_oldtio;
+/* bytes read from the port, waiting for the receive state machine.
+   One read() gets everything that the port has, up to the free space
+   before the end of the buffer.
+   Note: must be a power of two */
+#ifndef RS485_RX_BUFFER_SIZE
+#define RS485_RX_BUFFER_SIZE 4096
+#endif
+static uint8_t RS485_Rx_Buffer[RS485_RX_BUFFER_SIZE];
+static FIFO_BUFFER RS485_Rx_FIFO;
+/* how long to wait for data before the receive state machine runs
+   anyway, to check its silence timer */
+#ifndef RS485_POLL_TIMEOUT_MS
+#define RS485_POLL_TIMEOUT_MS 1
+#endif
 
 #define _POSIX_SOURCE 1 /* POSIX compliant source */
 
@@ -167,6 +188,8 @@ void RS485_Send_Frame(
     uint16_t nbytes)
 {       /* number of bytes of data (up to 501) */
     uint8_t turnaround_time;
+    uint16_t silence;
+    struct timespec delay;
     uint32_t baud;
     ssize_t written = 0;
 
@@ -179,10 +202,15 @@ void RS485_Send_Frame(
             turnaround_time = 2;
         else
             turnaround_time = 1;
-        while (mstp_port->SilenceTimer() < turnaround_time) {
-            /* do nothing - wait for timer to increment */
-            sched_yield();
-        };
+        /* the silence timer reads the clock, so sleep out the rest
+           of the turnaround instead of polling it */
+        silence = mstp_port->SilenceTimer();
+        while (silence < turnaround_time) {
+            delay.tv_sec = 0;
+            delay.tv_nsec = (turnaround_time - silence) * 1000000L;
+            nanosleep(&delay, NULL);
+            silence = mstp_port->SilenceTimer();
+        }
     }
     /*
        On  success,  the  number of bytes written are returned (zero indicates
@@ -201,29 +229,60 @@ void RS485_Send_Frame(
     return;
 }
 
+/* waits up to RS485_POLL_TIMEOUT_MS for data, then reads all that
+   the port has into the receive FIFO.
+   returns false if the port reported an error */
+static bool RS485_Fill_Rx_Buffer(
+    void)
+{
+    uint8_t *buf;
+    struct pollfd fds;
+    unsigned space;
+    ssize_t count;
+
+    /* read straight into the FIFO, up to the end of its buffer */
+    buf = FIFO_Reserve(&RS485_Rx_FIFO, &space);
+    if (!buf) {
+        return true;
+    }
+    fds.fd = RS485_Handle;
+    fds.events = POLLIN;
+    fds.revents = 0;
+    if (poll(&fds, 1, RS485_POLL_TIMEOUT_MS) <= 0) {
+        return true;
+    }
+    if (!(fds.revents & POLLIN)) {
+        return !(fds.revents & (POLLERR | POLLNVAL));
+    }
+    count = read(RS485_Handle, buf, space);
+    if (count > 0) {
+        (void) FIFO_Commit(&RS485_Rx_FIFO, (unsigned) count);
+    } else if ((count < 0) && (errno != EINTR) && (errno != EAGAIN)) {
+        return false;
+    }
+
+    return true;
+}
+
 /* called by timer, interrupt(?) or other thread */
 void RS485_Check_UART_Data(
     struct mstp_port_struct_t *mstp_port)
 {
-    uint8_t buf[1];
-    int count;
-
     if (mstp_port->ReceiveError == true) {
         /* wait for state machine to clear this */
     }
     /* wait for state machine to read from the DataRegister */
     else if (mstp_port->DataAvailable == false) {
-        /* check for data */
-        count = read(RS485_Handle, buf, sizeof(buf));
-        /* if error, */
-        /* ReceiveError = TRUE; */
-        /* return; */
-        if (count > 0) {
-            mstp_port->DataRegister = buf[0];
+        /* check for data, waiting for it if there is none */
+        if (FIFO_Empty(&RS485_Rx_FIFO) && !RS485_Fill_Rx_Buffer()) {
+            mstp_port->ReceiveError = true;
+            return;
+        }
+        if (!FIFO_Empty(&RS485_Rx_FIFO)) {
+            mstp_port->DataRegister = FIFO_Get(&RS485_Rx_FIFO);
             /* if data is ready, */
             mstp_port->DataAvailable = true;
         }
-        usleep(30);
     }
 }
 
@@ -242,6 +301,7 @@ void RS485_Initialize(
     struct termios newtio;
 
     printf("RS485: Initializing %s", RS485_Port_Name);
+    FIFO_Init(&RS485_Rx_FIFO, &RS485_Rx_Buffer[0], sizeof(RS485_Rx_Buffer));
     /*
        Open device for reading and writing.
        Blocking mode - more CPU effecient
@@ -287,6 +347,107 @@ void RS485_Initialize(
     printf("=success!\n");
 }
 
+#ifdef TEST
+#include <assert.h>
+#include <string.h>
+
+#include "ctest.h"
+
+/* receive over a pseudo-terminal pair, where the test writes to the
+   master side and the port is the slave side */
+void testRS485_Receive(
+    Test * pTest)
+{
+    static char slave_name[64];
+    struct mstp_port_struct_t mstp_port;
+    uint8_t wbuf[1000];
+    int master;
+    unsigned i;
+    unsigned received = 0;
+    unsigned idle = 0;
+    bool in_order = true;
+    ssize_t written;
+
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    ct_test(pTest, master >= 0);
+    if (master < 0)
+        return;
+    ct_test(pTest, grantpt(master) == 0);
+    ct_test(pTest, unlockpt(master) == 0);
+    strncpy(slave_name, ptsname(master), sizeof(slave_name) - 1);
+    RS485_Set_Interface(slave_name);
+    RS485_Initialize();
+
+    memset(&mstp_port, 0, sizeof(mstp_port));
+    /* nothing to read yet */
+    RS485_Check_UART_Data(&mstp_port);
+    ct_test(pTest, mstp_port.DataAvailable == false);
+    ct_test(pTest, mstp_port.ReceiveError == false);
+
+    for (i = 0; i < sizeof(wbuf); i++) {
+        wbuf[i] = (uint8_t) (i * 7);
+    }
+    written = write(master, wbuf, sizeof(wbuf));
+    ct_test(pTest, written == sizeof(wbuf));
+    while ((received < sizeof(wbuf)) && (idle < 1000)) {
+        RS485_Check_UART_Data(&mstp_port);
+        if (mstp_port.DataAvailable) {
+            if (mstp_port.DataRegister != wbuf[received])
+                in_order = false;
+            if (received == 0) {
+                /* one read() got more than the first byte */
+                ct_test(pTest, !FIFO_Empty(&RS485_Rx_FIFO));
+            }
+            received++;
+            mstp_port.DataAvailable = false;
+        } else {
+            idle++;
+        }
+    }
+    ct_test(pTest, received == sizeof(wbuf));
+    ct_test(pTest, in_order);
+    /* the data register is not overwritten until it is taken */
+    written = write(master, wbuf, 2);
+    RS485_Check_UART_Data(&mstp_port);
+    ct_test(pTest, mstp_port.DataAvailable == true);
+    ct_test(pTest, mstp_port.DataRegister == wbuf[0]);
+    RS485_Check_UART_Data(&mstp_port);
+    ct_test(pTest, mstp_port.DataRegister == wbuf[0]);
+    mstp_port.DataAvailable = false;
+    RS485_Check_UART_Data(&mstp_port);
+    ct_test(pTest, mstp_port.DataAvailable == true);
+    ct_test(pTest, mstp_port.DataRegister == wbuf[1]);
+    mstp_port.DataAvailable = false;
+    RS485_Check_UART_Data(&mstp_port);
+    ct_test(pTest, mstp_port.DataAvailable == false);
+
+    close(master);
+}
+
+#ifdef TEST_RS485_RECEIVE
+int main(
+    void)
+{
+    Test *pTest;
+    bool rc;
+
+    pTest = ct_create("RS485 Receive", NULL);
+
+    /* individual tests */
+    rc = ct_addTestFunction(pTest, testRS485_Receive);
+    assert(rc);
+
+    ct_setStream(pTest, stdout);
+    ct_run(pTest);
+    (void) ct_report(pTest);
+
+    ct_destroy(pTest);
+
+    return 0;
+}
+#endif /* TEST_RS485_RECEIVE */
+#endif /* TEST */
+
 #ifdef TEST_RS485
 #include <string.h>
 int main(
@@ -3,10 +3,11 @@ CC      = gcc
 BASEDIR = .
 # -g for debugging with gdb
 DEFINES = -DBIG_ENDIAN=0 -DTEST_RS485 -DBACDL_TEST
-INCLUDES = -I. -I../../ 
+INCLUDES = -I. -I../../ -I../../include
 CFLAGS  = -Wall $(INCLUDES) $(DEFINES) -g
 
-SRCS = rs485.c
+SRCS = rs485.c \
+	../../src/fifo.c
 
 OBJS = ${SRCS:.c=.o}
 
@@ -0,0 +1,39 @@
+#Makefile to build the pseudo-terminal receive test case
+CC      = gcc
+BASEDIR = .
+TEST_DIR = ../../test
+# -g for debugging with gdb
+DEFINES = -DBIG_ENDIAN=0 -DTEST -DTEST_RS485_RECEIVE -DBACDL_TEST
+INCLUDES = -I. -I../../ -I../../include -I$(TEST_DIR)
+CFLAGS  = -Wall $(INCLUDES) $(DEFINES) -g
+
+SRCS = rs485.c \
+	../../src/fifo.c \
+	$(TEST_DIR)/ctest.c
+
+OBJS = ${SRCS:.c=.o}
+
+TARGET = rs485_receive
+
+# the test needs the ctest unit test framework
+ifeq ($(wildcard $(TEST_DIR)/ctest.c),)
+all:
+	@echo "${TARGET}: $(TEST_DIR)/ctest.c not found, test not built"
+else
+all: ${TARGET}
+endif
+ 
+${TARGET}: ${OBJS}
+	${CC} -o $@ ${OBJS} 
+
+.c.o:
+	${CC} -c ${CFLAGS} $*.c -o $@
+	
+depend:
+	rm -f .depend
+	${CC} -MM ${CFLAGS} *.c >> .depend
+	
+clean:
+	rm -rf core ${TARGET} $(OBJS) *.bak *.1 *.ini
+
+include: .depend
@@ -12,7 +12,8 @@ SRCS = rs485.c \
 	$(SRCDIR)/mstp.c \
 	$(SRCDIR)/mstptext.c \
 	$(SRCDIR)/indtext.c \
-	$(SRCDIR)/crc.c
+	$(SRCDIR)/crc.c \
+	$(SRCDIR)/fifo.c
 
 OBJS = ${SRCS:.c=.o}
 
@@ -0,0 +1,952 @@
+/*************************************************************************
+* Copyright (C) 2026 agent <agent@local>
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+*********************************************************************/
+
+/* long running version of bacrp: keeps the datalink, address cache and
+   TSM alive and serves a stream of ReadProperty requests, one per line,
+   from stdin or from a local UNIX socket.  Each request line is
+     device-instance object-type object-instance property [index]
+   and produces exactly one reply line with the value or an error.
+   With -c, Present_Value is served from a cache kept by SubscribeCOV. */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>       /* for time */
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define PRINT_ENABLED 1
+
+#include "bacdef.h"
+#include "config.h"
+#include "bactext.h"
+#include "bacerror.h"
+#include "iam.h"
+#include "arf.h"
+#include "tsm.h"
+#include "address.h"
+#include "npdu.h"
+#include "apdu.h"
+#include "device.h"
+#include "net.h"
+#include "datalink.h"
+#include "whois.h"
+#include "rp.h"
+#include "cov.h"
+#include "bacapp.h"
+/* some demo stuff needed */
+#include "filename.h"
+#include "handlers.h"
+#include "client.h"
+#include "txbuf.h"
+#include "dlenv.h"
+
+/* buffer used for receive */
+static uint8_t Rx_Buf[MAX_MPDU] = { 0 };
+
+/* the request currently being served */
+typedef enum {
+    RPD_STATE_IDLE,
+    RPD_STATE_BINDING,
+    RPD_STATE_WAITING
+} RPD_STATE;
+
+static RPD_STATE Request_State = RPD_STATE_IDLE;
+static uint32_t Target_Device_Object_Instance = BACNET_MAX_INSTANCE;
+static uint32_t Target_Object_Instance = BACNET_MAX_INSTANCE;
+static BACNET_OBJECT_TYPE Target_Object_Type = OBJECT_ANALOG_INPUT;
+static BACNET_PROPERTY_ID Target_Object_Property = PROP_ACKED_TRANSITIONS;
+static int32_t Target_Object_Index = BACNET_ARRAY_ALL;
+static uint8_t Request_Invoke_ID = 0;
+static time_t Request_Elapsed_Seconds = 0;
+/* set by the reply handlers once the reply line has been written */
+static bool Request_Done = false;
+
+/* where the requests come from and where the replies go */
+static int Input_FD = -1;
+static FILE *Output_Stream = NULL;
+/* set when a reply couldn't be written, so the client has gone */
+static bool Output_Failed = false;
+static int Listen_FD = -1;
+static char Line_Buf[256];
+static size_t Line_Len = 0;
+/* set when select() says the input (or listen socket) is readable */
+static bool Input_Ready = false;
+
+static void reply_end(
+    void)
+{
+    fprintf(Output_Stream, "\n");
+    if ((fflush(Output_Stream) != 0) || ferror(Output_Stream))
+        Output_Failed = true;
+    Request_Done = true;
+}
+
+/* With -c, Present_Value reads are answered from a cache that COV
+   notifications keep up to date.  The first read of a point polls it
+   and subscribes to it, and the subscription is renewed at half its
+   lifetime.  Points that can't be subscribed to are polled, as they
+   are without -c. */
+#ifndef MAX_COV_CACHE
+#define MAX_COV_CACHE 16384
+#endif
+/* number of hash chains */
+#ifndef COV_CACHE_HASH_SIZE
+#define COV_CACHE_HASH_SIZE 4096
+#endif
+/* our process identifier in the subscriptions */
+#define COV_CACHE_PROCESS_ID 1
+
+typedef enum {
+    COV_CACHE_STATE_UNSUBSCRIBED,
+    COV_CACHE_STATE_SUBSCRIBING,
+    COV_CACHE_STATE_SUBSCRIBED,
+    /* the device said no - polled until we ask again */
+    COV_CACHE_STATE_REFUSED
+} COV_CACHE_STATE;
+
+typedef struct cov_cache_entry {
+    uint32_t device_id;
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    COV_CACHE_STATE state;
+    uint8_t invoke_id;
+    /* when to subscribe again, and when the subscription ends */
+    time_t renew_time;
+    time_t expire_time;
+    /* string values aren't kept, so those points are polled */
+    bool value_valid;
+    BACNET_COMPACT_VALUE value;
+    /* the next entry in the same hash chain, as index + 1, or 0 */
+    uint16_t next;
+} COV_CACHE_ENTRY;
+
+static COV_CACHE_ENTRY COV_Cache[MAX_COV_CACHE];
+static unsigned COV_Cache_Count = 0;
+static uint16_t COV_Cache_Hash[COV_CACHE_HASH_SIZE];
+/* the entry waiting for each invoke ID, as index + 1, or 0 */
+static uint16_t COV_Cache_Invoke[256];
+/* subscription lifetime in seconds, or 0 for no cache */
+static uint32_t COV_Lifetime = 0;
+/* set when there is an entry to subscribe before the next second */
+static bool COV_Cache_Pending = false;
+
+static unsigned cov_cache_hash(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    uint32_t hash = 2166136261UL;
+
+    hash = (hash ^ device_id) * 16777619UL;
+    hash = (hash ^ (uint32_t) object_type) * 16777619UL;
+    hash = (hash ^ object_instance) * 16777619UL;
+
+    return hash % COV_CACHE_HASH_SIZE;
+}
+
+/* returns NULL if it is not there, and there is no room or
+   no need to add it */
+static COV_CACHE_ENTRY *cov_cache_find(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    bool add)
+{
+    COV_CACHE_ENTRY *entry = NULL;
+    unsigned hash = 0;
+    uint16_t next = 0;
+
+    hash = cov_cache_hash(device_id, object_type, object_instance);
+    next = COV_Cache_Hash[hash];
+    while (next) {
+        entry = &COV_Cache[next - 1];
+        if ((entry->device_id == device_id) &&
+            (entry->object_type == object_type) &&
+            (entry->object_instance == object_instance))
+            return entry;
+        next = entry->next;
+    }
+    if (!add || (COV_Cache_Count >= MAX_COV_CACHE))
+        return NULL;
+    entry = &COV_Cache[COV_Cache_Count];
+    memset(entry, 0, sizeof(*entry));
+    entry->device_id = device_id;
+    entry->object_type = object_type;
+    entry->object_instance = object_instance;
+    entry->state = COV_CACHE_STATE_UNSUBSCRIBED;
+    entry->next = COV_Cache_Hash[hash];
+    COV_Cache_Count++;
+    COV_Cache_Hash[hash] = (uint16_t) COV_Cache_Count;
+    COV_Cache_Pending = true;
+
+    return entry;
+}
+
+/* takes the entry off its invoke ID; NULL if none is waiting on it */
+static COV_CACHE_ENTRY *cov_cache_invoke_id(
+    uint8_t invoke_id)
+{
+    COV_CACHE_ENTRY *entry = NULL;
+
+    if (invoke_id && COV_Cache_Invoke[invoke_id]) {
+        entry = &COV_Cache[COV_Cache_Invoke[invoke_id] - 1];
+        COV_Cache_Invoke[invoke_id] = 0;
+        entry->invoke_id = 0;
+    }
+
+    return entry;
+}
+
+/* the subscription failed: the cached value can't be trusted,
+   and we ask again after a lifetime */
+static void cov_cache_refused(
+    COV_CACHE_ENTRY * entry)
+{
+    entry->state = COV_CACHE_STATE_REFUSED;
+    entry->value_valid = false;
+    entry->renew_time = time(NULL) + COV_Lifetime;
+}
+
+/* returns true and the value if the read can be answered from the cache */
+static bool cov_cache_value(
+    COV_CACHE_ENTRY * entry,
+    BACNET_APPLICATION_DATA_VALUE * value)
+{
+    if ((entry->state == COV_CACHE_STATE_SUBSCRIBED) && entry->value_valid &&
+        (time(NULL) < entry->expire_time)) {
+        return bacapp_compact_to_value(&entry->value, value);
+    }
+
+    return false;
+}
+
+static void cov_cache_update(
+    COV_CACHE_ENTRY * entry,
+    BACNET_APPLICATION_DATA_VALUE * value)
+{
+    entry->value_valid =
+        (bool) (bacapp_compact_from_value(&entry->value, value, NULL,
+            0) == 0);
+}
+
+static void cov_cache_subscribe(
+    COV_CACHE_ENTRY * entry,
+    bool cancel)
+{
+    BACNET_SUBSCRIBE_COV_DATA cov_data;
+
+    memset(&cov_data, 0, sizeof(cov_data));
+    cov_data.subscriberProcessIdentifier = COV_CACHE_PROCESS_ID;
+    cov_data.monitoredObjectIdentifier.type = entry->object_type;
+    cov_data.monitoredObjectIdentifier.instance = entry->object_instance;
+    cov_data.cancellationRequest = cancel;
+    cov_data.issueConfirmedNotifications = false;
+    cov_data.lifetime = COV_Lifetime;
+    entry->invoke_id = Send_COV_Subscribe(entry->device_id, &cov_data);
+    if (entry->invoke_id) {
+        COV_Cache_Invoke[entry->invoke_id] = (uint16_t) (entry - COV_Cache) + 1;
+    }
+}
+
+/* subscribes and renews - called every second, or sooner when
+   there is a new point */
+static void cov_cache_task(
+    void)
+{
+    COV_CACHE_ENTRY *entry = NULL;
+    BACNET_ADDRESS dest;
+    unsigned max_apdu = 0;
+    time_t now = time(NULL);
+    unsigned i = 0;
+
+    COV_Cache_Pending = false;
+    for (i = 0; i < COV_Cache_Count; i++) {
+        entry = &COV_Cache[i];
+        if (entry->state == COV_CACHE_STATE_SUBSCRIBING) {
+            if (tsm_invoke_id_failed(entry->invoke_id)) {
+                tsm_free_invoke_id(entry->invoke_id);
+                cov_cache_invoke_id(entry->invoke_id);
+                cov_cache_refused(entry);
+            }
+            continue;
+        }
+        if (now < entry->renew_time)
+            continue;
+        /* the first read of the point does the binding */
+        if (!address_bind_request(entry->device_id, &max_apdu, &dest))
+            continue;
+        if (!tsm_transaction_available())
+            break;
+        cov_cache_subscribe(entry, false);
+        if (entry->invoke_id)
+            entry->state = COV_CACHE_STATE_SUBSCRIBING;
+    }
+}
+
+/* lets the devices know we are going, as far as the TSM allows */
+static void cov_cache_cancel(
+    void)
+{
+    unsigned i = 0;
+
+    for (i = 0; i < COV_Cache_Count; i++) {
+        if (COV_Cache[i].state != COV_CACHE_STATE_SUBSCRIBED)
+            continue;
+        if (!tsm_transaction_available())
+            break;
+        cov_cache_subscribe(&COV_Cache[i], true);
+    }
+}
+
+static void MySubscribeCOVAckHandler(
+    BACNET_ADDRESS * src,
+    uint8_t invoke_id)
+{
+    COV_CACHE_ENTRY *entry = NULL;
+    time_t now = time(NULL);
+
+    (void) src;
+    entry = cov_cache_invoke_id(invoke_id);
+    if (entry && (entry->state == COV_CACHE_STATE_SUBSCRIBING)) {
+        entry->state = COV_CACHE_STATE_SUBSCRIBED;
+        entry->expire_time = now + COV_Lifetime;
+        entry->renew_time = now + (COV_Lifetime / 2);
+    }
+}
+
+static void MySubscribeCOVErrorHandler(
+    BACNET_ADDRESS * src,
+    uint8_t invoke_id,
+    BACNET_ERROR_CLASS error_class,
+    BACNET_ERROR_CODE error_code)
+{
+    COV_CACHE_ENTRY *entry = NULL;
+
+    (void) src;
+    (void) error_class;
+    (void) error_code;
+    entry = cov_cache_invoke_id(invoke_id);
+    if (entry)
+        cov_cache_refused(entry);
+}
+
+static void MyUnconfirmedCOVNotificationHandler(
+    uint8_t * service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS * src)
+{
+    BACNET_COV_DATA cov_data;
+    BACNET_PROPERTY_VALUE property_value[4];
+    BACNET_PROPERTY_VALUE *value = NULL;
+    COV_CACHE_ENTRY *entry = NULL;
+    unsigned i = 0;
+
+    (void) src;
+    /* values past the end of a short list are left zeroed */
+    memset(property_value, 0, sizeof(property_value));
+    for (i = 1; i < 4; i++) {
+        property_value[i - 1].next = &property_value[i];
+    }
+    cov_data.listOfValues = &property_value[0];
+    if (cov_notify_decode_service_request(service_request, service_len,
+            &cov_data) <= 0)
+        return;
+    if (cov_data.subscriberProcessIdentifier != COV_CACHE_PROCESS_ID)
+        return;
+    entry =
+        cov_cache_find(cov_data.initiatingDeviceIdentifier,
+        (BACNET_OBJECT_TYPE) cov_data.monitoredObjectIdentifier.type,
+        cov_data.monitoredObjectIdentifier.instance, false);
+    if (!entry)
+        return;
+    for (value = cov_data.listOfValues; value; value = value->next) {
+        if ((value->propertyIdentifier == PROP_PRESENT_VALUE) &&
+            (value->propertyArrayIndex == BACNET_ARRAY_ALL)) {
+            cov_cache_update(entry, &value->value);
+        }
+    }
+}
+
+static void MyErrorHandler(
+    BACNET_ADDRESS * src,
+    uint8_t invoke_id,
+    BACNET_ERROR_CLASS error_class,
+    BACNET_ERROR_CODE error_code)
+{
+    (void) src;
+    if ((Request_State != RPD_STATE_WAITING) ||
+        (invoke_id != Request_Invoke_ID))
+        return;
+    fprintf(Output_Stream, "BACnet Error: %s: %s",
+        bactext_error_class_name((int) error_class),
+        bactext_error_code_name((int) error_code));
+    reply_end();
+}
+
+static void MyAbortHandler(
+    BACNET_ADDRESS * src,
+    uint8_t invoke_id,
+    uint8_t abort_reason,
+    bool server)
+{
+    COV_CACHE_ENTRY *entry = NULL;
+
+    (void) src;
+    (void) server;
+    entry = cov_cache_invoke_id(invoke_id);
+    if (entry) {
+        /* the device can't take the subscription - poll it */
+        cov_cache_refused(entry);
+        return;
+    }
+    if ((Request_State != RPD_STATE_WAITING) ||
+        (invoke_id != Request_Invoke_ID))
+        return;
+    fprintf(Output_Stream, "BACnet Abort: %s",
+        bactext_abort_reason_name((int) abort_reason));
+    reply_end();
+}
+
+static void MyRejectHandler(
+    BACNET_ADDRESS * src,
+    uint8_t invoke_id,
+    uint8_t reject_reason)
+{
+    COV_CACHE_ENTRY *entry = NULL;
+
+    (void) src;
+    entry = cov_cache_invoke_id(invoke_id);
+    if (entry) {
+        cov_cache_refused(entry);
+        return;
+    }
+    if ((Request_State != RPD_STATE_WAITING) ||
+        (invoke_id != Request_Invoke_ID))
+        return;
+    fprintf(Output_Stream, "BACnet Reject: %s",
+        bactext_reject_reason_name((int) reject_reason));
+    reply_end();
+}
+
+/* prints the value(s) on a single line, using braces for lists */
+static void MyReadPropertyAckHandler(
+    uint8_t * service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS * src,
+    BACNET_CONFIRMED_SERVICE_ACK_DATA * service_data)
+{
+    BACNET_READ_PROPERTY_DATA data;
+    BACNET_APPLICATION_DATA_VALUE value;
+    uint8_t *application_data;
+    int application_data_len;
+    int len = 0;
+    bool print_brace = false;
+    COV_CACHE_ENTRY *entry = NULL;
+
+    (void) src;
+    if ((Request_State != RPD_STATE_WAITING) ||
+        (service_data->invoke_id != Request_Invoke_ID))
+        return;
+    len = rp_ack_decode_service_request(service_request, service_len, &data);
+    if (len <= 0) {
+        fprintf(Output_Stream, "Error: Invalid ReadProperty Ack!");
+        reply_end();
+        return;
+    }
+    application_data = data.application_data;
+    application_data_len = data.application_data_len;
+    for (;;) {
+        len =
+            bacapp_decode_application_data(application_data,
+            application_data_len, &value);
+        if (!print_brace && (len > 0) && (len < application_data_len)) {
+            fprintf(Output_Stream, "{");
+            print_brace = true;
+        }
+        bacapp_print_value(Output_Stream, &value, data.object_property);
+        if ((len > 0) && (len < application_data_len)) {
+            application_data += len;
+            application_data_len -= len;
+            fprintf(Output_Stream, ",");
+        } else
+            break;
+    }
+    if (print_brace)
+        fprintf(Output_Stream, "}");
+    reply_end();
+    /* a single Present_Value also refreshes the cache */
+    if (!print_brace && (len > 0) &&
+        (data.object_property == PROP_PRESENT_VALUE) &&
+        (data.array_index == BACNET_ARRAY_ALL)) {
+        entry =
+            cov_cache_find(Target_Device_Object_Instance, data.object_type,
+            data.object_instance, false);
+        if (entry) {
+            cov_cache_update(entry, &value);
+        }
+    }
+}
+
+static void Init_Service_Handlers(
+    void)
+{
+    Device_Init();
+    handler_read_property_object_set(OBJECT_DEVICE,
+        Device_Encode_Property_APDU, Device_Valid_Object_Instance_Number);
+    /* we need to handle who-is
+       to support dynamic device binding to us */
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_WHO_IS, handler_who_is);
+    /* handle i-am to support binding to other devices */
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_I_AM, handler_i_am_bind);
+    /* set the handler for all the services we don't implement
+       It is required to send the proper reject message... */
+    apdu_set_unrecognized_service_handler_handler
+        (handler_unrecognized_service);
+    /* we must implement read property - it's required! */
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_READ_PROPERTY,
+        handler_read_property);
+    /* handle the data coming back from confirmed requests */
+    apdu_set_confirmed_ack_handler(SERVICE_CONFIRMED_READ_PROPERTY,
+        MyReadPropertyAckHandler);
+    /* handle any errors coming back */
+    apdu_set_error_handler(SERVICE_CONFIRMED_READ_PROPERTY, MyErrorHandler);
+    apdu_set_abort_handler(MyAbortHandler);
+    apdu_set_reject_handler(MyRejectHandler);
+    /* keep the cache */
+    apdu_set_confirmed_simple_ack_handler(SERVICE_CONFIRMED_SUBSCRIBE_COV,
+        MySubscribeCOVAckHandler);
+    apdu_set_error_handler(SERVICE_CONFIRMED_SUBSCRIBE_COV,
+        MySubscribeCOVErrorHandler);
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_COV_NOTIFICATION,
+        MyUnconfirmedCOVNotificationHandler);
+}
+
+/* decodes and validates a request line; returns false and writes
+   the reply line if the request is not valid */
+static bool request_parse(
+    char *line)
+{
+    long values[5] = { 0 };
+    char *pEnd = NULL;
+    int count = 0;
+
+    while (count < 5) {
+        values[count] = strtol(line, &pEnd, 0);
+        if (pEnd == line)
+            break;
+        line = pEnd;
+        count++;
+    }
+    if (count < 4) {
+        fprintf(Output_Stream,
+            "Error: expected device-instance object-type "
+            "object-instance property [index]");
+        reply_end();
+        return false;
+    }
+    if ((values[0] < 0) || (values[0] > BACNET_MAX_INSTANCE)) {
+        fprintf(Output_Stream,
+            "Error: device-instance=%ld - it must be less than %u",
+            values[0], BACNET_MAX_INSTANCE);
+        reply_end();
+        return false;
+    }
+    if ((values[1] < 0) || (values[1] > MAX_BACNET_OBJECT_TYPE)) {
+        fprintf(Output_Stream,
+            "Error: object-type=%ld - it must be less than %u", values[1],
+            MAX_BACNET_OBJECT_TYPE + 1);
+        reply_end();
+        return false;
+    }
+    if ((values[2] < 0) || (values[2] > BACNET_MAX_INSTANCE)) {
+        fprintf(Output_Stream,
+            "Error: object-instance=%ld - it must be less than %u",
+            values[2], BACNET_MAX_INSTANCE + 1);
+        reply_end();
+        return false;
+    }
+    if ((values[3] < 0) || (values[3] > MAX_BACNET_PROPERTY_ID)) {
+        fprintf(Output_Stream,
+            "Error: property=%ld - it must be less than %u", values[3],
+            MAX_BACNET_PROPERTY_ID + 1);
+        reply_end();
+        return false;
+    }
+    Target_Device_Object_Instance = (uint32_t) values[0];
+    Target_Object_Type = (BACNET_OBJECT_TYPE) values[1];
+    Target_Object_Instance = (uint32_t) values[2];
+    Target_Object_Property = (BACNET_PROPERTY_ID) values[3];
+    if (count > 4)
+        Target_Object_Index = (int32_t) values[4];
+    else
+        Target_Object_Index = BACNET_ARRAY_ALL;
+
+    return true;
+}
+
+/* starts serving one request line */
+static void request_start(
+    char *line)
+{
+    BACNET_ADDRESS dest;
+    unsigned max_apdu = 0;
+    COV_CACHE_ENTRY *entry = NULL;
+    BACNET_APPLICATION_DATA_VALUE value;
+
+    Request_Done = false;
+    Request_Invoke_ID = 0;
+    Request_Elapsed_Seconds = 0;
+    if (!request_parse(line)) {
+        Request_State = RPD_STATE_IDLE;
+        return;
+    }
+    if (COV_Lifetime && (Target_Object_Property == PROP_PRESENT_VALUE) &&
+        (Target_Object_Index == BACNET_ARRAY_ALL)) {
+        entry =
+            cov_cache_find(Target_Device_Object_Instance, Target_Object_Type,
+            Target_Object_Instance, true);
+        if (entry && cov_cache_value(entry, &value)) {
+            bacapp_print_value(Output_Stream, &value, PROP_PRESENT_VALUE);
+            reply_end();
+            Request_State = RPD_STATE_IDLE;
+            return;
+        }
+    }
+    Request_State = RPD_STATE_BINDING;
+    if (!address_bind_request(Target_Device_Object_Instance, &max_apdu,
+            &dest)) {
+        Send_WhoIs(Target_Device_Object_Instance,
+            Target_Device_Object_Instance);
+    }
+}
+
+/* advances the current request; called once per loop */
+static void request_task(
+    time_t elapsed_seconds)
+{
+    BACNET_ADDRESS dest;
+    unsigned max_apdu = 0;
+    time_t timeout_seconds = 0;
+
+    timeout_seconds = (apdu_timeout() / 1000) * apdu_retries();
+    if (Request_State == RPD_STATE_BINDING) {
+        if (address_bind_request(Target_Device_Object_Instance, &max_apdu,
+                &dest)) {
+            Request_Invoke_ID =
+                Send_Read_Property_Request(Target_Device_Object_Instance,
+                Target_Object_Type, Target_Object_Instance,
+                Target_Object_Property, Target_Object_Index);
+            if (Request_Invoke_ID) {
+                Request_State = RPD_STATE_WAITING;
+            }
+            /* else no TSM slot free yet - try again next loop */
+        } else {
+            Request_Elapsed_Seconds += elapsed_seconds;
+            if (Request_Elapsed_Seconds > timeout_seconds) {
+                fprintf(Output_Stream, "Error: APDU Timeout!");
+                reply_end();
+            }
+        }
+    } else if (Request_State == RPD_STATE_WAITING) {
+        if (Request_Done || tsm_invoke_id_free(Request_Invoke_ID)) {
+            if (!Request_Done) {
+                /* completed without a reply we recognized */
+                fprintf(Output_Stream, "Error: No Reply!");
+                reply_end();
+            }
+        } else if (tsm_invoke_id_failed(Request_Invoke_ID)) {
+            tsm_free_invoke_id(Request_Invoke_ID);
+            fprintf(Output_Stream, "Error: TSM Timeout!");
+            reply_end();
+        }
+    }
+    if (Request_Done) {
+        Request_State = RPD_STATE_IDLE;
+        Request_Invoke_ID = 0;
+    }
+}
+
+/* returns a pointer to the next complete line from the input,
+   or NULL if there isn't one yet.  Sets *closed at end of input. */
+static char *input_line(
+    bool * closed)
+{
+    static char line[sizeof(Line_Buf)];
+    ssize_t count = 0;
+    size_t i = 0;
+
+    for (;;) {
+        for (i = 0; i < Line_Len; i++) {
+            if (Line_Buf[i] == '\n') {
+                memcpy(line, Line_Buf, i);
+                line[i] = 0;
+                if ((i > 0) && (line[i - 1] == '\r'))
+                    line[i - 1] = 0;
+                Line_Len -= (i + 1);
+                memmove(Line_Buf, &Line_Buf[i + 1], Line_Len);
+                return line;
+            }
+        }
+        if (Line_Len == sizeof(Line_Buf)) {
+            /* too long to be a request - drop it */
+            Line_Len = 0;
+        }
+        if (*closed || !Input_Ready)
+            return NULL;
+        Input_Ready = false;
+        count =
+            read(Input_FD, &Line_Buf[Line_Len],
+            sizeof(Line_Buf) - Line_Len);
+        if (count <= 0) {
+            if ((count < 0) && (errno == EINTR))
+                continue;
+            *closed = true;
+            if (Line_Len) {
+                /* last line without a newline */
+                memcpy(line, Line_Buf, Line_Len);
+                line[Line_Len] = 0;
+                Line_Len = 0;
+                return line;
+            }
+            return NULL;
+        }
+        Line_Len += (size_t) count;
+    }
+}
+
+static int unix_socket_listen(
+    const char *path)
+{
+    struct sockaddr_un addr;
+    int sock_fd = -1;
+
+    sock_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock_fd < 0)
+        return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    unlink(path);
+    if ((bind(sock_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) ||
+        (listen(sock_fd, 1) < 0)) {
+        close(sock_fd);
+        return -1;
+    }
+
+    return sock_fd;
+}
+
+/* waits for a packet or a request line, whichever comes first.
+   returns true if the datalink has a packet waiting, and sets
+   Input_Ready if the input can be read without blocking. */
+static bool wait_for_input(
+    unsigned timeout)
+{
+    fd_set read_fds;
+    struct timeval select_timeout;
+    int max = bip_socket();
+    int wait_fd = -1;
+    /* datagrams already taken from the socket don't wake select */
+    bool pending = bip_receive_pending();
+
+    if (pending)
+        timeout = 0;
+    FD_ZERO(&read_fds);
+    FD_SET(bip_socket(), &read_fds);
+    /* only look at the input while we are idle */
+    if (Request_State == RPD_STATE_IDLE) {
+        if (Input_FD >= 0)
+            wait_fd = Input_FD;
+        else
+            wait_fd = Listen_FD;
+    }
+    if (wait_fd >= 0) {
+        FD_SET(wait_fd, &read_fds);
+        if (wait_fd > max)
+            max = wait_fd;
+    }
+    select_timeout.tv_sec = timeout / 1000;
+    select_timeout.tv_usec = 1000 * (timeout % 1000);
+    if (select(max + 1, &read_fds, NULL, NULL, &select_timeout) <= 0)
+        return pending;
+    if ((wait_fd >= 0) && FD_ISSET(wait_fd, &read_fds))
+        Input_Ready = true;
+
+    return pending || FD_ISSET(bip_socket(), &read_fds);
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    BACNET_ADDRESS src = {
+        0
+    };  /* address where message came from */
+    uint16_t pdu_len = 0;
+    uint8_t *npdu = NULL;
+    unsigned timeout = 100;     /* milliseconds */
+    time_t last_seconds = 0;
+    time_t current_seconds = 0;
+    const char *socket_path = NULL;
+    char *line = NULL;
+    bool closed = false;
+    int argi = 0;
+
+    if ((argc > 1) && (strcmp(argv[1], "--help") == 0)) {
+        printf("Usage: %s [-s socket-path] [-c lifetime]\r\n"
+            "Reads requests, one per line, from stdin or from clients of\r\n"
+            "the UNIX socket at socket-path, and writes one reply line\r\n"
+            "per request.  A request line is:\r\n"
+            "device-instance object-type object-instance property [index]\r\n"
+            "using the same values as bacrp.  The datalink, address\r\n"
+            "cache and TSM are kept between requests, so only the first\r\n"
+            "request to each device needs to bind with Who-Is.\r\n"
+            "Set BACNET_ADDRESS_CACHE_FILE to keep the bindings between\r\n"
+            "runs, and BACNET_ADDRESS_CACHE_SAVE_INTERVAL to also save\r\n"
+            "them every so many seconds.\r\n"
+            "With -c, the first Present_Value read of each object also\r\n"
+            "subscribes to its changes (SubscribeCOV) for lifetime\r\n"
+            "seconds, renewed at half that, and later reads are answered\r\n"
+            "from the notifications without asking the device.\r\n"
+            "Send 'quit' or close stdin to exit.\r\n",
+            filename_remove_path(argv[0]));
+        return 0;
+    }
+    for (argi = 1; argi < argc; argi++) {
+        if ((strcmp(argv[argi], "-s") == 0) && (argi + 1 < argc)) {
+            socket_path = argv[++argi];
+        } else if ((strcmp(argv[argi], "-c") == 0) && (argi + 1 < argc)) {
+            COV_Lifetime = strtoul(argv[++argi], NULL, 0);
+        }
+    }
+
+    /* a client that goes away in the middle of a reply makes the
+       write fail, instead of killing the daemon */
+    signal(SIGPIPE, SIG_IGN);
+    /* setup my info */
+    Device_Set_Object_Instance_Number(BACNET_MAX_INSTANCE);
+    address_init();
+    Init_Service_Handlers();
+    dlenv_init();
+    if (socket_path) {
+        Listen_FD = unix_socket_listen(socket_path);
+        if (Listen_FD < 0) {
+            fprintf(stderr, "Unable to listen on %s: %s\r\n", socket_path,
+                strerror(errno));
+            return 1;
+        }
+    } else {
+        Input_FD = STDIN_FILENO;
+        Output_Stream = stdout;
+    }
+    last_seconds = time(NULL);
+    /* loop until the input is closed */
+    for (;;) {
+        current_seconds = time(NULL);
+        /* at least one second has passed */
+        if (current_seconds != last_seconds) {
+            tsm_timer_milliseconds(((current_seconds - last_seconds) * 1000));
+            address_cache_timer((uint16_t) (current_seconds - last_seconds));
+            dlenv_maintenance_timer((uint16_t) (current_seconds -
+                    last_seconds));
+        }
+        if (COV_Lifetime && ((current_seconds != last_seconds) ||
+                COV_Cache_Pending)) {
+            cov_cache_task();
+        }
+        if (Request_State == RPD_STATE_IDLE) {
+            if (Input_FD < 0) {
+                /* wait for the next client */
+                if (Input_Ready) {
+                    Input_Ready = false;
+                    Input_FD = accept(Listen_FD, NULL, NULL);
+                    if (Input_FD >= 0) {
+                        Output_Stream = fdopen(dup(Input_FD), "w");
+                        Line_Len = 0;
+                        closed = false;
+                        Output_Failed = (Output_Stream == NULL);
+                    }
+                }
+            } else {
+                if (Output_Failed) {
+                    /* the rest of its requests can't be answered */
+                    closed = true;
+                    Line_Len = 0;
+                }
+                line = input_line(&closed);
+                if (line) {
+                    if (strcmp(line, "quit") == 0) {
+                        break;
+                    }
+                    if (line[0] && (line[0] != ';')) {
+                        request_start(line);
+                    }
+                } else if (closed) {
+                    if (Listen_FD < 0)
+                        break;
+                    /* client went away; wait for the next one */
+                    if (Output_Stream)
+                        fclose(Output_Stream);
+                    Output_Stream = NULL;
+                    close(Input_FD);
+                    Input_FD = -1;
+                }
+            }
+        }
+        request_task(current_seconds - last_seconds);
+        /* don't sleep if there is another request already buffered */
+        if ((Request_State == RPD_STATE_IDLE) && memchr(Line_Buf, '\n',
+                Line_Len)) {
+            timeout = 0;
+        } else {
+            timeout = 100;
+        }
+        if (wait_for_input(timeout)) {
+            pdu_len =
+                datalink_receive_in_place(&src, &Rx_Buf[0], MAX_MPDU, 0,
+                &npdu);
+            /* process */
+            if (pdu_len) {
+                npdu_handler(&src, npdu, pdu_len);
+            }
+            request_task(0);
+        }
+        /* keep track of time for next check */
+        last_seconds = current_seconds;
+    }
+    if (Listen_FD >= 0) {
+        close(Listen_FD);
+        unlink(socket_path);
+    }
+    cov_cache_cancel();
+    datalink_cleanup();
+
+    return 0;
+}
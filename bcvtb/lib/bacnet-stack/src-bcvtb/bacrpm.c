@@ -0,0 +1,831 @@
+/*************************************************************************
+* Copyright (C) 2026 agent <agent@local>
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+*********************************************************************/
+
+/* command line tool that reads a list of points using as few
+   ReadPropertyMultiple requests as will fit in each device's max APDU,
+   and prints one line per point in the order of the point list */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>       /* for time */
+
+#define PRINT_ENABLED 1
+
+#include "bacdef.h"
+#include "config.h"
+#include "bactext.h"
+#include "bacerror.h"
+#include "bacdcode.h"
+#include "iam.h"
+#include "tsm.h"
+#include "address.h"
+#include "npdu.h"
+#include "apdu.h"
+#include "device.h"
+#include "net.h"
+#include "datalink.h"
+#include "whois.h"
+#include "rpm.h"
+/* some demo stuff needed */
+#include "filename.h"
+#include "handlers.h"
+#include "client.h"
+#include "txbuf.h"
+#include "dlenv.h"
+#include "pipeline.h"
+
+/* guess at the encoded size of one property value in the reply.
+   Replies that turn out to be bigger than the peer can take are
+   aborted by the peer and the request is split and sent again. */
+#ifndef RPM_VALUE_ESTIMATE
+#define RPM_VALUE_ESTIMATE 16
+#endif
+
+/* buffer used for receive */
+static uint8_t Rx_Buf[MAX_MPDU] = { 0 };
+
+typedef enum {
+    POINT_PENDING,
+    POINT_VALUE,
+    POINT_ACCESS_ERROR,
+    POINT_ERROR,
+    POINT_ABORT,
+    POINT_REJECT,
+    POINT_TSM_TIMEOUT,
+    POINT_APDU_TIMEOUT,
+    POINT_SEND_FAILED
+} POINT_STATUS;
+
+typedef struct rpm_point {
+    uint32_t device_id;
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    BACNET_PROPERTY_ID object_property;
+    int32_t array_index;
+    POINT_STATUS status;
+    /* error class or abort/reject reason */
+    unsigned reason;
+    BACNET_ERROR_CODE error_code;
+    /* copy of the encoded property value from the ack */
+    uint8_t *value;
+    unsigned value_len;
+} RPM_POINT;
+
+/* a run of points in Point_Order that go in one request */
+typedef struct rpm_batch {
+    unsigned first;
+    unsigned count;
+    /* the request, kept until it completes */
+    BACNET_READ_ACCESS_DATA *read_access;
+    BACNET_PROPERTY_REFERENCE *property;
+} RPM_BATCH;
+
+typedef struct rpm_device {
+    uint32_t device_id;
+    unsigned max_apdu;
+    bool bound;
+} RPM_DEVICE;
+
+static RPM_POINT *Points = NULL;
+static unsigned Point_Count = 0;
+/* indexes into Points, sorted by device and object */
+static unsigned *Point_Order = NULL;
+static RPM_DEVICE *Devices = NULL;
+static unsigned Device_Count = 0;
+
+static void batch_set_status(
+    RPM_BATCH * batch,
+    POINT_STATUS status,
+    unsigned reason,
+    BACNET_ERROR_CODE error_code)
+{
+    unsigned i;
+    RPM_POINT *point;
+
+    for (i = 0; i < batch->count; i++) {
+        point = &Points[Point_Order[batch->first + i]];
+        if (point->status == POINT_PENDING) {
+            point->status = status;
+            point->reason = reason;
+            point->error_code = error_code;
+        }
+    }
+}
+
+/* returns the length of the property value up to the closing tag 4,
+   or -1 if it is malformed */
+static int rpm_ack_value_length(
+    uint8_t * apdu,
+    unsigned apdu_len)
+{
+    unsigned len = 0;
+    unsigned depth = 0;
+    int tag_len = 0;
+    uint8_t tag_number = 0;
+    uint32_t len_value_type = 0;
+
+    while (len < apdu_len) {
+        tag_len =
+            decode_tag_number_and_value_safe(&apdu[len], apdu_len - len,
+            &tag_number, &len_value_type);
+        if (tag_len <= 0)
+            return -1;
+        if (decode_is_opening_tag(&apdu[len])) {
+            depth++;
+        } else if (decode_is_closing_tag(&apdu[len])) {
+            if (depth == 0)
+                return (tag_number == 4) ? (int) len : -1;
+            depth--;
+        } else if (IS_CONTEXT_SPECIFIC(apdu[len]) ||
+            (tag_number != BACNET_APPLICATION_TAG_BOOLEAN)) {
+            /* application booleans carry the value in the tag */
+            if (len_value_type > (apdu_len - len - tag_len))
+                return -1;
+            tag_len += len_value_type;
+        }
+        len += tag_len;
+    }
+
+    return -1;
+}
+
+/* decodes the error class and code of a property access error and
+   the closing tag after them, or returns -1 if they don't fit */
+static int rpm_ack_decode_error(
+    uint8_t * apdu,
+    unsigned apdu_len,
+    uint32_t * error_class,
+    uint32_t * error_code)
+{
+    unsigned len = 0;
+    int tag_len = 0;
+    uint8_t tag_number = 0;
+    uint32_t len_value_type = 0;
+    uint32_t *error_value[2];
+    unsigned i = 0;
+
+    error_value[0] = error_class;
+    error_value[1] = error_code;
+    for (i = 0; i < 2; i++) {
+        if (len >= apdu_len)
+            return -1;
+        tag_len =
+            decode_tag_number_and_value_safe(&apdu[len], apdu_len - len,
+            &tag_number, &len_value_type);
+        if ((tag_len <= 0) || IS_CONTEXT_SPECIFIC(apdu[len]) ||
+            (tag_number != BACNET_APPLICATION_TAG_ENUMERATED) ||
+            (len_value_type > 4) ||
+            ((len + tag_len + len_value_type) > apdu_len))
+            return -1;
+        len += tag_len;
+        len += decode_enumerated(&apdu[len], len_value_type, error_value[i]);
+    }
+    if ((decode_tag_number_and_value_safe(&apdu[len], apdu_len - len,
+                &tag_number, &len_value_type) <= 0) ||
+        !decode_is_closing_tag(&apdu[len]) || (tag_number != 5))
+        return -1;
+
+    return (int) len + 1;
+}
+
+/* the results come back in the same order as they were requested */
+static void batch_ack_decode(
+    RPM_BATCH * batch,
+    uint8_t * service_request,
+    uint16_t service_len)
+{
+    uint8_t *apdu = service_request;
+    unsigned apdu_len = service_len;
+    unsigned index = 0;
+    int len = 0;
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance = 0;
+    BACNET_PROPERTY_ID object_property;
+    int32_t array_index = 0;
+    uint32_t error_class = 0;
+    uint32_t error_code = 0;
+    RPM_POINT *point = NULL;
+
+    while ((apdu_len > 0) && (index < batch->count)) {
+        len =
+            rpm_ack_decode_object_id(apdu, apdu_len, &object_type,
+            &object_instance);
+        if (len <= 0)
+            break;
+        apdu += len;
+        apdu_len -= len;
+        while ((apdu_len > 0) && (index < batch->count)) {
+            len = rpm_ack_decode_object_end(apdu, apdu_len);
+            if (len > 0) {
+                apdu += len;
+                apdu_len -= len;
+                break;
+            }
+            len =
+                rpm_ack_decode_object_property(apdu, apdu_len,
+                &object_property, &array_index);
+            if (len <= 0)
+                break;
+            apdu += len;
+            apdu_len -= len;
+            point = &Points[Point_Order[batch->first + index]];
+            if ((point->object_type != object_type) ||
+                (point->object_instance != object_instance) ||
+                (point->object_property != object_property) ||
+                (point->array_index != array_index)) {
+                /* not what we asked for */
+                apdu_len = 0;
+                break;
+            }
+            index++;
+            if (apdu_len && decode_is_opening_tag_number(apdu, 4)) {
+                apdu++;
+                apdu_len--;
+                len = rpm_ack_value_length(apdu, apdu_len);
+                if (len < 0) {
+                    apdu_len = 0;
+                    break;
+                }
+                point->value = malloc(len ? len : 1);
+                if (point->value) {
+                    memcpy(point->value, apdu, len);
+                    point->value_len = len;
+                    point->status = POINT_VALUE;
+                }
+                /* value and closing tag */
+                apdu += len + 1;
+                apdu_len -= len + 1;
+            } else if (apdu_len && decode_is_opening_tag_number(apdu, 5)) {
+                apdu++;
+                apdu_len--;
+                len =
+                    rpm_ack_decode_error(apdu, apdu_len, &error_class,
+                    &error_code);
+                if (len < 0) {
+                    apdu_len = 0;
+                    break;
+                }
+                point->reason = error_class;
+                point->error_code = (BACNET_ERROR_CODE) error_code;
+                point->status = POINT_ACCESS_ERROR;
+                /* error and closing tag */
+                apdu += len;
+                apdu_len -= len;
+            } else {
+                apdu_len = 0;
+                break;
+            }
+        }
+    }
+}
+
+static void batch_free(
+    RPM_BATCH * batch)
+{
+    free(batch->read_access);
+    free(batch->property);
+    free(batch);
+}
+
+static void batch_complete(
+    PIPELINE_RESULT * result,
+    void *context);
+
+/* queues a request for a run of points of one device */
+static void batch_queue(
+    unsigned first,
+    unsigned count)
+{
+    RPM_BATCH *batch = NULL;
+    RPM_POINT *point = NULL;
+    RPM_POINT *previous = NULL;
+    BACNET_READ_ACCESS_DATA *object = NULL;
+    unsigned objects = 0;
+    unsigned i = 0;
+
+    batch = calloc(1, sizeof(RPM_BATCH));
+    if (batch) {
+        batch->first = first;
+        batch->count = count;
+        batch->read_access = calloc(count, sizeof(BACNET_READ_ACCESS_DATA));
+        batch->property = calloc(count, sizeof(BACNET_PROPERTY_REFERENCE));
+    }
+    if (!batch || !batch->read_access || !batch->property) {
+        for (i = 0; i < count; i++) {
+            point = &Points[Point_Order[first + i]];
+            if (point->status == POINT_PENDING)
+                point->status = POINT_SEND_FAILED;
+        }
+        if (batch)
+            batch_free(batch);
+        return;
+    }
+    for (i = 0; i < count; i++) {
+        point = &Points[Point_Order[first + i]];
+        if (!previous || (previous->object_type != point->object_type) ||
+            (previous->object_instance != point->object_instance)) {
+            if (object)
+                object->next = &batch->read_access[objects];
+            object = &batch->read_access[objects++];
+            object->object_type = point->object_type;
+            object->object_instance = point->object_instance;
+            object->listOfProperties = &batch->property[i];
+        } else {
+            batch->property[i - 1].next = &batch->property[i];
+        }
+        batch->property[i].propertyIdentifier = point->object_property;
+        batch->property[i].propertyArrayIndex = point->array_index;
+        previous = point;
+    }
+    if (!pipeline_read_property_multiple(point->device_id,
+            batch->read_access, batch_complete, batch)) {
+        batch_set_status(batch, POINT_SEND_FAILED, 0, ERROR_CODE_OTHER);
+        batch_free(batch);
+    }
+}
+
+static void batch_complete(
+    PIPELINE_RESULT * result,
+    void *context)
+{
+    RPM_BATCH *batch = (RPM_BATCH *) context;
+    unsigned half = 0;
+
+    switch (result->status) {
+        case PIPELINE_STATUS_ACK:
+            batch_ack_decode(batch, result->service_request,
+                result->service_len);
+            /* anything not in the ack is an error */
+            batch_set_status(batch, POINT_REJECT, REJECT_REASON_INVALID_TAG,
+                ERROR_CODE_OTHER);
+            break;
+        case PIPELINE_STATUS_ERROR:
+            batch_set_status(batch, POINT_ERROR, result->error_class,
+                result->error_code);
+            break;
+        case PIPELINE_STATUS_ABORT:
+            if (((result->reason == ABORT_REASON_SEGMENTATION_NOT_SUPPORTED)
+                    || (result->reason == ABORT_REASON_BUFFER_OVERFLOW)) &&
+                (batch->count > 1)) {
+                /* the reply didn't fit - ask for half as much twice */
+                half = batch->count / 2;
+                batch_queue(batch->first, half);
+                batch_queue(batch->first + half, batch->count - half);
+            } else {
+                batch_set_status(batch, POINT_ABORT, result->reason,
+                    ERROR_CODE_OTHER);
+            }
+            break;
+        case PIPELINE_STATUS_REJECT:
+            batch_set_status(batch, POINT_REJECT, result->reason,
+                ERROR_CODE_OTHER);
+            break;
+        case PIPELINE_STATUS_TIMEOUT:
+            batch_set_status(batch, POINT_TSM_TIMEOUT, 0, ERROR_CODE_OTHER);
+            break;
+        case PIPELINE_STATUS_NOT_BOUND:
+            batch_set_status(batch, POINT_APDU_TIMEOUT, 0, ERROR_CODE_OTHER);
+            break;
+        default:
+            batch_set_status(batch, POINT_SEND_FAILED, 0, ERROR_CODE_OTHER);
+            break;
+    }
+    batch_free(batch);
+}
+
+static void Init_Service_Handlers(
+    void)
+{
+    Device_Init();
+    handler_read_property_object_set(OBJECT_DEVICE,
+        Device_Encode_Property_APDU, Device_Valid_Object_Instance_Number);
+    /* we need to handle who-is
+       to support dynamic device binding to us */
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_WHO_IS, handler_who_is);
+    /* handle i-am to support binding to other devices */
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_I_AM, handler_i_am_bind);
+    /* set the handler for all the services we don't implement
+       It is required to send the proper reject message... */
+    apdu_set_unrecognized_service_handler_handler
+        (handler_unrecognized_service);
+    /* we must implement read property - it's required! */
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_READ_PROPERTY,
+        handler_read_property);
+    /* the replies to our requests go to the pipeline */
+    pipeline_init();
+}
+
+/* File format - one point per line, ';' starts a comment:
+device-instance object-type object-instance property [index]
+123 0 1 85
+123 1 101 87 3
+*/
+static bool point_list_load(
+    const char *filename)
+{
+    FILE *pFile = NULL;
+    char line[256] = { "" };
+    long values[5] = { 0 };
+    char *pLine = NULL;
+    char *pEnd = NULL;
+    int count = 0;
+    unsigned line_number = 0;
+    unsigned size = 0;
+    RPM_POINT *point = NULL;
+
+    if (strcmp(filename, "-") == 0)
+        pFile = stdin;
+    else
+        pFile = fopen(filename, "r");
+    if (!pFile) {
+        fprintf(stderr, "Unable to open %s: %s\r\n", filename,
+            strerror(errno));
+        return false;
+    }
+    while (fgets(line, (int) sizeof(line), pFile) != NULL) {
+        line_number++;
+        if (line[0] == ';')
+            continue;
+        pLine = line;
+        for (count = 0; count < 5; count++) {
+            values[count] = strtol(pLine, &pEnd, 0);
+            if (pEnd == pLine)
+                break;
+            pLine = pEnd;
+        }
+        if (count == 0)
+            continue;
+        if ((count < 4) || (values[0] < 0) ||
+            (values[0] > BACNET_MAX_INSTANCE) || (values[1] < 0) ||
+            (values[1] > MAX_BACNET_OBJECT_TYPE) || (values[2] < 0) ||
+            (values[2] > BACNET_MAX_INSTANCE) || (values[3] < 0) ||
+            (values[3] > MAX_BACNET_PROPERTY_ID)) {
+            fprintf(stderr, "%s:%u: invalid point\r\n", filename,
+                line_number);
+            continue;
+        }
+        if (Point_Count == size) {
+            size = size ? size * 2 : 64;
+            point = realloc(Points, size * sizeof(RPM_POINT));
+            if (!point)
+                break;
+            Points = point;
+        }
+        point = &Points[Point_Count++];
+        memset(point, 0, sizeof(RPM_POINT));
+        point->device_id = (uint32_t) values[0];
+        point->object_type = (BACNET_OBJECT_TYPE) values[1];
+        point->object_instance = (uint32_t) values[2];
+        point->object_property = (BACNET_PROPERTY_ID) values[3];
+        if (count > 4)
+            point->array_index = (int32_t) values[4];
+        else
+            point->array_index = BACNET_ARRAY_ALL;
+        point->status = POINT_PENDING;
+    }
+    if (pFile != stdin)
+        fclose(pFile);
+
+    return (Point_Count > 0);
+}
+
+static int point_order_compare(
+    const void *a,
+    const void *b)
+{
+    const RPM_POINT *pa = &Points[*(const unsigned *) a];
+    const RPM_POINT *pb = &Points[*(const unsigned *) b];
+
+    if (pa->device_id != pb->device_id)
+        return (pa->device_id < pb->device_id) ? -1 : 1;
+    if (pa->object_type != pb->object_type)
+        return (pa->object_type < pb->object_type) ? -1 : 1;
+    if (pa->object_instance != pb->object_instance)
+        return (pa->object_instance < pb->object_instance) ? -1 : 1;
+    /* keep the file order for the properties of an object */
+    if (*(const unsigned *) a != *(const unsigned *) b)
+        return (*(const unsigned *) a < *(const unsigned *) b) ? -1 : 1;
+
+    return 0;
+}
+
+static RPM_DEVICE *device_find(
+    uint32_t device_id)
+{
+    unsigned i;
+
+    for (i = 0; i < Device_Count; i++) {
+        if (Devices[i].device_id == device_id)
+            return &Devices[i];
+    }
+
+    return NULL;
+}
+
+/* encoded size of an unsigned or enumerated value with its tag */
+static unsigned encoded_unsigned_size(
+    uint32_t value)
+{
+    if (value < 0x100)
+        return 2;
+    else if (value < 0x10000)
+        return 3;
+    else if (value < 0x1000000)
+        return 4;
+
+    return 5;
+}
+
+/* splits the points of one device into batches that fit the request
+   and an estimate of the reply into max_apdu */
+static void device_batches_build(
+    RPM_DEVICE * device)
+{
+    unsigned i = 0;
+    unsigned first = 0;
+    unsigned count = 0;
+    unsigned request_len = 0;
+    unsigned reply_len = 0;
+    unsigned object_len = 0;
+    unsigned property_len = 0;
+    unsigned max_apdu = 0;
+    RPM_POINT *point = NULL;
+    RPM_POINT *previous = NULL;
+
+    max_apdu = device->max_apdu;
+    if ((max_apdu == 0) || (max_apdu > MAX_APDU))
+        max_apdu = MAX_APDU;
+    for (i = 0; i < Point_Count; i++) {
+        point = &Points[Point_Order[i]];
+        if (point->device_id != device->device_id) {
+            if (count)
+                break;
+            continue;
+        }
+        if (count == 0)
+            first = i;
+        /* object id, opening and closing tags */
+        object_len = 0;
+        if (!previous || (previous->object_type != point->object_type) ||
+            (previous->object_instance != point->object_instance))
+            object_len = 5 + 2;
+        property_len = encoded_unsigned_size(point->object_property);
+        if (point->array_index != BACNET_ARRAY_ALL)
+            property_len += encoded_unsigned_size(point->array_index);
+        if (count && ((request_len + object_len + property_len > max_apdu) ||
+                (reply_len + object_len + property_len + 2 +
+                    RPM_VALUE_ESTIMATE > max_apdu))) {
+            batch_queue(first, count);
+            first = i;
+            count = 0;
+            previous = NULL;
+            object_len = 5 + 2;
+        }
+        if (count == 0) {
+            /* confirmed request and complex ack headers */
+            request_len = 4;
+            reply_len = 3;
+        }
+        request_len += object_len + property_len;
+        reply_len += object_len + property_len + 2 + RPM_VALUE_ESTIMATE;
+        previous = point;
+        count++;
+    }
+    if (count)
+        batch_queue(first, count);
+}
+
+static void point_print(
+    RPM_POINT * point)
+{
+    BACNET_APPLICATION_DATA_VALUE value;
+    uint8_t *application_data = point->value;
+    int application_data_len = point->value_len;
+    int len = 0;
+    bool print_brace = false;
+
+    switch (point->status) {
+        case POINT_VALUE:
+            if (application_data_len <= 0) {
+                /* an empty list */
+                fprintf(stdout, "{}");
+            }
+            while (application_data_len > 0) {
+                if (IS_CONTEXT_SPECIFIC(*application_data)) {
+                    len =
+                        bacapp_decode_context_data(application_data,
+                        application_data_len, &value, point->object_property);
+                } else {
+                    len =
+                        bacapp_decode_application_data(application_data,
+                        application_data_len, &value);
+                }
+                if (!print_brace && (len > 0) && (len < application_data_len)) {
+                    fprintf(stdout, "{");
+                    print_brace = true;
+                }
+                bacapp_print_value(stdout, &value, point->object_property);
+                if ((len > 0) && (len < application_data_len)) {
+                    application_data += len;
+                    application_data_len -= len;
+                    fprintf(stdout, ",");
+                } else
+                    break;
+            }
+            if (print_brace)
+                fprintf(stdout, "}");
+            break;
+        case POINT_ACCESS_ERROR:
+        case POINT_ERROR:
+            fprintf(stdout, "BACnet Error: %s: %s",
+                bactext_error_class_name((int) point->reason),
+                bactext_error_code_name((int) point->error_code));
+            break;
+        case POINT_ABORT:
+            fprintf(stdout, "BACnet Abort: %s",
+                bactext_abort_reason_name((int) point->reason));
+            break;
+        case POINT_REJECT:
+            fprintf(stdout, "BACnet Reject: %s",
+                bactext_reject_reason_name((int) point->reason));
+            break;
+        case POINT_TSM_TIMEOUT:
+            fprintf(stdout, "Error: TSM Timeout!");
+            break;
+        case POINT_APDU_TIMEOUT:
+            fprintf(stdout, "Error: APDU Timeout!");
+            break;
+        case POINT_SEND_FAILED:
+        default:
+            fprintf(stdout, "Error: Unable to send request!");
+            break;
+    }
+    fprintf(stdout, "\r\n");
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    BACNET_ADDRESS src = {
+        0
+    };  /* address where message came from */
+    BACNET_ADDRESS dest;
+    uint16_t pdu_len = 0;
+    uint8_t *npdu = NULL;
+    unsigned timeout = 100;     /* milliseconds */
+    time_t elapsed_seconds = 0;
+    time_t last_seconds = 0;
+    time_t current_seconds = 0;
+    time_t timeout_seconds = 0;
+    unsigned bound_count = 0;
+    unsigned i = 0;
+    bool error = false;
+    RPM_DEVICE *device = NULL;
+
+    if ((argc < 2) || (strcmp(argv[1], "--help") == 0)) {
+        printf("Usage: %s point-list-file\r\n",
+            filename_remove_path(argv[0]));
+        if ((argc > 1) && (strcmp(argv[1], "--help") == 0)) {
+            printf("point-list-file:\r\n"
+                "File with one point per line, or - for stdin, as:\r\n"
+                "device-instance object-type object-instance property "
+                "[index]\r\n"
+                "using the same values as bacrp.  Lines starting with ;\r\n"
+                "are comments.  The points of each device are read with\r\n"
+                "as few ReadPropertyMultiple requests as will fit in the\r\n"
+                "device's max APDU, with several requests in flight to\r\n"
+                "each device at once, and one line is printed per point\r\n"
+                "in the order of the file.\r\n");
+        }
+        return 0;
+    }
+    if (!point_list_load(argv[1])) {
+        return 1;
+    }
+    Point_Order = calloc(Point_Count, sizeof(unsigned));
+    Devices = calloc(Point_Count, sizeof(RPM_DEVICE));
+    if (!Point_Order || !Devices) {
+        fprintf(stderr, "Out of memory!\r\n");
+        return 1;
+    }
+    for (i = 0; i < Point_Count; i++) {
+        Point_Order[i] = i;
+        if (!device_find(Points[i].device_id)) {
+            Devices[Device_Count++].device_id = Points[i].device_id;
+        }
+    }
+    qsort(Point_Order, Point_Count, sizeof(unsigned), point_order_compare);
+
+    /* setup my info */
+    Device_Set_Object_Instance_Number(BACNET_MAX_INSTANCE);
+    address_init();
+    Init_Service_Handlers();
+    dlenv_init();
+    /* configure the timeout values */
+    last_seconds = time(NULL);
+    timeout_seconds = (apdu_timeout() / 1000) * apdu_retries();
+    /* try to bind with the devices */
+    for (i = 0; i < Device_Count; i++) {
+        device = &Devices[i];
+        device->bound =
+            address_bind_request(device->device_id, &device->max_apdu,
+            &dest);
+        if (device->bound) {
+            device_batches_build(device);
+            bound_count++;
+        } else {
+            Send_WhoIs(device->device_id, device->device_id);
+        }
+    }
+    /* loop until every point has a result */
+    for (;;) {
+        /* increment timer - exit if timed out */
+        current_seconds = time(NULL);
+
+        /* at least one second has passed */
+        if (current_seconds != last_seconds) {
+            tsm_timer_milliseconds(((current_seconds - last_seconds) * 1000));
+            pipeline_timer_milliseconds(((current_seconds -
+                        last_seconds) * 1000));
+        }
+        /* wait until the devices are bound, or timeout */
+        if (bound_count < Device_Count) {
+            for (i = 0; i < Device_Count; i++) {
+                device = &Devices[i];
+                if (device->bound)
+                    continue;
+                device->bound =
+                    address_bind_request(device->device_id,
+                    &device->max_apdu, &dest);
+                if (device->bound) {
+                    device_batches_build(device);
+                    bound_count++;
+                }
+            }
+            elapsed_seconds += (current_seconds - last_seconds);
+            if (elapsed_seconds > timeout_seconds) {
+                for (i = 0; i < Point_Count; i++) {
+                    device = device_find(Points[i].device_id);
+                    if (!device->bound &&
+                        (Points[i].status == POINT_PENDING)) {
+                        Points[i].status = POINT_APDU_TIMEOUT;
+                    }
+                }
+                bound_count = Device_Count;
+            }
+        }
+        /* keep the requests to all the devices in flight */
+        pipeline_task();
+        if ((bound_count == Device_Count) && (pipeline_count() == 0))
+            break;
+
+        /* returns 0 bytes on timeout */
+        pdu_len =
+            datalink_receive_in_place(&src, &Rx_Buf[0], MAX_MPDU, timeout,
+            &npdu);
+
+        /* process */
+        if (pdu_len) {
+            npdu_handler(&src, npdu, pdu_len);
+        }
+
+        /* keep track of time for next check */
+        last_seconds = current_seconds;
+    }
+    for (i = 0; i < Point_Count; i++) {
+        point_print(&Points[i]);
+        if (Points[i].status != POINT_VALUE)
+            error = true;
+        free(Points[i].value);
+    }
+    datalink_cleanup();
+
+    if (error)
+        return 1;
+    return 0;
+}
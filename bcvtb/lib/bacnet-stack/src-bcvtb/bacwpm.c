@@ -0,0 +1,741 @@
+/*************************************************************************
+* Copyright (C) 2026 agent <agent@local>
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+*********************************************************************/
+
+/* command line tool that writes a list of values using one
+   WritePropertyMultiple request per device, or as few as will fit in
+   each device's max APDU, and prints one line per value in the order
+   of the value list */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>       /* for time */
+
+#define PRINT_ENABLED 1
+
+#include "bacdef.h"
+#include "config.h"
+#include "bactext.h"
+#include "bacerror.h"
+#include "bacdcode.h"
+#include "iam.h"
+#include "tsm.h"
+#include "address.h"
+#include "npdu.h"
+#include "apdu.h"
+#include "device.h"
+#include "net.h"
+#include "datalink.h"
+#include "whois.h"
+#include "wpm.h"
+/* some demo stuff needed */
+#include "filename.h"
+#include "handlers.h"
+#include "client.h"
+#include "txbuf.h"
+#include "dlenv.h"
+#include "pipeline.h"
+
+/* the send functions count the NPDU header against the max APDU,
+   so leave room for the largest one */
+#ifndef WPM_NPDU_SIZE
+#define WPM_NPDU_SIZE 21
+#endif
+
+/* buffer used for receive */
+static uint8_t Rx_Buf[MAX_MPDU] = { 0 };
+
+typedef enum {
+    ROW_PENDING,
+    ROW_WRITTEN,
+    ROW_ERROR,
+    ROW_ABORT,
+    ROW_REJECT,
+    ROW_TSM_TIMEOUT,
+    ROW_APDU_TIMEOUT,
+    ROW_SEND_FAILED
+} ROW_STATUS;
+
+typedef struct wpm_row {
+    uint32_t device_id;
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    BACNET_PROPERTY_ID object_property;
+    int32_t array_index;
+    uint8_t priority;
+    BACNET_APPLICATION_DATA_VALUE value;
+    /* encoded size of the value */
+    unsigned value_len;
+    ROW_STATUS status;
+    /* error class or abort/reject reason */
+    unsigned reason;
+    BACNET_ERROR_CODE error_code;
+} WPM_ROW;
+
+/* a run of rows in Row_Order that go in one request */
+typedef struct wpm_batch {
+    unsigned first;
+    unsigned count;
+    /* the request, kept until it completes */
+    BACNET_WRITE_ACCESS_DATA *write_access;
+    BACNET_PROPERTY_VALUE *property;
+} WPM_BATCH;
+
+typedef struct wpm_device {
+    uint32_t device_id;
+    unsigned max_apdu;
+    bool bound;
+} WPM_DEVICE;
+
+static WPM_ROW *Rows = NULL;
+static unsigned Row_Count = 0;
+/* indexes into Rows, sorted by device */
+static unsigned *Row_Order = NULL;
+static WPM_DEVICE *Devices = NULL;
+static unsigned Device_Count = 0;
+
+static void row_set_status(
+    WPM_ROW * row,
+    ROW_STATUS status,
+    unsigned reason,
+    BACNET_ERROR_CODE error_code)
+{
+    if (row->status == ROW_PENDING) {
+        row->status = status;
+        row->reason = reason;
+        row->error_code = error_code;
+    }
+}
+
+static void batch_set_status(
+    WPM_BATCH * batch,
+    ROW_STATUS status,
+    unsigned reason,
+    BACNET_ERROR_CODE error_code)
+{
+    unsigned i;
+
+    for (i = 0; i < batch->count; i++) {
+        row_set_status(&Rows[Row_Order[batch->first + i]], status, reason,
+            error_code);
+    }
+}
+
+static void row_status_from_result(
+    WPM_ROW * row,
+    PIPELINE_RESULT * result)
+{
+    switch (result->status) {
+        case PIPELINE_STATUS_SIMPLE_ACK:
+            row_set_status(row, ROW_WRITTEN, 0, ERROR_CODE_OTHER);
+            break;
+        case PIPELINE_STATUS_ERROR:
+            row_set_status(row, ROW_ERROR, result->error_class,
+                result->error_code);
+            break;
+        case PIPELINE_STATUS_ABORT:
+            row_set_status(row, ROW_ABORT, result->reason, ERROR_CODE_OTHER);
+            break;
+        case PIPELINE_STATUS_REJECT:
+            row_set_status(row, ROW_REJECT, result->reason, ERROR_CODE_OTHER);
+            break;
+        case PIPELINE_STATUS_TIMEOUT:
+            row_set_status(row, ROW_TSM_TIMEOUT, 0, ERROR_CODE_OTHER);
+            break;
+        case PIPELINE_STATUS_NOT_BOUND:
+            row_set_status(row, ROW_APDU_TIMEOUT, 0, ERROR_CODE_OTHER);
+            break;
+        default:
+            row_set_status(row, ROW_SEND_FAILED, 0, ERROR_CODE_OTHER);
+            break;
+    }
+}
+
+/* WriteProperty, for devices that don't do WritePropertyMultiple */
+static uint8_t row_write_send(
+    uint32_t device_id,
+    void *context)
+{
+    WPM_ROW *row = (WPM_ROW *) context;
+
+    return Send_Write_Property_Request(device_id, row->object_type,
+        row->object_instance, row->object_property, &row->value,
+        row->priority, row->array_index);
+}
+
+static void row_write_complete(
+    PIPELINE_RESULT * result,
+    void *context)
+{
+    row_status_from_result((WPM_ROW *) context, result);
+}
+
+static void batch_free(
+    WPM_BATCH * batch)
+{
+    free(batch->write_access);
+    free(batch->property);
+    free(batch);
+}
+
+static void batch_complete(
+    PIPELINE_RESULT * result,
+    void *context);
+
+/* queues a request for a run of rows of one device */
+static void batch_queue(
+    unsigned first,
+    unsigned count)
+{
+    WPM_BATCH *batch = NULL;
+    WPM_ROW *row = NULL;
+    WPM_ROW *previous = NULL;
+    BACNET_WRITE_ACCESS_DATA *object = NULL;
+    BACNET_PROPERTY_VALUE *property = NULL;
+    unsigned objects = 0;
+    unsigned i = 0;
+
+    batch = calloc(1, sizeof(WPM_BATCH));
+    if (batch) {
+        batch->first = first;
+        batch->count = count;
+        batch->write_access =
+            calloc(count, sizeof(BACNET_WRITE_ACCESS_DATA));
+        batch->property = calloc(count, sizeof(BACNET_PROPERTY_VALUE));
+    }
+    if (!batch || !batch->write_access || !batch->property) {
+        for (i = 0; i < count; i++) {
+            row_set_status(&Rows[Row_Order[first + i]], ROW_SEND_FAILED, 0,
+                ERROR_CODE_OTHER);
+        }
+        if (batch)
+            batch_free(batch);
+        return;
+    }
+    /* the rows of an object that follow each other share its entry,
+       so the writes are done in the order of the file */
+    for (i = 0; i < count; i++) {
+        row = &Rows[Row_Order[first + i]];
+        property = &batch->property[i];
+        if (!previous || (previous->object_type != row->object_type) ||
+            (previous->object_instance != row->object_instance)) {
+            if (object)
+                object->next = &batch->write_access[objects];
+            object = &batch->write_access[objects++];
+            object->object_type = row->object_type;
+            object->object_instance = row->object_instance;
+            object->listOfProperties = property;
+        } else {
+            batch->property[i - 1].next = property;
+        }
+        property->propertyIdentifier = row->object_property;
+        property->propertyArrayIndex = row->array_index;
+        property->value = row->value;
+        property->priority = row->priority;
+        previous = row;
+    }
+    if (!pipeline_write_property_multiple(row->device_id,
+            batch->write_access, batch_complete, batch)) {
+        batch_set_status(batch, ROW_SEND_FAILED, 0, ERROR_CODE_OTHER);
+        batch_free(batch);
+    }
+}
+
+/* returns the index in the batch of the row of the failed write,
+   or the batch count if none of them is */
+static unsigned batch_row_failed(
+    WPM_BATCH * batch,
+    BACNET_WRITE_PROPERTY_DATA * wpdata)
+{
+    WPM_ROW *row = NULL;
+    unsigned i = 0;
+
+    for (i = 0; i < batch->count; i++) {
+        row = &Rows[Row_Order[batch->first + i]];
+        if ((row->object_type == wpdata->object_type) &&
+            (row->object_instance == wpdata->object_instance) &&
+            (row->object_property == wpdata->object_property) &&
+            (row->array_index == wpdata->array_index))
+            break;
+    }
+
+    return i;
+}
+
+static void batch_complete(
+    PIPELINE_RESULT * result,
+    void *context)
+{
+    WPM_BATCH *batch = (WPM_BATCH *) context;
+    WPM_ROW *row = NULL;
+    unsigned half = 0;
+    unsigned failed = 0;
+    unsigned i = 0;
+
+    if ((result->status == PIPELINE_STATUS_REJECT) &&
+        (result->reason == REJECT_REASON_UNRECOGNIZED_SERVICE)) {
+        /* write them one at a time instead */
+        for (i = 0; i < batch->count; i++) {
+            row = &Rows[Row_Order[batch->first + i]];
+            if (!pipeline_send(row->device_id, row_write_send,
+                    row_write_complete, row)) {
+                row_set_status(row, ROW_SEND_FAILED, 0, ERROR_CODE_OTHER);
+            }
+        }
+    } else if ((batch->count > 1) &&
+        (result->status == PIPELINE_STATUS_ABORT) &&
+        ((result->reason == ABORT_REASON_SEGMENTATION_NOT_SUPPORTED) ||
+            (result->reason == ABORT_REASON_BUFFER_OVERFLOW))) {
+        /* the request didn't fit, and nothing was written -
+           send half as much twice */
+        half = batch->count / 2;
+        batch_queue(batch->first, half);
+        batch_queue(batch->first + half, batch->count - half);
+    } else if ((result->status == PIPELINE_STATUS_ERROR) &&
+        result->first_failed &&
+        ((failed = batch_row_failed(batch, result->first_failed)) <
+            batch->count)) {
+        /* the writes are done in order up to the one that failed, so
+           only the ones after it are sent again */
+        for (i = 0; i < failed; i++) {
+            row_set_status(&Rows[Row_Order[batch->first + i]], ROW_WRITTEN,
+                0, ERROR_CODE_OTHER);
+        }
+        row_status_from_result(&Rows[Row_Order[batch->first + failed]],
+            result);
+        if ((failed + 1) < batch->count) {
+            batch_queue(batch->first + failed + 1,
+                batch->count - failed - 1);
+        }
+    } else {
+        for (i = 0; i < batch->count; i++) {
+            row_status_from_result(&Rows[Row_Order[batch->first + i]],
+                result);
+        }
+    }
+    batch_free(batch);
+}
+
+static void Init_Service_Handlers(
+    void)
+{
+    Device_Init();
+    handler_read_property_object_set(OBJECT_DEVICE,
+        Device_Encode_Property_APDU, Device_Valid_Object_Instance_Number);
+    /* we need to handle who-is
+       to support dynamic device binding to us */
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_WHO_IS, handler_who_is);
+    /* handle i-am to support binding to other devices */
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_I_AM, handler_i_am_bind);
+    /* set the handler for all the services we don't implement
+       It is required to send the proper reject message... */
+    apdu_set_unrecognized_service_handler_handler
+        (handler_unrecognized_service);
+    /* we must implement read property - it's required! */
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_READ_PROPERTY,
+        handler_read_property);
+    /* the replies to our requests go to the pipeline */
+    pipeline_init();
+}
+
+/* File format - one value per line, ';' starts a comment:
+device-instance object-type object-instance property priority index tag value
+123 2 0 85 8 -1 4 42.5
+123 1 2 85 0 -1 0 null
+The value is the rest of the line, so character strings can have spaces.
+*/
+static bool row_list_load(
+    const char *filename)
+{
+    FILE *pFile = NULL;
+    char line[MAX_APDU] = { "" };
+    long values[7] = { 0 };
+    char *pLine = NULL;
+    char *pEnd = NULL;
+    int count = 0;
+    unsigned line_number = 0;
+    unsigned size = 0;
+    size_t len = 0;
+    uint8_t apdu[MAX_APDU];
+    WPM_ROW *row = NULL;
+
+    if (strcmp(filename, "-") == 0)
+        pFile = stdin;
+    else
+        pFile = fopen(filename, "r");
+    if (!pFile) {
+        fprintf(stderr, "Unable to open %s: %s\r\n", filename,
+            strerror(errno));
+        return false;
+    }
+    while (fgets(line, (int) sizeof(line), pFile) != NULL) {
+        line_number++;
+        if (line[0] == ';')
+            continue;
+        pLine = line;
+        for (count = 0; count < 7; count++) {
+            values[count] = strtol(pLine, &pEnd, 0);
+            if (pEnd == pLine)
+                break;
+            pLine = pEnd;
+        }
+        if (count == 0)
+            continue;
+        /* the value is the rest of the line */
+        while (isspace((unsigned char) *pLine))
+            pLine++;
+        len = strlen(pLine);
+        while (len && isspace((unsigned char) pLine[len - 1]))
+            pLine[--len] = 0;
+        if ((count < 7) || (len == 0) || (values[0] < 0) ||
+            (values[0] > BACNET_MAX_INSTANCE) || (values[1] < 0) ||
+            (values[1] > MAX_BACNET_OBJECT_TYPE) || (values[2] < 0) ||
+            (values[2] > BACNET_MAX_INSTANCE) || (values[3] < 0) ||
+            (values[3] > MAX_BACNET_PROPERTY_ID) || (values[4] < 0) ||
+            (values[4] > BACNET_MAX_PRIORITY) || (values[5] < -1) ||
+            (values[6] < 0) || (values[6] >= MAX_BACNET_APPLICATION_TAG)) {
+            fprintf(stderr, "%s:%u: invalid value\r\n", filename,
+                line_number);
+            continue;
+        }
+        if (Row_Count == size) {
+            size = size ? size * 2 : 64;
+            row = realloc(Rows, size * sizeof(WPM_ROW));
+            if (!row)
+                break;
+            Rows = row;
+        }
+        row = &Rows[Row_Count];
+        memset(row, 0, sizeof(WPM_ROW));
+        if (!bacapp_parse_application_data((BACNET_APPLICATION_TAG)
+                values[6], pLine, &row->value)) {
+            fprintf(stderr, "%s:%u: unable to parse the tag value\r\n",
+                filename, line_number);
+            continue;
+        }
+        row->value.next = NULL;
+        row->value_len = bacapp_encode_application_data(&apdu[0], &row->value);
+        row->device_id = (uint32_t) values[0];
+        row->object_type = (BACNET_OBJECT_TYPE) values[1];
+        row->object_instance = (uint32_t) values[2];
+        row->object_property = (BACNET_PROPERTY_ID) values[3];
+        row->priority = (uint8_t) values[4];
+        if (values[5] == -1)
+            row->array_index = BACNET_ARRAY_ALL;
+        else
+            row->array_index = (int32_t) values[5];
+        row->status = ROW_PENDING;
+        Row_Count++;
+    }
+    if (pFile != stdin)
+        fclose(pFile);
+
+    return (Row_Count > 0);
+}
+
+static int row_order_compare(
+    const void *a,
+    const void *b)
+{
+    const WPM_ROW *pa = &Rows[*(const unsigned *) a];
+    const WPM_ROW *pb = &Rows[*(const unsigned *) b];
+
+    if (pa->device_id != pb->device_id)
+        return (pa->device_id < pb->device_id) ? -1 : 1;
+    /* keep the file order for the writes to a device */
+    if (*(const unsigned *) a != *(const unsigned *) b)
+        return (*(const unsigned *) a < *(const unsigned *) b) ? -1 : 1;
+
+    return 0;
+}
+
+static WPM_DEVICE *device_find(
+    uint32_t device_id)
+{
+    unsigned i;
+
+    for (i = 0; i < Device_Count; i++) {
+        if (Devices[i].device_id == device_id)
+            return &Devices[i];
+    }
+
+    return NULL;
+}
+
+/* encoded size of an unsigned or enumerated value with its tag */
+static unsigned encoded_unsigned_size(
+    uint32_t value)
+{
+    if (value < 0x100)
+        return 2;
+    else if (value < 0x10000)
+        return 3;
+    else if (value < 0x1000000)
+        return 4;
+
+    return 5;
+}
+
+/* sends the rows of one device in one request,
+   or splits them into requests that fit into max_apdu */
+static void device_batches_build(
+    WPM_DEVICE * device)
+{
+    unsigned i = 0;
+    unsigned first = 0;
+    unsigned count = 0;
+    unsigned request_len = 0;
+    unsigned object_len = 0;
+    unsigned property_len = 0;
+    unsigned max_apdu = 0;
+    WPM_ROW *row = NULL;
+    WPM_ROW *previous = NULL;
+
+    max_apdu = device->max_apdu;
+    if ((max_apdu == 0) || (max_apdu > MAX_APDU))
+        max_apdu = MAX_APDU;
+    if (max_apdu > WPM_NPDU_SIZE)
+        max_apdu -= WPM_NPDU_SIZE;
+    for (i = 0; i < Row_Count; i++) {
+        row = &Rows[Row_Order[i]];
+        if (row->device_id != device->device_id) {
+            if (count)
+                break;
+            continue;
+        }
+        if (count == 0)
+            first = i;
+        /* object id, opening and closing tags */
+        object_len = 0;
+        if (!previous || (previous->object_type != row->object_type) ||
+            (previous->object_instance != row->object_instance))
+            object_len = 5 + 2;
+        /* property, value with its tags, and priority */
+        property_len = encoded_unsigned_size(row->object_property);
+        if (row->array_index != BACNET_ARRAY_ALL)
+            property_len += encoded_unsigned_size(row->array_index);
+        property_len += 2 + row->value_len;
+        if (row->priority != BACNET_NO_PRIORITY)
+            property_len += 2;
+        if (count && (request_len + object_len + property_len > max_apdu)) {
+            batch_queue(first, count);
+            first = i;
+            count = 0;
+            previous = NULL;
+            object_len = 5 + 2;
+        }
+        if (count == 0) {
+            /* confirmed request header */
+            request_len = 4;
+        }
+        request_len += object_len + property_len;
+        previous = row;
+        count++;
+    }
+    if (count)
+        batch_queue(first, count);
+}
+
+static void row_print(
+    WPM_ROW * row)
+{
+    switch (row->status) {
+        case ROW_WRITTEN:
+            fprintf(stdout, "WriteProperty Acknowledged!");
+            break;
+        case ROW_ERROR:
+            fprintf(stdout, "BACnet Error: %s: %s",
+                bactext_error_class_name((int) row->reason),
+                bactext_error_code_name((int) row->error_code));
+            break;
+        case ROW_ABORT:
+            fprintf(stdout, "BACnet Abort: %s",
+                bactext_abort_reason_name((int) row->reason));
+            break;
+        case ROW_REJECT:
+            fprintf(stdout, "BACnet Reject: %s",
+                bactext_reject_reason_name((int) row->reason));
+            break;
+        case ROW_TSM_TIMEOUT:
+            fprintf(stdout, "Error: TSM Timeout!");
+            break;
+        case ROW_APDU_TIMEOUT:
+            fprintf(stdout, "Error: APDU Timeout!");
+            break;
+        case ROW_SEND_FAILED:
+        default:
+            fprintf(stdout, "Error: Unable to send request!");
+            break;
+    }
+    fprintf(stdout, "\r\n");
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    BACNET_ADDRESS src = {
+        0
+    };  /* address where message came from */
+    BACNET_ADDRESS dest;
+    uint16_t pdu_len = 0;
+    uint8_t *npdu = NULL;
+    unsigned timeout = 100;     /* milliseconds */
+    time_t elapsed_seconds = 0;
+    time_t last_seconds = 0;
+    time_t current_seconds = 0;
+    time_t timeout_seconds = 0;
+    unsigned bound_count = 0;
+    unsigned i = 0;
+    bool error = false;
+    WPM_DEVICE *device = NULL;
+
+    if ((argc < 2) || (strcmp(argv[1], "--help") == 0)) {
+        printf("Usage: %s value-list-file\r\n",
+            filename_remove_path(argv[0]));
+        if ((argc > 1) && (strcmp(argv[1], "--help") == 0)) {
+            printf("value-list-file:\r\n"
+                "File with one value per line, or - for stdin, as:\r\n"
+                "device-instance object-type object-instance property "
+                "priority index tag value\r\n"
+                "using the same values as bacwp, with one tag and value.\r\n"
+                "Lines starting with ; are comments.  The values of each\r\n"
+                "device are written with one WritePropertyMultiple\r\n"
+                "request, or as few as will fit in the device's max APDU,\r\n"
+                "in the order of the file, and one line is printed per\r\n"
+                "value in the order of the file.  Devices that don't\r\n"
+                "support WritePropertyMultiple are written one value at\r\n"
+                "a time with WriteProperty.\r\n");
+        }
+        return 0;
+    }
+    if (!row_list_load(argv[1])) {
+        return 1;
+    }
+    Row_Order = calloc(Row_Count, sizeof(unsigned));
+    Devices = calloc(Row_Count, sizeof(WPM_DEVICE));
+    if (!Row_Order || !Devices) {
+        fprintf(stderr, "Out of memory!\r\n");
+        return 1;
+    }
+    for (i = 0; i < Row_Count; i++) {
+        Row_Order[i] = i;
+        if (!device_find(Rows[i].device_id)) {
+            Devices[Device_Count++].device_id = Rows[i].device_id;
+        }
+    }
+    qsort(Row_Order, Row_Count, sizeof(unsigned), row_order_compare);
+
+    /* setup my info */
+    Device_Set_Object_Instance_Number(BACNET_MAX_INSTANCE);
+    address_init();
+    Init_Service_Handlers();
+    /* one request in flight to a device keeps the writes in order */
+    pipeline_window_default_set(1);
+    dlenv_init();
+    /* configure the timeout values */
+    last_seconds = time(NULL);
+    timeout_seconds = (apdu_timeout() / 1000) * apdu_retries();
+    /* try to bind with the devices */
+    for (i = 0; i < Device_Count; i++) {
+        device = &Devices[i];
+        device->bound =
+            address_bind_request(device->device_id, &device->max_apdu,
+            &dest);
+        if (device->bound) {
+            device_batches_build(device);
+            bound_count++;
+        } else {
+            Send_WhoIs(device->device_id, device->device_id);
+        }
+    }
+    /* loop until every row has a result */
+    for (;;) {
+        /* increment timer - exit if timed out */
+        current_seconds = time(NULL);
+
+        /* at least one second has passed */
+        if (current_seconds != last_seconds) {
+            tsm_timer_milliseconds(((current_seconds - last_seconds) * 1000));
+            pipeline_timer_milliseconds(((current_seconds -
+                        last_seconds) * 1000));
+        }
+        /* wait until the devices are bound, or timeout */
+        if (bound_count < Device_Count) {
+            for (i = 0; i < Device_Count; i++) {
+                device = &Devices[i];
+                if (device->bound)
+                    continue;
+                device->bound =
+                    address_bind_request(device->device_id,
+                    &device->max_apdu, &dest);
+                if (device->bound) {
+                    device_batches_build(device);
+                    bound_count++;
+                }
+            }
+            elapsed_seconds += (current_seconds - last_seconds);
+            if (elapsed_seconds > timeout_seconds) {
+                for (i = 0; i < Row_Count; i++) {
+                    device = device_find(Rows[i].device_id);
+                    if (!device->bound) {
+                        row_set_status(&Rows[i], ROW_APDU_TIMEOUT, 0,
+                            ERROR_CODE_OTHER);
+                    }
+                }
+                bound_count = Device_Count;
+            }
+        }
+        /* keep the requests to all the devices in flight */
+        pipeline_task();
+        if ((bound_count == Device_Count) && (pipeline_count() == 0))
+            break;
+
+        /* returns 0 bytes on timeout */
+        pdu_len =
+            datalink_receive_in_place(&src, &Rx_Buf[0], MAX_MPDU, timeout,
+            &npdu);
+
+        /* process */
+        if (pdu_len) {
+            npdu_handler(&src, npdu, pdu_len);
+        }
+
+        /* keep track of time for next check */
+        last_seconds = current_seconds;
+    }
+    for (i = 0; i < Row_Count; i++) {
+        row_print(&Rows[i]);
+        if (Rows[i].status != ROW_WRITTEN)
+            error = true;
+    }
+    datalink_cleanup();
+
+    if (error)
+        return 1;
+    return 0;
+}
@@ -36,6 +36,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "config.h"
 #include "bacaddr.h"
 #include "address.h"
@@ -46,12 +47,35 @@
 /* occurs in BACnet.  A device id is bound to a MAC address. */
 /* The normal method is using Who-Is, and using the data from I-Am */
 
+/* The cache can hold more than 255 entries - see MAX_ADDRESS_CACHE.
+   Entries are found through two hash tables, one by device id and
+   one by address, and the entries that can expire are kept in two
+   heaps ordered by expiry time: one for bound entries and one for
+   outstanding bind requests. */
+#if (MAX_ADDRESS_CACHE > 65535)
+#error MAX_ADDRESS_CACHE must be 65535 or less
+#endif
+
+/* number of hash chains for each index */
+#ifndef ADDRESS_CACHE_HASH_SIZE
+#define ADDRESS_CACHE_HASH_SIZE MAX_ADDRESS_CACHE
+#endif
+
+/* links between entries are the index + 1, 0 is none */
+typedef uint16_t ADDRESS_LINK;
+
 static struct Address_Cache_Entry {
     uint8_t Flags;
     uint32_t device_id;
     unsigned max_apdu;
     BACNET_ADDRESS address;
+    /* the cache time, in seconds, when the entry expires */
     uint32_t TimeToLive;
+    /* next entry in the same device id or address hash chain */
+    ADDRESS_LINK Device_Next;
+    ADDRESS_LINK Address_Next;
+    /* position + 1 in its expiry heap */
+    ADDRESS_LINK Heap_Position;
 } Address_Cache[MAX_ADDRESS_CACHE];
 
 /* State flags for cache entries */
@@ -69,6 +93,326 @@ static struct Address_Cache_Entry {
 #define BAC_ADDR_SHORT_TIME BAC_ADDR_SECS_1HOUR
 #define BAC_ADDR_FOREVER    0xFFFFFFFF  /* Permenant entry */
 
+struct Address_Cache_Heap {
+    ADDRESS_LINK Entry[MAX_ADDRESS_CACHE];
+    unsigned Count;
+};
+
+static ADDRESS_LINK Device_Hash[ADDRESS_CACHE_HASH_SIZE];
+static ADDRESS_LINK Address_Hash[ADDRESS_CACHE_HASH_SIZE];
+/* bound entries that are not static */
+static struct Address_Cache_Heap Bound_Heap;
+/* entries waiting for an I-Am */
+static struct Address_Cache_Heap Bind_Request_Heap;
+/* free entries below Address_Cache_Never_Used, lowest on top */
+static ADDRESS_LINK Address_Cache_Free[MAX_ADDRESS_CACHE];
+static unsigned Address_Cache_Free_Count = 0;
+static unsigned Address_Cache_Never_Used = 0;
+static unsigned Address_Cache_Bound_Count = 0;
+/* seconds counted by address_cache_timer */
+static uint32_t Address_Cache_Clock = 0;
+
+static unsigned address_device_hash(
+    uint32_t device_id)
+{
+    return device_id % ADDRESS_CACHE_HASH_SIZE;
+}
+
+/* covers the same fields as bacnet_address_same() */
+static unsigned address_mac_hash(
+    BACNET_ADDRESS * src)
+{
+    uint32_t hash = 2166136261UL;
+    uint8_t max_len = 0;
+    uint8_t i = 0;
+
+    max_len = src->mac_len;
+    if (max_len > MAX_MAC_LEN)
+        max_len = MAX_MAC_LEN;
+    for (i = 0; i < max_len; i++) {
+        hash = (hash ^ src->mac[i]) * 16777619UL;
+    }
+    hash = (hash ^ (src->net & 0xFF)) * 16777619UL;
+    hash = (hash ^ (src->net >> 8)) * 16777619UL;
+    max_len = src->len;
+    if (max_len > MAX_MAC_LEN)
+        max_len = MAX_MAC_LEN;
+    for (i = 0; i < max_len; i++) {
+        hash = (hash ^ src->adr[i]) * 16777619UL;
+    }
+
+    return hash % ADDRESS_CACHE_HASH_SIZE;
+}
+
+/* true if a expires before b */
+static bool address_heap_before(
+    ADDRESS_LINK a,
+    ADDRESS_LINK b)
+{
+    return ((int32_t) (Address_Cache[a].TimeToLive -
+            Address_Cache[b].TimeToLive) < 0);
+}
+
+static void address_heap_set(
+    struct Address_Cache_Heap *heap,
+    unsigned position,
+    ADDRESS_LINK index)
+{
+    heap->Entry[position] = index;
+    Address_Cache[index].Heap_Position = (ADDRESS_LINK) (position + 1);
+}
+
+static void address_heap_up(
+    struct Address_Cache_Heap *heap,
+    unsigned position)
+{
+    ADDRESS_LINK index = heap->Entry[position];
+    unsigned parent = 0;
+
+    while (position > 0) {
+        parent = (position - 1) / 2;
+        if (!address_heap_before(index, heap->Entry[parent]))
+            break;
+        address_heap_set(heap, position, heap->Entry[parent]);
+        position = parent;
+    }
+    address_heap_set(heap, position, index);
+}
+
+static void address_heap_down(
+    struct Address_Cache_Heap *heap,
+    unsigned position)
+{
+    ADDRESS_LINK index = heap->Entry[position];
+    unsigned child = 0;
+
+    for (;;) {
+        child = (2 * position) + 1;
+        if (child >= heap->Count)
+            break;
+        if (((child + 1) < heap->Count) &&
+            address_heap_before(heap->Entry[child + 1], heap->Entry[child]))
+            child++;
+        if (!address_heap_before(heap->Entry[child], index))
+            break;
+        address_heap_set(heap, position, heap->Entry[child]);
+        position = child;
+    }
+    address_heap_set(heap, position, index);
+}
+
+static void address_heap_insert(
+    struct Address_Cache_Heap *heap,
+    ADDRESS_LINK index)
+{
+    heap->Entry[heap->Count] = index;
+    heap->Count++;
+    address_heap_up(heap, heap->Count - 1);
+}
+
+static void address_heap_remove(
+    struct Address_Cache_Heap *heap,
+    ADDRESS_LINK index)
+{
+    unsigned position = Address_Cache[index].Heap_Position - 1;
+
+    Address_Cache[index].Heap_Position = 0;
+    heap->Count--;
+    if (position < heap->Count) {
+        heap->Entry[position] = heap->Entry[heap->Count];
+        address_heap_up(heap, position);
+        address_heap_down(heap, Address_Cache[heap->Entry[position]].
+            Heap_Position - 1);
+    }
+}
+
+/* which heap the entry belongs in, if any */
+static struct Address_Cache_Heap *address_entry_heap(
+    struct Address_Cache_Entry *pMatch)
+{
+    if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_STATIC)) !=
+        BAC_ADDR_IN_USE)
+        return NULL;
+    if ((pMatch->Flags & BAC_ADDR_BIND_REQ) != 0)
+        return &Bind_Request_Heap;
+
+    return &Bound_Heap;
+}
+
+static bool address_entry_bound(
+    struct Address_Cache_Entry *pMatch)
+{
+    return ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
+        BAC_ADDR_IN_USE);
+}
+
+static void address_chain_remove(
+    ADDRESS_LINK * pLink,
+    ADDRESS_LINK index,
+    bool device_chain)
+{
+    struct Address_Cache_Entry *pEntry;
+
+    while (*pLink) {
+        pEntry = &Address_Cache[*pLink - 1];
+        if ((*pLink - 1) == index) {
+            if (device_chain) {
+                *pLink = pEntry->Device_Next;
+                pEntry->Device_Next = 0;
+            } else {
+                *pLink = pEntry->Address_Next;
+                pEntry->Address_Next = 0;
+            }
+            break;
+        }
+        if (device_chain)
+            pLink = &pEntry->Device_Next;
+        else
+            pLink = &pEntry->Address_Next;
+    }
+}
+
+/* Every change to the flags, device id, address or time to live of
+   an entry in use goes between unlink and link, so that the indexes
+   follow the entry. */
+static void address_entry_unlink(
+    ADDRESS_LINK index)
+{
+    struct Address_Cache_Entry *pMatch = &Address_Cache[index];
+    struct Address_Cache_Heap *heap;
+
+    if ((pMatch->Flags & BAC_ADDR_IN_USE) == 0)
+        return;
+    address_chain_remove(&Device_Hash[address_device_hash(pMatch->
+                device_id)], index, true);
+    if (address_entry_bound(pMatch)) {
+        address_chain_remove(&Address_Hash[address_mac_hash(&pMatch->
+                    address)], index, false);
+        Address_Cache_Bound_Count--;
+    }
+    heap = address_entry_heap(pMatch);
+    if (heap && pMatch->Heap_Position)
+        address_heap_remove(heap, index);
+}
+
+static void address_entry_link(
+    ADDRESS_LINK index)
+{
+    struct Address_Cache_Entry *pMatch = &Address_Cache[index];
+    struct Address_Cache_Heap *heap;
+    unsigned hash;
+
+    if ((pMatch->Flags & BAC_ADDR_IN_USE) == 0)
+        return;
+    hash = address_device_hash(pMatch->device_id);
+    pMatch->Device_Next = Device_Hash[hash];
+    Device_Hash[hash] = index + 1;
+    if (address_entry_bound(pMatch)) {
+        hash = address_mac_hash(&pMatch->address);
+        pMatch->Address_Next = Address_Hash[hash];
+        Address_Hash[hash] = index + 1;
+        Address_Cache_Bound_Count++;
+    }
+    heap = address_entry_heap(pMatch);
+    if (heap)
+        address_heap_insert(heap, index);
+}
+
+/* sets the time to live of an entry, in seconds from now */
+static void address_entry_ttl(
+    struct Address_Cache_Entry *pMatch,
+    uint32_t TimeOut)
+{
+    pMatch->TimeToLive = Address_Cache_Clock + TimeOut;
+}
+
+/* the entry in use for the device, or NULL */
+static struct Address_Cache_Entry *address_find_device(
+    uint32_t device_id)
+{
+    ADDRESS_LINK link;
+    struct Address_Cache_Entry *pMatch;
+
+    link = Device_Hash[address_device_hash(device_id)];
+    while (link) {
+        pMatch = &Address_Cache[link - 1];
+        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
+            (pMatch->device_id == device_id))
+            return pMatch;
+        link = pMatch->Device_Next;
+    }
+
+    return NULL;
+}
+
+static void address_entry_free(
+    struct Address_Cache_Entry *pMatch)
+{
+    ADDRESS_LINK index = (ADDRESS_LINK) (pMatch - Address_Cache);
+
+    address_entry_unlink(index);
+    pMatch->Flags = 0;
+    Address_Cache_Free[Address_Cache_Free_Count] = index;
+    Address_Cache_Free_Count++;
+}
+
+/* takes a never used or free entry, or returns NULL if there are none */
+static struct Address_Cache_Entry *address_entry_new(
+    void)
+{
+    struct Address_Cache_Entry *pMatch = NULL;
+
+    /* freed entries whose slot is held for a caller are skipped */
+    while (Address_Cache_Free_Count) {
+        Address_Cache_Free_Count--;
+        pMatch = &Address_Cache[Address_Cache_Free[Address_Cache_Free_Count]];
+        if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_RESERVED)) == 0)
+            return pMatch;
+    }
+    if (Address_Cache_Never_Used < MAX_ADDRESS_CACHE) {
+        pMatch = &Address_Cache[Address_Cache_Never_Used];
+        Address_Cache_Never_Used++;
+        return pMatch;
+    }
+
+    return NULL;
+}
+
+/* rebuilds the indexes and the free list from the entry flags */
+static void address_cache_rebuild(
+    void)
+{
+    unsigned i = 0;
+
+    for (i = 0; i < ADDRESS_CACHE_HASH_SIZE; i++) {
+        Device_Hash[i] = 0;
+        Address_Hash[i] = 0;
+    }
+    Bound_Heap.Count = 0;
+    Bind_Request_Heap.Count = 0;
+    Address_Cache_Bound_Count = 0;
+    Address_Cache_Free_Count = 0;
+    Address_Cache_Never_Used = 0;
+    for (i = 0; i < MAX_ADDRESS_CACHE; i++) {
+        Address_Cache[i].Device_Next = 0;
+        Address_Cache[i].Address_Next = 0;
+        Address_Cache[i].Heap_Position = 0;
+        if ((Address_Cache[i].Flags & BAC_ADDR_IN_USE) != 0) {
+            address_entry_link((ADDRESS_LINK) i);
+            Address_Cache_Never_Used = i + 1;
+        }
+    }
+    /* lowest comes off first */
+    i = Address_Cache_Never_Used;
+    while (i > 0) {
+        i--;
+        if ((Address_Cache[i].Flags & BAC_ADDR_IN_USE) == 0) {
+            Address_Cache_Free[Address_Cache_Free_Count] = (ADDRESS_LINK) i;
+            Address_Cache_Free_Count++;
+        }
+    }
+}
+
 bool address_match(
     BACNET_ADDRESS * dest,
     BACNET_ADDRESS * src)
@@ -110,88 +454,56 @@ void address_remove_device(
 {
     struct Address_Cache_Entry *pMatch;
 
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            pMatch->Flags = 0;
-            break;
-        }
-        pMatch++;
+    pMatch = address_find_device(device_id);
+    if (pMatch) {
+        address_entry_free(pMatch);
     }
 
     return;
 }
 
 /*****************************************************************************
- * Search the cache for the entry nearest expiry and delete it. Mark the     *
+ * Take the entry nearest expiry off the cache and delete it. Mark the       *
  * entry as reserved with a 1 hour TTL and return a pointer to the reserved  *
  * entry. Will not delete a static entry and returns NULL pointer if no      *
  * entry available to free up. Does not check for free entries as it is      *
  * assumed we are calling this due to the lack of those.                     *
  *****************************************************************************/
 
-
 struct Address_Cache_Entry *address_remove_oldest(
     void)
 {
-    struct Address_Cache_Entry *pMatch;
-    struct Address_Cache_Entry *pCandidate;
-    uint32_t ulTime;
-
-    pCandidate = NULL;
-    ulTime = BAC_ADDR_FOREVER - 1;      /* Longest possible non static time to live */
-
-    /* First pass - try only in use and bound entries */
-
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if ((pMatch->
-                Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ |
-                    BAC_ADDR_STATIC)) == BAC_ADDR_IN_USE) {
-            if (pMatch->TimeToLive <= ulTime) { /* Shorter lived entry found */
-                ulTime = pMatch->TimeToLive;
-                pCandidate = pMatch;
-            }
-        }
-        pMatch++;
+    struct Address_Cache_Entry *pCandidate = NULL;
+    ADDRESS_LINK index;
+
+    /* First try only in use and bound entries,
+       then in use and un bound as last resort */
+    if (Bound_Heap.Count) {
+        pCandidate = &Address_Cache[Bound_Heap.Entry[0]];
+    } else if (Bind_Request_Heap.Count) {
+        pCandidate = &Address_Cache[Bind_Request_Heap.Entry[0]];
     }
 
     if (pCandidate != NULL) {   /* Found something to free up */
+        index = (ADDRESS_LINK) (pCandidate - Address_Cache);
+        address_entry_unlink(index);
         pCandidate->Flags = BAC_ADDR_RESERVED;
-        pCandidate->TimeToLive = BAC_ADDR_SHORT_TIME;   /* only reserve it for a short while */
-        return (pCandidate);
-    }
-
-    /* Second pass - try in use and un bound as last resort */
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if ((pMatch->
-                Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ |
-                    BAC_ADDR_STATIC)) ==
-            (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) {
-            if (pMatch->TimeToLive <= ulTime) { /* Shorter lived entry found */
-                ulTime = pMatch->TimeToLive;
-                pCandidate = pMatch;
-            }
-        }
-        pMatch++;
-    }
-
-    if (pCandidate != NULL) {   /* Found something to free up */
-        pCandidate->Flags = BAC_ADDR_RESERVED;
-        pCandidate->TimeToLive = BAC_ADDR_SHORT_TIME;   /* only reserve it for a short while */
+        /* only reserve it for a short while */
+        address_entry_ttl(pCandidate, BAC_ADDR_SHORT_TIME);
     }
 
     return (pCandidate);
 }
 
-
 /* File format:
-DeviceID MAC SNET SADR MAX-APDU
+DeviceID MAC SNET SADR MAX-APDU [TTL]
 4194303 05 0 0 50
 55555 C0:A8:00:18:BA:C0 26001 19 50
+12345 C0:A8:00:19:BA:C0 0 0 1476 86000
 note: useful for MS/TP Slave static binding
+Entries without a TTL are static.  Entries with a TTL, in seconds,
+are learned bindings saved by address_file_save(), and expire as
+if they had been learned again when they were loaded.
 */
 static const char *Address_Cache_Filename = "address_cache";
 
@@ -203,19 +515,23 @@ void address_file_init(
     long device_id = 0;
     int snet = 0;
     unsigned max_apdu = 0;
-    unsigned mac[6];
+    unsigned mac[MAX_MAC_LEN] = { 0 };
     int count = 0;
     char mac_string[80], sadr_string[80];
     BACNET_ADDRESS src;
     int index = 0;
+    unsigned long ttl = 0;
+    int fields = 0;
 
     pFile = fopen(pFilename, "r");
     if (pFile) {
         while (fgets(line, (int) sizeof(line), pFile) != NULL) {
             /* ignore comments */
             if (line[0] != ';') {
-                if (sscanf(line, "%ld %s %d %s %u", &device_id, &mac_string[0],
-                        &snet, &sadr_string[0], &max_apdu) == 5) {
+                fields =
+                    sscanf(line, "%ld %79s %d %79s %u %lu", &device_id,
+                    &mac_string[0], &snet, &sadr_string[0], &max_apdu, &ttl);
+                if (fields >= 5) {
                     count =
                         sscanf(mac_string, "%x:%x:%x:%x:%x:%x", &mac[0],
                         &mac[1], &mac[2], &mac[3], &mac[4], &mac[5]);
@@ -239,7 +555,14 @@ void address_file_init(
                         }
                     }
                     address_add((uint32_t) device_id, max_apdu, &src);
-                    address_set_device_TTL(device_id, 0, true); /* Mark as static entry */
+                    if (fields == 6) {
+                        if (ttl > BAC_ADDR_LONG_TIME)
+                            ttl = BAC_ADDR_LONG_TIME;
+                        address_set_device_TTL(device_id, (uint32_t) ttl,
+                            false);
+                    } else {
+                        address_set_device_TTL(device_id, 0, true);     /* Mark as static entry */
+                    }
                 }
             }
         }
@@ -249,6 +572,80 @@ void address_file_init(
     return;
 }
 
+static void address_file_hex(
+    FILE * pFile,
+    uint8_t * octets,
+    uint8_t len)
+{
+    uint8_t i;
+
+    if (len > MAX_MAC_LEN)
+        len = MAX_MAC_LEN;
+    for (i = 0; i < len; i++) {
+        fprintf(pFile, "%02X", octets[i]);
+        if ((i + 1) < len) {
+            fprintf(pFile, ":");
+        }
+    }
+}
+
+/* Writes the bound entries in the format read by address_file_init(),
+   static entries without a TTL.  The file is written under a temporary
+   name and then renamed, so a reader never sees half a file.
+   Returns false if the file could not be written. */
+bool address_file_save(
+    const char *pFilename)
+{
+    FILE *pFile = NULL; /* stream pointer */
+    char temp_name[256] = { "" };
+    struct Address_Cache_Entry *pMatch;
+    int32_t ttl = 0;
+    bool status = true;
+
+    if (!pFilename ||
+        (strlen(pFilename) + sizeof(".tmp") > sizeof(temp_name)))
+        return false;
+    sprintf(temp_name, "%s.tmp", pFilename);
+    pFile = fopen(temp_name, "w");
+    if (!pFile)
+        return false;
+    fprintf(pFile, "; DeviceID MAC SNET SADR MAX-APDU [TTL]\n");
+    pMatch = Address_Cache;
+    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
+        if (address_entry_bound(pMatch) && (pMatch->address.mac_len != 0)) {
+            fprintf(pFile, "%lu ", (unsigned long) pMatch->device_id);
+            address_file_hex(pFile, pMatch->address.mac,
+                pMatch->address.mac_len);
+            fprintf(pFile, " %u ", (unsigned) pMatch->address.net);
+            if (pMatch->address.net && pMatch->address.len) {
+                address_file_hex(pFile, pMatch->address.adr,
+                    pMatch->address.len);
+            } else {
+                fprintf(pFile, "0");
+            }
+            fprintf(pFile, " %u", pMatch->max_apdu);
+            if ((pMatch->Flags & BAC_ADDR_STATIC) == 0) {
+                ttl = (int32_t) (pMatch->TimeToLive - Address_Cache_Clock);
+                if (ttl < 0)
+                    ttl = 0;
+                fprintf(pFile, " %lu", (unsigned long) ttl);
+            }
+            fprintf(pFile, "\n");
+        }
+        pMatch++;
+    }
+    if (ferror(pFile))
+        status = false;
+    if (fclose(pFile) != 0)
+        status = false;
+    if (status && (rename(temp_name, pFilename) != 0))
+        status = false;
+    if (!status)
+        remove(temp_name);
+
+    return status;
+}
+
 
 /****************************************************************************
  * Clear down the cache and make sure the full complement of entries are    *
@@ -265,6 +662,7 @@ void address_init(
         pMatch->Flags = 0;
         pMatch++;
     }
+    address_cache_rebuild();
     address_file_init(Address_Cache_Filename);
 
     return;
@@ -287,7 +685,9 @@ void address_init_partial(
     while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
         if ((pMatch->Flags & BAC_ADDR_IN_USE) != 0) {   /* It's in use so let's check further */
             if (((pMatch->Flags & BAC_ADDR_BIND_REQ) != 0) ||
-                (pMatch->TimeToLive == 0))
+                (((pMatch->Flags & BAC_ADDR_STATIC) == 0) &&
+                    ((int32_t) (pMatch->TimeToLive -
+                            Address_Cache_Clock) <= 0)))
                 pMatch->Flags = 0;
         }
 
@@ -297,6 +697,7 @@ void address_init_partial(
 
         pMatch++;
     }
+    address_cache_rebuild();
     address_file_init(Address_Cache_Filename);
 
     return;
@@ -316,25 +717,24 @@ void address_set_device_TTL(
     bool StaticFlag)
 {
     struct Address_Cache_Entry *pMatch;
-
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {     /* If bound then we have either static or normaal */
-                if (StaticFlag) {
-                    pMatch->Flags |= BAC_ADDR_STATIC;
-                    pMatch->TimeToLive = BAC_ADDR_FOREVER;
-                } else {
-                    pMatch->Flags &= ~BAC_ADDR_STATIC;
-                    pMatch->TimeToLive = TimeOut;
-                }
+    ADDRESS_LINK index;
+
+    pMatch = address_find_device(device_id);
+    if (pMatch) {
+        index = (ADDRESS_LINK) (pMatch - Address_Cache);
+        address_entry_unlink(index);
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) { /* If bound then we have either static or normaal */
+            if (StaticFlag) {
+                pMatch->Flags |= BAC_ADDR_STATIC;
+                pMatch->TimeToLive = BAC_ADDR_FOREVER;
             } else {
-                pMatch->TimeToLive = TimeOut;   /* For unbound we can only set the time to live */
+                pMatch->Flags &= ~BAC_ADDR_STATIC;
+                address_entry_ttl(pMatch, TimeOut);
             }
-            break;      /* Exit now if found at all - bound or unbound */
+        } else {
+            address_entry_ttl(pMatch, TimeOut); /* For unbound we can only set the time to live */
         }
-        pMatch++;
+        address_entry_link(index);
     }
 }
 
@@ -347,18 +747,11 @@ bool address_get_by_device(
     struct Address_Cache_Entry *pMatch;
     bool found = false; /* return value */
 
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {     /* If bound then fetch data */
-                *src = pMatch->address;
-                *max_apdu = pMatch->max_apdu;
-                found = true;   /* Prove we found it */
-            }
-            break;      /* Exit now if found at all - bound or unbound */
-        }
-        pMatch++;
+    pMatch = address_find_device(device_id);
+    if (pMatch && ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0)) { /* If bound then fetch data */
+        *src = pMatch->address;
+        *max_apdu = pMatch->max_apdu;
+        found = true;   /* Prove we found it */
     }
 
     return found;
@@ -371,20 +764,21 @@ bool address_get_device_id(
     uint32_t * device_id)
 {
     struct Address_Cache_Entry *pMatch;
+    ADDRESS_LINK link;
     bool found = false; /* return value */
 
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) == BAC_ADDR_IN_USE) {       /* If bound */
-            if (bacnet_address_same(&pMatch->address, src)) {
-                if (device_id) {
-                    *device_id = pMatch->device_id;
-                }
-                found = true;
-                break;
+    /* only bound entries are in the address index */
+    link = Address_Hash[address_mac_hash(src)];
+    while (link) {
+        pMatch = &Address_Cache[link - 1];
+        if (bacnet_address_same(&pMatch->address, src)) {
+            if (device_id) {
+                *device_id = pMatch->device_id;
             }
+            found = true;
+            break;
         }
-        pMatch++;
+        link = pMatch->Address_Next;
     }
 
     return found;
@@ -395,8 +789,8 @@ void address_add(
     unsigned max_apdu,
     BACNET_ADDRESS * src)
 {
-    bool found = false; /* return value */
     struct Address_Cache_Entry *pMatch;
+    ADDRESS_LINK index;
 
     /* Note: Previously this function would ignore bind request
        marked entries and in fact would probably overwrite the first
@@ -405,58 +799,42 @@ void address_add(
        bind request if it exists */
 
     /* existing device or bind request outstanding - update address */
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            pMatch->address = *src;
-            pMatch->max_apdu = max_apdu;
-
-            /* Pick the right time to live */
-
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) != 0)       /* Bind requested so long time */
-                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
-            else if ((pMatch->Flags & BAC_ADDR_STATIC) != 0)    /* Static already so make sure it never expires */
-                pMatch->TimeToLive = BAC_ADDR_FOREVER;
-            else if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) /* Opportunistic entry so leave on short fuse */
-                pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
-            else
-                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;        /* Renewing existing entry */
-
-            pMatch->Flags &= ~BAC_ADDR_BIND_REQ;        /* Clear bind request flag just in case */
-            found = true;
-            break;
-        }
-        pMatch++;
+    pMatch = address_find_device(device_id);
+    if (pMatch) {
+        index = (ADDRESS_LINK) (pMatch - Address_Cache);
+        address_entry_unlink(index);
+        pMatch->address = *src;
+        pMatch->max_apdu = max_apdu;
+
+        /* Pick the right time to live */
+
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) != 0)   /* Bind requested so long time */
+            address_entry_ttl(pMatch, BAC_ADDR_LONG_TIME);
+        else if ((pMatch->Flags & BAC_ADDR_STATIC) != 0)        /* Static already so make sure it never expires */
+            pMatch->TimeToLive = BAC_ADDR_FOREVER;
+        else if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0)     /* Opportunistic entry so leave on short fuse */
+            address_entry_ttl(pMatch, BAC_ADDR_SHORT_TIME);
+        else
+            address_entry_ttl(pMatch, BAC_ADDR_LONG_TIME);      /* Renewing existing entry */
+
+        pMatch->Flags &= ~BAC_ADDR_BIND_REQ;    /* Clear bind request flag just in case */
+        address_entry_link(index);
+        return;
     }
 
     /* new device - add to cache if there is room */
-    if (!found) {
-        pMatch = Address_Cache;
-        while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-            if ((pMatch->Flags & BAC_ADDR_IN_USE) == 0) {
-                pMatch->Flags = BAC_ADDR_IN_USE;
-                pMatch->device_id = device_id;
-                pMatch->max_apdu = max_apdu;
-                pMatch->address = *src;
-                pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;       /* Opportunistic entry so leave on short fuse */
-                found = true;
-                break;
-            }
-            pMatch++;
-        }
-    }
-
+    pMatch = address_entry_new();
     /* See if we can squeeze it in */
-    if (!found) {
+    if (pMatch == NULL) {
         pMatch = address_remove_oldest();
-        if (pMatch != NULL) {
-            pMatch->Flags = BAC_ADDR_IN_USE;
-            pMatch->device_id = device_id;
-            pMatch->max_apdu = max_apdu;
-            pMatch->address = *src;
-            pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;   /* Opportunistic entry so leave on short fuse */
-        }
+    }
+    if (pMatch != NULL) {
+        pMatch->Flags = BAC_ADDR_IN_USE;
+        pMatch->device_id = device_id;
+        pMatch->max_apdu = max_apdu;
+        pMatch->address = *src;
+        address_entry_ttl(pMatch, BAC_ADDR_SHORT_TIME); /* Opportunistic entry so leave on short fuse */
+        address_entry_link((ADDRESS_LINK) (pMatch - Address_Cache));
     }
     return;
 }
@@ -470,45 +848,38 @@ bool address_bind_request(
 {
     bool found = false; /* return value */
     struct Address_Cache_Entry *pMatch;
+    ADDRESS_LINK index;
 
     /* existing device - update address info if currently bound */
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {     /* Already bound */
-                found = true;
-                *src = pMatch->address;
-                *max_apdu = pMatch->max_apdu;
-                if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {        /* Was picked up opportunistacilly */
-                    pMatch->Flags &= ~BAC_ADDR_SHORT_TTL;       /* Convert to normal entry  */
-                    pMatch->TimeToLive = BAC_ADDR_LONG_TIME;    /* And give it a decent time to live */
-                }
+    pMatch = address_find_device(device_id);
+    if (pMatch) {
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) { /* Already bound */
+            found = true;
+            *src = pMatch->address;
+            *max_apdu = pMatch->max_apdu;
+            if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {    /* Was picked up opportunistacilly */
+                index = (ADDRESS_LINK) (pMatch - Address_Cache);
+                address_entry_unlink(index);
+                pMatch->Flags &= ~BAC_ADDR_SHORT_TTL;   /* Convert to normal entry  */
+                address_entry_ttl(pMatch, BAC_ADDR_LONG_TIME);  /* And give it a decent time to live */
+                address_entry_link(index);
             }
-            return (found);     /* True if bound, false if bind request outstanding */
         }
-        pMatch++;
+        return (found); /* True if bound, false if bind request outstanding */
     }
 
     /* Not there already so look for a free entry to put it in */
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_RESERVED)) == 0) {
-            pMatch->Flags = BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ;        /* In use and awaiting binding */
-            pMatch->device_id = device_id;
-            pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;   /* No point in leaving bind requests in for long haul */
-            /* now would be a good time to do a Who-Is request */
-            return (false);
-        }
-        pMatch++;
-    }
-
+    pMatch = address_entry_new();
     /* No free entries, See if we can squeeze it in by dropping an existing one */
-    pMatch = address_remove_oldest();
+    if (pMatch == NULL) {
+        pMatch = address_remove_oldest();
+    }
     if (pMatch != NULL) {
-        pMatch->Flags = BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ;
+        pMatch->Flags = BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ;    /* In use and awaiting binding */
         pMatch->device_id = device_id;
-        pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;       /* No point in leaving bind requests in for long haul */
+        address_entry_ttl(pMatch, BAC_ADDR_SHORT_TIME); /* No point in leaving bind requests in for long haul */
+        address_entry_link((ADDRESS_LINK) (pMatch - Address_Cache));
+        /* now would be a good time to do a Who-Is request */
     }
     return (false);
 }
@@ -520,20 +891,19 @@ void address_add_binding(
     BACNET_ADDRESS * src)
 {
     struct Address_Cache_Entry *pMatch;
+    ADDRESS_LINK index;
 
     /* existing device or bind request - update address */
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            pMatch->address = *src;
-            pMatch->max_apdu = max_apdu;
-            pMatch->Flags &= ~BAC_ADDR_BIND_REQ;        /* Clear bind request flag in case it was set */
-            if ((pMatch->Flags & BAC_ADDR_STATIC) == 0) /* Only update TTL if not static */
-                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;        /* and set it on a long fuse */
-            break;
-        }
-        pMatch++;
+    pMatch = address_find_device(device_id);
+    if (pMatch) {
+        index = (ADDRESS_LINK) (pMatch - Address_Cache);
+        address_entry_unlink(index);
+        pMatch->address = *src;
+        pMatch->max_apdu = max_apdu;
+        pMatch->Flags &= ~BAC_ADDR_BIND_REQ;    /* Clear bind request flag in case it was set */
+        if ((pMatch->Flags & BAC_ADDR_STATIC) == 0)     /* Only update TTL if not static */
+            address_entry_ttl(pMatch, BAC_ADDR_LONG_TIME);      /* and set it on a long fuse */
+        address_entry_link(index);
     }
     return;
 }
@@ -564,18 +934,8 @@ bool address_get_by_index(
 unsigned address_count(
     void)
 {
-    struct Address_Cache_Entry *pMatch;
-    unsigned count = 0; /* return value */
-
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) == BAC_ADDR_IN_USE) /* Only count bound entries */
-            count++;
-
-        pMatch++;
-    }
-
-    return count;
+    /* Only count bound entries */
+    return Address_Cache_Bound_Count;
 }
 
 /****************************************************************************
@@ -627,28 +987,29 @@ int address_list_encode(
 
 
 /****************************************************************************
- * Scan the cache and eliminate any expired entries. Should be called       *
- * periodically to ensure the cache is managed correctly. If this function  *
- * is never called at all the whole cache is effectivly rendered static and *
- * entries never expire unless explicetly deleted.                          *    
+ * Eliminate any expired entries. Should be called periodically to ensure   *
+ * the cache is managed correctly. If this function is never called at all *
+ * the whole cache is effectivly rendered static and entries never expire   *
+ * unless explicetly deleted. Only the entries at the top of the expiry     *
+ * heaps are looked at, so the cost is in the entries that expire.          *
  ****************************************************************************/
 
 void address_cache_timer(
     uint16_t uSeconds)
 {       /* Approximate number of seconds since last call to this function */
+    struct Address_Cache_Heap *heap[2] = { &Bound_Heap, &Bind_Request_Heap };
     struct Address_Cache_Entry *pMatch;
+    unsigned i;
 
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if (((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_RESERVED)) != 0)
-            && ((pMatch->Flags & BAC_ADDR_STATIC) != 0)) {      /* Check all entries holding a slot except statics */
-            if (pMatch->TimeToLive >= uSeconds)
-                pMatch->TimeToLive -= uSeconds;
-            else
-                pMatch->Flags = 0;
+    Address_Cache_Clock += uSeconds;
+    /* static entries are not in the heaps */
+    for (i = 0; i < 2; i++) {
+        while (heap[i]->Count) {
+            pMatch = &Address_Cache[heap[i]->Entry[0]];
+            if ((int32_t) (pMatch->TimeToLive - Address_Cache_Clock) >= 0)
+                break;
+            address_entry_free(pMatch);
         }
-
-        pMatch++;
     }
 }
 
@@ -668,6 +1029,8 @@ static void set_address(
     for (i = 0; i < MAX_MAC_LEN; i++) {
         dest->mac[i] = index;
     }
+    /* unique past 255 entries */
+    dest->mac[0] = index >> 8;
     dest->mac_len = MAX_MAC_LEN;
     dest->net = 7;
     dest->len = MAX_MAC_LEN;
@@ -807,6 +1170,143 @@ void testAddress(
     }
 }
 
+/* the file holds up to 6 octets of MAC and SADR */
+static void set_file_test_address(
+    unsigned index,
+    BACNET_ADDRESS * dest)
+{
+    unsigned i;
+
+    memset(dest, 0, sizeof(BACNET_ADDRESS));
+    for (i = 0; i < 6; i++) {
+        dest->mac[i] = 0xC0 + index + i;
+    }
+    dest->mac_len = 6;
+    if (index % 2) {
+        dest->net = 26001;
+        dest->len = 1;
+        dest->adr[0] = index;
+    }
+}
+
+void testAddressFileSave(
+    Test * pTest)
+{
+    unsigned i;
+    BACNET_ADDRESS src;
+    unsigned max_apdu = 480;
+    BACNET_ADDRESS test_address;
+    unsigned test_max_apdu = 0;
+    const char *pFilename = "address_cache_saved";
+
+    remove(Address_Cache_Filename);
+    address_init();
+    for (i = 0; i < 4; i++) {
+        set_file_test_address(i, &src);
+        address_add(i, max_apdu + i, &src);
+    }
+    /* one static, two learned, and one still waiting */
+    address_set_device_TTL(0, 0, true);
+    address_set_device_TTL(1, 100, false);
+    address_set_device_TTL(2, 200, false);
+    address_remove_device(3);
+    address_bind_request(3, &test_max_apdu, &test_address);
+    address_cache_timer(50);
+    ct_test(pTest, address_file_save(pFilename));
+    /* load it into an empty cache */
+    address_init();
+    ct_test(pTest, address_count() == 0);
+    address_file_init(pFilename);
+    ct_test(pTest, address_count() == 3);
+    for (i = 0; i < 3; i++) {
+        set_file_test_address(i, &src);
+        ct_test(pTest, address_get_by_device(i, &test_max_apdu,
+                &test_address));
+        ct_test(pTest, test_max_apdu == (max_apdu + i));
+        ct_test(pTest, bacnet_address_same(&test_address, &src));
+    }
+    ct_test(pTest, !address_get_by_device(3, &test_max_apdu,
+            &test_address));
+    /* the learned entries kept what was left of their time */
+    address_cache_timer(51);
+    ct_test(pTest, !address_get_by_device(1, &test_max_apdu,
+            &test_address));
+    ct_test(pTest, address_get_by_device(2, &test_max_apdu, &test_address));
+    address_cache_timer(100);
+    ct_test(pTest, !address_get_by_device(2, &test_max_apdu,
+            &test_address));
+    ct_test(pTest, address_get_by_device(0, &test_max_apdu, &test_address));
+    remove(pFilename);
+    address_init();
+}
+
+void testAddressExpiry(
+    Test * pTest)
+{
+    unsigned i;
+    BACNET_ADDRESS src;
+    uint32_t device_id = 0;
+    unsigned max_apdu = 480;
+    BACNET_ADDRESS test_address;
+    uint32_t test_device_id = 0;
+    unsigned test_max_apdu = 0;
+
+    /* start without the static entries from the file test */
+    remove(Address_Cache_Filename);
+    address_init();
+    /* a full cache of bound entries with staggered lifetimes */
+    for (i = 0; i < MAX_ADDRESS_CACHE; i++) {
+        set_address(i, &src);
+        address_add(i, max_apdu, &src);
+        address_set_device_TTL(i, 100 + i, false);
+    }
+    ct_test(pTest, address_count() == MAX_ADDRESS_CACHE);
+    /* one static entry never expires */
+    address_set_device_TTL(0, 0, true);
+    /* the next one in pushes out the entry closest to expiry */
+    set_address(MAX_ADDRESS_CACHE, &src);
+    device_id = MAX_ADDRESS_CACHE;
+    address_add(device_id, max_apdu, &src);
+    ct_test(pTest, address_get_by_device(device_id, &test_max_apdu,
+            &test_address));
+    ct_test(pTest, !address_get_by_device(1, &test_max_apdu,
+            &test_address));
+    ct_test(pTest, address_get_device_id(&src, &test_device_id));
+    ct_test(pTest, test_device_id == device_id);
+    ct_test(pTest, address_count() == MAX_ADDRESS_CACHE);
+    /* a bind request takes the next one */
+    ct_test(pTest, !address_bind_request(device_id + 1, &test_max_apdu,
+            &test_address));
+    ct_test(pTest, !address_get_by_device(2, &test_max_apdu,
+            &test_address));
+    ct_test(pTest, address_count() == (MAX_ADDRESS_CACHE - 1));
+    /* entries expire in order */
+    address_cache_timer(100 + 3);
+    ct_test(pTest, address_get_by_device(3, &test_max_apdu, &test_address));
+    address_cache_timer(1);
+    ct_test(pTest, !address_get_by_device(3, &test_max_apdu,
+            &test_address));
+    ct_test(pTest, address_get_by_device(4, &test_max_apdu, &test_address));
+    set_address(3, &src);
+    ct_test(pTest, !address_get_device_id(&src, &test_device_id));
+    /* everything but the static entry, and the freed entries reused */
+    address_cache_timer(0xFFFF);
+    address_cache_timer(0xFFFF);
+    ct_test(pTest, address_count() == 1);
+    ct_test(pTest, address_get_by_device(0, &test_max_apdu, &test_address));
+    for (i = 1; i < MAX_ADDRESS_CACHE; i++) {
+        set_address(i, &src);
+        address_add(i, max_apdu, &src);
+    }
+    ct_test(pTest, address_count() == MAX_ADDRESS_CACHE);
+    for (i = 0; i < MAX_ADDRESS_CACHE; i++) {
+        set_address(i, &src);
+        ct_test(pTest, address_get_device_id(&src, &test_device_id));
+        ct_test(pTest, test_device_id == i);
+    }
+    address_init();
+}
+
 #ifdef TEST_ADDRESS
 int main(
     void)
@@ -820,6 +1320,10 @@ int main(
     assert(rc);
     rc = ct_addTestFunction(pTest, testAddressFile);
     assert(rc);
+    rc = ct_addTestFunction(pTest, testAddressExpiry);
+    assert(rc);
+    rc = ct_addTestFunction(pTest, testAddressFileSave);
+    assert(rc);
 
 
     ct_setStream(pTest, stdout);
@@ -34,7 +34,9 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include "config.h"
 #include "bits.h"
+#include "arena.h"
 #include "apdu.h"
 #include "bacdef.h"
 #include "bacdcode.h"
@@ -48,6 +50,10 @@ static uint16_t Timeout_Milliseconds = 3000;
 /* Number of APDU Retries */
 static uint8_t Number_Of_Retries = 3;
 
+/* scratch memory for the service handlers, emptied after each APDU */
+static BACNET_THREAD_LOCAL BACNET_ARENA Request_Arena;
+static BACNET_THREAD_LOCAL uint8_t Request_Arena_Buffer[MAX_REQUEST_ARENA];
+
 /* a simple table for crossing the services supported */
 static BACNET_SERVICES_SUPPORTED
     confirmed_service_supported[MAX_BACNET_CONFIRMED_SERVICE] = {
@@ -240,6 +246,17 @@ void apdu_set_error_handler(
         Error_Function[service_choice] = pFunction;
 }
 
+static complex_error_function
+    Complex_Error_Function[MAX_BACNET_CONFIRMED_SERVICE];
+
+void apdu_set_complex_error_handler(
+    BACNET_CONFIRMED_SERVICE service_choice,
+    complex_error_function pFunction)
+{
+    if (service_choice < MAX_BACNET_CONFIRMED_SERVICE)
+        Complex_Error_Function[service_choice] = pFunction;
+}
+
 static abort_function Abort_Function;
 
 void apdu_set_abort_handler(
@@ -285,6 +302,19 @@ uint16_t apdu_decode_confirmed_service_request(
     return len;
 }
 
+uint16_t apdu_max_response(
+    BACNET_CONFIRMED_SERVICE_DATA * service_data)
+{
+    uint16_t max_resp = MAX_APDU;
+
+    if ((service_data->max_resp > 0) &&
+        (service_data->max_resp < MAX_APDU)) {
+        max_resp = (uint16_t) service_data->max_resp;
+    }
+
+    return max_resp;
+}
+
 uint16_t apdu_timeout(
     void)
 {
@@ -309,6 +339,23 @@ void apdu_retries_set(
     Number_Of_Retries = value;
 }
 
+void *apdu_arena_alloc(
+    size_t size)
+{
+    if (!Request_Arena.buffer) {
+        arena_init(&Request_Arena, &Request_Arena_Buffer[0],
+            sizeof(Request_Arena_Buffer));
+    }
+
+    return arena_alloc(&Request_Arena, size);
+}
+
+void apdu_arena_reset(
+    void)
+{
+    arena_reset(&Request_Arena);
+}
+
 void apdu_handler(
     BACNET_ADDRESS * src,
     uint8_t * apdu,     /* APDU data */
@@ -344,6 +391,14 @@ void apdu_handler(
                         && (service_choice !=
                             SERVICE_CONFIRMED_REINITIALIZE_DEVICE)))
                     break;
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+                /* the handlers get the request once it is all here */
+                if (service_data.segmented_message &&
+                    !tsm_segmented_request_received(src, &service_data,
+                        service_choice, &service_request,
+                        &service_request_len))
+                    break;
+#endif
                 if ((service_choice < MAX_BACNET_CONFIRMED_SERVICE) &&
                     (Confirmed_Function[service_choice]))
                     Confirmed_Function[service_choice] (service_request,
@@ -413,6 +468,14 @@ void apdu_handler(
                 service_choice = apdu[len++];
                 service_request = &apdu[len];
                 service_request_len = apdu_len - len;
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+                /* the handlers get the ack once it is all here */
+                if (service_ack_data.segmented_message &&
+                    !tsm_segmented_complex_ack_received(src,
+                        &service_ack_data, service_choice, &service_request,
+                        &service_request_len))
+                    break;
+#endif
                 switch (service_choice) {
                     case SERVICE_CONFIRMED_GET_ALARM_SUMMARY:
                     case SERVICE_CONFIRMED_GET_ENROLLMENT_SUMMARY:
@@ -445,14 +508,26 @@ void apdu_handler(
                 }
                 break;
             case PDU_TYPE_SEGMENT_ACK:
-                /* FIXME: what about a denial of service attack here?
-                   we could check src to see if that matched the tsm */
-                tsm_free_invoke_id(invoke_id);
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+                /* we only send segments as a server, so only the
+                   ones from a client are for us */
+                if ((apdu_len >= 4) && !(apdu[0] & BIT0))
+                    tsm_segment_ack_received(src, apdu[1], apdu[2], apdu[3],
+                        (apdu[0] & BIT1) ? true : false);
+#endif
                 break;
             case PDU_TYPE_ERROR:
                 invoke_id = apdu[1];
                 service_choice = apdu[2];
                 len = 3;
+                if ((apdu_len > len) &&
+                    (service_choice < MAX_BACNET_CONFIRMED_SERVICE) &&
+                    Complex_Error_Function[service_choice]) {
+                    Complex_Error_Function[service_choice] (src, invoke_id,
+                        &apdu[len], apdu_len - len);
+                    tsm_free_invoke_id(invoke_id);
+                    break;
+                }
 
                 /* FIXME: Currently special case for C_P_T but there are others which may
                    need consideration such as ChangeList-Error, CreateObject-Error,
@@ -499,6 +574,14 @@ void apdu_handler(
                 server = apdu[0] & 0x01;
                 invoke_id = apdu[1];
                 reason = apdu[2];
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+                /* from a client, it is for the segments of its
+                   request or of our answer, and not for our invoke ID */
+                if (!server) {
+                    tsm_segmented_abort_received(src, invoke_id);
+                    break;
+                }
+#endif
                 if (Abort_Function)
                     Abort_Function(src, invoke_id, reason, server);
                 tsm_free_invoke_id(invoke_id);
@@ -506,6 +589,8 @@ void apdu_handler(
             default:
                 break;
         }
+        /* the handlers are done with their scratch memory */
+        arena_reset(&Request_Arena);
     }
     return;
 }
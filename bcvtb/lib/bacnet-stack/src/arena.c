@@ -0,0 +1,329 @@
+/**************************************************************************
+*
+* Copyright (C) 2026 agent <agent@local>
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+*********************************************************************/
+
+/* Functional Description: Arena and pool allocators.
+   See the unit tests for usage examples. */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+/* the strictest alignment that a caller could need */
+union arena_align_t {
+    void *pointer;
+    long integer;
+    double real;
+};
+#define ARENA_ALIGN (sizeof(union arena_align_t))
+#define ARENA_ALIGN_UP(n) (((n) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+struct pool_chunk {
+    struct pool_chunk *next;
+};
+
+struct pool_block {
+    struct pool_block *next;
+};
+
+void arena_init(
+    BACNET_ARENA * arena,
+    void *buffer,
+    size_t size)
+{
+    if (arena) {
+        arena->buffer = buffer;
+        arena->size = buffer ? size : 0;
+        arena->used = 0;
+    }
+}
+
+void *arena_alloc(
+    BACNET_ARENA * arena,
+    size_t size)
+{
+    size_t offset = 0;
+    size_t pad = 0;
+
+    if (!arena || !arena->buffer) {
+        return NULL;
+    }
+    /* the buffer itself might not be aligned */
+    offset = (size_t) (arena->buffer + arena->used);
+    pad = ARENA_ALIGN_UP(offset) - offset;
+    if ((arena->size - arena->used) < pad) {
+        return NULL;
+    }
+    offset = arena->used + pad;
+    if ((arena->size - offset) < size) {
+        return NULL;
+    }
+    arena->used = offset + size;
+
+    return &arena->buffer[offset];
+}
+
+void arena_reset(
+    BACNET_ARENA * arena)
+{
+    if (arena) {
+        arena->used = 0;
+    }
+}
+
+size_t arena_used(
+    BACNET_ARENA * arena)
+{
+    return (arena ? arena->used : 0);
+}
+
+void pool_init(
+    BACNET_POOL * pool,
+    size_t block_size,
+    unsigned chunk_blocks)
+{
+    if (pool) {
+        pool->block_size = block_size;
+        pool->chunk_blocks = chunk_blocks;
+        pool->chunks = NULL;
+        pool->free_list = NULL;
+    }
+}
+
+/* size of a block in the chunk - it holds the free list link when free */
+static size_t pool_stride(
+    BACNET_POOL * pool)
+{
+    size_t size = pool->block_size;
+
+    if (size < sizeof(struct pool_block)) {
+        size = sizeof(struct pool_block);
+    }
+
+    return ARENA_ALIGN_UP(size);
+}
+
+/* malloc another chunk of blocks and put them on the free list */
+static bool pool_grow(
+    BACNET_POOL * pool)
+{
+    struct pool_chunk *chunk;
+    struct pool_block *block;
+    uint8_t *blocks;
+    size_t stride = pool_stride(pool);
+    unsigned count = pool->chunk_blocks ? pool->chunk_blocks : 1;
+    unsigned i;
+
+    chunk =
+        malloc(ARENA_ALIGN_UP(sizeof(struct pool_chunk)) +
+        (stride * count));
+    if (!chunk) {
+        return false;
+    }
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+    blocks = (uint8_t *) chunk + ARENA_ALIGN_UP(sizeof(struct pool_chunk));
+    /* link them so that the first block is handed out first */
+    for (i = count; i > 0; i--) {
+        block = (struct pool_block *) &blocks[stride * (i - 1)];
+        block->next = pool->free_list;
+        pool->free_list = block;
+    }
+
+    return true;
+}
+
+void *pool_alloc(
+    BACNET_POOL * pool)
+{
+    struct pool_block *block;
+
+    if (!pool) {
+        return NULL;
+    }
+    if (!pool->free_list && !pool_grow(pool)) {
+        return NULL;
+    }
+    block = pool->free_list;
+    pool->free_list = block->next;
+    memset(block, 0, pool->block_size);
+
+    return block;
+}
+
+void pool_free(
+    BACNET_POOL * pool,
+    void *block)
+{
+    struct pool_block *free_block = block;
+
+    if (pool && free_block) {
+        free_block->next = pool->free_list;
+        pool->free_list = free_block;
+    }
+}
+
+void pool_destroy(
+    BACNET_POOL * pool)
+{
+    struct pool_chunk *chunk;
+
+    if (pool) {
+        while (pool->chunks) {
+            chunk = pool->chunks;
+            pool->chunks = chunk->next;
+            free(chunk);
+        }
+        pool->free_list = NULL;
+    }
+}
+
+#ifdef TEST
+#include <assert.h>
+
+#include "ctest.h"
+
+void testArena(
+    Test * pTest)
+{
+    BACNET_ARENA arena;
+    uint8_t buffer[256];
+    uint8_t *data1;
+    uint8_t *data2;
+    void *data3;
+
+    arena_init(&arena, &buffer[1], sizeof(buffer) - 1);
+    ct_test(pTest, arena_used(&arena) == 0);
+    data1 = arena_alloc(&arena, 3);
+    ct_test(pTest, data1 != NULL);
+    ct_test(pTest, ((size_t) data1 % ARENA_ALIGN) == 0);
+    memset(data1, 0xAA, 3);
+    data2 = arena_alloc(&arena, 16);
+    ct_test(pTest, data2 != NULL);
+    ct_test(pTest, ((size_t) data2 % ARENA_ALIGN) == 0);
+    ct_test(pTest, data2 >= (data1 + 3));
+    memset(data2, 0x55, 16);
+    ct_test(pTest, data1[2] == 0xAA);
+    /* too big for what is left */
+    data3 = arena_alloc(&arena, sizeof(buffer));
+    ct_test(pTest, data3 == NULL);
+    ct_test(pTest, arena_used(&arena) <= (sizeof(buffer) - 1));
+    /* everything comes back after a reset */
+    arena_reset(&arena);
+    ct_test(pTest, arena_used(&arena) == 0);
+    data3 = arena_alloc(&arena, 3);
+    ct_test(pTest, data3 == data1);
+    /* use the arena right up to the end */
+    arena_reset(&arena);
+    data1 = arena_alloc(&arena, 0);
+    ct_test(pTest, data1 != NULL);
+    data2 = arena_alloc(&arena, sizeof(buffer) - 1 - (data1 - &buffer[1]));
+    ct_test(pTest, data2 == data1);
+    ct_test(pTest, arena_used(&arena) == (sizeof(buffer) - 1));
+    data3 = arena_alloc(&arena, 1);
+    ct_test(pTest, data3 == NULL);
+    /* no buffer, no memory */
+    arena_init(&arena, NULL, sizeof(buffer));
+    ct_test(pTest, arena_alloc(&arena, 1) == NULL);
+}
+
+void testPool(
+    Test * pTest)
+{
+    static BACNET_POOL static_pool = POOL_INITIALIZER(sizeof(double), 4);
+    BACNET_POOL pool;
+    uint8_t *block[10];
+    uint8_t *data;
+    unsigned i, j;
+
+    pool_init(&pool, 3, 4);
+    for (i = 0; i < 10; i++) {
+        block[i] = pool_alloc(&pool);
+        ct_test(pTest, block[i] != NULL);
+        ct_test(pTest, ((size_t) block[i] % ARENA_ALIGN) == 0);
+        for (j = 0; j < 3; j++) {
+            ct_test(pTest, block[i][j] == 0);
+        }
+        memset(block[i], i + 1, 3);
+        for (j = 0; j < i; j++) {
+            ct_test(pTest, block[i] != block[j]);
+        }
+    }
+    for (i = 0; i < 10; i++) {
+        for (j = 0; j < 3; j++) {
+            ct_test(pTest, block[i][j] == (i + 1));
+        }
+    }
+    /* freed blocks are handed out again, and cleared */
+    pool_free(&pool, block[7]);
+    data = pool_alloc(&pool);
+    ct_test(pTest, data == block[7]);
+    ct_test(pTest, data[0] == 0);
+    ct_test(pTest, block[8][0] == 9);
+    for (i = 0; i < 10; i++) {
+        pool_free(&pool, block[i]);
+    }
+    pool_free(&pool, NULL);
+    pool_destroy(&pool);
+    ct_test(pTest, pool.chunks == NULL);
+    ct_test(pTest, pool.free_list == NULL);
+    /* a destroyed pool can be used again */
+    data = pool_alloc(&pool);
+    ct_test(pTest, data != NULL);
+    pool_destroy(&pool);
+
+    data = pool_alloc(&static_pool);
+    ct_test(pTest, data != NULL);
+    pool_free(&static_pool, data);
+    ct_test(pTest, pool_alloc(&static_pool) == data);
+    pool_destroy(&static_pool);
+}
+
+#ifdef TEST_ARENA
+int main(
+    void)
+{
+    Test *pTest;
+    bool rc;
+
+    pTest = ct_create("Arena and Pool", NULL);
+
+    /* individual tests */
+    rc = ct_addTestFunction(pTest, testArena);
+    assert(rc);
+    rc = ct_addTestFunction(pTest, testPool);
+    assert(rc);
+
+    ct_setStream(pTest, stdout);
+    ct_run(pTest);
+    (void) ct_report(pTest);
+
+    ct_destroy(pTest);
+
+    return 0;
+}
+#endif /* TEST_ARENA */
+#endif /* TEST */
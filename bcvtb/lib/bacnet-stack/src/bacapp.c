@@ -361,6 +361,470 @@ bool bacapp_decode_application_data_safe(
 }
 
 
+void bacapp_iterator_init(
+    BACNET_APPLICATION_DATA_ITERATOR * iterator,
+    uint8_t * apdu,
+    uint32_t apdu_len)
+{
+    if (iterator) {
+        iterator->apdu = apdu;
+        iterator->apdu_len = apdu ? apdu_len : 0;
+        iterator->offset = 0;
+        iterator->malformed = false;
+    }
+}
+
+/* The view points into the buffer given to bacapp_iterator_init(),
+   so strings of any length are seen without being copied, and stay
+   valid for as long as that buffer does. */
+bool bacapp_iterator_next(
+    BACNET_APPLICATION_DATA_ITERATOR * iterator,
+    BACNET_APPLICATION_DATA_VIEW * view)
+{
+    uint8_t *apdu = NULL;
+    uint32_t remaining = 0;
+    int tag_len = 0;
+    uint8_t tag_number = 0;
+    uint32_t len_value_type = 0;
+    uint32_t data_len = 0;
+
+    if (!iterator || !view || iterator->malformed ||
+        (iterator->offset >= iterator->apdu_len)) {
+        return false;
+    }
+    apdu = &iterator->apdu[iterator->offset];
+    remaining = iterator->apdu_len - iterator->offset;
+    tag_len =
+        decode_tag_number_and_value_safe(apdu, remaining, &tag_number,
+        &len_value_type);
+    if (tag_len <= 0) {
+        iterator->malformed = true;
+        return false;
+    }
+    view->context_specific = IS_CONTEXT_SPECIFIC(apdu[0]);
+    view->opening = view->context_specific && decode_is_opening_tag(apdu);
+    view->closing = view->context_specific && decode_is_closing_tag(apdu);
+    view->tag = tag_number;
+    view->len_value_type = len_value_type;
+    if (view->opening || view->closing) {
+        data_len = 0;
+    } else if (!view->context_specific &&
+        (tag_number == BACNET_APPLICATION_TAG_BOOLEAN)) {
+        /* the value is in the tag */
+        data_len = 0;
+    } else {
+        data_len = len_value_type;
+    }
+    remaining -= (uint32_t) tag_len;
+    if (data_len > remaining) {
+        iterator->malformed = true;
+        return false;
+    }
+    view->data = &apdu[tag_len];
+    view->data_len = data_len;
+    iterator->offset += (uint32_t) tag_len + data_len;
+
+    return true;
+}
+
+bool bacapp_iterator_more(
+    BACNET_APPLICATION_DATA_ITERATOR * iterator)
+{
+    return (bool) (iterator && !iterator->malformed &&
+        (iterator->offset < iterator->apdu_len));
+}
+
+bool bacapp_view_decode(
+    BACNET_APPLICATION_DATA_VIEW * view,
+    BACNET_APPLICATION_DATA_VALUE * value)
+{
+    int len = 0;
+
+    if (!view || !value || view->context_specific) {
+        return false;
+    }
+    value->context_specific = false;
+    value->context_tag = 0;
+    value->tag = view->tag;
+    value->next = NULL;
+    len =
+        bacapp_decode_data(view->data, view->tag, view->len_value_type,
+        value);
+
+    return (bool) ((value->tag != MAX_BACNET_APPLICATION_TAG) &&
+        ((uint32_t) len == view->data_len));
+}
+
+int bacapp_compact_from_value(
+    BACNET_COMPACT_VALUE * compact,
+    BACNET_APPLICATION_DATA_VALUE * value,
+    uint8_t * storage,
+    uint32_t storage_size)
+{
+    uint8_t *octets = NULL;
+    uint32_t length = 0;
+    uint8_t encoding = 0;
+    bool string = false;
+
+    if (!compact || !value) {
+        return -1;
+    }
+    compact->context_specific = value->context_specific;
+    compact->context_tag = value->context_tag;
+    compact->tag = value->tag;
+    switch (value->tag) {
+#if defined (BACAPP_NULL)
+        case BACNET_APPLICATION_TAG_NULL:
+            break;
+#endif
+#if defined (BACAPP_BOOLEAN)
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            compact->type.Boolean = value->type.Boolean;
+            break;
+#endif
+#if defined (BACAPP_UNSIGNED)
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            compact->type.Unsigned_Int = value->type.Unsigned_Int;
+            break;
+#endif
+#if defined (BACAPP_SIGNED)
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            compact->type.Signed_Int = value->type.Signed_Int;
+            break;
+#endif
+#if defined (BACAPP_REAL)
+        case BACNET_APPLICATION_TAG_REAL:
+            compact->type.Real = value->type.Real;
+            break;
+#endif
+#if defined (BACAPP_DOUBLE)
+        case BACNET_APPLICATION_TAG_DOUBLE:
+            compact->type.Double = value->type.Double;
+            break;
+#endif
+#if defined (BACAPP_OCTET_STRING)
+        case BACNET_APPLICATION_TAG_OCTET_STRING:
+            octets = octetstring_value(&value->type.Octet_String);
+            length = (uint32_t) octetstring_length(&value->type.Octet_String);
+            string = true;
+            break;
+#endif
+#if defined (BACAPP_CHARACTER_STRING)
+        case BACNET_APPLICATION_TAG_CHARACTER_STRING:
+            octets = (uint8_t *)
+                characterstring_value(&value->type.Character_String);
+            length = (uint32_t)
+                characterstring_length(&value->type.Character_String);
+            encoding =
+                characterstring_encoding(&value->type.Character_String);
+            string = true;
+            break;
+#endif
+#if defined (BACAPP_BIT_STRING)
+        case BACNET_APPLICATION_TAG_BIT_STRING:
+            compact->type.Bit_String = value->type.Bit_String;
+            break;
+#endif
+#if defined (BACAPP_ENUMERATED)
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            compact->type.Enumerated = value->type.Enumerated;
+            break;
+#endif
+#if defined (BACAPP_DATE)
+        case BACNET_APPLICATION_TAG_DATE:
+            compact->type.Date = value->type.Date;
+            break;
+#endif
+#if defined (BACAPP_TIME)
+        case BACNET_APPLICATION_TAG_TIME:
+            compact->type.Time = value->type.Time;
+            break;
+#endif
+#if defined (BACAPP_OBJECT_ID)
+        case BACNET_APPLICATION_TAG_OBJECT_ID:
+            compact->type.Object_Id = value->type.Object_Id;
+            break;
+#endif
+        default:
+            return -1;
+    }
+    if (!string) {
+        return 0;
+    }
+    if (length > storage_size) {
+        return -1;
+    }
+    if (length) {
+        memcpy(storage, octets, length);
+    }
+    compact->type.String.value = storage;
+    compact->type.String.length = length;
+    compact->type.String.encoding = encoding;
+
+    return (int) length;
+}
+
+bool bacapp_compact_from_view(
+    BACNET_COMPACT_VALUE * compact,
+    BACNET_APPLICATION_DATA_VIEW * view)
+{
+    uint8_t *apdu = NULL;
+    uint32_t len_value = 0;
+    uint16_t object_type = 0;
+    int len = 0;
+
+    if (!compact || !view || view->context_specific) {
+        return false;
+    }
+    apdu = view->data;
+    len_value = view->len_value_type;
+    compact->context_specific = false;
+    compact->context_tag = 0;
+    compact->tag = view->tag;
+    switch (view->tag) {
+        case BACNET_APPLICATION_TAG_NULL:
+            break;
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            compact->type.Boolean = decode_boolean(len_value);
+            break;
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            len = decode_unsigned(apdu, len_value,
+                &compact->type.Unsigned_Int);
+            break;
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            len = decode_signed(apdu, len_value, &compact->type.Signed_Int);
+            break;
+        case BACNET_APPLICATION_TAG_REAL:
+            len = decode_real_safe(apdu, len_value, &compact->type.Real);
+            break;
+        case BACNET_APPLICATION_TAG_DOUBLE:
+            len = decode_double_safe(apdu, len_value, &compact->type.Double);
+            break;
+        case BACNET_APPLICATION_TAG_OCTET_STRING:
+            compact->type.String.value = apdu;
+            compact->type.String.length = view->data_len;
+            compact->type.String.encoding = 0;
+            len = (int) view->data_len;
+            break;
+        case BACNET_APPLICATION_TAG_CHARACTER_STRING:
+            /* the first octet is the character set */
+            if (view->data_len == 0) {
+                return false;
+            }
+            compact->type.String.value = &apdu[1];
+            compact->type.String.length = view->data_len - 1;
+            compact->type.String.encoding = apdu[0];
+            len = (int) view->data_len;
+            break;
+        case BACNET_APPLICATION_TAG_BIT_STRING:
+            if (view->data_len > (MAX_BITSTRING_BYTES + 1)) {
+                return false;
+            }
+            len = decode_bitstring(apdu, len_value,
+                &compact->type.Bit_String);
+            break;
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            len = decode_enumerated(apdu, len_value,
+                &compact->type.Enumerated);
+            break;
+        case BACNET_APPLICATION_TAG_DATE:
+            len = decode_date_safe(apdu, len_value, &compact->type.Date);
+            break;
+        case BACNET_APPLICATION_TAG_TIME:
+            len = decode_bacnet_time_safe(apdu, len_value,
+                &compact->type.Time);
+            break;
+        case BACNET_APPLICATION_TAG_OBJECT_ID:
+            len = decode_object_id_safe(apdu, len_value, &object_type,
+                &compact->type.Object_Id.instance);
+            compact->type.Object_Id.type = object_type;
+            break;
+        default:
+            return false;
+    }
+
+    return (bool) ((uint32_t) len == view->data_len);
+}
+
+bool bacapp_compact_to_value(
+    BACNET_COMPACT_VALUE * compact,
+    BACNET_APPLICATION_DATA_VALUE * value)
+{
+    bool status = true;
+
+    if (!compact || !value) {
+        return false;
+    }
+    value->context_specific = compact->context_specific;
+    value->context_tag = compact->context_tag;
+    value->tag = compact->tag;
+    value->next = NULL;
+    switch (compact->tag) {
+#if defined (BACAPP_NULL)
+        case BACNET_APPLICATION_TAG_NULL:
+            break;
+#endif
+#if defined (BACAPP_BOOLEAN)
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            value->type.Boolean = compact->type.Boolean;
+            break;
+#endif
+#if defined (BACAPP_UNSIGNED)
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            value->type.Unsigned_Int = compact->type.Unsigned_Int;
+            break;
+#endif
+#if defined (BACAPP_SIGNED)
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            value->type.Signed_Int = compact->type.Signed_Int;
+            break;
+#endif
+#if defined (BACAPP_REAL)
+        case BACNET_APPLICATION_TAG_REAL:
+            value->type.Real = compact->type.Real;
+            break;
+#endif
+#if defined (BACAPP_DOUBLE)
+        case BACNET_APPLICATION_TAG_DOUBLE:
+            value->type.Double = compact->type.Double;
+            break;
+#endif
+#if defined (BACAPP_OCTET_STRING)
+        case BACNET_APPLICATION_TAG_OCTET_STRING:
+            status =
+                octetstring_init(&value->type.Octet_String,
+                compact->type.String.value, compact->type.String.length);
+            break;
+#endif
+#if defined (BACAPP_CHARACTER_STRING)
+        case BACNET_APPLICATION_TAG_CHARACTER_STRING:
+            status =
+                characterstring_init(&value->type.Character_String,
+                compact->type.String.encoding,
+                (char *) compact->type.String.value,
+                compact->type.String.length);
+            break;
+#endif
+#if defined (BACAPP_BIT_STRING)
+        case BACNET_APPLICATION_TAG_BIT_STRING:
+            value->type.Bit_String = compact->type.Bit_String;
+            break;
+#endif
+#if defined (BACAPP_ENUMERATED)
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            value->type.Enumerated = compact->type.Enumerated;
+            break;
+#endif
+#if defined (BACAPP_DATE)
+        case BACNET_APPLICATION_TAG_DATE:
+            value->type.Date = compact->type.Date;
+            break;
+#endif
+#if defined (BACAPP_TIME)
+        case BACNET_APPLICATION_TAG_TIME:
+            value->type.Time = compact->type.Time;
+            break;
+#endif
+#if defined (BACAPP_OBJECT_ID)
+        case BACNET_APPLICATION_TAG_OBJECT_ID:
+            value->type.Object_Id = compact->type.Object_Id;
+            break;
+#endif
+        default:
+            status = false;
+            break;
+    }
+
+    return status;
+}
+
+/* encodes the strings straight from where they are */
+int bacapp_compact_encode_application_data(
+    uint8_t * apdu,
+    BACNET_COMPACT_VALUE * compact)
+{
+    int apdu_len = 0;   /* total length of the apdu, return value */
+
+    if (!compact || !apdu) {
+        return 0;
+    }
+    switch (compact->tag) {
+        case BACNET_APPLICATION_TAG_NULL:
+            apdu[0] = compact->tag;
+            apdu_len++;
+            break;
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            apdu_len =
+                encode_application_boolean(&apdu[0], compact->type.Boolean);
+            break;
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            apdu_len =
+                encode_application_unsigned(&apdu[0],
+                compact->type.Unsigned_Int);
+            break;
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            apdu_len =
+                encode_application_signed(&apdu[0], compact->type.Signed_Int);
+            break;
+        case BACNET_APPLICATION_TAG_REAL:
+            apdu_len = encode_application_real(&apdu[0], compact->type.Real);
+            break;
+        case BACNET_APPLICATION_TAG_DOUBLE:
+            apdu_len =
+                encode_application_double(&apdu[0], compact->type.Double);
+            break;
+        case BACNET_APPLICATION_TAG_OCTET_STRING:
+            apdu_len =
+                encode_tag(&apdu[0], compact->tag, false,
+                compact->type.String.length);
+            if (compact->type.String.length) {
+                memcpy(&apdu[apdu_len], compact->type.String.value,
+                    compact->type.String.length);
+            }
+            apdu_len += (int) compact->type.String.length;
+            break;
+        case BACNET_APPLICATION_TAG_CHARACTER_STRING:
+            apdu_len =
+                encode_tag(&apdu[0], compact->tag, false,
+                compact->type.String.length + 1);
+            apdu[apdu_len++] = compact->type.String.encoding;
+            if (compact->type.String.length) {
+                memcpy(&apdu[apdu_len], compact->type.String.value,
+                    compact->type.String.length);
+            }
+            apdu_len += (int) compact->type.String.length;
+            break;
+        case BACNET_APPLICATION_TAG_BIT_STRING:
+            apdu_len =
+                encode_application_bitstring(&apdu[0],
+                &compact->type.Bit_String);
+            break;
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            apdu_len =
+                encode_application_enumerated(&apdu[0],
+                compact->type.Enumerated);
+            break;
+        case BACNET_APPLICATION_TAG_DATE:
+            apdu_len =
+                encode_application_date(&apdu[0], &compact->type.Date);
+            break;
+        case BACNET_APPLICATION_TAG_TIME:
+            apdu_len =
+                encode_application_time(&apdu[0], &compact->type.Time);
+            break;
+        case BACNET_APPLICATION_TAG_OBJECT_ID:
+            apdu_len =
+                encode_application_object_id(&apdu[0],
+                (int) compact->type.Object_Id.type,
+                compact->type.Object_Id.instance);
+            break;
+        default:
+            break;
+    }
+
+    return apdu_len;
+}
+
 int bacapp_encode_context_data_value(
     uint8_t * apdu,
     uint8_t context_tag_number,
@@ -967,6 +1431,68 @@ bool bacapp_print_value(
 
     return status;
 }
+
+/* prints the strings from where they are in the buffer, so they can
+   be longer than a BACNET_APPLICATION_DATA_VALUE holds, and prints
+   context specific data in hex */
+bool bacapp_print_view(
+    FILE * stream,
+    BACNET_APPLICATION_DATA_VIEW * view,
+    BACNET_PROPERTY_ID property)
+{
+    BACNET_APPLICATION_DATA_VALUE value;
+    bool status = true; /*return value */
+    uint32_t len = 0, i = 0;
+    uint8_t *octet_str;
+
+    if (!view) {
+        return false;
+    }
+    if (view->opening) {
+        fprintf(stream, "{");
+    } else if (view->closing) {
+        fprintf(stream, "}");
+    } else if (view->context_specific ||
+        (view->tag == BACNET_APPLICATION_TAG_OCTET_STRING)) {
+        octet_str = view->data;
+        for (i = 0; i < view->data_len; i++) {
+            fprintf(stream, "%02X", *octet_str);
+            octet_str++;
+        }
+    } else if (view->tag == BACNET_APPLICATION_TAG_CHARACTER_STRING) {
+        /* the first octet is the character set */
+        fprintf(stream, "\"");
+        for (i = 1; i < view->data_len; i++) {
+            if (isprint(view->data[i])) {
+                fprintf(stream, "%c", view->data[i]);
+            } else {
+                fprintf(stream, ".");
+            }
+        }
+        fprintf(stream, "\"");
+    } else if (view->tag == BACNET_APPLICATION_TAG_BIT_STRING) {
+        /* the first octet is the number of unused bits in the last */
+        if (view->data_len > 1) {
+            len = ((view->data_len - 1) * 8) - (view->data[0] & 0x07);
+        }
+        fprintf(stream, "{");
+        for (i = 0; i < len; i++) {
+            fprintf(stream, "%s",
+                (view->data[1 + (i / 8)] & (0x80 >> (i % 8))) ? "true" :
+                "false");
+            if (i < len - 1)
+                fprintf(stream, ",");
+        }
+        fprintf(stream, "}");
+    } else if (bacapp_view_decode(view, &value)) {
+        /* the rest are small */
+        status = bacapp_print_value(stream, &value, property);
+    } else {
+        status = false;
+    }
+
+    return status;
+}
 #endif
 
 #ifdef BACAPP_PRINT_ENABLED
@@ -1710,6 +2236,261 @@ void testBACnetApplicationData(
 }
 
 
+/* compares what two print functions wrote */
+static bool testBACnetApplicationDataPrinted(
+    BACNET_APPLICATION_DATA_VALUE * value,
+    BACNET_APPLICATION_DATA_VIEW * view)
+{
+    char value_text[512] = "";
+    char view_text[512] = "";
+    FILE *stream;
+
+    stream = tmpfile();
+    if (!stream) {
+        return false;
+    }
+    bacapp_print_value(stream, value, PROP_PRESENT_VALUE);
+    fflush(stream);
+    rewind(stream);
+    fgets(value_text, sizeof(value_text), stream);
+    fclose(stream);
+    stream = tmpfile();
+    if (!stream) {
+        return false;
+    }
+    bacapp_print_view(stream, view, PROP_PRESENT_VALUE);
+    fflush(stream);
+    rewind(stream);
+    fgets(view_text, sizeof(view_text), stream);
+    fclose(stream);
+
+    return (bool) (strcmp(value_text, view_text) == 0);
+}
+
+void testBACnetApplicationDataIterator(
+    Test * pTest)
+{
+    uint8_t apdu[MAX_APDU];
+    char text[301];
+    BACNET_APPLICATION_DATA_ITERATOR iterator;
+    BACNET_APPLICATION_DATA_VIEW view;
+    BACNET_APPLICATION_DATA_VALUE value;
+    BACNET_APPLICATION_DATA_VALUE test_value;
+    BACNET_CHARACTER_STRING char_string;
+    int apdu_len = 0;
+    int len = 0;
+    int text_len = 0;
+    unsigned i = 0;
+
+    /* a string longer than 255 octets */
+    for (i = 0; i < (sizeof(text) - 1); i++) {
+        text[i] = (char) ('a' + (i % 26));
+    }
+    text[i] = 0;
+    characterstring_init_ansi(&char_string, text);
+    text_len = encode_application_character_string(&apdu[apdu_len],
+        &char_string);
+    apdu_len += text_len;
+    value.tag = BACNET_APPLICATION_TAG_REAL;
+    value.type.Real = 3.5F;
+    apdu_len += bacapp_encode_application_data(&apdu[apdu_len], &value);
+    apdu_len += encode_application_boolean(&apdu[apdu_len], true);
+    apdu_len += encode_opening_tag(&apdu[apdu_len], 3);
+    apdu_len += encode_context_boolean(&apdu[apdu_len], 0, true);
+    apdu_len += encode_closing_tag(&apdu[apdu_len], 3);
+    value.tag = BACNET_APPLICATION_TAG_UNSIGNED_INT;
+    value.type.Unsigned_Int = 70000;
+    apdu_len += bacapp_encode_application_data(&apdu[apdu_len], &value);
+
+    bacapp_iterator_init(&iterator, &apdu[0], (uint32_t) apdu_len);
+    ct_test(pTest, bacapp_iterator_next(&iterator, &view));
+    ct_test(pTest, !view.context_specific);
+    ct_test(pTest, view.tag == BACNET_APPLICATION_TAG_CHARACTER_STRING);
+    ct_test(pTest, view.data_len == 301);
+    ct_test(pTest, view.data[0] == CHARACTER_ANSI_X34);
+    ct_test(pTest, memcmp(&view.data[1], text, 300) == 0);
+    ct_test(pTest, (view.data + view.data_len) == &apdu[text_len]);
+    ct_test(pTest, bacapp_view_decode(&view, &test_value));
+    ct_test(pTest, characterstring_length(&test_value.type.Character_String)
+        == 300);
+    ct_test(pTest, testBACnetApplicationDataPrinted(&test_value, &view));
+    ct_test(pTest, bacapp_iterator_more(&iterator));
+
+    ct_test(pTest, bacapp_iterator_next(&iterator, &view));
+    ct_test(pTest, view.tag == BACNET_APPLICATION_TAG_REAL);
+    ct_test(pTest, view.data_len == 4);
+    ct_test(pTest, bacapp_view_decode(&view, &test_value));
+    ct_test(pTest, test_value.type.Real == 3.5F);
+
+    ct_test(pTest, bacapp_iterator_next(&iterator, &view));
+    ct_test(pTest, view.tag == BACNET_APPLICATION_TAG_BOOLEAN);
+    ct_test(pTest, view.len_value_type == 1);
+    ct_test(pTest, view.data_len == 0);
+    ct_test(pTest, bacapp_view_decode(&view, &test_value));
+    ct_test(pTest, test_value.type.Boolean == true);
+
+    ct_test(pTest, bacapp_iterator_next(&iterator, &view));
+    ct_test(pTest, view.context_specific && view.opening && !view.closing);
+    ct_test(pTest, view.tag == 3);
+    ct_test(pTest, view.data_len == 0);
+    /* a context BOOLEAN has its value in a content octet */
+    ct_test(pTest, bacapp_iterator_next(&iterator, &view));
+    ct_test(pTest, view.context_specific && !view.opening && !view.closing);
+    ct_test(pTest, view.tag == 0);
+    ct_test(pTest, view.data_len == 1);
+    ct_test(pTest, view.data[0] == 1);
+    ct_test(pTest, !bacapp_view_decode(&view, &test_value));
+    ct_test(pTest, bacapp_iterator_next(&iterator, &view));
+    ct_test(pTest, view.context_specific && view.closing && !view.opening);
+    ct_test(pTest, view.tag == 3);
+
+    ct_test(pTest, bacapp_iterator_next(&iterator, &view));
+    ct_test(pTest, view.tag == BACNET_APPLICATION_TAG_UNSIGNED_INT);
+    ct_test(pTest, bacapp_view_decode(&view, &test_value));
+    ct_test(pTest, test_value.type.Unsigned_Int == 70000);
+    ct_test(pTest, !bacapp_iterator_more(&iterator));
+    ct_test(pTest, !bacapp_iterator_next(&iterator, &view));
+    ct_test(pTest, !iterator.malformed);
+
+    /* the data of the last tag runs past the end */
+    bacapp_iterator_init(&iterator, &apdu[0], (uint32_t) apdu_len - 1);
+    for (i = 0; bacapp_iterator_next(&iterator, &view); i++) {
+        /* count them */
+    }
+    ct_test(pTest, i == 6);
+    ct_test(pTest, iterator.malformed);
+    /* the length of the string runs past the end */
+    bacapp_iterator_init(&iterator, &apdu[0], 200);
+    ct_test(pTest, !bacapp_iterator_next(&iterator, &view));
+    ct_test(pTest, iterator.malformed);
+    /* an extended length that is cut off */
+    bacapp_iterator_init(&iterator, &apdu[0], 2);
+    ct_test(pTest, !bacapp_iterator_next(&iterator, &view));
+    ct_test(pTest, iterator.malformed);
+    bacapp_iterator_init(&iterator, NULL, 10);
+    ct_test(pTest, !bacapp_iterator_next(&iterator, &view));
+    ct_test(pTest, !iterator.malformed);
+
+    /* the views print the same as the values */
+    value.tag = BACNET_APPLICATION_TAG_OCTET_STRING;
+    octetstring_init(&value.type.Octet_String, (uint8_t *) "\x01\xAB\x7F",
+        3);
+    len = bacapp_encode_application_data(&apdu[0], &value);
+    bacapp_iterator_init(&iterator, &apdu[0], (uint32_t) len);
+    ct_test(pTest, bacapp_iterator_next(&iterator, &view));
+    ct_test(pTest, testBACnetApplicationDataPrinted(&value, &view));
+    value.tag = BACNET_APPLICATION_TAG_BIT_STRING;
+    bitstring_init(&value.type.Bit_String);
+    for (i = 0; i < 11; i++) {
+        bitstring_set_bit(&value.type.Bit_String, (uint8_t) i,
+            (i % 3) ? true : false);
+    }
+    len = bacapp_encode_application_data(&apdu[0], &value);
+    bacapp_iterator_init(&iterator, &apdu[0], (uint32_t) len);
+    ct_test(pTest, bacapp_iterator_next(&iterator, &view));
+    ct_test(pTest, testBACnetApplicationDataPrinted(&value, &view));
+    value.tag = BACNET_APPLICATION_TAG_ENUMERATED;
+    value.type.Enumerated = 1;
+    len = bacapp_encode_application_data(&apdu[0], &value);
+    bacapp_iterator_init(&iterator, &apdu[0], (uint32_t) len);
+    ct_test(pTest, bacapp_iterator_next(&iterator, &view));
+    ct_test(pTest, testBACnetApplicationDataPrinted(&value, &view));
+
+    return;
+}
+
+void testBACnetCompactValue(
+    Test * pTest)
+{
+    static const char *values[] = {
+        "", "1", "70000", "-70000", "3.5", "-1234.5625",
+        "00FFA5", "Hello World, this is quite a long string", "10110",
+        "85", "2009/6/15:1", "23:59:58.99", "8:4194302"
+    };
+    uint8_t apdu[MAX_APDU];
+    uint8_t test_apdu[MAX_APDU];
+    uint8_t storage[64];
+    BACNET_APPLICATION_DATA_ITERATOR iterator;
+    BACNET_APPLICATION_DATA_VIEW view;
+    BACNET_APPLICATION_DATA_VALUE value;
+    BACNET_APPLICATION_DATA_VALUE test_value;
+    BACNET_COMPACT_VALUE compact;
+    BACNET_COMPACT_VALUE test_compact;
+    int apdu_len = 0;
+    int test_len = 0;
+    int used = 0;
+    uint8_t tag = 0;
+
+    /* the point of it */
+    ct_test(pTest, sizeof(BACNET_COMPACT_VALUE) <= 32);
+    for (tag = 0; tag <= BACNET_APPLICATION_TAG_OBJECT_ID; tag++) {
+        if (tag == BACNET_APPLICATION_TAG_BIT_STRING) {
+            /* there is no parser for them */
+            value.tag = tag;
+            bitstring_init(&value.type.Bit_String);
+            for (test_len = 0; values[tag][test_len]; test_len++) {
+                bitstring_set_bit(&value.type.Bit_String, (uint8_t) test_len,
+                    (values[tag][test_len] == '1') ? true : false);
+            }
+        } else {
+            ct_test(pTest, bacapp_parse_application_data(
+                    (BACNET_APPLICATION_TAG) tag, values[tag], &value));
+        }
+        value.context_specific = false;
+        value.context_tag = 0;
+        apdu_len = bacapp_encode_application_data(&apdu[0], &value);
+        ct_test(pTest, apdu_len > 0);
+        /* from the big value, with the strings copied */
+        memset(storage, 0, sizeof(storage));
+        used = bacapp_compact_from_value(&compact, &value, &storage[0],
+            sizeof(storage));
+        ct_test(pTest, used >= 0);
+        if ((tag == BACNET_APPLICATION_TAG_OCTET_STRING) ||
+            (tag == BACNET_APPLICATION_TAG_CHARACTER_STRING)) {
+            ct_test(pTest, used > 0);
+            ct_test(pTest, compact.type.String.value == &storage[0]);
+            /* no room, and no storage */
+            ct_test(pTest, bacapp_compact_from_value(&test_compact, &value,
+                    &storage[0], (uint32_t) used - 1) == -1);
+            ct_test(pTest, bacapp_compact_from_value(&test_compact, &value,
+                    NULL, 0) == -1);
+        } else {
+            ct_test(pTest, used == 0);
+            ct_test(pTest, bacapp_compact_from_value(&test_compact, &value,
+                    NULL, 0) == 0);
+        }
+        /* encodes the same */
+        test_len = bacapp_compact_encode_application_data(&test_apdu[0],
+            &compact);
+        ct_test(pTest, test_len == apdu_len);
+        ct_test(pTest, memcmp(apdu, test_apdu, (size_t) apdu_len) == 0);
+        /* and converts back */
+        ct_test(pTest, bacapp_compact_to_value(&compact, &test_value));
+        ct_test(pTest, bacapp_same_value(&value, &test_value));
+        /* from the encoding, with the strings left where they are */
+        bacapp_iterator_init(&iterator, &apdu[0], (uint32_t) apdu_len);
+        ct_test(pTest, bacapp_iterator_next(&iterator, &view));
+        ct_test(pTest, bacapp_compact_from_view(&test_compact, &view));
+        ct_test(pTest, test_compact.tag == tag);
+        if (tag == BACNET_APPLICATION_TAG_OCTET_STRING) {
+            ct_test(pTest, test_compact.type.String.value == view.data);
+        } else if (tag == BACNET_APPLICATION_TAG_CHARACTER_STRING) {
+            ct_test(pTest, test_compact.type.String.value == &view.data[1]);
+            ct_test(pTest, test_compact.type.String.encoding ==
+                CHARACTER_ANSI_X34);
+        }
+        ct_test(pTest, bacapp_compact_to_value(&test_compact, &test_value));
+        ct_test(pTest, bacapp_same_value(&value, &test_value));
+    }
+    /* context data needs to know the property */
+    apdu_len = encode_context_unsigned(&apdu[0], 1, 5);
+    bacapp_iterator_init(&iterator, &apdu[0], (uint32_t) apdu_len);
+    ct_test(pTest, bacapp_iterator_next(&iterator, &view));
+    ct_test(pTest, !bacapp_compact_from_view(&test_compact, &view));
+
+    return;
+}
+
 #ifdef TEST_BACNET_APPLICATION_DATA
 int main(
     void)
@@ -1725,6 +2506,10 @@ int main(
     assert(rc);
     rc = ct_addTestFunction(pTest, testBACnetApplicationData_Safe);
     assert(rc);
+    rc = ct_addTestFunction(pTest, testBACnetApplicationDataIterator);
+    assert(rc);
+    rc = ct_addTestFunction(pTest, testBACnetCompactValue);
+    assert(rc);
 
     ct_setStream(pTest, stdout);
     ct_run(pTest);
@@ -89,6 +89,33 @@
 */
 
 
+#if BACNET_FAST_CODEC
+/* What the first octet of a tag says: the length/value/type field as
+   a value, 0 for opening and closing tags, and flags for the extended
+   tag number and extended length octets that follow it */
+#define TAG_INFO_EXTENDED_NUMBER 0x10
+#define TAG_INFO_EXTENDED_VALUE 0x20
+#define TAG_INFO(x) \
+    ((((x) & 0x07) <= 4 ? ((x) & 0x07) : \
+    (((x) & 0x07) == 5 ? TAG_INFO_EXTENDED_VALUE : 0)) | \
+    (((x) & 0xF0) == 0xF0 ? TAG_INFO_EXTENDED_NUMBER : 0))
+#define TAG_INFO_4(x) \
+    TAG_INFO(x), TAG_INFO((x) + 1), TAG_INFO((x) + 2), TAG_INFO((x) + 3)
+#define TAG_INFO_16(x) \
+    TAG_INFO_4(x), TAG_INFO_4((x) + 4), TAG_INFO_4((x) + 8), \
+    TAG_INFO_4((x) + 12)
+#define TAG_INFO_64(x) \
+    TAG_INFO_16(x), TAG_INFO_16((x) + 16), TAG_INFO_16((x) + 32), \
+    TAG_INFO_16((x) + 48)
+
+static const uint8_t Tag_Info[256] = {
+    TAG_INFO_64(0x00), TAG_INFO_64(0x40), TAG_INFO_64(0x80), TAG_INFO_64(0xC0)
+};
+
+/* the first octet of an application tag with 0 to 4 octets of value */
+#define APPLICATION_TAG_OCTET(tag, len) ((uint8_t) (((tag) << 4) | (len)))
+#endif
+
 /* from clause 20.1.2.4 max-segments-accepted */
 /* and clause 20.1.2.5 max-APDU-length-accepted */
 /* returns the encoded octet */
@@ -373,7 +400,43 @@ int decode_tag_number_and_value(
     int len = 1;
     uint16_t value16;
     uint32_t value32;
+#if BACNET_FAST_CODEC
+    uint8_t info = Tag_Info[apdu[0]];
 
+    if (info & TAG_INFO_EXTENDED_NUMBER) {
+        if (tag_number) {
+            *tag_number = apdu[1];
+        }
+        len = 2;
+    } else if (tag_number) {
+        *tag_number = (uint8_t) (apdu[0] >> 4);
+    }
+    if (info & TAG_INFO_EXTENDED_VALUE) {
+        if (apdu[len] == 255) {
+            len++;
+            len += decode_unsigned32(&apdu[len], &value32);
+            if (value) {
+                *value = value32;
+            }
+        } else if (apdu[len] == 254) {
+            len++;
+            len += decode_unsigned16(&apdu[len], &value16);
+            if (value) {
+                *value = value16;
+            }
+        } else {
+            if (value) {
+                *value = apdu[len];
+            }
+            len++;
+        }
+    } else if (value) {
+        /* small value, or 0 for opening and closing tags */
+        *value = info & 0x07;
+    }
+
+    return len;
+#else
     len = decode_tag_number(&apdu[0], tag_number);
     if (IS_EXTENDED_VALUE(apdu[0])) {
         /* tagged as uint32_t */
@@ -410,6 +473,7 @@ int decode_tag_number_and_value(
     }
 
     return len;
+#endif
 }
 
 /* Same as function above, but will safely fail is packet has been truncated */
@@ -427,7 +491,7 @@ int decode_tag_number_and_value_safe(
         apdu_len_remaining -= len;
         if (IS_EXTENDED_VALUE(apdu[0])) {
             /* tagged as uint32_t */
-            if (apdu[len] == 255 && apdu_len_remaining >= 5) {
+            if (apdu_len_remaining >= 5 && apdu[len] == 255) {
                 uint32_t value32;
                 len++;
                 len += decode_unsigned32(&apdu[len], &value32);
@@ -436,7 +500,7 @@ int decode_tag_number_and_value_safe(
                 }
             }
             /* tagged as uint16_t */
-            else if (apdu[len] == 254 && apdu_len_remaining >= 3) {
+            else if (apdu_len_remaining >= 3 && apdu[len] == 254) {
                 uint16_t value16;
                 len++;
                 len += decode_unsigned16(&apdu[len], &value16);
@@ -445,7 +509,7 @@ int decode_tag_number_and_value_safe(
                 }
             }
             /* no tag - must be uint8_t */
-            else if (apdu[len] < 254 && apdu_len_remaining >= 1) {
+            else if (apdu_len_remaining >= 1 && apdu[len] < 254) {
                 if (value) {
                     *value = apdu[len];
                 }
@@ -863,9 +927,14 @@ int encode_application_object_id(
 
     /* assumes that the tag only consumes 1 octet */
     len = encode_bacnet_object_id(&apdu[1], object_type, instance);
+#if BACNET_FAST_CODEC
+    apdu[0] = APPLICATION_TAG_OCTET(BACNET_APPLICATION_TAG_OBJECT_ID, len);
+    len++;
+#else
     len +=
         encode_tag(&apdu[0], BACNET_APPLICATION_TAG_OBJECT_ID, false,
         (uint32_t) len);
+#endif
 
     return len;
 }
@@ -1105,12 +1174,30 @@ int decode_unsigned(
     uint32_t * value)
 {
     uint16_t unsigned16_value = 0;
+#if BACNET_FAST_CODEC
+    uint32_t unsigned32_value = 0;
+#endif
 
     if (value) {
         switch (len_value) {
             case 1:
                 *value = apdu[0];
                 break;
+#if BACNET_FAST_CODEC
+            case 2:
+                memcpy(&unsigned16_value, apdu, 2);
+                *value = BACNET_ORDER16(unsigned16_value);
+                break;
+            case 3:
+                *value =
+                    ((uint32_t) apdu[0] << 16) | ((uint32_t) apdu[1] << 8) |
+                    apdu[2];
+                break;
+            case 4:
+                memcpy(&unsigned32_value, apdu, 4);
+                *value = BACNET_ORDER32(unsigned32_value);
+                break;
+#else
             case 2:
                 decode_unsigned16(&apdu[0], &unsigned16_value);
                 *value = unsigned16_value;
@@ -1121,6 +1208,7 @@ int decode_unsigned(
             case 4:
                 decode_unsigned32(&apdu[0], value);
                 break;
+#endif
             default:
                 *value = 0;
                 break;
@@ -1209,9 +1297,15 @@ int encode_application_unsigned(
     int len = 0;
 
     len = encode_bacnet_unsigned(&apdu[1], value);
+#if BACNET_FAST_CODEC
+    apdu[0] =
+        APPLICATION_TAG_OCTET(BACNET_APPLICATION_TAG_UNSIGNED_INT, len);
+    len++;
+#else
     len +=
         encode_tag(&apdu[0], BACNET_APPLICATION_TAG_UNSIGNED_INT, false,
         (uint32_t) len);
+#endif
 
     return len;
 }
@@ -1275,9 +1369,14 @@ int encode_application_enumerated(
 
     /* assumes that the tag only consumes 1 octet */
     len = encode_bacnet_enumerated(&apdu[1], value);
+#if BACNET_FAST_CODEC
+    apdu[0] = APPLICATION_TAG_OCTET(BACNET_APPLICATION_TAG_ENUMERATED, len);
+    len++;
+#else
     len +=
         encode_tag(&apdu[0], BACNET_APPLICATION_TAG_ENUMERATED, false,
         (uint32_t) len);
+#endif
 
     return len;
 }
@@ -1396,9 +1495,14 @@ int encode_application_signed(
 
     /* assumes that the tag only consumes 1 octet */
     len = encode_bacnet_signed(&apdu[1], value);
+#if BACNET_FAST_CODEC
+    apdu[0] = APPLICATION_TAG_OCTET(BACNET_APPLICATION_TAG_SIGNED_INT, len);
+    len++;
+#else
     len +=
         encode_tag(&apdu[0], BACNET_APPLICATION_TAG_SIGNED_INT, false,
         (uint32_t) len);
+#endif
 
     return len;
 }
@@ -1441,9 +1545,14 @@ int encode_application_real(
 
     /* assumes that the tag only consumes 1 octet */
     len = encode_bacnet_real(value, &apdu[1]);
+#if BACNET_FAST_CODEC
+    apdu[0] = APPLICATION_TAG_OCTET(BACNET_APPLICATION_TAG_REAL, len);
+    len++;
+#else
     len +=
         encode_tag(&apdu[0], BACNET_APPLICATION_TAG_REAL, false,
         (uint32_t) len);
+#endif
 
     return len;
 }
@@ -1884,6 +1993,65 @@ void testBACDCodeTags(
     return;
 }
 
+/* every first octet decodes as clause 20.2.1 says it should */
+void testBACDCodeTagOctets(
+    Test * pTest)
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    unsigned octet = 0;
+    unsigned extended = 0;
+    uint8_t tag_number = 0;
+    uint32_t value = 0;
+    uint8_t test_tag_number = 0;
+    uint32_t test_value = 0;
+    int len = 0;
+    int test_len = 0;
+    /* the extended length octet */
+    uint8_t length_octets[3] = { 200, 254, 255 };
+
+    for (octet = 0; octet < 256; octet++) {
+        for (extended = 0; extended < 3; extended++) {
+            apdu[0] = (uint8_t) octet;
+            test_len = 1;
+            if ((octet >> 4) == 15) {
+                apdu[test_len++] = 77;
+                test_tag_number = 77;
+            } else {
+                test_tag_number = (uint8_t) (octet >> 4);
+            }
+            apdu[test_len] = length_octets[extended];
+            apdu[test_len + 1] = 0x12;
+            apdu[test_len + 2] = 0x34;
+            apdu[test_len + 3] = 0x56;
+            apdu[test_len + 4] = 0x78;
+            if ((octet & 0x07) <= 4) {
+                test_value = octet & 0x07;
+            } else if ((octet & 0x07) == 5) {
+                if (apdu[test_len] == 255) {
+                    test_value = 0x12345678UL;
+                    test_len += 5;
+                } else if (apdu[test_len] == 254) {
+                    test_value = 0x1234;
+                    test_len += 3;
+                } else {
+                    test_value = apdu[test_len];
+                    test_len += 1;
+                }
+            } else {
+                /* opening and closing tags */
+                test_value = 0;
+            }
+            len = decode_tag_number_and_value(&apdu[0], &tag_number, &value);
+            ct_test(pTest, len == test_len);
+            ct_test(pTest, tag_number == test_tag_number);
+            ct_test(pTest, value == test_value);
+            /* the same without the tag number or value */
+            ct_test(pTest, decode_tag_number_and_value(&apdu[0], NULL,
+                    NULL) == test_len);
+        }
+    }
+}
+
 void testBACDCodeEnumerated(
     Test * pTest)
 {
@@ -2998,6 +3166,8 @@ int main(
     /* individual tests */
     rc = ct_addTestFunction(pTest, testBACDCodeTags);
     assert(rc);
+    rc = ct_addTestFunction(pTest, testBACDCodeTagOctets);
+    assert(rc);
     rc = ct_addTestFunction(pTest, testBACDCodeReal);
     assert(rc);
     rc = ct_addTestFunction(pTest, testBACDCodeUnsigned);
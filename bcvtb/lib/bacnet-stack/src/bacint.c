@@ -36,14 +36,21 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "config.h"
+#include "bacint.h"
 
 int encode_unsigned16(
     uint8_t * apdu,
     uint16_t value)
 {
+#if BACNET_FAST_CODEC
+    value = BACNET_ORDER16(value);
+    memcpy(apdu, &value, 2);
+#else
     apdu[0] = (uint8_t) ((value & 0xff00) >> 8);
     apdu[1] = (uint8_t) (value & 0x00ff);
+#endif
 
     return 2;
 }
@@ -52,10 +59,19 @@ int decode_unsigned16(
     uint8_t * apdu,
     uint16_t * value)
 {
+#if BACNET_FAST_CODEC
+    uint16_t value16;
+
+    if (value) {
+        memcpy(&value16, apdu, 2);
+        *value = BACNET_ORDER16(value16);
+    }
+#else
     if (value) {
         *value = (uint16_t) ((((uint16_t) apdu[0]) << 8) & 0xff00);
         *value |= ((uint16_t) (((uint16_t) apdu[1]) & 0x00ff));
     }
+#endif
 
     return 2;
 }
@@ -88,10 +104,15 @@ int encode_unsigned32(
     uint8_t * apdu,
     uint32_t value)
 {
+#if BACNET_FAST_CODEC
+    value = BACNET_ORDER32(value);
+    memcpy(apdu, &value, 4);
+#else
     apdu[0] = (uint8_t) ((value & 0xff000000) >> 24);
     apdu[1] = (uint8_t) ((value & 0x00ff0000) >> 16);
     apdu[2] = (uint8_t) ((value & 0x0000ff00) >> 8);
     apdu[3] = (uint8_t) (value & 0x000000ff);
+#endif
 
     return 4;
 }
@@ -100,12 +121,21 @@ int decode_unsigned32(
     uint8_t * apdu,
     uint32_t * value)
 {
+#if BACNET_FAST_CODEC
+    uint32_t value32;
+
+    if (value) {
+        memcpy(&value32, apdu, 4);
+        *value = BACNET_ORDER32(value32);
+    }
+#else
     if (value) {
         *value = ((uint32_t) ((((uint32_t) apdu[0]) << 24) & 0xff000000));
         *value |= ((uint32_t) ((((uint32_t) apdu[1]) << 16) & 0x00ff0000));
         *value |= ((uint32_t) ((((uint32_t) apdu[2]) << 8) & 0x0000ff00));
         *value |= ((uint32_t) (((uint32_t) apdu[3]) & 0x000000ff));
     }
+#endif
 
     return 4;
 }
@@ -195,18 +225,25 @@ int encode_signed32(
     uint8_t * apdu,
     int32_t value)
 {
+#if BACNET_FAST_CODEC
+    return encode_unsigned32(apdu, (uint32_t) value);
+#else
     apdu[0] = (uint8_t) ((value & 0xff000000) >> 24);
     apdu[1] = (uint8_t) ((value & 0x00ff0000) >> 16);
     apdu[2] = (uint8_t) ((value & 0x0000ff00) >> 8);
     apdu[3] = (uint8_t) (value & 0x000000ff);
 
     return 4;
+#endif
 }
 
 int decode_signed32(
     uint8_t * apdu,
     int32_t * value)
 {
+#if BACNET_FAST_CODEC
+    return decode_unsigned32(apdu, (uint32_t *) value);
+#else
     if (value) {
         *value = ((int32_t) ((((int32_t) apdu[0]) << 24) & 0xff000000));
         *value |= ((int32_t) ((((int32_t) apdu[1]) << 16) & 0x00ff0000));
@@ -215,6 +252,7 @@ int decode_signed32(
     }
 
     return 4;
+#endif
 }
 
 /* end of decoding_encoding.c */
@@ -345,6 +383,32 @@ void testBACnetSigned32(
     }
 }
 
+/* the APDU is big-endian whatever the order of the host */
+void testBACnetIntegerOrder(
+    Test * pTest)
+{
+    uint8_t apdu[32] = { 0 };
+    uint16_t value16 = 0;
+    uint32_t value32 = 0;
+    int32_t signed32 = 0;
+
+    encode_unsigned16(&apdu[1], 0x0102);
+    ct_test(pTest, (apdu[1] == 0x01) && (apdu[2] == 0x02));
+    decode_unsigned16(&apdu[1], &value16);
+    ct_test(pTest, value16 == 0x0102);
+    /* odd addresses, in case the host minds */
+    encode_unsigned32(&apdu[3], 0x01020304UL);
+    ct_test(pTest, (apdu[3] == 0x01) && (apdu[4] == 0x02) &&
+        (apdu[5] == 0x03) && (apdu[6] == 0x04));
+    decode_unsigned32(&apdu[3], &value32);
+    ct_test(pTest, value32 == 0x01020304UL);
+    encode_signed32(&apdu[7], -2);
+    ct_test(pTest, (apdu[7] == 0xFF) && (apdu[8] == 0xFF) &&
+        (apdu[9] == 0xFF) && (apdu[10] == 0xFE));
+    decode_signed32(&apdu[7], &signed32);
+    ct_test(pTest, signed32 == -2);
+}
+
 #ifdef TEST_BACINT
 int main(
     void)
@@ -368,6 +432,8 @@ int main(
     assert(rc);
     rc = ct_addTestFunction(pTest, testBACnetSigned32);
     assert(rc);
+    rc = ct_addTestFunction(pTest, testBACnetIntegerOrder);
+    assert(rc);
     /* configure output */
     ct_setStream(pTest, stdout);
     ct_run(pTest);
@@ -54,13 +54,21 @@ int decode_real(
     uint8_t * apdu,
     float *real_value)
 {
+#if BACNET_FAST_CODEC
+    uint32_t value;
+
+    /* NOTE: assumes the compiler stores float as IEEE-754 float */
+    memcpy(&value, apdu, 4);
+    value = BACNET_ORDER32(value);
+    memcpy(real_value, &value, 4);
+#else
     union {
         uint8_t byte[4];
         float real_value;
     } my_data;
 
     /* NOTE: assumes the compiler stores float as IEEE-754 float */
-#if BIG_ENDIAN
+#if BACNET_BIG_ENDIAN
     my_data.byte[0] = apdu[0];
     my_data.byte[1] = apdu[1];
     my_data.byte[2] = apdu[2];
@@ -73,6 +81,7 @@ int decode_real(
 #endif
 
     *real_value = my_data.real_value;
+#endif
 
     return 4;
 }
@@ -114,6 +123,14 @@ int encode_bacnet_real(
     float value,
     uint8_t * apdu)
 {
+#if BACNET_FAST_CODEC
+    uint32_t real_value;
+
+    /* NOTE: assumes the compiler stores float as IEEE-754 float */
+    memcpy(&real_value, &value, 4);
+    real_value = BACNET_ORDER32(real_value);
+    memcpy(apdu, &real_value, 4);
+#else
     union {
         uint8_t byte[4];
         float real_value;
@@ -121,7 +138,7 @@ int encode_bacnet_real(
 
     /* NOTE: assumes the compiler stores float as IEEE-754 float */
     my_data.real_value = value;
-#if BIG_ENDIAN
+#if BACNET_BIG_ENDIAN
     apdu[0] = my_data.byte[0];
     apdu[1] = my_data.byte[1];
     apdu[2] = my_data.byte[2];
@@ -131,6 +148,7 @@ int encode_bacnet_real(
     apdu[1] = my_data.byte[2];
     apdu[2] = my_data.byte[1];
     apdu[3] = my_data.byte[0];
+#endif
 #endif
 
     return 4;
@@ -142,13 +160,29 @@ int decode_double(
     uint8_t * apdu,
     double *double_value)
 {
+#if BACNET_FAST_CODEC
+    uint32_t value[2];
+#if !BACNET_BIG_ENDIAN
+    uint32_t swap;
+#endif
+
+    /* NOTE: assumes the compiler stores double as IEEE-754 double,
+       in the same word order as its integers */
+    memcpy(&value[0], apdu, 8);
+#if !BACNET_BIG_ENDIAN
+    swap = BACNET_ORDER32(value[0]);
+    value[0] = BACNET_ORDER32(value[1]);
+    value[1] = swap;
+#endif
+    memcpy(double_value, &value[0], 8);
+#else
     union {
         uint8_t byte[8];
         double double_value;
     } my_data;
 
     /* NOTE: assumes the compiler stores float as IEEE-754 float */
-#if BIG_ENDIAN
+#if BACNET_BIG_ENDIAN
     my_data.byte[0] = apdu[0];
     my_data.byte[1] = apdu[1];
     my_data.byte[2] = apdu[2];
@@ -169,6 +203,7 @@ int decode_double(
 #endif
 
     *double_value = my_data.double_value;
+#endif
 
     return 8;
 }
@@ -192,6 +227,22 @@ int encode_bacnet_double(
     double value,
     uint8_t * apdu)
 {
+#if BACNET_FAST_CODEC
+    uint32_t double_value[2];
+#if !BACNET_BIG_ENDIAN
+    uint32_t swap;
+#endif
+
+    /* NOTE: assumes the compiler stores double as IEEE-754 double,
+       in the same word order as its integers */
+    memcpy(&double_value[0], &value, 8);
+#if !BACNET_BIG_ENDIAN
+    swap = BACNET_ORDER32(double_value[0]);
+    double_value[0] = BACNET_ORDER32(double_value[1]);
+    double_value[1] = swap;
+#endif
+    memcpy(apdu, &double_value[0], 8);
+#else
     union {
         uint8_t byte[8];
         double double_value;
@@ -199,7 +250,7 @@ int encode_bacnet_double(
 
     /* NOTE: assumes the compiler stores float as IEEE-754 float */
     my_data.double_value = value;
-#if BIG_ENDIAN
+#if BACNET_BIG_ENDIAN
     apdu[0] = my_data.byte[0];
     apdu[1] = my_data.byte[1];
     apdu[2] = my_data.byte[2];
@@ -217,6 +268,7 @@ int encode_bacnet_double(
     apdu[5] = my_data.byte[2];
     apdu[6] = my_data.byte[1];
     apdu[7] = my_data.byte[0];
+#endif
 #endif
 
     return 8;
@@ -275,6 +327,29 @@ void testBACdouble(
     ct_test(pTest, test_double_value == double_value);
 }
 
+/* the APDU is big-endian whatever the order of the host */
+void testBACrealOrder(
+    Test * pTest)
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    uint8_t real_apdu[4] = { 0xC0, 0x49, 0x0F, 0xD0 };
+    uint8_t double_apdu[8] = { 0x40, 0x09, 0x21, 0xFB,
+        0x54, 0x44, 0x2D, 0x18
+    };
+    float real_value = 0.0;
+    double double_value = 0.0;
+
+    /* odd addresses, in case the host minds */
+    encode_bacnet_real(-3.14159F, &apdu[1]);
+    ct_test(pTest, memcmp(&apdu[1], real_apdu, 4) == 0);
+    decode_real(&apdu[1], &real_value);
+    ct_test(pTest, real_value == -3.14159F);
+    encode_bacnet_double(3.141592653589793, &apdu[5]);
+    ct_test(pTest, memcmp(&apdu[5], double_apdu, 8) == 0);
+    decode_double(&apdu[5], &double_value);
+    ct_test(pTest, double_value == 3.141592653589793);
+}
+
 #ifdef TEST_BACNET_REAL
 int main(
     void)
@@ -288,6 +363,8 @@ int main(
     assert(rc);
     rc = ct_addTestFunction(pTest, testBACdouble);
     assert(rc);
+    rc = ct_addTestFunction(pTest, testBACrealOrder);
+    assert(rc);
 
     /* configure output */
     ct_setStream(pTest, stdout);
@@ -240,18 +240,21 @@ INDTEXT_DATA bacnet_object_type_names[] = {
    the procedures and constraints described in Clause 23. */
 };
 
+static INDTEXT_INDEX Object_Type_Index =
+    INDTEXT_INDEX_INITIALIZER(bacnet_object_type_names);
+
 const char *bactext_object_type_name(
     unsigned index)
 {
-    return indtext_by_index_split_default(bacnet_object_type_names, index, 128,
-        ASHRAE_Reserved_String, Vendor_Proprietary_String);
+    return indtext_index_by_index_split_default(&Object_Type_Index,
+        index, 128, ASHRAE_Reserved_String, Vendor_Proprietary_String);
 }
 
 bool bactext_object_type_index(
     const char *search_name,
     unsigned *found_index)
 {
-    return indtext_by_istring(bacnet_object_type_names, search_name,
+    return indtext_index_by_istring(&Object_Type_Index, search_name,
         found_index);
 }
 
@@ -918,24 +921,28 @@ INDTEXT_DATA bacnet_property_names[] = {
        procedures and constraints described in Clause 23. */
 };
 
+static INDTEXT_INDEX Property_Index =
+    INDTEXT_INDEX_INITIALIZER(bacnet_property_names);
+
 const char *bactext_property_name(
     unsigned index)
 {
-    return indtext_by_index_split_default(bacnet_property_names, index, 512,
-        ASHRAE_Reserved_String, Vendor_Proprietary_String);
+    return indtext_index_by_index_split_default(&Property_Index, index,
+        512, ASHRAE_Reserved_String, Vendor_Proprietary_String);
 }
 
 unsigned bactext_property_id(
     const char *name)
 {
-    return indtext_by_istring_default(bacnet_property_names, name, 0);
+    return indtext_index_by_istring_default(&Property_Index, name, 0);
 }
 
 bool bactext_property_index(
     const char *search_name,
     unsigned *found_index)
 {
-    return indtext_by_istring(bacnet_property_names, search_name, found_index);
+    return indtext_index_by_istring(&Property_Index, search_name,
+        found_index);
 }
 
 INDTEXT_DATA bacnet_engineering_unit_names[] = {
@@ -1332,19 +1339,22 @@ INDTEXT_DATA bacnet_engineering_unit_names[] = {
    the procedures and constraints described in Clause 23. */
 };
 
+static INDTEXT_INDEX Engineering_Unit_Index =
+    INDTEXT_INDEX_INITIALIZER(bacnet_engineering_unit_names);
+
 const char *bactext_engineering_unit_name(
     unsigned index)
 {
-    return indtext_by_index_split_default(bacnet_engineering_unit_names, index,
-        256, ASHRAE_Reserved_String, Vendor_Proprietary_String);
+    return indtext_index_by_index_split_default(&Engineering_Unit_Index,
+        index, 256, ASHRAE_Reserved_String, Vendor_Proprietary_String);
 }
 
 bool bactext_engineering_unit_index(
     const char *search_name,
     unsigned *found_index)
 {
-    return indtext_by_istring(bacnet_engineering_unit_names, search_name,
-        found_index);
+    return indtext_index_by_istring(&Engineering_Unit_Index,
+        search_name, found_index);
 }
 
 INDTEXT_DATA bacnet_reject_reason_names[] = {
@@ -1618,11 +1628,14 @@ INDTEXT_DATA bacnet_error_code_names[] = {
     {0, NULL}
 };
 
+static INDTEXT_INDEX Error_Code_Index =
+    INDTEXT_INDEX_INITIALIZER(bacnet_error_code_names);
+
 const char *bactext_error_code_name(
     unsigned index)
 {
-    return indtext_by_index_split_default(bacnet_error_code_names, index,
-        FIRST_PROPRIETARY_ERROR_CLASS, ASHRAE_Reserved_String,
+    return indtext_index_by_index_split_default(&Error_Code_Index,
+        index, FIRST_PROPRIETARY_ERROR_CLASS, ASHRAE_Reserved_String,
         Vendor_Proprietary_String);
 }
 
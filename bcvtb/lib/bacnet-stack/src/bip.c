@@ -70,6 +70,7 @@ bool bip_valid(
 void bip_cleanup(
     void)
 {
+    bip_receive_cleanup();
     if (bip_valid())
         close(BIP_Socket);
     BIP_Socket = -1;
@@ -137,6 +138,72 @@ static int bip_decode_bip_address(
     return len;
 }
 
+/* sends the BVLC header and the data behind it as one datagram */
+/* returns number of bytes sent on success, negative number on failure */
+int bip_send_mpdu(
+    struct sockaddr_in *dest,   /* destination in network order */
+    uint8_t * header,   /* BVLC header */
+    uint16_t header_len,
+    uint8_t * pdu,      /* any data to be sent - may be null */
+    uint16_t pdu_len)
+{
+#if BIP_SENDMSG
+    /* the kernel gathers the header and the data */
+    struct iovec iov[2];
+    struct msghdr msg;
+
+    iov[0].iov_base = header;
+    iov[0].iov_len = header_len;
+    iov[1].iov_base = pdu;
+    iov[1].iov_len = pdu ? pdu_len : 0;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = dest;
+    msg.msg_namelen = sizeof(struct sockaddr_in);
+    msg.msg_iov = &iov[0];
+    msg.msg_iovlen = 2;
+
+    return sendmsg(BIP_Socket, &msg, 0);
+#else
+    uint8_t mtu[MAX_MPDU];
+    int mtu_len = 0;
+
+    if ((header_len + pdu_len) > sizeof(mtu))
+        return -1;
+    memcpy(&mtu[0], header, header_len);
+    mtu_len = header_len;
+    if (pdu) {
+        memcpy(&mtu[mtu_len], pdu, pdu_len);
+        mtu_len += pdu_len;
+    }
+
+    return sendto(BIP_Socket, (char *) mtu, mtu_len, 0,
+        (struct sockaddr *) dest, sizeof(struct sockaddr));
+#endif
+}
+
+#if !BIP_SENDMMSG
+/* the port can send the whole list in one call by defining
+   BIP_SENDMMSG and providing this function */
+int bip_send_mpdu_multiple(
+    struct sockaddr_in *dest,   /* destinations in network order */
+    unsigned dest_count,
+    uint8_t * header,   /* BVLC header */
+    uint16_t header_len,
+    uint8_t * pdu,      /* any data to be sent - may be null */
+    uint16_t pdu_len)
+{
+    unsigned i = 0;
+    int sent = 0;
+
+    for (i = 0; i < dest_count; i++) {
+        if (bip_send_mpdu(&dest[i], header, header_len, pdu, pdu_len) >= 0)
+            sent++;
+    }
+
+    return sent;
+}
+#endif
+
 /* function to send a packet out the BACnet/IP socket (Annex J) */
 /* returns number of bytes sent on success, negative number on failure */
 int bip_send_pdu(
@@ -146,9 +213,7 @@ int bip_send_pdu(
     unsigned pdu_len)
 {       /* number of bytes of data */
     struct sockaddr_in bip_dest;
-    uint8_t mtu[MAX_MPDU] = { 0 };
-    int mtu_len = 0;
-    int bytes_sent = 0;
+    uint8_t header[4];
     /* addr and port in host format */
     struct in_addr address;
     uint16_t port = 0;
@@ -159,16 +224,16 @@ int bip_send_pdu(
     if (BIP_Socket < 0)
         return BIP_Socket;
 
-    mtu[0] = BVLL_TYPE_BACNET_IP;
+    header[0] = BVLL_TYPE_BACNET_IP;
     bip_dest.sin_family = AF_INET;
     if (dest->net == BACNET_BROADCAST_NETWORK) {
         /* broadcast */
         address.s_addr = BIP_Broadcast_Address.s_addr;
         port = BIP_Port;
-        mtu[1] = BVLC_ORIGINAL_BROADCAST_NPDU;
+        header[1] = BVLC_ORIGINAL_BROADCAST_NPDU;
     } else if (dest->mac_len == 6) {
         bip_decode_bip_address(&dest->mac[0], &address, &port);
-        mtu[1] = BVLC_ORIGINAL_UNICAST_NPDU;
+        header[1] = BVLC_ORIGINAL_UNICAST_NPDU;
     } else {
         /* invalid address */
         return -1;
@@ -176,42 +241,30 @@ int bip_send_pdu(
     bip_dest.sin_addr.s_addr = htonl(address.s_addr);
     bip_dest.sin_port = htons(port);
     memset(&(bip_dest.sin_zero), '\0', 8);
-    mtu_len = 2;
-    mtu_len +=
-        encode_unsigned16(&mtu[mtu_len],
+    (void) encode_unsigned16(&header[2],
         (uint16_t) (pdu_len + 4 /*inclusive */ ));
-    memcpy(&mtu[mtu_len], pdu, pdu_len);
-    mtu_len += pdu_len;
 
     /* Send the packet */
-    bytes_sent =
-        sendto(BIP_Socket, (char *) mtu, mtu_len, 0,
-        (struct sockaddr *) &bip_dest, sizeof(struct sockaddr));
-
-    return bytes_sent;
+    return bip_send_mpdu(&bip_dest, header, 4, pdu, (uint16_t) pdu_len);
 }
 
-/* receives a BACnet/IP packet */
-/* returns the number of octets in the PDU, or zero on failure */
-uint16_t bip_receive(
-    BACNET_ADDRESS * src,       /* source address */
-    uint8_t * pdu,      /* PDU data */
-    uint16_t max_pdu,   /* amount of space available in the PDU  */
+#if !BIP_RECVMMSG
+/* the port can provide a faster receive by defining BIP_RECVMMSG
+   and these three functions */
+int bip_receive_datagram(
+    uint8_t * buf,
+    uint16_t max_len,
+    uint8_t ** datagram,
+    struct sockaddr_in *sin,
     unsigned timeout)
-{       /* number of milliseconds to wait for a packet */
-    int received_bytes = 0;
-    uint16_t pdu_len = 0;       /* return value */
+{
     fd_set read_fds;
     int max = 0;
     struct timeval select_timeout;
-    struct sockaddr_in sin = { 0 };
-    socklen_t sin_len = sizeof(sin);
-    uint16_t i = 0;
-
-    /* Make sure the socket is open */
-    if (BIP_Socket < 0)
-        return 0;
+    socklen_t sin_len = sizeof(*sin);
+    int received_bytes = 0;
 
+    *datagram = buf;
     /* we could just use a non-blocking socket, but that consumes all
        the CPU time.  We can use a timeout; it is only supported as
        a select. */
@@ -229,25 +282,64 @@ uint16_t bip_receive(
     /* see if there is a packet for us */
     if (select(max + 1, &read_fds, NULL, NULL, &select_timeout) > 0)
         received_bytes =
-            recvfrom(BIP_Socket, (char *) &pdu[0], max_pdu, 0,
-            (struct sockaddr *) &sin, &sin_len);
-    else
-        return 0;
-
+            recvfrom(BIP_Socket, (char *) &buf[0], max_len, 0,
+            (struct sockaddr *) sin, &sin_len);
     /* See if there is a problem */
-    if (received_bytes < 0) {
+    if (received_bytes < 0)
+        received_bytes = 0;
+
+    return received_bytes;
+}
+
+bool bip_receive_pending(
+    void)
+{
+    return false;
+}
+
+void bip_receive_cleanup(
+    void)
+{
+    return;
+}
+#endif
+
+/* receives a BACnet/IP packet and leaves the NPDU where it landed,
+   behind the BVLC header, at *npdu - in pdu, or in the port's receive
+   ring until the next receive */
+/* returns the number of octets in the NPDU, or zero on failure */
+uint16_t bip_receive_in_place(
+    BACNET_ADDRESS * src,       /* source address */
+    uint8_t * pdu,      /* BVLC header and NPDU */
+    uint16_t max_pdu,   /* amount of space available in the PDU  */
+    unsigned timeout,   /* number of milliseconds to wait for a packet */
+    uint8_t ** npdu)
+{
+    uint8_t *mpdu = NULL;       /* the datagram, BVLC header and all */
+    int received_bytes = 0;
+    uint16_t pdu_len = 0;       /* return value */
+    uint16_t bvlc_len = 0;
+    struct sockaddr_in sin = { 0 };
+
+    *npdu = pdu;
+    /* Make sure the socket is open */
+    if (BIP_Socket < 0)
         return 0;
-    }
+
+    received_bytes = bip_receive_datagram(pdu, max_pdu, &mpdu, &sin,
+        timeout);
 
     /* no problem, just no bytes */
-    if (received_bytes == 0)
+    if (received_bytes < 4)
         return 0;
 
     /* the signature of a BACnet/IP packet */
-    if (pdu[0] != BVLL_TYPE_BACNET_IP)
+    if (mpdu[0] != BVLL_TYPE_BACNET_IP)
         return 0;
-    if ((pdu[1] == BVLC_ORIGINAL_UNICAST_NPDU) ||
-        (pdu[1] == BVLC_ORIGINAL_BROADCAST_NPDU)) {
+    /* decode the length of the PDU - length is inclusive of BVLC */
+    (void) decode_unsigned16(&mpdu[2], &bvlc_len);
+    if ((mpdu[1] == BVLC_ORIGINAL_UNICAST_NPDU) ||
+        (mpdu[1] == BVLC_ORIGINAL_BROADCAST_NPDU)) {
         /* ignore messages from me */
         if ((sin.sin_addr.s_addr == htonl(BIP_Address.s_addr)) &&
             (sin.sin_port == htons(BIP_Port))) {
@@ -262,26 +354,12 @@ uint16_t bip_receive(
             (void) encode_unsigned16(&src->mac[4], htons(sin.sin_port));
             /* FIXME: check destination address */
             /* see if it is broadcast or for us */
-            /* decode the length of the PDU - length is inclusive of BVLC */
-            (void) decode_unsigned16(&pdu[2], &pdu_len);
-            /* subtract off the BVLC header */
-            pdu_len -= 4;
-            if (pdu_len < max_pdu) {
-#if 0
-                fprintf(stderr, "BIP: NPDU[%hu]:", pdu_len);
-#endif
-                /* shift the buffer to return a valid PDU */
-                for (i = 0; i < pdu_len; i++) {
-                    pdu[i] = pdu[4 + i];
-#if 0
-                    fprintf(stderr, "%02X ", pdu[i]);
-#endif
-                }
-#if 0
-                fprintf(stderr, "\n");
-#endif
+            if ((bvlc_len >= 4) && (bvlc_len <= received_bytes)) {
+                /* subtract off the BVLC header */
+                pdu_len = bvlc_len - 4;
+                *npdu = &mpdu[4];
             }
-            /* ignore packets that are too large */
+            /* ignore packets that were cut short */
             /* clients should check my max-apdu first */
             else {
                 pdu_len = 0;
@@ -290,9 +368,9 @@ uint16_t bip_receive(
 #endif
             }
         }
-    } else if (pdu[1] == BVLC_FORWARDED_NPDU) {
-        (void) decode_unsigned32(&pdu[4], (uint32_t *) & sin.sin_addr.s_addr);
-        (void) decode_unsigned16(&pdu[8], &sin.sin_port);
+    } else if ((mpdu[1] == BVLC_FORWARDED_NPDU) && (received_bytes >= 10)) {
+        (void) decode_unsigned32(&mpdu[4], (uint32_t *) & sin.sin_addr.s_addr);
+        (void) decode_unsigned16(&mpdu[8], &sin.sin_port);
         if ((sin.sin_addr.s_addr == htonl(BIP_Address.s_addr)) &&
             (sin.sin_port == htons(BIP_Port))) {
             /* ignore messages from me */
@@ -304,17 +382,12 @@ uint16_t bip_receive(
             (void) encode_unsigned16(&src->mac[4], htons(sin.sin_port));
             /* FIXME: check destination address */
             /* see if it is broadcast or for us */
-            /* decode the length of the PDU - length is inclusive of BVLC */
-            (void) decode_unsigned16(&pdu[2], &pdu_len);
-            /* subtract off the BVLC header */
-            pdu_len -= 10;
-            if (pdu_len < max_pdu) {
-                /* shift the buffer to return a valid PDU */
-                for (i = 0; i < pdu_len; i++) {
-                    pdu[i] = pdu[4 + 6 + i];
-                }
+            if ((bvlc_len >= 10) && (bvlc_len <= received_bytes)) {
+                /* subtract off the BVLC header */
+                pdu_len = bvlc_len - 10;
+                *npdu = &mpdu[10];
             } else {
-                /* ignore packets that are too large */
+                /* ignore packets that were cut short */
                 /* clients should check my max-apdu first */
                 pdu_len = 0;
             }
@@ -328,6 +401,24 @@ uint16_t bip_receive(
     return pdu_len;
 }
 
+/* receives a BACnet/IP packet */
+/* returns the number of octets in the PDU, or zero on failure */
+uint16_t bip_receive(
+    BACNET_ADDRESS * src,       /* source address */
+    uint8_t * pdu,      /* PDU data */
+    uint16_t max_pdu,   /* amount of space available in the PDU  */
+    unsigned timeout)
+{       /* number of milliseconds to wait for a packet */
+    uint16_t pdu_len = 0;
+    uint8_t *npdu = NULL;
+
+    pdu_len = bip_receive_in_place(src, pdu, max_pdu, timeout, &npdu);
+    if (pdu_len && (npdu != pdu))
+        memmove(&pdu[0], npdu, pdu_len);
+
+    return pdu_len;
+}
+
 void bip_get_my_address(
     BACNET_ADDRESS * my_address)
 {
@@ -285,18 +285,17 @@ static int bvlc_encode_read_bdt_ack(
     return pdu_len;
 }
 
-static int bvlc_encode_forwarded_npdu(
+/* encodes the BVLC header and original source address, which go
+   out in front of the NPDU */
+static int bvlc_encode_forwarded_npdu_header(
     uint8_t * pdu,
     struct sockaddr_in *sin,    /* source address in network order */
-    uint8_t * npdu,
     unsigned npdu_length)
 {
     int len = 0;
     struct in_addr address;
     uint16_t port;
 
-    unsigned i; /* for loop counter */
-
     if (pdu) {
         pdu[0] = BVLL_TYPE_BACNET_IP;
         pdu[1] = BVLC_FORWARDED_NPDU;
@@ -308,10 +307,6 @@ static int bvlc_encode_forwarded_npdu(
         address.s_addr = ntohl(sin->sin_addr.s_addr);
         port = ntohs(sin->sin_port);
         len += bvlc_encode_bip_address(&pdu[len], &address, port);
-        for (i = 0; i < npdu_length; i++) {
-            pdu[len] = npdu[i];
-            len++;
-        }
     }
 
     return len;
@@ -652,8 +647,7 @@ static int bvlc_send_mpdu(
     bvlc_dest.sin_port = dest->sin_port;
     memset(&(bvlc_dest.sin_zero), '\0', 8);
     /* Send the packet */
-    return sendto(bip_socket(), (char *) mtu, mtu_len, 0,
-        (struct sockaddr *) &bvlc_dest, sizeof(struct sockaddr));
+    return bip_send_mpdu(&bvlc_dest, mtu, mtu_len, NULL, 0);
 }
 
 static void bvlc_bdt_forward_npdu(
@@ -661,38 +655,49 @@ static void bvlc_bdt_forward_npdu(
     uint8_t * npdu,     /* the NPDU */
     uint16_t npdu_length)
 {       /* length of the NPDU  */
-    uint8_t mtu[MAX_MPDU] = { 0 };
+    uint8_t mtu[4 + 6] = { 0 };
     uint16_t mtu_len = 0;
     unsigned i = 0;     /* loop counter */
-    struct sockaddr_in bip_dest = { 0 };
+    struct sockaddr_in bip_dest[MAX_BBMD_ENTRIES];
+    unsigned dest_count = 0;
 
-    mtu_len = bvlc_encode_forwarded_npdu(&mtu[0], sin, npdu, npdu_length);
+    mtu_len = bvlc_encode_forwarded_npdu_header(&mtu[0], sin, npdu_length);
     /* loop through the BDT and send one to each entry, except us */
     for (i = 0; i < MAX_BBMD_ENTRIES; i++) {
         if (BBMD_Table[i].valid) {
+            memset(&bip_dest[dest_count], 0, sizeof(struct sockaddr_in));
+            bip_dest[dest_count].sin_family = AF_INET;
             /* The B/IP address to which the Forwarded-NPDU message is
                sent is formed by inverting the broadcast distribution
                mask in the BDT entry and logically ORing it with the
                BBMD address of the same entry. */
-            bip_dest.sin_addr.s_addr =
+            bip_dest[dest_count].sin_addr.s_addr =
                 htonl(((~BBMD_Table[i].broadcast_mask.
                         s_addr) | BBMD_Table[i].dest_address.s_addr));
-            bip_dest.sin_port = htons(BBMD_Table[i].dest_port);
+            bip_dest[dest_count].sin_port = htons(BBMD_Table[i].dest_port);
             /* don't send to my broadcast address and same port */
-            if ((bip_dest.sin_addr.s_addr == htonl(bip_get_broadcast_addr()))
-                && (bip_dest.sin_port == htons(bip_get_port()))) {
+            if ((bip_dest[dest_count].sin_addr.s_addr ==
+                    htonl(bip_get_broadcast_addr()))
+                && (bip_dest[dest_count].sin_port == htons(bip_get_port()))) {
                 continue;
             }
             /* don't send to my ip address and same port */
-            if ((bip_dest.sin_addr.s_addr == htonl(bip_get_addr())) &&
-                (bip_dest.sin_port == htons(bip_get_port()))) {
+            if ((bip_dest[dest_count].sin_addr.s_addr ==
+                    htonl(bip_get_addr())) &&
+                (bip_dest[dest_count].sin_port == htons(bip_get_port()))) {
                 continue;
             }
-            bvlc_send_mpdu(&bip_dest, mtu, mtu_len);
             debug_printf("BVLC: BDT Sent Forwarded-NPDU to %s:%04X\n",
-                inet_ntoa(bip_dest.sin_addr), ntohs(bip_dest.sin_port));
+                inet_ntoa(bip_dest[dest_count].sin_addr),
+                ntohs(bip_dest[dest_count].sin_port));
+            dest_count++;
         }
     }
+    /* the same message goes to all of them */
+    if (dest_count && (bip_socket() >= 0)) {
+        bip_send_mpdu_multiple(&bip_dest[0], dest_count, mtu, mtu_len, npdu,
+            npdu_length);
+    }
 
     return;
 }
@@ -704,14 +709,18 @@ static void bvlc_forward_npdu(
     uint8_t * npdu,     /* the NPDU */
     uint16_t npdu_length)
 {       /* length of the NPDU  */
-    uint8_t mtu[MAX_MPDU] = { 0 };
+    uint8_t mtu[4 + 6] = { 0 };
     uint16_t mtu_len = 0;
     struct sockaddr_in bip_dest = { 0 };
 
-    mtu_len = bvlc_encode_forwarded_npdu(&mtu[0], sin, npdu, npdu_length);
+    if (bip_socket() < 0) {
+        return;
+    }
+    mtu_len = bvlc_encode_forwarded_npdu_header(&mtu[0], sin, npdu_length);
+    bip_dest.sin_family = AF_INET;
     bip_dest.sin_addr.s_addr = htonl(bip_get_broadcast_addr());
     bip_dest.sin_port = htons(bip_get_port());
-    bvlc_send_mpdu(&bip_dest, mtu, mtu_len);
+    bip_send_mpdu(&bip_dest, mtu, mtu_len, npdu, npdu_length);
     debug_printf("BVLC: Sent Forwarded-NPDU as local broadcast.\n");
 }
 
@@ -720,32 +729,43 @@ static void bvlc_fdt_forward_npdu(
     uint8_t * npdu,     /* returns the NPDU */
     uint16_t max_npdu)
 {       /* amount of space available in the NPDU  */
-    uint8_t mtu[MAX_MPDU] = { 0 };
+    uint8_t mtu[4 + 6] = { 0 };
     uint16_t mtu_len = 0;
     unsigned i = 0;     /* loop counter */
-    struct sockaddr_in bip_dest = { 0 };
+    struct sockaddr_in bip_dest[MAX_FD_ENTRIES];
+    unsigned dest_count = 0;
 
-    mtu_len = bvlc_encode_forwarded_npdu(&mtu[0], sin, npdu, max_npdu);
+    mtu_len = bvlc_encode_forwarded_npdu_header(&mtu[0], sin, max_npdu);
     /* loop through the FDT and send one to each entry */
     for (i = 0; i < MAX_FD_ENTRIES; i++) {
         if (FD_Table[i].valid && FD_Table[i].seconds_remaining) {
-            bip_dest.sin_addr.s_addr = htonl(FD_Table[i].dest_address.s_addr);
-            bip_dest.sin_port = htons(FD_Table[i].dest_port);
+            memset(&bip_dest[dest_count], 0, sizeof(struct sockaddr_in));
+            bip_dest[dest_count].sin_family = AF_INET;
+            bip_dest[dest_count].sin_addr.s_addr =
+                htonl(FD_Table[i].dest_address.s_addr);
+            bip_dest[dest_count].sin_port = htons(FD_Table[i].dest_port);
             /* don't send to my ip address and same port */
-            if ((bip_dest.sin_addr.s_addr == htonl(bip_get_addr())) &&
-                (bip_dest.sin_port == htons(bip_get_port()))) {
+            if ((bip_dest[dest_count].sin_addr.s_addr ==
+                    htonl(bip_get_addr())) &&
+                (bip_dest[dest_count].sin_port == htons(bip_get_port()))) {
                 continue;
             }
             /* don't send to src ip address and same port */
-            if ((bip_dest.sin_addr.s_addr == sin->sin_addr.s_addr) &&
-                (bip_dest.sin_port == sin->sin_port)) {
+            if ((bip_dest[dest_count].sin_addr.s_addr == sin->sin_addr.s_addr)
+                && (bip_dest[dest_count].sin_port == sin->sin_port)) {
                 continue;
             }
-            bvlc_send_mpdu(&bip_dest, mtu, mtu_len);
             debug_printf("BVLC: FDT Sent Forwarded-NPDU to %s:%04X\n",
-                inet_ntoa(bip_dest.sin_addr), ntohs(bip_dest.sin_port));
+                inet_ntoa(bip_dest[dest_count].sin_addr),
+                ntohs(bip_dest[dest_count].sin_port));
+            dest_count++;
         }
     }
+    /* the same message goes to all of them */
+    if (dest_count && (bip_socket() >= 0)) {
+        bip_send_mpdu_multiple(&bip_dest[0], dest_count, mtu, mtu_len, npdu,
+            max_npdu);
+    }
 
     return;
 }
@@ -836,71 +856,52 @@ static bool bvlc_bdt_member_mask_is_unicast(
     return unicast;
 }
 
+/* the NPDU is left where it was received, at *npdu_start - in npdu,
+   or in the port's receive ring until the next receive */
 /* returns:
     Number of bytes received, or 0 if none or timeout. */
-uint16_t bvlc_receive(
+uint16_t bvlc_receive_in_place(
     BACNET_ADDRESS * src,       /* returns the source address */
-    uint8_t * npdu,     /* returns the NPDU */
+    uint8_t * npdu,     /* returns the BVLC header and NPDU */
     uint16_t max_npdu,  /* amount of space available in the NPDU  */
-    unsigned timeout)
-{       /* number of milliseconds to wait for a packet */
+    unsigned timeout,   /* number of milliseconds to wait for a packet */
+    uint8_t ** npdu_start)
+{
+    uint8_t *mpdu = NULL;       /* the datagram, BVLC header and all */
     uint16_t npdu_len = 0;      /* return value */
-    fd_set read_fds;
-    int max = 0;
-    struct timeval select_timeout;
     struct sockaddr_in sin = { 0 };
     struct sockaddr_in original_sin = { 0 };
     struct sockaddr_in dest = { 0 };
-    socklen_t sin_len = sizeof(sin);
     int function_type = 0;
     int received_bytes = 0;
     uint16_t result_code = 0;
-    uint16_t i = 0;
     bool status = false;
     uint16_t time_to_live = 0;
 
+    *npdu_start = npdu;
     /* Make sure the socket is open */
     if (bip_socket() < 0) {
         return 0;
     }
 
-    /* we could just use a non-blocking socket, but that consumes all
-       the CPU time.  We can use a timeout; it is only supported as
-       a select. */
-    if (timeout >= 1000) {
-        select_timeout.tv_sec = timeout / 1000;
-        select_timeout.tv_usec =
-            1000 * (timeout - select_timeout.tv_sec * 1000);
-    } else {
-        select_timeout.tv_sec = 0;
-        select_timeout.tv_usec = 1000 * timeout;
-    }
-    FD_ZERO(&read_fds);
-    FD_SET(bip_socket(), &read_fds);
-    max = bip_socket();
-    /* see if there is a packet for us */
-    if (select(max + 1, &read_fds, NULL, NULL, &select_timeout) > 0) {
-        received_bytes =
-            recvfrom(bip_socket(), (char *) &npdu[0], max_npdu, 0,
-            (struct sockaddr *) &sin, &sin_len);
-    } else {
-        return 0;
-    }
-    /* See if there is a problem */
-    if (received_bytes < 0) {
-        return 0;
-    }
+    received_bytes = bip_receive_datagram(npdu, max_npdu, &mpdu, &sin,
+        timeout);
     /* no problem, just no bytes */
-    if (received_bytes == 0) {
+    if (received_bytes < 4) {
         return 0;
     }
     /* the signature of a BACnet/IP packet */
-    if (npdu[0] != BVLL_TYPE_BACNET_IP) {
+    if (mpdu[0] != BVLL_TYPE_BACNET_IP) {
         return 0;
     }
-    function_type = npdu[1];
+    function_type = mpdu[1];
     /* decode the length of the PDU - length is inclusive of BVLC */
-    (void) decode_unsigned16(&npdu[2], &npdu_len);
+    (void) decode_unsigned16(&mpdu[2], &npdu_len);
+    /* ignore packets that were cut short */
+    /* clients should check my max-apdu first */
+    if ((npdu_len < 4) || (npdu_len > received_bytes)) {
+        return 0;
+    }
     /* subtract off the BVLC header */
     npdu_len -= 4;
     switch (function_type) {
@@ -913,7 +914,7 @@ uint16_t bvlc_receive(
                foreign device shall re-register with the BBMD by sending a BVLL
                Register-Foreign-Device message */
             /* FIXME: clients may need this result */
-            (void) decode_unsigned16(&npdu[4], &result_code);
+            (void) decode_unsigned16(&mpdu[4], &result_code);
             BVLC_Result_Code = (BACNET_BVLC_RESULT) result_code;
             debug_printf("BVLC: Result Code=%d\n", BVLC_Result_Code);
             /* not an NPDU */
@@ -929,7 +930,7 @@ uint16_t bvlc_receive(
                a result code of X'0000'. Otherwise, the BBMD shall return a
                BVLC-Result message to the originating device with a result code
                of X'0010' indicating that the write attempt has failed. */
-            status = bvlc_create_bdt(&npdu[4], npdu_len);
+            status = bvlc_create_bdt(&mpdu[4], npdu_len);
             if (status) {
                 bvlc_send_result(&sin, BVLC_RESULT_SUCCESSFUL_COMPLETION);
             } else {
@@ -980,33 +981,29 @@ uint16_t bvlc_receive(
                BACnet devices may omit the broadcast using the B/IP
                broadcast address. The method by which a BBMD determines whether
                or not other BACnet devices are present is a local matter. */
+            if (npdu_len < 6) {
+                npdu_len = 0;
+                break;
+            }
             /* decode the 4 byte original address and 2 byte port */
-            bvlc_decode_bip_address(&npdu[4], &original_sin.sin_addr,
+            bvlc_decode_bip_address(&mpdu[4], &original_sin.sin_addr,
                 &original_sin.sin_port);
             npdu_len -= 6;
             /*  Broadcast locally if received via unicast from a BDT member */
             if (bvlc_bdt_member_mask_is_unicast(&sin)) {
                 dest.sin_addr.s_addr = htonl(bip_get_broadcast_addr());
                 dest.sin_port = htons(bip_get_port());
-                bvlc_send_mpdu(&dest, &npdu[4 + 6], npdu_len);
+                /* the Forwarded-NPDU message itself is broadcast */
+                bvlc_send_mpdu(&dest, &mpdu[0], 4 + 6 + npdu_len);
             }
             /* use the original addr from the BVLC for src */
             dest.sin_addr.s_addr = htonl(original_sin.sin_addr.s_addr);
             dest.sin_port = htons(original_sin.sin_port);
-            bvlc_fdt_forward_npdu(&dest, &npdu[4 + 6], npdu_len);
+            bvlc_fdt_forward_npdu(&dest, &mpdu[4 + 6], npdu_len);
             debug_printf("BVLC: Received Forwarded-NPDU from %s:%04X.\n",
                 inet_ntoa(dest.sin_addr), ntohs(dest.sin_port));
             bvlc_internet_to_bacnet_address(src, &dest);
-            if (npdu_len < max_npdu) {
-                /* shift the buffer to return a valid PDU */
-                for (i = 0; i < npdu_len; i++) {
-                    npdu[i] = npdu[4 + 6 + i];
-                }
-            } else {
-                /* ignore packets that are too large */
-                /* clients should check my max-apdu first */
-                npdu_len = 0;
-            }
+            *npdu_start = &mpdu[4 + 6];
             break;
         case BVLC_REGISTER_FOREIGN_DEVICE:
             /* Upon receipt of a BVLL Register-Foreign-Device message, a BBMD
@@ -1018,7 +1015,7 @@ uint16_t bvlc_receive(
                without the receipt of another BVLL Register-Foreign-Device
                message from the same foreign device, the FDT entry for this
                device shall be cleared. */
-            (void) decode_unsigned16(&npdu[4], &time_to_live);
+            (void) decode_unsigned16(&mpdu[4], &time_to_live);
             if (bvlc_register_foreign_device(&sin, time_to_live)) {
                 bvlc_send_result(&sin, BVLC_RESULT_SUCCESSFUL_COMPLETION);
                 debug_printf("BVLC: Registered a Foreign Device.\n");
@@ -1062,7 +1059,7 @@ uint16_t bvlc_receive(
                of X'0000'. Otherwise, the BBMD shall return a BVLCResult
                message to the originating device with a result code of X'0050'
                indicating that the deletion attempt has failed. */
-            if (bvlc_delete_foreign_device(&npdu[4])) {
+            if (bvlc_delete_foreign_device(&mpdu[4])) {
                 bvlc_send_result(&sin, BVLC_RESULT_SUCCESSFUL_COMPLETION);
             } else {
                 bvlc_send_result(&sin,
@@ -1087,9 +1084,9 @@ uint16_t bvlc_receive(
                it shall return a BVLC-Result message to the foreign device
                with a result code of X'0060' indicating that the forwarding
                attempt was unsuccessful */
-            bvlc_forward_npdu(&sin, &npdu[4], npdu_len);
-            bvlc_bdt_forward_npdu(&sin, &npdu[4], npdu_len);
-            bvlc_fdt_forward_npdu(&sin, &npdu[4], npdu_len);
+            bvlc_forward_npdu(&sin, &mpdu[4], npdu_len);
+            bvlc_bdt_forward_npdu(&sin, &mpdu[4], npdu_len);
+            bvlc_fdt_forward_npdu(&sin, &mpdu[4], npdu_len);
             /* not an NPDU */
             npdu_len = 0;
             break;
@@ -1101,16 +1098,7 @@ uint16_t bvlc_receive(
                 npdu_len = 0;
             } else {
                 bvlc_internet_to_bacnet_address(src, &sin);
-                if (npdu_len < max_npdu) {
-                    /* shift the buffer to return a valid PDU */
-                    for (i = 0; i < npdu_len; i++) {
-                        npdu[i] = npdu[4 + i];
-                    }
-                } else {
-                    /* ignore packets that are too large */
-                    /* clients should check my max-apdu first */
-                    npdu_len = 0;
-                }
+                *npdu_start = &mpdu[4];
             }
             break;
         case BVLC_ORIGINAL_BROADCAST_NPDU:
@@ -1129,26 +1117,40 @@ uint16_t bvlc_receive(
                shall be sent directly to each foreign device currently in
                the BBMD's FDT also using the BVLL Forwarded-NPDU message. */
             bvlc_internet_to_bacnet_address(src, &sin);
-            if (npdu_len < max_npdu) {
-                /* shift the buffer to return a valid PDU */
-                for (i = 0; i < npdu_len; i++) {
-                    npdu[i] = npdu[4 + i];
-                }
-                /* if BDT or FDT entries exist, Forward the NPDU */
-                bvlc_bdt_forward_npdu(&sin, &npdu[0], npdu_len);
-                bvlc_fdt_forward_npdu(&sin, &npdu[0], npdu_len);
-            } else {
-                /* ignore packets that are too large */
-                npdu_len = 0;
-            }
+            *npdu_start = &mpdu[4];
+            /* if BDT or FDT entries exist, Forward the NPDU */
+            bvlc_bdt_forward_npdu(&sin, &mpdu[4], npdu_len);
+            bvlc_fdt_forward_npdu(&sin, &mpdu[4], npdu_len);
             break;
         default:
+            /* not an NPDU */
+            npdu_len = 0;
             break;
     }
 
     return npdu_len;
 }
 
+/* returns:
+    Number of bytes received, or 0 if none or timeout. */
+uint16_t bvlc_receive(
+    BACNET_ADDRESS * src,       /* returns the source address */
+    uint8_t * npdu,     /* returns the NPDU */
+    uint16_t max_npdu,  /* amount of space available in the NPDU  */
+    unsigned timeout)
+{       /* number of milliseconds to wait for a packet */
+    uint16_t npdu_len = 0;
+    uint8_t *npdu_start = NULL;
+
+    npdu_len =
+        bvlc_receive_in_place(src, npdu, max_npdu, timeout, &npdu_start);
+    if (npdu_len && (npdu_start != npdu)) {
+        memmove(&npdu[0], npdu_start, npdu_len);
+    }
+
+    return npdu_len;
+}
+
 /* function to send a packet out the BACnet/IP socket (Annex J) */
 /* returns number of bytes sent on success, negative number on failure */
 int bvlc_send_pdu(
@@ -1158,8 +1160,7 @@ int bvlc_send_pdu(
     unsigned pdu_len)
 {       /* number of bytes of data */
     struct sockaddr_in bvlc_dest = { 0 };
-    uint8_t mtu[MAX_MPDU] = { 0 };
-    uint16_t mtu_len = 0;
+    uint8_t mtu[4];
     /* addr and port in host format */
     struct in_addr address;
     uint16_t port = 0;
@@ -1167,6 +1168,10 @@ int bvlc_send_pdu(
 
     /* bip datalink doesn't need to know the npdu data */
     (void) npdu_data;
+    /* assumes that the driver has already been initialized */
+    if (bip_socket() < 0) {
+        return -1;
+    }
     mtu[0] = BVLL_TYPE_BACNET_IP;
     if (dest->net == BACNET_BROADCAST_NETWORK) {
         /* if we are a foreign device */
@@ -1190,14 +1195,13 @@ int bvlc_send_pdu(
         /* invalid address */
         return -1;
     }
+    bvlc_dest.sin_family = AF_INET;
     bvlc_dest.sin_addr.s_addr = htonl(address.s_addr);
     bvlc_dest.sin_port = htons(port);
     BVLC_length = pdu_len + 4 /*inclusive */ ;
-    mtu_len = 2;
-    mtu_len += encode_unsigned16(&mtu[mtu_len], BVLC_length);
-    memcpy(&mtu[mtu_len], pdu, pdu_len);
-    mtu_len += pdu_len;
-    return bvlc_send_mpdu(&bvlc_dest, mtu, mtu_len);
+    (void) encode_unsigned16(&mtu[2], BVLC_length);
+    /* the NPDU goes out from where it is, behind the header */
+    return bip_send_mpdu(&bvlc_dest, mtu, 4, pdu, (uint16_t) pdu_len);
 }
 
 #ifdef TEST
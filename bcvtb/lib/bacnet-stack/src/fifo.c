@@ -47,7 +47,7 @@
 * ALGORITHM:   none
 * NOTES:       none
 *****************************************************************************/
-static unsigned FIFO_Count(
+unsigned FIFO_Count(
     FIFO_BUFFER const *b)
 {
     return (b ? (b->head - b->tail) : 0);
@@ -175,6 +175,56 @@ bool FIFO_Add(
     return status;
 }
 
+/****************************************************************************
+* DESCRIPTION: Finds the free space after the last element of data that
+*              can be written in one piece, such as by read()
+* RETURN:      start of the free space, or NULL if there is none
+* ALGORITHM:   none
+* NOTES:       count gets the number of bytes.  Use FIFO_Commit to add
+*              the bytes that were written.
+*****************************************************************************/
+uint8_t *FIFO_Reserve(
+    FIFO_BUFFER * b,
+    unsigned *count)
+{
+    unsigned head;
+    unsigned space;
+
+    *count = 0;
+    if (!b || FIFO_Full(b)) {
+        return NULL;
+    }
+    head = b->head % b->buffer_len;
+    space = b->buffer_len - FIFO_Count(b);
+    if (space > (b->buffer_len - head)) {
+        /* the rest is at the start of the buffer */
+        space = b->buffer_len - head;
+    }
+    *count = space;
+
+    return (uint8_t *) & b->buffer[head];
+}
+
+/****************************************************************************
+* DESCRIPTION: Adds the bytes written into the space from FIFO_Reserve
+* RETURN:      true if the bytes fit and were added, false if not added
+* ALGORITHM:   none
+* NOTES:       none
+*****************************************************************************/
+bool FIFO_Commit(
+    FIFO_BUFFER * b,
+    unsigned count)
+{
+    bool status = false;        /* return value */
+
+    if (b && (count <= (b->buffer_len - FIFO_Count(b)))) {
+        b->head += count;
+        status = true;
+    }
+
+    return status;
+}
+
 /****************************************************************************
 * DESCRIPTION: Flushes any data in the buffer
 * RETURN:      none
@@ -228,6 +278,10 @@ void testFIFOBuffer(
     uint8_t test_data;
     uint8_t index;
     uint8_t count;
+    uint8_t *reserved;
+    unsigned space;
+    unsigned count2;
+    unsigned head;
     bool status;
 
     FIFO_Init(&test_buffer, data_store, sizeof(data_store));
@@ -293,6 +347,36 @@ void testFIFOBuffer(
     ct_test(pTest, !FIFO_Empty(&test_buffer));
     FIFO_Flush(&test_buffer);
     ct_test(pTest, FIFO_Empty(&test_buffer));
+    /* test Reserve and Commit, which stop at the end of the buffer */
+    reserved = FIFO_Reserve(&test_buffer, &space);
+    ct_test(pTest, reserved != NULL);
+    head = test_buffer.head % FIFO_BUFFER_SIZE;
+    ct_test(pTest, reserved == &data_store[head]);
+    ct_test(pTest, space == (FIFO_BUFFER_SIZE - head));
+    for (index = 0; index < space; index++) {
+        reserved[index] = index;
+    }
+    status = FIFO_Commit(&test_buffer, space);
+    ct_test(pTest, status == true);
+    ct_test(pTest, FIFO_Count(&test_buffer) == space);
+    reserved = FIFO_Reserve(&test_buffer, &count2);
+    ct_test(pTest, reserved == &data_store[0]);
+    ct_test(pTest, count2 == head);
+    for (index = 0; index < count2; index++) {
+        reserved[index] = space + index;
+    }
+    status = FIFO_Commit(&test_buffer, count2 + 1);
+    ct_test(pTest, status == false);
+    status = FIFO_Commit(&test_buffer, count2);
+    ct_test(pTest, status == true);
+    reserved = FIFO_Reserve(&test_buffer, &count2);
+    ct_test(pTest, reserved == NULL);
+    ct_test(pTest, count2 == 0);
+    for (index = 0; index < FIFO_BUFFER_SIZE; index++) {
+        test_data = FIFO_Get(&test_buffer);
+        ct_test(pTest, test_data == index);
+    }
+    ct_test(pTest, FIFO_Empty(&test_buffer));
 
     return;
 }
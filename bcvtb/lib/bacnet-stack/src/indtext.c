@@ -32,6 +32,7 @@
  -------------------------------------------
 ####COPYRIGHTEND####*/
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 #include "indtext.h"
 
@@ -189,6 +190,221 @@ unsigned indtext_count(
     return count;
 }
 
+/* orders the elements by text, then by where they are in the list,
+   so that the first of equal elements is the first one in the list */
+static int indtext_compare_string(
+    const void *a,
+    const void *b)
+{
+    const INDTEXT_DATA *data_a = *(INDTEXT_DATA * const *) a;
+    const INDTEXT_DATA *data_b = *(INDTEXT_DATA * const *) b;
+    int rv;
+
+    rv = stricmp(data_a->pString, data_b->pString);
+    if (rv == 0) {
+        rv = (data_a > data_b) - (data_a < data_b);
+    }
+
+    return rv;
+}
+
+/* orders the elements by index, then by where they are in the list */
+static int indtext_compare_index(
+    const void *a,
+    const void *b)
+{
+    const INDTEXT_DATA *data_a = *(INDTEXT_DATA * const *) a;
+    const INDTEXT_DATA *data_b = *(INDTEXT_DATA * const *) b;
+    int rv;
+
+    rv = (data_a->index > data_b->index) - (data_a->index < data_b->index);
+    if (rv == 0) {
+        rv = (data_a > data_b) - (data_a < data_b);
+    }
+
+    return rv;
+}
+
+/* builds the sorted views of the list, if they are not built yet.
+   returns false if there is no memory for them. */
+static bool indtext_index_build(
+    INDTEXT_INDEX * data_index)
+{
+    INDTEXT_DATA **by_string;
+    INDTEXT_DATA **by_index;
+    unsigned count;
+    unsigned i;
+
+    if (data_index->by_string) {
+        return true;
+    }
+    count = indtext_count(data_index->data_list);
+    /* one block holds both views */
+    by_string = malloc((count ? count : 1) * 2 * sizeof(*by_string));
+    if (!by_string) {
+        return false;
+    }
+    by_index = &by_string[count];
+    for (i = 0; i < count; i++) {
+        by_string[i] = &data_index->data_list[i];
+        by_index[i] = &data_index->data_list[i];
+    }
+    qsort(by_string, count, sizeof(*by_string), indtext_compare_string);
+    qsort(by_index, count, sizeof(*by_index), indtext_compare_index);
+    data_index->count = count;
+    data_index->by_index = by_index;
+    data_index->by_string = by_string;
+
+    return true;
+}
+
+/* returns the position in by_string of the first element with text
+   that matches, ignoring case, or the count if there is none */
+static unsigned indtext_index_find_istring(
+    INDTEXT_INDEX * data_index,
+    const char *search_name)
+{
+    unsigned left = 0;
+    unsigned right = data_index->count;
+    unsigned middle;
+
+    while (left < right) {
+        middle = left + ((right - left) / 2);
+        if (stricmp(data_index->by_string[middle]->pString,
+                search_name) < 0) {
+            left = middle + 1;
+        } else {
+            right = middle;
+        }
+    }
+    if ((left < data_index->count) &&
+        (stricmp(data_index->by_string[left]->pString, search_name) != 0)) {
+        left = data_index->count;
+    }
+
+    return left;
+}
+
+bool indtext_index_by_string(
+    INDTEXT_INDEX * data_index,
+    const char *search_name,
+    unsigned *found_index)
+{
+    INDTEXT_DATA *data = NULL;
+    unsigned i;
+
+    if (!data_index || !search_name) {
+        return false;
+    }
+    if (!indtext_index_build(data_index)) {
+        return indtext_by_string(data_index->data_list, search_name,
+            found_index);
+    }
+    /* the exact match is among the ones that match ignoring case,
+       and the first one of them in the list is first here */
+    for (i = indtext_index_find_istring(data_index, search_name);
+        i < data_index->count; i++) {
+        if (stricmp(data_index->by_string[i]->pString, search_name) != 0) {
+            break;
+        }
+        if (strcmp(data_index->by_string[i]->pString, search_name) == 0) {
+            data = data_index->by_string[i];
+            break;
+        }
+    }
+    if (data && found_index) {
+        *found_index = data->index;
+    }
+
+    return (data != NULL);
+}
+
+bool indtext_index_by_istring(
+    INDTEXT_INDEX * data_index,
+    const char *search_name,
+    unsigned *found_index)
+{
+    unsigned i;
+
+    if (!data_index || !search_name) {
+        return false;
+    }
+    if (!indtext_index_build(data_index)) {
+        return indtext_by_istring(data_index->data_list, search_name,
+            found_index);
+    }
+    i = indtext_index_find_istring(data_index, search_name);
+    if (i >= data_index->count) {
+        return false;
+    }
+    if (found_index) {
+        *found_index = data_index->by_string[i]->index;
+    }
+
+    return true;
+}
+
+unsigned indtext_index_by_istring_default(
+    INDTEXT_INDEX * data_index,
+    const char *search_name,
+    unsigned default_index)
+{
+    unsigned index = 0;
+
+    if (!indtext_index_by_istring(data_index, search_name, &index))
+        index = default_index;
+
+    return index;
+}
+
+const char *indtext_index_by_index_default(
+    INDTEXT_INDEX * data_index,
+    unsigned index,
+    const char *default_name)
+{
+    unsigned left = 0;
+    unsigned right = 0;
+    unsigned middle;
+
+    if (!data_index) {
+        return default_name;
+    }
+    if (!indtext_index_build(data_index)) {
+        return indtext_by_index_default(data_index->data_list, index,
+            default_name);
+    }
+    right = data_index->count;
+    while (left < right) {
+        middle = left + ((right - left) / 2);
+        if (data_index->by_index[middle]->index < index) {
+            left = middle + 1;
+        } else {
+            right = middle;
+        }
+    }
+    if ((left < data_index->count) &&
+        (data_index->by_index[left]->index == index)) {
+        return data_index->by_index[left]->pString;
+    }
+
+    return default_name;
+}
+
+const char *indtext_index_by_index_split_default(
+    INDTEXT_INDEX * data_index,
+    unsigned index,
+    unsigned split_index,
+    const char *before_split_default_name,
+    const char *default_name)
+{
+    if (index < split_index)
+        return indtext_index_by_index_default(data_index, index,
+            before_split_default_name);
+    else
+        return indtext_index_by_index_default(data_index, index,
+            default_name);
+}
+
 #ifdef TEST
 #include <assert.h>
 #include "ctest.h"
@@ -236,6 +452,72 @@ void testIndexText(
     ct_test(pTest, index == indtext_by_istring_default(data_list, "ANNA",
             index));
 }
+
+/* the sorted views find what a walk through the list finds */
+void testIndexTextIndex(
+    Test * pTest)
+{
+    static INDTEXT_DATA dup_list[] = {
+        {7, "Zed"},
+        {3, "anna"},
+        {9, "Anna"},
+        {3, "Bob"},
+        {5, "ANNA"},
+        {1, "Carl"},
+        {0, NULL}
+    };
+    static INDTEXT_INDEX dup_index = INDTEXT_INDEX_INITIALIZER(dup_list);
+    static INDTEXT_INDEX names_index = INDTEXT_INDEX_INITIALIZER(data_list);
+    static INDTEXT_DATA empty_list[] = {
+        {0, NULL}
+    };
+    static INDTEXT_INDEX empty_index = INDTEXT_INDEX_INITIALIZER(empty_list);
+    const char *names[] = {
+        "Zed", "zed", "anna", "Anna", "ANNA", "aNNa", "Bob", "Carl", "carl",
+        "Dave", "", "A", "Zz", "Joshua", "JOSHUA", "Patricia", "Mary"
+    };
+    unsigned i;
+    unsigned index = 0;
+    unsigned list_index = 0;
+    bool found;
+    bool list_found;
+
+    for (i = 0; i < (sizeof(names) / sizeof(names[0])); i++) {
+        index = list_index = 99;
+        found = indtext_index_by_string(&dup_index, names[i], &index);
+        list_found = indtext_by_string(dup_list, names[i], &list_index);
+        ct_test(pTest, found == list_found);
+        ct_test(pTest, index == list_index);
+        index = list_index = 99;
+        found = indtext_index_by_istring(&dup_index, names[i], &index);
+        list_found = indtext_by_istring(dup_list, names[i], &list_index);
+        ct_test(pTest, found == list_found);
+        ct_test(pTest, index == list_index);
+        index = list_index = 99;
+        found = indtext_index_by_istring(&names_index, names[i], &index);
+        list_found = indtext_by_istring(data_list, names[i], &list_index);
+        ct_test(pTest, found == list_found);
+        ct_test(pTest, index == list_index);
+        ct_test(pTest, indtext_index_by_istring_default(&names_index,
+                names[i], 42) == indtext_by_istring_default(data_list,
+                names[i], 42));
+        ct_test(pTest, indtext_index_by_istring(&empty_index, names[i],
+                NULL) == false);
+    }
+    for (i = 0; i < 12; i++) {
+        ct_test(pTest, indtext_index_by_index_default(&dup_index, i,
+                "none") == indtext_by_index_default(dup_list, i, "none"));
+        ct_test(pTest, indtext_index_by_index_split_default(&names_index, i,
+                3, "before", "after") ==
+            indtext_by_index_split_default(data_list, i, 3, "before",
+                "after"));
+    }
+    ct_test(pTest, indtext_index_by_index_default(&empty_index, 0,
+            "none") != NULL);
+    ct_test(pTest, indtext_index_by_string(&dup_index, NULL, NULL) == false);
+    ct_test(pTest, indtext_index_by_istring(NULL, "Bob", NULL) == false);
+    ct_test(pTest, indtext_index_by_index_default(NULL, 3, NULL) == NULL);
+}
 #endif
 
 #ifdef TEST_INDEX_TEXT
@@ -250,6 +532,8 @@ int main(
     /* individual tests */
     rc = ct_addTestFunction(pTest, testIndexText);
     assert(rc);
+    rc = ct_addTestFunction(pTest, testIndexTextIndex);
+    assert(rc);
 
     ct_setStream(pTest, stdout);
     ct_run(pTest);
@@ -35,12 +35,16 @@
 /* This is an enhanced array of pointers to data. */
 /* The list is sorted, indexed, and keyed. */
 /* The array is much faster than a linked list. */
+/* A hash table of the nodes, using open addressing, */
+/* finds a key without searching the array. */
 /* It stores a pointer to data, which you must */
 /* malloc and free on your own, or just use */
 /* static data */
 
 #include <stdlib.h>
+#include <string.h>
 
+#include "arena.h"
 #include "keylist.h"    /* check for valid prototypes */
 
 #ifndef FALSE
@@ -55,123 +59,233 @@
 /* Generic node routines */
 /*/////////////////////////////////////////////////////////////////// */
 
+/* nodes and lists come from pools, since discovery adds and
+   deletes a lot of them */
+#ifndef KEYLIST_POOL_BLOCKS
+#define KEYLIST_POOL_BLOCKS 64
+#endif
+static BACNET_POOL Node_Pool =
+    POOL_INITIALIZER(sizeof(struct Keylist_Node), KEYLIST_POOL_BLOCKS);
+static BACNET_POOL List_Pool =
+    POOL_INITIALIZER(sizeof(struct Keylist), KEYLIST_POOL_BLOCKS);
+
+/* smallest array of nodes, and smallest hash table */
+#define KEYLIST_MIN_SIZE 8
+#define KEYLIST_MIN_TABLE 16
+
 /* grab memory for a node */
 static struct Keylist_Node *NodeCreate(
     void)
 {
-    return calloc(1, sizeof(struct Keylist_Node));
+    return pool_alloc(&Node_Pool);
 }
 
 /* grab memory for a list */
 static struct Keylist *KeylistCreate(
     void)
 {
-    return calloc(1, sizeof(struct Keylist));
+    return pool_alloc(&List_Pool);
 }
 
 /* check to see if the array is big enough for an addition */
 /* or is too big when we are deleting and we can shrink */
+/* The array doubles or halves, so adding n nodes copies O(n) pointers. */
 /* returns TRUE if success, FALSE if failed */
 static int CheckArraySize(
     OS_Keylist list)
 {
     int new_size = 0;   /* set it up so that no size change is the default */
-    const int chunk = 8;        /* minimum number of nodes to allocate memory for */
     struct Keylist_Node **new_array;    /* new array of nodes, if needed */
-    int i;      /* counter */
     if (!list)
         return FALSE;
 
     /* indicates the need for more memory allocation */
     if (list->count == list->size)
-        new_size = list->size + chunk;
+        new_size = list->size ? (list->size * 2) : KEYLIST_MIN_SIZE;
 
     /* allow for shrinking memory */
-    else if ((list->size > chunk) && (list->count < (list->size - chunk)))
-        new_size = list->size - chunk;
+    else if ((list->size > KEYLIST_MIN_SIZE) &&
+        (list->count < (list->size / 4)))
+        new_size = list->size / 2;
     if (new_size) {
-
-        /* Allocate more room for node pointer array */
-        new_array = calloc((size_t) new_size, sizeof(new_array));
-
+        new_array =
+            realloc(list->array, (size_t) new_size * sizeof(*new_array));
         /* See if we got the memory we wanted */
         if (!new_array)
-            return FALSE;
-
-        /* copy the nodes from the old array to the new array */
-        if (list->array) {
-            for (i = 0; i < list->count; i++) {
-                new_array[i] = list->array[i];
-            }
-            free(list->array);
-        }
+            return (list->count < list->size);
         list->array = new_array;
         list->size = new_size;
     }
     return TRUE;
 }
 
+/*/////////////////////////////////////////////////////////////////// */
+/* Hash table routines */
+/*/////////////////////////////////////////////////////////////////// */
+
+/* the home slot of a key - multiplicative hashing, using the top bits */
+static int TableHome(
+    OS_Keylist list,
+    KEY key)
+{
+    return (int) ((uint32_t) (key * 2654435769UL) >> (32 -
+            list->table_bits));
+}
+
+/* puts a node into the table.  Nodes with the same key are found in
+   the order of the array, which has the newest one first, so the new
+   node takes the place of the first one and moves that one along. */
+static void TableInsert(
+    OS_Keylist list,
+    struct Keylist_Node *node)
+{
+    struct Keylist_Node *moved;
+    int mask = list->table_size - 1;
+    int slot;
+
+    slot = TableHome(list, node->key);
+    while (list->table[slot]) {
+        if (list->table[slot]->key == node->key) {
+            moved = list->table[slot];
+            list->table[slot] = node;
+            node = moved;
+        }
+        slot = (slot + 1) & mask;
+    }
+    list->table[slot] = node;
+}
+
+/* takes a node out of the table, and moves the nodes after it back
+   into the gap, so that no search ever stops short */
+static void TableRemove(
+    OS_Keylist list,
+    struct Keylist_Node *node)
+{
+    int mask = list->table_size - 1;
+    int slot;   /* the gap */
+    int next;   /* the node that might move into the gap */
+    int home;   /* where that node would like to be */
+
+    slot = TableHome(list, node->key);
+    while (list->table[slot] != node) {
+        if (!list->table[slot])
+            return;
+        slot = (slot + 1) & mask;
+    }
+    next = slot;
+    for (;;) {
+        next = (next + 1) & mask;
+        if (!list->table[next])
+            break;
+        home = TableHome(list, list->table[next]->key);
+        /* stays put if its home is after the gap, up to where it is */
+        if (slot <= next) {
+            if ((slot < home) && (home <= next))
+                continue;
+        } else if ((slot < home) || (home <= next)) {
+            continue;
+        }
+        list->table[slot] = list->table[next];
+        slot = next;
+    }
+    list->table[slot] = NULL;
+}
+
+/* returns the first node in the array with the given key, or NULL */
+static struct Keylist_Node *TableFind(
+    OS_Keylist list,
+    KEY key)
+{
+    struct Keylist_Node *node;
+    int mask;
+    int slot;
+
+    if (!list->table)
+        return NULL;
+    mask = list->table_size - 1;
+    slot = TableHome(list, key);
+    while ((node = list->table[slot]) != NULL) {
+        if (node->key == key)
+            return node;
+        slot = (slot + 1) & mask;
+    }
+
+    return NULL;
+}
+
+/* keeps the table at most half full, and at least 1/8 full */
+/* returns TRUE if success, FALSE if failed */
+static int CheckTableSize(
+    OS_Keylist list,
+    int count)
+{
+    struct Keylist_Node **new_table;
+    int new_bits = list->table_bits;
+    int i;
+
+    if (!list->table)
+        new_bits = 4;
+    while ((count * 2) > (1 << new_bits))
+        new_bits++;
+    while (((1 << new_bits) > KEYLIST_MIN_TABLE) &&
+        ((count * 8) < (1 << new_bits)))
+        new_bits--;
+    if (list->table && (new_bits == list->table_bits))
+        return TRUE;
+    new_table = calloc((size_t) 1 << new_bits, sizeof(*new_table));
+    if (!new_table)
+        return (list->table && ((count * 2) <= list->table_size));
+    free(list->table);
+    list->table = new_table;
+    list->table_bits = new_bits;
+    list->table_size = 1 << new_bits;
+    /* oldest first, so that the newest of each key ends up first */
+    for (i = list->count - 1; i >= 0; i--) {
+        TableInsert(list, list->array[i]);
+    }
+
+    return TRUE;
+}
 
 /* find the index of the key that we are looking for */
 /* since it is sorted, we can optimize the search */
 /* returns TRUE if found, and FALSE not found */
-/* returns the found key and the index where it was found in parameters */
-/* If the key is not found, the nearest index from the bottom will be returned, */
-/* allowing the ability to find where an key should go into the list. */
+/* returns the index of the first node with the key in parameters */
+/* If the key is not found, the index where the key should go */
+/* into the list will be returned. */
 static int FindIndex(
     OS_Keylist list,
     KEY key,
     int *pIndex)
 {
-    struct Keylist_Node *node;  /* holds the new node */
-    int left = 0;       /* the left branch of tree, beginning of list */
-    int right = 0;      /* the right branch on the tree, end of list */
+    int left = 0;       /* the first node that might be the key */
+    int right = 0;      /* one past the last node that might be */
     int index = 0;      /* our current search place in the array */
-    KEY current_key = 0;        /* place holder for current node key */
-    int status = FALSE; /* return value */
+
     if (!list || !list->array || !list->count) {
         *pIndex = 0;
         return (FALSE);
     }
-    right = list->count - 1;
+    right = list->count;
     /* assume that the list is sorted */
-    do {
-
-        /* A binary search */
-        index = (left + right) / 2;
-        node = list->array[index];
-        if (!node)
-            break;
-        current_key = node->key;
-        if (key < current_key)
-            right = index - 1;
-
-        else
+    while (left < right) {
+        index = left + ((right - left) / 2);
+        if (list->array[index]->key < key)
             left = index + 1;
-    }
-    while ((key != current_key) && (left <= right));
-    if (key == current_key) {
-        status = TRUE;
-        *pIndex = index;
-    }
-
-    else {
-
-        /* where the index should be */
-        if (key > current_key)
-            *pIndex = index + 1;
-
         else
-            *pIndex = index;
+            right = index;
     }
-    return (status);
+    *pIndex = left;
+
+    return ((left < list->count) && (list->array[left]->key == key));
 }
 
 
 /*/////////////////////////////////////////////////////////////////// */
 /* list data functions */
 /*/////////////////////////////////////////////////////////////////// */
-/* inserts a node into its sorted position */
+/* inserts a node into its sorted position, */
+/* in front of any nodes with the same key */
 int Keylist_Data_Add(
     OS_Keylist list,
     KEY key,
@@ -179,37 +293,22 @@ int Keylist_Data_Add(
 {
     struct Keylist_Node *node;  /* holds the new node */
     int index = -1;     /* return value */
-    int i;      /* counts through the array */
-
-    if (list && CheckArraySize(list)) {
-        /* figure out where to put the new node */
-        if (list->count) {
-            (void) FindIndex(list, key, &index);
-            /* Add to the beginning of the list */
-            if (index < 0)
-                index = 0;
-
-            /* Add to the end of the list */
-            else if (index > list->count)
-                index = list->count;
-
-            /* Move all the items up to make room for the new one */
-            for (i = list->count; i > index; i--) {
-                list->array[i] = list->array[i - 1];
-            }
-        }
-
-        else {
-            index = 0;
-        }
 
+    if (list && CheckArraySize(list) && CheckTableSize(list,
+            list->count + 1)) {
         /* create and add the node */
         node = NodeCreate();
         if (node) {
-            list->count++;
             node->key = key;
             node->data = data;
+            /* figure out where to put the new node */
+            (void) FindIndex(list, key, &index);
+            /* Move all the items up to make room for the new one */
+            memmove(&list->array[index + 1], &list->array[index],
+                (size_t) (list->count - index) * sizeof(list->array[0]));
             list->array[index] = node;
+            list->count++;
+            TableInsert(list, node);
         }
     }
     return index;
@@ -227,33 +326,17 @@ void *Keylist_Data_Delete_By_Index(
     if (list && list->array && list->count && (index >= 0) &&
         (index < list->count)) {
         node = list->array[index];
-        if (node)
-            data = node->data;
-
-        /* move the nodes to account for the deleted one */
-        if (list->count == 1) {
-
-            /* There is no node shifting to do */
-        }
-        /* We are the last one */
-        else if (index == (list->count - 1)) {
-
-            /* There is no node shifting to do */
-        }
+        data = node->data;
+        TableRemove(list, node);
         /* Move all the nodes down one */
-        else {
-            int i;      /* counter */
-            int count = list->count - 1;
-            for (i = index; i < count; i++) {
-                list->array[i] = list->array[i + 1];
-            }
-        }
+        memmove(&list->array[index], &list->array[index + 1],
+            (size_t) (list->count - index - 1) * sizeof(list->array[0]));
         list->count--;
-        if (node)
-            free(node);
+        pool_free(&Node_Pool, node);
 
-        /* potentially reduce the size of the array */
+        /* potentially reduce the size of the array and table */
         (void) CheckArraySize(list);
+        (void) CheckTableSize(list, list->count);
     }
     return (data);
 }
@@ -297,12 +380,9 @@ void *Keylist_Data(
     KEY key)
 {
     struct Keylist_Node *node = NULL;
-    int index = 0;      /* used to look up the index of node */
 
-    if (list && list->array && list->count) {
-        if (FindIndex(list, key, &index))
-            node = list->array[index];
-    }
+    if (list && list->count)
+        node = TableFind(list, key);
 
     return node ? node->data : NULL;
 }
@@ -344,10 +424,8 @@ KEY Keylist_Next_Empty_Key(
     OS_Keylist list,
     KEY key)
 {
-    int index;
-
-    if (list) {
-        while (FindIndex(list, key, &index)) {
+    if (list && list->count) {
+        while (TableFind(list, key)) {
             if (KEY_LAST(key))
                 break;
             key++;
@@ -375,8 +453,10 @@ OS_Keylist Keylist_Create(
     struct Keylist *list;
 
     list = KeylistCreate();
-    if (list)
+    if (list) {
         CheckArraySize(list);
+        CheckTableSize(list, 0);
+    }
 
     return list;
 }
@@ -385,14 +465,18 @@ OS_Keylist Keylist_Create(
 void Keylist_Delete(
     OS_Keylist list)
 {       /* list number to be deleted */
+    int i;
+
     if (list) {
         /* clean out the list */
-        while (list->count) {
-            (void) Keylist_Data_Delete_By_Index(list, 0);
+        for (i = 0; i < list->count; i++) {
+            pool_free(&Node_Pool, list->array[i]);
         }
         if (list->array)
             free(list->array);
-        free(list);
+        if (list->table)
+            free(list->table);
+        pool_free(&List_Pool, list);
     }
 
     return;
@@ -680,6 +764,146 @@ void testKeyListLarge(
     return;
 }
 
+/* test duplicate keys, and the next empty key */
+void testKeyListDuplicates(
+    Test * pTest)
+{
+    OS_Keylist list;
+    int index;
+    char *data1 = "Joshua";
+    char *data2 = "Anna";
+    char *data3 = "Mary";
+    char *data4 = "Steve";
+    char *data;
+
+    list = Keylist_Create();
+    ct_test(pTest, list != NULL);
+
+    index = Keylist_Data_Add(list, 5, data1);
+    ct_test(pTest, index == 0);
+    index = Keylist_Data_Add(list, 7, data2);
+    ct_test(pTest, index == 1);
+    index = Keylist_Data_Add(list, 5, data3);
+    ct_test(pTest, index == 0);
+    index = Keylist_Data_Add(list, 5, data4);
+    ct_test(pTest, index == 0);
+    /* the newest of a key is first */
+    data = Keylist_Data(list, 5);
+    ct_test(pTest, data == data4);
+    ct_test(pTest, Keylist_Data_Index(list, 1) == data3);
+    ct_test(pTest, Keylist_Data_Index(list, 2) == data1);
+    ct_test(pTest, Keylist_Data_Index(list, 3) == data2);
+    ct_test(pTest, Keylist_Next_Empty_Key(list, 5) == 6);
+    ct_test(pTest, Keylist_Next_Empty_Key(list, 7) == 8);
+    ct_test(pTest, Keylist_Next_Empty_Key(list, 0) == 0);
+    /* delete from the middle of the duplicates */
+    data = Keylist_Data_Delete_By_Index(list, 1);
+    ct_test(pTest, data == data3);
+    ct_test(pTest, Keylist_Data(list, 5) == data4);
+    data = Keylist_Data_Delete(list, 5);
+    ct_test(pTest, data == data4);
+    ct_test(pTest, Keylist_Data(list, 5) == data1);
+    data = Keylist_Data_Delete(list, 5);
+    ct_test(pTest, data == data1);
+    ct_test(pTest, Keylist_Data(list, 5) == NULL);
+    ct_test(pTest, Keylist_Data(list, 7) == data2);
+    ct_test(pTest, Keylist_Count(list) == 1);
+
+    Keylist_Delete(list);
+
+    return;
+}
+
+/* compare the list with a simple model of it after random changes */
+void testKeyListRandom(
+    Test * pTest)
+{
+    static KEY model_key[2048];
+    static int model_data[2048];
+    int model_count = 0;
+    OS_Keylist list;
+    KEY key;
+    int index;
+    int i;
+    int *data;
+    bool ok = true;
+    unsigned long seed = 1;
+    unsigned step;
+
+    list = Keylist_Create();
+    ct_test(pTest, list != NULL);
+    for (step = 0; step < 20000; step++) {
+        seed = (seed * 1103515245UL + 12345UL) & 0x7FFFFFFFUL;
+        /* few keys, so there are duplicates, spread over the table */
+        key = (KEY) ((seed >> 8) % 512) * 4099;
+        if ((model_count < 2048) && (((seed >> 4) % 8) < 5)) {
+            /* add, in front of the same keys */
+            for (i = 0; i < model_count; i++) {
+                if (model_key[i] >= key)
+                    break;
+            }
+            index = Keylist_Data_Add(list, key, &model_data[step % 2048]);
+            if (index != i)
+                ok = false;
+            memmove(&model_key[i + 1], &model_key[i],
+                (model_count - i) * sizeof(model_key[0]));
+            memmove(&model_data[i + 1], &model_data[i],
+                (model_count - i) * sizeof(model_data[0]));
+            model_key[i] = key;
+            model_data[i] = step % 2048;
+            model_count++;
+        } else if (model_count && (((seed >> 4) % 8) < 7)) {
+            /* delete by index */
+            i = (seed >> 12) % model_count;
+            data = Keylist_Data_Delete_By_Index(list, i);
+            if (data != &model_data[model_data[i]])
+                ok = false;
+            model_count--;
+            memmove(&model_key[i], &model_key[i + 1],
+                (model_count - i) * sizeof(model_key[0]));
+            memmove(&model_data[i], &model_data[i + 1],
+                (model_count - i) * sizeof(model_data[0]));
+        } else {
+            /* delete by key */
+            for (i = 0; i < model_count; i++) {
+                if (model_key[i] == key)
+                    break;
+            }
+            data = Keylist_Data_Delete(list, key);
+            if (i < model_count) {
+                if (data != &model_data[model_data[i]])
+                    ok = false;
+                model_count--;
+                memmove(&model_key[i], &model_key[i + 1],
+                    (model_count - i) * sizeof(model_key[0]));
+                memmove(&model_data[i], &model_data[i + 1],
+                    (model_count - i) * sizeof(model_data[0]));
+            } else if (data) {
+                ok = false;
+            }
+        }
+        if (Keylist_Count(list) != model_count)
+            ok = false;
+        if ((step % 64) == 0) {
+            for (i = 0; i < model_count; i++) {
+                if ((Keylist_Key(list, i) != model_key[i]) ||
+                    (Keylist_Data_Index(list,
+                            i) != &model_data[model_data[i]]))
+                    ok = false;
+                /* the first of each key is the one found by key */
+                if (((i == 0) || (model_key[i - 1] != model_key[i])) &&
+                    (Keylist_Data(list,
+                            model_key[i]) != &model_data[model_data[i]]))
+                    ok = false;
+            }
+        }
+    }
+    ct_test(pTest, ok);
+    Keylist_Delete(list);
+
+    return;
+}
+
 #ifdef TEST_KEYLIST
 int main(
     void)
@@ -700,6 +924,10 @@ int main(
     assert(rc);
     rc = ct_addTestFunction(pTest, testKeyListLarge);
     assert(rc);
+    rc = ct_addTestFunction(pTest, testKeyListDuplicates);
+    assert(rc);
+    rc = ct_addTestFunction(pTest, testKeyListRandom);
+    assert(rc);
 
     ct_setStream(pTest, stdout);
     ct_run(pTest);
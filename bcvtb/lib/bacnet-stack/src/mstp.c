@@ -227,7 +227,6 @@ uint16_t MSTP_Create_Frame(
     index = 8;
     while (data_len && data && (index < buffer_len)) {
         buffer[index] = *data;
-        crc16 = CRC_Calc_Data(buffer[index], crc16);
         data++;
         index++;
         data_len--;
@@ -235,6 +234,7 @@ uint16_t MSTP_Create_Frame(
     /* append the data CRC if necessary */
     if (index > 8) {
         if ((index + 2) <= buffer_len) {
+            crc16 = CRC_Calc_Data_Block(&buffer[8], index - 8, crc16);
             crc16 = ~crc16;
             buffer[index] = crc16 & 0xFF;       /* LSB first */
             index++;
@@ -505,16 +505,17 @@ void MSTP_Receive_Frame_FSM(
             } else if (mstp_port->DataAvailable == true) {
                 printf_receive_data("%02X ", mstp_port->DataRegister);
                 if (mstp_port->Index < mstp_port->DataLength) {
-                    /* DataOctet */
-                    mstp_port->DataCRC =
-                        CRC_Calc_Data(mstp_port->DataRegister,
-                        mstp_port->DataCRC);
+                    /* DataOctet - the CRC of the data octets is
+                       taken in one block when the CRC arrives */
                     mstp_port->InputBuffer[mstp_port->Index] =
                         mstp_port->DataRegister;
                     mstp_port->Index++;
                     mstp_port->receive_state = MSTP_RECEIVE_STATE_DATA;
                 } else if (mstp_port->Index == mstp_port->DataLength) {
                     /* CRC1 */
+                    mstp_port->DataCRC =
+                        CRC_Calc_Data_Block(mstp_port->InputBuffer,
+                        mstp_port->DataLength, mstp_port->DataCRC);
                     mstp_port->DataCRC =
                         CRC_Calc_Data(mstp_port->DataRegister,
                         mstp_port->DataCRC);
@@ -0,0 +1,865 @@
+/**************************************************************************
+*
+* Copyright (C) 2026 agent <agent@local>
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+*********************************************************************/
+
+/* Functional Description: pcapng capture file writer and reader.
+   The blocks are written in host byte order, which the byte order
+   magic of the section header tells the reader about.
+   See the unit tests for usage examples. */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pcapng.h"
+
+#define PCAPNG_BLOCK_SECTION_HEADER 0x0A0D0D0A
+#define PCAPNG_BLOCK_INTERFACE 0x00000001
+#define PCAPNG_BLOCK_SIMPLE_PACKET 0x00000003
+#define PCAPNG_BLOCK_ENHANCED_PACKET 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+#define PCAPNG_OPTION_END 0
+#define PCAPNG_OPTION_IF_TSRESOL 9
+/* the block type, block length and trailing block length */
+#define PCAPNG_BLOCK_OVERHEAD 12
+/* interface id, timestamp, captured and original length */
+#define PCAPNG_PACKET_OVERHEAD (PCAPNG_BLOCK_OVERHEAD + 20)
+/* link type, reserved, snaplen, if_tsresol option, end of options */
+#define PCAPNG_INTERFACE_SIZE (PCAPNG_BLOCK_OVERHEAD + 8 + 8 + 4)
+/* byte order magic, version, section length */
+#define PCAPNG_SECTION_SIZE (PCAPNG_BLOCK_OVERHEAD + 16)
+
+#define PCAPNG_PAD4(n) (((n) + 3) & ~3UL)
+/* largest block or record that the reader will take */
+#define PCAPNG_MAX_BLOCK (16UL * 1024UL * 1024UL)
+
+/* libpcap file header magic numbers */
+#define PCAP_MAGIC_MICROSECONDS 0xA1B2C3D4
+#define PCAP_MAGIC_NANOSECONDS 0xA1B23C4D
+#define PCAP_HEADER_SIZE 24
+#define PCAP_RECORD_SIZE 16
+
+static void write_bytes(
+    PCAPNG_WRITER * writer,
+    const void *data,
+    size_t length)
+{
+    if (length) {
+        fwrite(data, length, 1, writer->file);
+        writer->file_size += length;
+    }
+}
+
+static void write_u16(
+    PCAPNG_WRITER * writer,
+    uint16_t value)
+{
+    write_bytes(writer, &value, sizeof(value));
+}
+
+static void write_u32(
+    PCAPNG_WRITER * writer,
+    uint32_t value)
+{
+    write_bytes(writer, &value, sizeof(value));
+}
+
+static void write_section_header(
+    PCAPNG_WRITER * writer)
+{
+    write_u32(writer, PCAPNG_BLOCK_SECTION_HEADER);
+    write_u32(writer, PCAPNG_SECTION_SIZE);
+    write_u32(writer, PCAPNG_BYTE_ORDER_MAGIC);
+    write_u16(writer, 1);       /* major version */
+    write_u16(writer, 0);       /* minor version */
+    /* section length is not known: -1 */
+    write_u32(writer, 0xFFFFFFFF);
+    write_u32(writer, 0xFFFFFFFF);
+    write_u32(writer, PCAPNG_SECTION_SIZE);
+}
+
+static void write_interface(
+    PCAPNG_WRITER * writer,
+    unsigned interface_id)
+{
+    uint8_t tsresol[4] = { 9, 0, 0, 0 };        /* nanoseconds, padded */
+
+    write_u32(writer, PCAPNG_BLOCK_INTERFACE);
+    write_u32(writer, PCAPNG_INTERFACE_SIZE);
+    write_u16(writer, writer->link_type[interface_id]);
+    write_u16(writer, 0);       /* reserved */
+    write_u32(writer, writer->snaplen[interface_id]);
+    write_u16(writer, PCAPNG_OPTION_IF_TSRESOL);
+    write_u16(writer, 1);
+    write_bytes(writer, tsresol, sizeof(tsresol));
+    write_u16(writer, PCAPNG_OPTION_END);
+    write_u16(writer, 0);
+    write_u32(writer, PCAPNG_INTERFACE_SIZE);
+}
+
+/* creates the current file and writes the section header
+   and the interfaces already added to it */
+static bool create_file(
+    PCAPNG_WRITER * writer)
+{
+    unsigned i;
+
+    if (writer->file_number) {
+        sprintf(writer->file_name, "%s.%u", writer->base_name,
+            writer->file_number);
+    } else {
+        strcpy(writer->file_name, writer->base_name);
+    }
+    writer->file = fopen(writer->file_name, "wb");
+    if (!writer->file) {
+        return false;
+    }
+    setvbuf(writer->file, NULL, _IOFBF, PCAPNG_BUFFER_SIZE);
+    writer->file_size = 0;
+    writer->file_packets = 0;
+    write_section_header(writer);
+    for (i = 0; i < writer->interface_count; i++) {
+        write_interface(writer, i);
+    }
+
+    return true;
+}
+
+bool pcapng_writer_open(
+    PCAPNG_WRITER * writer,
+    const char *filename,
+    uint32_t max_file_size)
+{
+    if (!writer || !filename ||
+        (strlen(filename) >= sizeof(writer->base_name))) {
+        return false;
+    }
+    memset(writer, 0, sizeof(*writer));
+    strcpy(writer->base_name, filename);
+    writer->max_file_size = max_file_size;
+
+    return create_file(writer);
+}
+
+int pcapng_writer_add_interface(
+    PCAPNG_WRITER * writer,
+    uint16_t link_type,
+    uint32_t snaplen)
+{
+    unsigned interface_id;
+
+    if (!writer->file || (writer->interface_count >= PCAPNG_MAX_INTERFACES)) {
+        return -1;
+    }
+    interface_id = writer->interface_count;
+    writer->link_type[interface_id] = link_type;
+    writer->snaplen[interface_id] = snaplen;
+    writer->interface_count++;
+    write_interface(writer, interface_id);
+
+    return (int) interface_id;
+}
+
+bool pcapng_writer_packet(
+    PCAPNG_WRITER * writer,
+    unsigned interface_id,
+    uint64_t timestamp,
+    const uint8_t * data,
+    uint32_t length)
+{
+    uint32_t captured, block_len;
+    uint8_t pad[4] = { 0, 0, 0, 0 };
+
+    if (!writer->file || (interface_id >= writer->interface_count)) {
+        return false;
+    }
+    captured = length;
+    if (writer->snaplen[interface_id] &&
+        (captured > writer->snaplen[interface_id])) {
+        captured = writer->snaplen[interface_id];
+    }
+    block_len = PCAPNG_PACKET_OVERHEAD + PCAPNG_PAD4(captured);
+    if (writer->max_file_size && writer->file_packets &&
+        ((writer->file_size + block_len) > writer->max_file_size)) {
+        fclose(writer->file);
+        writer->file_number++;
+        if (!create_file(writer)) {
+            return false;
+        }
+    }
+    write_u32(writer, PCAPNG_BLOCK_ENHANCED_PACKET);
+    write_u32(writer, block_len);
+    write_u32(writer, interface_id);
+    write_u32(writer, (uint32_t) (timestamp >> 32));
+    write_u32(writer, (uint32_t) timestamp);
+    write_u32(writer, captured);
+    write_u32(writer, length);
+    write_bytes(writer, data, captured);
+    write_bytes(writer, pad, PCAPNG_PAD4(captured) - captured);
+    write_u32(writer, block_len);
+    writer->file_packets++;
+
+    return !ferror(writer->file);
+}
+
+void pcapng_writer_flush(
+    PCAPNG_WRITER * writer)
+{
+    if (writer->file) {
+        fflush(writer->file);
+    }
+}
+
+void pcapng_writer_close(
+    PCAPNG_WRITER * writer)
+{
+    if (writer->file) {
+        fclose(writer->file);
+        writer->file = NULL;
+    }
+}
+
+static uint32_t swap_u32(
+    uint32_t value)
+{
+    return ((value >> 24) & 0x000000FF) | ((value >> 8) & 0x0000FF00) |
+        ((value << 8) & 0x00FF0000) | ((value << 24) & 0xFF000000);
+}
+
+/* value of the 32 bit field at buffer, in the byte order of the file */
+static uint32_t read_u32(
+    PCAPNG_READER * reader,
+    const uint8_t * buffer)
+{
+    uint32_t value;
+
+    memcpy(&value, buffer, sizeof(value));
+    if (reader->swapped) {
+        value = swap_u32(value);
+    }
+
+    return value;
+}
+
+static uint16_t read_u16(
+    PCAPNG_READER * reader,
+    const uint8_t * buffer)
+{
+    uint16_t value;
+
+    memcpy(&value, buffer, sizeof(value));
+    if (reader->swapped) {
+        value = (uint16_t) ((value >> 8) | (value << 8));
+    }
+
+    return value;
+}
+
+/* reads length octets from the file into the buffer of the reader,
+   after the first offset octets which are already there */
+static bool read_buffer(
+    PCAPNG_READER * reader,
+    size_t offset,
+    size_t length)
+{
+    uint8_t *buffer;
+
+    if (length > PCAPNG_MAX_BLOCK) {
+        return false;
+    }
+    if (length > reader->buffer_size) {
+        buffer = realloc(reader->buffer, length);
+        if (!buffer) {
+            return false;
+        }
+        reader->buffer = buffer;
+        reader->buffer_size = length;
+    }
+    if (length > offset) {
+        if (fread(&reader->buffer[offset], length - offset, 1,
+                reader->file) != 1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* converts a timestamp in units of the if_tsresol option to ns */
+static uint64_t timestamp_ns(
+    uint64_t timestamp,
+    uint8_t tsresol)
+{
+    uint64_t scale = 1;
+    unsigned exponent;
+
+    if (tsresol & 0x80) {
+        /* negative power of two */
+        exponent = tsresol & 0x7F;
+        if (exponent >= 64) {
+            return 0;
+        }
+        return ((timestamp >> exponent) * 1000000000ULL) +
+            (((timestamp & ((1ULL << exponent) - 1)) * 1000000000ULL) >>
+            exponent);
+    }
+    /* negative power of ten */
+    if (tsresol <= 9) {
+        for (exponent = tsresol; exponent < 9; exponent++) {
+            scale *= 10;
+        }
+        return timestamp * scale;
+    }
+    for (exponent = 9; (exponent < tsresol) && (exponent < 29); exponent++) {
+        scale *= 10;
+    }
+
+    return timestamp / scale;
+}
+
+bool pcapng_reader_open(
+    PCAPNG_READER * reader,
+    const char *filename)
+{
+    uint8_t header[PCAP_HEADER_SIZE];
+    uint32_t magic;
+
+    if (!reader || !filename) {
+        return false;
+    }
+    memset(reader, 0, sizeof(*reader));
+    reader->file = fopen(filename, "rb");
+    if (!reader->file) {
+        return false;
+    }
+    if (fread(header, 12, 1, reader->file) != 1) {
+        pcapng_reader_close(reader);
+        return false;
+    }
+    memcpy(&magic, header, sizeof(magic));
+    if (magic == PCAPNG_BLOCK_SECTION_HEADER) {
+        /* the section header is read as the first block */
+        reader->pcapng = true;
+        fseek(reader->file, 0, SEEK_SET);
+        return true;
+    }
+    if ((magic == swap_u32(PCAP_MAGIC_MICROSECONDS)) ||
+        (magic == swap_u32(PCAP_MAGIC_NANOSECONDS))) {
+        reader->swapped = true;
+        magic = swap_u32(magic);
+    }
+    if ((magic != PCAP_MAGIC_MICROSECONDS) &&
+        (magic != PCAP_MAGIC_NANOSECONDS)) {
+        pcapng_reader_close(reader);
+        return false;
+    }
+    if (fread(&header[12], PCAP_HEADER_SIZE - 12, 1, reader->file) != 1) {
+        pcapng_reader_close(reader);
+        return false;
+    }
+    reader->fraction_ns = (magic == PCAP_MAGIC_NANOSECONDS) ? 1 : 1000;
+    reader->link_type = (uint16_t) read_u32(reader, &header[20]);
+
+    return true;
+}
+
+static bool pcap_next(
+    PCAPNG_READER * reader,
+    PCAPNG_PACKET * packet)
+{
+    uint32_t seconds, fraction, length;
+
+    if (!read_buffer(reader, 0, PCAP_RECORD_SIZE)) {
+        return false;
+    }
+    seconds = read_u32(reader, &reader->buffer[0]);
+    fraction = read_u32(reader, &reader->buffer[4]);
+    length = read_u32(reader, &reader->buffer[8]);
+    packet->original_length = read_u32(reader, &reader->buffer[12]);
+    if (!read_buffer(reader, PCAP_RECORD_SIZE, PCAP_RECORD_SIZE + length)) {
+        return false;
+    }
+    packet->link_type = reader->link_type;
+    packet->timestamp = ((uint64_t) seconds * 1000000000ULL) +
+        ((uint64_t) fraction * reader->fraction_ns);
+    packet->data = &reader->buffer[PCAP_RECORD_SIZE];
+    packet->length = length;
+
+    return true;
+}
+
+/* learns the link type and timestamp resolution of an interface */
+static void pcapng_interface(
+    PCAPNG_READER * reader,
+    uint32_t block_len)
+{
+    unsigned interface_id = reader->interface_count;
+    uint32_t offset = 16;
+    uint16_t code, length;
+
+    reader->interface_count++;
+    if (interface_id >= PCAPNG_MAX_INTERFACES) {
+        return;
+    }
+    reader->if_link_type[interface_id] = read_u16(reader, &reader->buffer[8]);
+    reader->if_tsresol[interface_id] = 6;
+    while ((offset + 4) <= (block_len - 4)) {
+        code = read_u16(reader, &reader->buffer[offset]);
+        length = read_u16(reader, &reader->buffer[offset + 2]);
+        if ((code == PCAPNG_OPTION_END) ||
+            ((offset + 4 + length) > (block_len - 4))) {
+            break;
+        }
+        if ((code == PCAPNG_OPTION_IF_TSRESOL) && (length >= 1)) {
+            reader->if_tsresol[interface_id] = reader->buffer[offset + 4];
+        }
+        offset += 4 + PCAPNG_PAD4(length);
+    }
+}
+
+static bool pcapng_next(
+    PCAPNG_READER * reader,
+    PCAPNG_PACKET * packet)
+{
+    uint32_t block_type, block_len, interface_id, length;
+    uint64_t timestamp;
+
+    for (;;) {
+        if (!read_buffer(reader, 0, 8)) {
+            return false;
+        }
+        block_type = read_u32(reader, &reader->buffer[0]);
+        if (block_type == PCAPNG_BLOCK_SECTION_HEADER) {
+            /* a new section can be in the other byte order */
+            if (!read_buffer(reader, 8, 12)) {
+                return false;
+            }
+            reader->swapped = false;
+            if (read_u32(reader, &reader->buffer[8]) !=
+                PCAPNG_BYTE_ORDER_MAGIC) {
+                reader->swapped = true;
+                if (read_u32(reader, &reader->buffer[8]) !=
+                    PCAPNG_BYTE_ORDER_MAGIC) {
+                    return false;
+                }
+            }
+            reader->interface_count = 0;
+        }
+        block_len = read_u32(reader, &reader->buffer[4]);
+        if ((block_len < PCAPNG_BLOCK_OVERHEAD) || (block_len % 4)) {
+            return false;
+        }
+        if (!read_buffer(reader, (block_type ==
+                    PCAPNG_BLOCK_SECTION_HEADER) ? 12 : 8, block_len)) {
+            return false;
+        }
+        if (block_type == PCAPNG_BLOCK_INTERFACE) {
+            if (block_len >= 20) {
+                pcapng_interface(reader, block_len);
+            }
+        } else if ((block_type == PCAPNG_BLOCK_ENHANCED_PACKET) &&
+            (block_len >= PCAPNG_PACKET_OVERHEAD)) {
+            interface_id = read_u32(reader, &reader->buffer[8]);
+            length = read_u32(reader, &reader->buffer[20]);
+            if ((interface_id < reader->interface_count) &&
+                (interface_id < PCAPNG_MAX_INTERFACES) &&
+                (length <= (block_len - PCAPNG_PACKET_OVERHEAD))) {
+                timestamp = read_u32(reader, &reader->buffer[12]);
+                timestamp = (timestamp << 32) |
+                    read_u32(reader, &reader->buffer[16]);
+                packet->link_type = reader->if_link_type[interface_id];
+                packet->timestamp = timestamp_ns(timestamp,
+                    reader->if_tsresol[interface_id]);
+                packet->data = &reader->buffer[28];
+                packet->length = length;
+                packet->original_length =
+                    read_u32(reader, &reader->buffer[24]);
+                return true;
+            }
+        } else if ((block_type == PCAPNG_BLOCK_SIMPLE_PACKET) &&
+            (block_len >= 16) && (reader->interface_count > 0)) {
+            /* no timestamp, and the packet is cut to the snaplen */
+            packet->original_length = read_u32(reader, &reader->buffer[8]);
+            length = block_len - 16;
+            if (packet->original_length < length) {
+                length = packet->original_length;
+            }
+            packet->link_type = reader->if_link_type[0];
+            packet->timestamp = 0;
+            packet->data = &reader->buffer[12];
+            packet->length = length;
+            return true;
+        }
+        /* other blocks are skipped */
+    }
+}
+
+bool pcapng_reader_next(
+    PCAPNG_READER * reader,
+    PCAPNG_PACKET * packet)
+{
+    if (!reader->file) {
+        return false;
+    }
+    if (reader->pcapng) {
+        return pcapng_next(reader, packet);
+    }
+
+    return pcap_next(reader, packet);
+}
+
+void pcapng_reader_close(
+    PCAPNG_READER * reader)
+{
+    if (reader->file) {
+        fclose(reader->file);
+        reader->file = NULL;
+    }
+    free(reader->buffer);
+    reader->buffer = NULL;
+    reader->buffer_size = 0;
+}
+
+#ifdef TEST
+#include <assert.h>
+#include "ctest.h"
+
+static uint32_t get_u32(
+    const uint8_t * buffer)
+{
+    uint32_t value;
+
+    memcpy(&value, buffer, sizeof(value));
+
+    return value;
+}
+
+static uint16_t get_u16(
+    const uint8_t * buffer)
+{
+    uint16_t value;
+
+    memcpy(&value, buffer, sizeof(value));
+
+    return value;
+}
+
+/* reads a whole capture file into buffer */
+static size_t read_file(
+    const char *filename,
+    uint8_t * buffer,
+    size_t size)
+{
+    FILE *file;
+    size_t length = 0;
+
+    file = fopen(filename, "rb");
+    if (file) {
+        length = fread(buffer, 1, size, file);
+        fclose(file);
+    }
+
+    return length;
+}
+
+/* checks the section header and interface blocks at the start of
+   a file, and returns the offset of the first packet */
+static size_t testFileHeader(
+    Test * pTest,
+    const uint8_t * buffer,
+    size_t length,
+    unsigned interfaces)
+{
+    size_t offset = 0;
+    unsigned i;
+
+    ct_test(pTest, length >= PCAPNG_SECTION_SIZE);
+    ct_test(pTest, get_u32(&buffer[0]) == PCAPNG_BLOCK_SECTION_HEADER);
+    ct_test(pTest, get_u32(&buffer[4]) == PCAPNG_SECTION_SIZE);
+    ct_test(pTest, get_u32(&buffer[8]) == PCAPNG_BYTE_ORDER_MAGIC);
+    ct_test(pTest, get_u16(&buffer[12]) == 1);
+    ct_test(pTest, get_u16(&buffer[14]) == 0);
+    ct_test(pTest, get_u32(&buffer[24]) == PCAPNG_SECTION_SIZE);
+    offset = PCAPNG_SECTION_SIZE;
+    for (i = 0; i < interfaces; i++) {
+        ct_test(pTest, get_u32(&buffer[offset]) == PCAPNG_BLOCK_INTERFACE);
+        ct_test(pTest, get_u32(&buffer[offset + 4]) ==
+            PCAPNG_INTERFACE_SIZE);
+        ct_test(pTest, get_u16(&buffer[offset + 16]) ==
+            PCAPNG_OPTION_IF_TSRESOL);
+        ct_test(pTest, buffer[offset + 20] == 9);
+        ct_test(pTest, get_u32(&buffer[offset + PCAPNG_INTERFACE_SIZE - 4])
+            == PCAPNG_INTERFACE_SIZE);
+        offset += PCAPNG_INTERFACE_SIZE;
+    }
+
+    return offset;
+}
+
+void testPcapngWriter(
+    Test * pTest)
+{
+    PCAPNG_WRITER writer;
+    static uint8_t buffer[4096];
+    uint8_t frame[13] = { 0x55, 0xFF, 0x05, 0x01, 0x02, 0x00, 0x03,
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05
+    };
+    uint64_t timestamp = 1234567890123456789ULL;
+    size_t length, offset;
+    int id;
+    bool status;
+
+    status = pcapng_writer_open(&writer, "pcapng_test.pcapng", 0);
+    ct_test(pTest, status);
+    id = pcapng_writer_add_interface(&writer, PCAPNG_LINKTYPE_BACNET_MS_TP,
+        0);
+    ct_test(pTest, id == 0);
+    id = pcapng_writer_add_interface(&writer, PCAPNG_LINKTYPE_ETHERNET, 8);
+    ct_test(pTest, id == 1);
+    status = pcapng_writer_packet(&writer, 0, timestamp, frame,
+        sizeof(frame));
+    ct_test(pTest, status);
+    /* snaplen of the second interface cuts the packet to 8 octets */
+    status = pcapng_writer_packet(&writer, 1, timestamp + 1, frame,
+        sizeof(frame));
+    ct_test(pTest, status);
+    /* no such interface */
+    status = pcapng_writer_packet(&writer, 2, timestamp, frame,
+        sizeof(frame));
+    ct_test(pTest, !status);
+    pcapng_writer_close(&writer);
+
+    length = read_file("pcapng_test.pcapng", buffer, sizeof(buffer));
+    offset = testFileHeader(pTest, buffer, length, 2);
+    ct_test(pTest, get_u16(&buffer[PCAPNG_SECTION_SIZE + 8]) ==
+        PCAPNG_LINKTYPE_BACNET_MS_TP);
+    ct_test(pTest, get_u16(&buffer[PCAPNG_SECTION_SIZE +
+                PCAPNG_INTERFACE_SIZE + 8]) == PCAPNG_LINKTYPE_ETHERNET);
+    /* first packet: 13 octets padded to 16 */
+    ct_test(pTest, get_u32(&buffer[offset]) == PCAPNG_BLOCK_ENHANCED_PACKET);
+    ct_test(pTest, get_u32(&buffer[offset + 4]) == 32 + 16);
+    ct_test(pTest, get_u32(&buffer[offset + 8]) == 0);
+    ct_test(pTest, get_u32(&buffer[offset + 12]) ==
+        (uint32_t) (timestamp >> 32));
+    ct_test(pTest, get_u32(&buffer[offset + 16]) == (uint32_t) timestamp);
+    ct_test(pTest, get_u32(&buffer[offset + 20]) == sizeof(frame));
+    ct_test(pTest, get_u32(&buffer[offset + 24]) == sizeof(frame));
+    ct_test(pTest, memcmp(&buffer[offset + 28], frame, sizeof(frame)) == 0);
+    ct_test(pTest, buffer[offset + 28 + 13] == 0);
+    ct_test(pTest, get_u32(&buffer[offset + 44]) == 32 + 16);
+    offset += 32 + 16;
+    /* second packet: captured 8 of 13 */
+    ct_test(pTest, get_u32(&buffer[offset + 4]) == 32 + 8);
+    ct_test(pTest, get_u32(&buffer[offset + 8]) == 1);
+    ct_test(pTest, get_u32(&buffer[offset + 16]) ==
+        (uint32_t) (timestamp + 1));
+    ct_test(pTest, get_u32(&buffer[offset + 20]) == 8);
+    ct_test(pTest, get_u32(&buffer[offset + 24]) == sizeof(frame));
+    ct_test(pTest, memcmp(&buffer[offset + 28], frame, 8) == 0);
+    offset += 32 + 8;
+    ct_test(pTest, offset == length);
+
+    remove("pcapng_test.pcapng");
+}
+
+void testPcapngRotate(
+    Test * pTest)
+{
+    PCAPNG_WRITER writer;
+    static uint8_t buffer[4096];
+    uint8_t frame[8] = { 0x55, 0xFF, 0x00, 0x01, 0x02, 0x00, 0x00, 0x00 };
+    size_t length, offset, header;
+    unsigned i;
+    bool status;
+
+    /* room for the headers and two packets of 40 octets per file */
+    header = PCAPNG_SECTION_SIZE + PCAPNG_INTERFACE_SIZE;
+    status = pcapng_writer_open(&writer, "pcapng_test.pcapng",
+        header + 80);
+    ct_test(pTest, status);
+    pcapng_writer_add_interface(&writer, PCAPNG_LINKTYPE_BACNET_MS_TP, 0);
+    for (i = 0; i < 5; i++) {
+        frame[7] = (uint8_t) i;
+        status = pcapng_writer_packet(&writer, 0, i, frame, sizeof(frame));
+        ct_test(pTest, status);
+    }
+    ct_test(pTest, writer.file_number == 2);
+    ct_test(pTest, strcmp(writer.file_name, "pcapng_test.pcapng.2") == 0);
+    pcapng_writer_close(&writer);
+
+    length = read_file("pcapng_test.pcapng", buffer, sizeof(buffer));
+    ct_test(pTest, length == header + 80);
+    offset = testFileHeader(pTest, buffer, length, 1);
+    ct_test(pTest, buffer[offset + 28 + 7] == 0);
+    ct_test(pTest, buffer[offset + 40 + 28 + 7] == 1);
+    length = read_file("pcapng_test.pcapng.1", buffer, sizeof(buffer));
+    ct_test(pTest, length == header + 80);
+    offset = testFileHeader(pTest, buffer, length, 1);
+    ct_test(pTest, get_u32(&buffer[offset + 16]) == 2);
+    ct_test(pTest, buffer[offset + 28 + 7] == 2);
+    ct_test(pTest, buffer[offset + 40 + 28 + 7] == 3);
+    length = read_file("pcapng_test.pcapng.2", buffer, sizeof(buffer));
+    ct_test(pTest, length == header + 40);
+    offset = testFileHeader(pTest, buffer, length, 1);
+    ct_test(pTest, buffer[offset + 28 + 7] == 4);
+
+    remove("pcapng_test.pcapng");
+    remove("pcapng_test.pcapng.1");
+    remove("pcapng_test.pcapng.2");
+}
+
+void testPcapngReader(
+    Test * pTest)
+{
+    PCAPNG_WRITER writer;
+    PCAPNG_READER reader;
+    PCAPNG_PACKET packet;
+    uint8_t frame[501];
+    uint64_t timestamp = 1234567890123456789ULL;
+    uint32_t value;
+    unsigned i;
+    FILE *file;
+    bool status;
+
+    for (i = 0; i < sizeof(frame); i++) {
+        frame[i] = (uint8_t) (i * 13);
+    }
+    /* pcapng, from the writer, with two link types */
+    status = pcapng_writer_open(&writer, "pcapng_test.pcapng", 0);
+    ct_test(pTest, status);
+    pcapng_writer_add_interface(&writer, PCAPNG_LINKTYPE_BACNET_MS_TP, 0);
+    pcapng_writer_add_interface(&writer, PCAPNG_LINKTYPE_ETHERNET, 100);
+    for (i = 0; i < 20; i++) {
+        pcapng_writer_packet(&writer, i % 2, timestamp + i, frame, 8 + i * 20);
+    }
+    pcapng_writer_close(&writer);
+    status = pcapng_reader_open(&reader, "pcapng_test.pcapng");
+    ct_test(pTest, status);
+    for (i = 0; i < 20; i++) {
+        status = pcapng_reader_next(&reader, &packet);
+        ct_test(pTest, status);
+        if (!status) {
+            break;
+        }
+        ct_test(pTest, packet.link_type ==
+            ((i % 2) ? PCAPNG_LINKTYPE_ETHERNET :
+                PCAPNG_LINKTYPE_BACNET_MS_TP));
+        ct_test(pTest, packet.timestamp == (timestamp + i));
+        ct_test(pTest, packet.original_length == (8 + i * 20));
+        if ((i % 2) && (packet.original_length > 100)) {
+            ct_test(pTest, packet.length == 100);
+        } else {
+            ct_test(pTest, packet.length == packet.original_length);
+        }
+        ct_test(pTest, memcmp(packet.data, frame, packet.length) == 0);
+    }
+    status = pcapng_reader_next(&reader, &packet);
+    ct_test(pTest, !status);
+    pcapng_reader_close(&reader);
+
+    /* libpcap, microseconds, written in the other byte order */
+    file = fopen("pcapng_test.pcapng", "wb");
+    ct_test(pTest, file != NULL);
+    if (file) {
+        value = swap_u32(PCAP_MAGIC_MICROSECONDS);
+        fwrite(&value, 4, 1, file);
+        value = swap_u32(0x00040002);   /* version 2.4 */
+        fwrite(&value, 4, 1, file);
+        value = 0;
+        fwrite(&value, 4, 1, file);
+        fwrite(&value, 4, 1, file);
+        value = swap_u32(65535);
+        fwrite(&value, 4, 1, file);
+        value = swap_u32(PCAPNG_LINKTYPE_BACNET_MS_TP);
+        fwrite(&value, 4, 1, file);
+        value = swap_u32(1262304000);
+        fwrite(&value, 4, 1, file);
+        value = swap_u32(123456);
+        fwrite(&value, 4, 1, file);
+        value = swap_u32(10);
+        fwrite(&value, 4, 1, file);
+        fwrite(&value, 4, 1, file);
+        fwrite(frame, 10, 1, file);
+        fclose(file);
+    }
+    status = pcapng_reader_open(&reader, "pcapng_test.pcapng");
+    ct_test(pTest, status);
+    status = pcapng_reader_next(&reader, &packet);
+    ct_test(pTest, status);
+    ct_test(pTest, packet.link_type == PCAPNG_LINKTYPE_BACNET_MS_TP);
+    ct_test(pTest, packet.timestamp == 1262304000123456000ULL);
+    ct_test(pTest, packet.length == 10);
+    ct_test(pTest, memcmp(packet.data, frame, 10) == 0);
+    status = pcapng_reader_next(&reader, &packet);
+    ct_test(pTest, !status);
+    pcapng_reader_close(&reader);
+
+    /* not a capture file */
+    file = fopen("pcapng_test.pcapng", "wb");
+    if (file) {
+        fwrite(frame, sizeof(frame), 1, file);
+        fclose(file);
+    }
+    status = pcapng_reader_open(&reader, "pcapng_test.pcapng");
+    ct_test(pTest, !status);
+    status = pcapng_reader_open(&reader, "pcapng_missing.pcapng");
+    ct_test(pTest, !status);
+
+    /* timestamp resolutions */
+    ct_test(pTest, timestamp_ns(1500000, 6) == 1500000000ULL);
+    ct_test(pTest, timestamp_ns(15, 1) == 1500000000ULL);
+    ct_test(pTest, timestamp_ns(1500000000000ULL, 12) == 1500000000ULL);
+    ct_test(pTest, timestamp_ns(3, 0x81) == 1500000000ULL);
+
+    remove("pcapng_test.pcapng");
+}
+
+#ifdef TEST_PCAPNG
+int main(
+    void)
+{
+    Test *pTest;
+    bool rc;
+
+    pTest = ct_create("pcapng", NULL);
+
+    /* individual tests */
+    rc = ct_addTestFunction(pTest, testPcapngWriter);
+    assert(rc);
+    rc = ct_addTestFunction(pTest, testPcapngRotate);
+    assert(rc);
+    rc = ct_addTestFunction(pTest, testPcapngReader);
+    assert(rc);
+
+    ct_setStream(pTest, stdout);
+    ct_run(pTest);
+    (void) ct_report(pTest);
+
+    ct_destroy(pTest);
+
+    return 0;
+}
+#endif /* TEST_PCAPNG */
+#endif /* TEST */
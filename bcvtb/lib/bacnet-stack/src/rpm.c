@@ -49,7 +49,12 @@ int rpm_encode_apdu_init(
 
     if (apdu) {
         apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
-        apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU);
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+        /* segmented response accepted */
+        apdu[0] |= BIT1;
+#endif
+        apdu[1] =
+            encode_max_segs_max_apdu(MAX_SEGMENTS_ACCEPTED, MAX_APDU);
         apdu[2] = invoke_id;
         apdu[3] = SERVICE_CONFIRMED_READ_PROP_MULTIPLE; /* service choice */
         apdu_len = 4;
@@ -479,11 +484,6 @@ int rpm_ack_decode_object_property(
     return (int) len;
 }
 
-#ifdef TEST
-#include <assert.h>
-#include <string.h>
-#include "ctest.h"
-
 int rpm_ack_decode_apdu(
     uint8_t * apdu,
     int apdu_len,       /* total length of the apdu */
@@ -512,6 +512,11 @@ int rpm_ack_decode_apdu(
     return offset;
 }
 
+#ifdef TEST
+#include <assert.h>
+#include <string.h>
+#include "ctest.h"
+
 int rpm_decode_apdu(
     uint8_t * apdu,
     unsigned apdu_len,
@@ -524,7 +529,7 @@ int rpm_decode_apdu(
     if (!apdu)
         return -1;
     /* optional checking - most likely was already done prior to this call */
-    if (apdu[0] != PDU_TYPE_CONFIRMED_SERVICE_REQUEST)
+    if ((apdu[0] & 0xF0) != PDU_TYPE_CONFIRMED_SERVICE_REQUEST)
         return -1;
     /*  apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU); */
     *invoke_id = apdu[2];       /* invoke id - filled in by net layer */
@@ -35,6 +35,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 #include "bits.h"
 #include "apdu.h"
 #include "bacdef.h"
@@ -46,6 +47,7 @@
 #include "handlers.h"
 #include "address.h"
 #include "bacaddr.h"
+#include "abort.h"
 
 #if (MAX_TSM_TRANSACTIONS)
 /* Transaction State Machine */
@@ -54,77 +56,123 @@
 /* If we are only a server and only initiate broadcasts, */
 /* then we don't need a TSM layer. */
 
-/* FIXME: not coded for segmentation */
+/* The request timers are kept in a hashed timer wheel: each bucket
+   holds the transactions that time out in the same tick, modulo the
+   number of buckets.  A timer tick only looks at the buckets that
+   have come due, rather than at every transaction. */
+#ifndef TSM_TIMER_WHEEL_SIZE
+#define TSM_TIMER_WHEEL_SIZE 64
+#endif
+/* milliseconds per bucket */
+#ifndef TSM_TIMER_TICK
+#define TSM_TIMER_TICK 100
+#endif
 
 /* declare space for the TSM transactions, and set it up in the init. */
 /* table rules: an Invoke ID = 0 is an unused spot in the table */
 static BACNET_TSM_DATA TSM_List[MAX_TSM_TRANSACTIONS];
+/* the table index + 1 for each invoke ID, 0 if it is not in use */
+static uint8_t TSM_Invoke_ID_Index[256];
+/* indexes of the free spots that have been used before */
+static uint8_t TSM_Free_List[MAX_TSM_TRANSACTIONS];
+static unsigned TSM_Free_Count = 0;
+/* spots from here on have never been used */
+static unsigned TSM_Never_Used = 0;
+/* the timer wheel buckets, as index + 1 into the table */
+static uint8_t TSM_Timer_Wheel[TSM_TIMER_WHEEL_SIZE];
+/* milliseconds since startup, and the last tick looked at */
+static uint32_t TSM_Clock = 0;
+static uint32_t TSM_Clock_Tick = 0;
 
 /* returns MAX_TSM_TRANSACTIONS if not found */
 static uint8_t tsm_find_invokeID_index(
     uint8_t invokeID)
 {
-    unsigned i = 0;     /* counter */
     uint8_t index = MAX_TSM_TRANSACTIONS;       /* return value */
 
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++) {
-        if (TSM_List[i].InvokeID == invokeID) {
-            index = i;
-            break;
-        }
+    if (TSM_Invoke_ID_Index[invokeID]) {
+        index = TSM_Invoke_ID_Index[invokeID] - 1;
     }
 
     return index;
 }
 
+/* takes a spot off the free list */
 static uint8_t tsm_find_first_free_index(
     void)
 {
-    unsigned i = 0;     /* counter */
     uint8_t index = MAX_TSM_TRANSACTIONS;       /* return value */
 
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++) {
-        if (TSM_List[i].InvokeID == 0) {
-            index = i;
-            break;
-        }
+    if (TSM_Free_Count) {
+        TSM_Free_Count--;
+        index = TSM_Free_List[TSM_Free_Count];
+    } else if (TSM_Never_Used < MAX_TSM_TRANSACTIONS) {
+        index = (uint8_t) TSM_Never_Used;
+        TSM_Never_Used++;
     }
 
     return index;
 }
 
-bool tsm_transaction_available(
-    void)
+static void tsm_timer_link(
+    uint8_t index)
 {
-    bool status = false;        /* return value */
-    unsigned i = 0;     /* counter */
+    unsigned bucket;
+    uint8_t head;
 
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++) {
-        if (TSM_List[i].InvokeID == 0) {
-            /* one is available! */
-            status = true;
-            break;
-        }
+    bucket = (TSM_List[index].RequestTimer / TSM_TIMER_TICK) %
+        TSM_TIMER_WHEEL_SIZE;
+    head = TSM_Timer_Wheel[bucket];
+    TSM_List[index].TimerPrev = 0;
+    TSM_List[index].TimerNext = head;
+    if (head) {
+        TSM_List[head - 1].TimerPrev = index + 1;
     }
-
-    return status;
+    TSM_Timer_Wheel[bucket] = index + 1;
 }
 
-uint8_t tsm_transaction_idle_count(
-    void)
+static void tsm_timer_unlink(
+    uint8_t index)
 {
-    uint8_t count = 0;  /* return value */
-    unsigned i = 0;     /* counter */
+    unsigned bucket;
+    uint8_t next = TSM_List[index].TimerNext;
+    uint8_t prev = TSM_List[index].TimerPrev;
 
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++) {
-        if ((TSM_List[i].InvokeID == 0) &&
-            (TSM_List[i].state == TSM_STATE_IDLE)) {
-            /* one is available! */
-            count++;
-        }
+    if (prev) {
+        TSM_List[prev - 1].TimerNext = next;
+    } else {
+        bucket = (TSM_List[index].RequestTimer / TSM_TIMER_TICK) %
+            TSM_TIMER_WHEEL_SIZE;
+        TSM_Timer_Wheel[bucket] = next;
+    }
+    if (next) {
+        TSM_List[next - 1].TimerPrev = prev;
     }
+    TSM_List[index].TimerNext = 0;
+    TSM_List[index].TimerPrev = 0;
+}
 
-    return count;
+/* start the request timer */
+static void tsm_timer_start(
+    uint8_t index)
+{
+    TSM_List[index].RequestTimer = TSM_Clock + apdu_timeout();
+    tsm_timer_link(index);
+}
+
+bool tsm_transaction_available(
+    void)
+{
+    return ((TSM_Free_Count != 0) ||
+        (TSM_Never_Used < MAX_TSM_TRANSACTIONS));
+}
+
+uint8_t tsm_transaction_idle_count(
+    void)
+{
+    /* the free spots are always idle */
+    return (uint8_t) (TSM_Free_Count + (MAX_TSM_TRANSACTIONS -
+            TSM_Never_Used));
 }
 
 /* gets the next free invokeID,
@@ -136,38 +184,29 @@ uint8_t tsm_next_free_invokeID(
     static uint8_t current_invokeID = 1;        /* incremented... */
     uint8_t index = 0;
     uint8_t invokeID = 0;
-    bool found = false;
 
     /* is there even space available? */
     if (tsm_transaction_available()) {
-        while (!found) {
-            index = tsm_find_invokeID_index(current_invokeID);
-            if (index == MAX_TSM_TRANSACTIONS) {
-                /* Not found, so this invokeID is not used */
-                found = true;
-                /* set this id into the table */
-                index = tsm_find_first_free_index();
-                if (index != MAX_TSM_TRANSACTIONS) {
-                    TSM_List[index].InvokeID = invokeID = current_invokeID;
-                    TSM_List[index].state = TSM_STATE_IDLE;
-                    TSM_List[index].RequestTimer = apdu_timeout();
-                    /* update for the next call or check */
-                    current_invokeID++;
-                    /* skip zero - we treat that internally as invalid or no free */
-                    if (current_invokeID == 0) {
-                        current_invokeID = 1;
-                    }
-                }
-            } else {
-                /* found! This invokeID is already used */
-                /* try next one */
-                current_invokeID++;
-                /* skip zero - we treat that internally as invalid or no free */
-                if (current_invokeID == 0) {
-                    current_invokeID = 1;
-                }
+        /* a free spot means at least one unused invoke ID,
+           so this stops */
+        while (TSM_Invoke_ID_Index[current_invokeID]) {
+            current_invokeID++;
+            /* skip zero - we treat that internally as invalid or no free */
+            if (current_invokeID == 0) {
+                current_invokeID = 1;
             }
         }
+        /* set this id into the table */
+        index = tsm_find_first_free_index();
+        TSM_List[index].InvokeID = invokeID = current_invokeID;
+        TSM_List[index].state = TSM_STATE_IDLE;
+        TSM_Invoke_ID_Index[invokeID] = index + 1;
+        /* update for the next call or check */
+        current_invokeID++;
+        /* skip zero - we treat that internally as invalid or no free */
+        if (current_invokeID == 0) {
+            current_invokeID = 1;
+        }
     }
 
     return invokeID;
@@ -186,11 +225,14 @@ void tsm_set_confirmed_unsegmented_transaction(
     if (invokeID) {
         index = tsm_find_invokeID_index(invokeID);
         if (index < MAX_TSM_TRANSACTIONS) {
+            if (TSM_List[index].state == TSM_STATE_AWAIT_CONFIRMATION) {
+                tsm_timer_unlink(index);
+            }
             /* assign the transaction */
             TSM_List[index].state = TSM_STATE_AWAIT_CONFIRMATION;
             TSM_List[index].RetryCount = apdu_retries();
             /* start the timer */
-            TSM_List[index].RequestTimer = apdu_timeout();
+            tsm_timer_start(index);
             /* copy the data */
             for (j = 0; j < apdu_len; j++) {
                 TSM_List[index].apdu[j] = apdu[j];
@@ -237,35 +279,582 @@ bool tsm_get_transaction_pdu(
     return found;
 }
 
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+/* A message that is sent or received in segments is kept here,
+   together with the segment variables of 5.4.1 and a buffer for
+   the whole message.  Where we are the client, the TSM entry of
+   our invoke ID goes with it.  Where we are the server, it is
+   known by the client's address and invoke ID. */
+typedef struct BACnet_TSM_Segmented_Data {
+    /* IDLE is a free spot.  AWAIT_RESPONSE is a request that was
+       put back together and handed on, and the spot can be reused. */
+    BACNET_TSM_STATE state;
+    /* true when we are the server (the invoke ID was chosen by the peer) */
+    bool server;
+    uint8_t InvokeID;
+    /* the other end of the transaction */
+    BACNET_ADDRESS peer;
+    /* the network layer info for what we send to it */
+    BACNET_NPDU_DATA npdu_data;
+    /* the request header, for a segmented request */
+    BACNET_CONFIRMED_SERVICE_DATA service_data;
+    uint8_t service_choice;
+    /* used to count segment retries */
+    uint8_t SegmentRetryCount;
+    /* used to control APDU retries and the acceptance of server replies */
+    bool SentAllSegments;
+    /* stores the sequence number of the last segment received in order */
+    uint8_t LastSequenceNumber;
+    /* stores the sequence number of the first segment of */
+    /* a sequence of segments that fill a window */
+    uint8_t InitialSequenceNumber;
+    /* stores the current window size */
+    uint8_t ActualWindowSize;
+    /* used to perform timeout on PDU segments */
+    /* the TSM clock time, in milliseconds, when it times out */
+    uint32_t SegmentTimer;
+    /* when sending: the service data octets in each segment,
+       and the number of segments */
+    uint16_t segment_len;
+    uint16_t segment_count;
+    /* the service data of the whole message */
+    uint8_t data[MAX_SEGMENTED_APDU];
+    uint16_t data_len;
+} BACNET_TSM_SEGMENTED_DATA;
+
+/* octets before the service data in a segmented ComplexACK */
+#define TSM_SEGMENTED_ACK_HEADER_LEN 5
+/* the receiver waits this many segment timeouts for the next one */
+#define TSM_SEGMENT_RECEIVE_TIMEOUTS 4
+
+static BACNET_TSM_SEGMENTED_DATA
+    TSM_Segmented_List[MAX_SEGMENTED_TRANSACTIONS];
+/* a segment, SegmentACK or Abort on its way out, with its NPDU */
+static uint8_t TSM_Segment_Buffer[MAX_PDU];
+
+static BACNET_TSM_SEGMENTED_DATA *tsm_segmented_find(
+    BACNET_ADDRESS * peer,
+    uint8_t invokeID,
+    bool server)
+{
+    BACNET_TSM_SEGMENTED_DATA *seg = NULL;
+    unsigned i = 0;
+
+    for (i = 0; i < MAX_SEGMENTED_TRANSACTIONS; i++) {
+        if ((TSM_Segmented_List[i].state != TSM_STATE_IDLE) &&
+            (TSM_Segmented_List[i].server == server) &&
+            (TSM_Segmented_List[i].InvokeID == invokeID) &&
+            bacnet_address_same(&TSM_Segmented_List[i].peer, peer)) {
+            seg = &TSM_Segmented_List[i];
+            break;
+        }
+    }
+
+    return seg;
+}
+
+/* returns NULL if all the spots are in use */
+static BACNET_TSM_SEGMENTED_DATA *tsm_segmented_new(
+    BACNET_ADDRESS * peer,
+    uint8_t invokeID,
+    bool server,
+    BACNET_TSM_STATE state)
+{
+    BACNET_TSM_SEGMENTED_DATA *seg = NULL;
+    unsigned i = 0;
+
+    for (i = 0; i < MAX_SEGMENTED_TRANSACTIONS; i++) {
+        /* a request that was handed on has been answered by now */
+        if ((TSM_Segmented_List[i].state == TSM_STATE_IDLE) ||
+            (TSM_Segmented_List[i].state == TSM_STATE_AWAIT_RESPONSE)) {
+            seg = &TSM_Segmented_List[i];
+            break;
+        }
+    }
+    if (seg) {
+        seg->state = state;
+        seg->server = server;
+        seg->InvokeID = invokeID;
+        bacnet_address_copy(&seg->peer, peer);
+        npdu_encode_npdu_data(&seg->npdu_data, false,
+            MESSAGE_PRIORITY_NORMAL);
+        seg->SegmentRetryCount = 0;
+        seg->SentAllSegments = false;
+        /* so that segment 0 is the next one in order */
+        seg->LastSequenceNumber = 255;
+        seg->InitialSequenceNumber = 0;
+        seg->ActualWindowSize = 1;
+        seg->segment_len = 0;
+        seg->segment_count = 0;
+        seg->data_len = 0;
+    }
+
+    return seg;
+}
+
+/* fails the confirmed request that a ComplexACK was coming in for */
+static void tsm_segmented_release(
+    BACNET_TSM_SEGMENTED_DATA * seg)
+{
+    uint8_t index;
+
+    if (!seg->server) {
+        index = tsm_find_invokeID_index(seg->InvokeID);
+        if ((index < MAX_TSM_TRANSACTIONS) &&
+            (TSM_List[index].state == TSM_STATE_SEGMENTED_CONFIRMATION)) {
+            /* IDLE and a valid invoke id is a failed message */
+            TSM_List[index].state = TSM_STATE_IDLE;
+        }
+    }
+    seg->state = TSM_STATE_IDLE;
+}
+
+/* the window size is from 1..127, and we don't go above ours */
+static uint8_t tsm_segment_window_size(
+    uint8_t window_size)
+{
+    if (window_size == 0) {
+        window_size = 1;
+    } else if (window_size > MAX_SEGMENT_WINDOW) {
+        window_size = MAX_SEGMENT_WINDOW;
+    }
+
+    return window_size;
+}
+
+static void tsm_abort_send(
+    BACNET_ADDRESS * dest,
+    BACNET_NPDU_DATA * npdu_data,
+    uint8_t invokeID,
+    uint8_t abort_reason,
+    bool server)
+{
+    BACNET_ADDRESS my_address;
+    int pdu_len = 0;
+
+    datalink_get_my_address(&my_address);
+    pdu_len =
+        npdu_encode_pdu(&TSM_Segment_Buffer[0], dest, &my_address,
+        npdu_data);
+    pdu_len +=
+        abort_encode_apdu(&TSM_Segment_Buffer[pdu_len], invokeID,
+        abort_reason, server);
+    datalink_send_pdu(dest, npdu_data, &TSM_Segment_Buffer[0], pdu_len);
+}
+
+static void tsm_segment_ack_send(
+    BACNET_TSM_SEGMENTED_DATA * seg,
+    uint8_t sequence_number,
+    bool nak)
+{
+    BACNET_ADDRESS my_address;
+    int pdu_len = 0;
+
+    datalink_get_my_address(&my_address);
+    pdu_len =
+        npdu_encode_pdu(&TSM_Segment_Buffer[0], &seg->peer, &my_address,
+        &seg->npdu_data);
+    TSM_Segment_Buffer[pdu_len] = PDU_TYPE_SEGMENT_ACK;
+    if (nak) {
+        TSM_Segment_Buffer[pdu_len] |= BIT1;
+    }
+    if (seg->server) {
+        TSM_Segment_Buffer[pdu_len] |= BIT0;
+    }
+    pdu_len++;
+    TSM_Segment_Buffer[pdu_len++] = seg->InvokeID;
+    TSM_Segment_Buffer[pdu_len++] = sequence_number;
+    TSM_Segment_Buffer[pdu_len++] = seg->ActualWindowSize;
+    datalink_send_pdu(&seg->peer, &seg->npdu_data, &TSM_Segment_Buffer[0],
+        pdu_len);
+}
+
+static void tsm_segment_send(
+    BACNET_TSM_SEGMENTED_DATA * seg,
+    uint8_t sequence_number)
+{
+    BACNET_ADDRESS my_address;
+    int pdu_len = 0;
+    uint16_t offset = 0;
+    uint16_t len = 0;
+
+    offset = sequence_number * seg->segment_len;
+    len = seg->data_len - offset;
+    if (len > seg->segment_len) {
+        len = seg->segment_len;
+    }
+    datalink_get_my_address(&my_address);
+    pdu_len =
+        npdu_encode_pdu(&TSM_Segment_Buffer[0], &seg->peer, &my_address,
+        &seg->npdu_data);
+    TSM_Segment_Buffer[pdu_len] = PDU_TYPE_COMPLEX_ACK | BIT3;
+    if ((sequence_number + 1) < seg->segment_count) {
+        TSM_Segment_Buffer[pdu_len] |= BIT2;
+    }
+    pdu_len++;
+    TSM_Segment_Buffer[pdu_len++] = seg->InvokeID;
+    TSM_Segment_Buffer[pdu_len++] = sequence_number;
+    /* proposed window size */
+    TSM_Segment_Buffer[pdu_len++] = MAX_SEGMENT_WINDOW;
+    TSM_Segment_Buffer[pdu_len++] = seg->service_choice;
+    memcpy(&TSM_Segment_Buffer[pdu_len], &seg->data[offset], len);
+    pdu_len += len;
+    datalink_send_pdu(&seg->peer, &seg->npdu_data, &TSM_Segment_Buffer[0],
+        pdu_len);
+}
+
+/* FillWindow: sends the segments from InitialSequenceNumber on */
+static void tsm_segment_window_send(
+    BACNET_TSM_SEGMENTED_DATA * seg)
+{
+    unsigned sequence_number = seg->InitialSequenceNumber;
+    unsigned i = 0;
+
+    for (i = 0; (i < seg->ActualWindowSize) &&
+        (sequence_number < seg->segment_count); i++) {
+        tsm_segment_send(seg, (uint8_t) sequence_number);
+        sequence_number++;
+    }
+    seg->SentAllSegments = (sequence_number >= seg->segment_count);
+    seg->SegmentTimer = TSM_Clock + apdu_timeout();
+}
+
+/* takes a segment in, acknowledging it where the window says so.
+   returns true when it was the last one. */
+static bool tsm_segment_received(
+    BACNET_TSM_SEGMENTED_DATA * seg,
+    uint8_t sequence_number,
+    bool more_follows,
+    uint8_t * data,
+    uint16_t data_len)
+{
+    bool complete = false;
+
+    if (sequence_number != (uint8_t) (seg->LastSequenceNumber + 1)) {
+        /* SegmentReceivedOutOfOrder, or a duplicate */
+        tsm_segment_ack_send(seg, seg->LastSequenceNumber, true);
+        seg->InitialSequenceNumber = seg->LastSequenceNumber;
+    } else if (data_len > (sizeof(seg->data) - seg->data_len)) {
+        tsm_abort_send(&seg->peer, &seg->npdu_data, seg->InvokeID,
+            ABORT_REASON_BUFFER_OVERFLOW, seg->server);
+        tsm_segmented_release(seg);
+        return false;
+    } else {
+        memcpy(&seg->data[seg->data_len], data, data_len);
+        seg->data_len += data_len;
+        seg->LastSequenceNumber = sequence_number;
+        /* the first segment, the last one, and the end of each
+           window are acknowledged */
+        if ((!more_follows) || (sequence_number == 0) ||
+            (sequence_number == (uint8_t) (seg->InitialSequenceNumber +
+                    seg->ActualWindowSize))) {
+            tsm_segment_ack_send(seg, sequence_number, false);
+            seg->InitialSequenceNumber = sequence_number;
+        }
+        complete = !more_follows;
+    }
+    seg->SegmentTimer =
+        TSM_Clock + (TSM_SEGMENT_RECEIVE_TIMEOUTS * (uint32_t) apdu_timeout());
+
+    return complete;
+}
+
+bool tsm_segmented_complex_ack_send(
+    BACNET_ADDRESS * dest,
+    BACNET_NPDU_DATA * npdu_data,
+    BACNET_CONFIRMED_SERVICE_DATA * service_data,
+    uint8_t * apdu,
+    uint16_t apdu_len)
+{
+    BACNET_TSM_SEGMENTED_DATA *seg = NULL;
+    unsigned segment_len = 0;
+    unsigned segment_count = 0;
+    unsigned data_len = 0;
+
+    /* the ComplexACK header is 3 octets, and the segments have 5 */
+    if ((!service_data->segmented_response_accepted) || (apdu_len <= 3)) {
+        return false;
+    }
+    data_len = apdu_len - 3;
+    segment_len =
+        apdu_max_response(service_data) - TSM_SEGMENTED_ACK_HEADER_LEN;
+    segment_count = (data_len + segment_len - 1) / segment_len;
+    if ((data_len > MAX_SEGMENTED_APDU) ||
+        (segment_count > MAX_SEGMENTS_ACCEPTED) ||
+        (service_data->max_segs &&
+            (segment_count > (unsigned) service_data->max_segs))) {
+        return false;
+    }
+    /* the request may have come in segments, or this is the answer
+       to a request the client sent again */
+    seg = tsm_segmented_find(dest, service_data->invoke_id, true);
+    if (seg) {
+        seg->state = TSM_STATE_IDLE;
+    }
+    seg =
+        tsm_segmented_new(dest, service_data->invoke_id, true,
+        TSM_STATE_SEGMENTED_RESPONSE);
+    if (!seg) {
+        return false;
+    }
+    npdu_copy_data(&seg->npdu_data, npdu_data);
+    seg->service_choice = apdu[2];
+    memcpy(&seg->data[0], &apdu[3], data_len);
+    seg->data_len = (uint16_t) data_len;
+    seg->segment_len = (uint16_t) segment_len;
+    seg->segment_count = (uint16_t) segment_count;
+    /* the first segment goes alone, and the client's SegmentACK
+       gives the window size for the rest */
+    tsm_segment_window_send(seg);
+
+    return true;
+}
+
+void tsm_segment_ack_received(
+    BACNET_ADDRESS * src,
+    uint8_t invokeID,
+    uint8_t sequence_number,
+    uint8_t actual_window_size,
+    bool nak)
+{
+    BACNET_TSM_SEGMENTED_DATA *seg = NULL;
+
+    seg = tsm_segmented_find(src, invokeID, true);
+    if (!seg || (seg->state != TSM_STATE_SEGMENTED_RESPONSE)) {
+        return;
+    }
+    if ((uint8_t) (sequence_number - seg->InitialSequenceNumber) <
+        seg->ActualWindowSize) {
+        seg->SegmentRetryCount = 0;
+        if (seg->SentAllSegments &&
+            ((sequence_number + 1) == seg->segment_count)) {
+            /* FinalACK_Received */
+            seg->state = TSM_STATE_IDLE;
+        } else {
+            /* NewACK_Received - a negative ACK also tells
+               how far it got in order */
+            seg->InitialSequenceNumber = sequence_number + 1;
+            seg->ActualWindowSize =
+                tsm_segment_window_size(actual_window_size);
+            tsm_segment_window_send(seg);
+        }
+    } else if (nak &&
+        ((uint8_t) (sequence_number + 1) == seg->InitialSequenceNumber)) {
+        /* nothing in the window came through in order */
+        tsm_segment_window_send(seg);
+    } else {
+        /* DuplicateACK_Received */
+        seg->SegmentTimer = TSM_Clock + apdu_timeout();
+    }
+}
+
+void tsm_segmented_abort_received(
+    BACNET_ADDRESS * src,
+    uint8_t invokeID)
+{
+    BACNET_TSM_SEGMENTED_DATA *seg = NULL;
+
+    seg = tsm_segmented_find(src, invokeID, true);
+    if (seg) {
+        seg->state = TSM_STATE_IDLE;
+    }
+}
+
+bool tsm_segmented_complex_ack_received(
+    BACNET_ADDRESS * src,
+    BACNET_CONFIRMED_SERVICE_ACK_DATA * service_data,
+    uint8_t service_choice,
+    uint8_t ** service_request,
+    uint16_t * service_request_len)
+{
+    BACNET_TSM_SEGMENTED_DATA *seg = NULL;
+    BACNET_NPDU_DATA npdu_data;
+    uint8_t index;
+
+    index = tsm_find_invokeID_index(service_data->invoke_id);
+    if ((index >= MAX_TSM_TRANSACTIONS) ||
+        !bacnet_address_same(src, &TSM_List[index].dest)) {
+        return false;
+    }
+    if ((TSM_List[index].state == TSM_STATE_AWAIT_CONFIRMATION) &&
+        (service_data->sequence_number == 0)) {
+        tsm_timer_unlink(index);
+        seg =
+            tsm_segmented_new(src, service_data->invoke_id, false,
+            TSM_STATE_SEGMENTED_CONFIRMATION);
+        if (seg) {
+            TSM_List[index].state = TSM_STATE_SEGMENTED_CONFIRMATION;
+            seg->service_choice = service_choice;
+            seg->ActualWindowSize =
+                tsm_segment_window_size(service_data->proposed_window_number);
+        } else {
+            npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+            tsm_abort_send(src, &npdu_data, service_data->invoke_id,
+                ABORT_REASON_BUFFER_OVERFLOW, false);
+            TSM_List[index].state = TSM_STATE_IDLE;
+        }
+    } else if (TSM_List[index].state == TSM_STATE_SEGMENTED_CONFIRMATION) {
+        seg = tsm_segmented_find(src, service_data->invoke_id, false);
+    }
+    if (seg && tsm_segment_received(seg, service_data->sequence_number,
+            service_data->more_follows, *service_request,
+            *service_request_len)) {
+        /* the spot is let go of with the invoke ID */
+        *service_request = &seg->data[0];
+        *service_request_len = seg->data_len;
+        service_data->segmented_message = false;
+        service_data->more_follows = false;
+        return true;
+    }
+
+    return false;
+}
+
+bool tsm_segmented_request_received(
+    BACNET_ADDRESS * src,
+    BACNET_CONFIRMED_SERVICE_DATA * service_data,
+    uint8_t service_choice,
+    uint8_t ** service_request,
+    uint16_t * service_request_len)
+{
+    BACNET_TSM_SEGMENTED_DATA *seg = NULL;
+    BACNET_NPDU_DATA npdu_data;
+
+    seg = tsm_segmented_find(src, service_data->invoke_id, true);
+    if (seg && (seg->state != TSM_STATE_SEGMENTED_REQUEST)) {
+        /* the client started over */
+        seg->state = TSM_STATE_IDLE;
+        seg = NULL;
+    }
+    if (!seg && (service_data->sequence_number == 0)) {
+        seg =
+            tsm_segmented_new(src, service_data->invoke_id, true,
+            TSM_STATE_SEGMENTED_REQUEST);
+        if (seg) {
+            seg->service_data = *service_data;
+            seg->service_choice = service_choice;
+            seg->ActualWindowSize =
+                tsm_segment_window_size(service_data->proposed_window_number);
+        } else {
+            npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+            tsm_abort_send(src, &npdu_data, service_data->invoke_id,
+                ABORT_REASON_BUFFER_OVERFLOW, true);
+        }
+    }
+    if (seg && tsm_segment_received(seg, service_data->sequence_number,
+            service_data->more_follows, *service_request,
+            *service_request_len)) {
+        /* handed on - the spot can be reused from now on */
+        seg->state = TSM_STATE_AWAIT_RESPONSE;
+        *service_data = seg->service_data;
+        service_data->segmented_message = false;
+        service_data->more_follows = false;
+        *service_request = &seg->data[0];
+        *service_request_len = seg->data_len;
+        return true;
+    }
+
+    return false;
+}
+
+/* SegmentTimer expiry for each segmented message */
+static void tsm_segmented_timer(
+    void)
+{
+    BACNET_TSM_SEGMENTED_DATA *seg = NULL;
+    unsigned i = 0;
+
+    for (i = 0; i < MAX_SEGMENTED_TRANSACTIONS; i++) {
+        seg = &TSM_Segmented_List[i];
+        if ((seg->state == TSM_STATE_IDLE) ||
+            (seg->state == TSM_STATE_AWAIT_RESPONSE) ||
+            ((int32_t) (seg->SegmentTimer - TSM_Clock) > 0)) {
+            continue;
+        }
+        if ((seg->state == TSM_STATE_SEGMENTED_RESPONSE) &&
+            (seg->SegmentRetryCount < apdu_retries())) {
+            seg->SegmentRetryCount++;
+            tsm_segment_window_send(seg);
+        } else {
+            tsm_segmented_release(seg);
+        }
+    }
+}
+
+/* lets go of the ComplexACK that came in for our invoke ID */
+static void tsm_segmented_free(
+    uint8_t invokeID)
+{
+    unsigned i = 0;
+
+    for (i = 0; i < MAX_SEGMENTED_TRANSACTIONS; i++) {
+        if ((TSM_Segmented_List[i].state != TSM_STATE_IDLE) &&
+            (!TSM_Segmented_List[i].server) &&
+            (TSM_Segmented_List[i].InvokeID == invokeID)) {
+            TSM_Segmented_List[i].state = TSM_STATE_IDLE;
+        }
+    }
+}
+#endif
+
+/* retries or fails the transactions in one bucket that are due */
+static void tsm_timer_bucket(
+    unsigned bucket)
+{
+    uint8_t next = TSM_Timer_Wheel[bucket];
+    uint8_t index;
+
+    /* take the whole bucket - anything not due goes back in */
+    TSM_Timer_Wheel[bucket] = 0;
+    while (next) {
+        index = next - 1;
+        next = TSM_List[index].TimerNext;
+        /* the wheel wraps - this may be due on a later turn */
+        if ((int32_t) (TSM_List[index].RequestTimer - TSM_Clock) > 0) {
+            tsm_timer_link(index);
+            continue;
+        }
+        /* timeout.  retry? */
+        TSM_List[index].RetryCount--;
+        if (TSM_List[index].RetryCount) {
+            tsm_timer_start(index);
+            datalink_send_pdu(&TSM_List[index].dest,
+                &TSM_List[index].npdu_data, &TSM_List[index].apdu[0],
+                TSM_List[index].apdu_len);
+        } else {
+            /* note: the invoke id has not been cleared yet
+               and this indicates a failed message:
+               IDLE and a valid invoke id */
+            TSM_List[index].TimerNext = 0;
+            TSM_List[index].TimerPrev = 0;
+            TSM_List[index].state = TSM_STATE_IDLE;
+        }
+    }
+}
+
 /* called once a millisecond or slower */
 void tsm_timer_milliseconds(
     uint16_t milliseconds)
 {
-    unsigned i = 0;     /* counter */
+    uint32_t tick = 0;
+    unsigned count = 0;
 
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++) {
-        if (TSM_List[i].state == TSM_STATE_AWAIT_CONFIRMATION) {
-            if (TSM_List[i].RequestTimer > milliseconds)
-                TSM_List[i].RequestTimer -= milliseconds;
-            else
-                TSM_List[i].RequestTimer = 0;
-            /* timeout.  retry? */
-            if (TSM_List[i].RequestTimer == 0) {
-                TSM_List[i].RetryCount--;
-                TSM_List[i].RequestTimer = apdu_timeout();
-                if (TSM_List[i].RetryCount) {
-                    datalink_send_pdu(&TSM_List[i].dest,
-                        &TSM_List[i].npdu_data, &TSM_List[i].apdu[0],
-                        TSM_List[i].apdu_len);
-                } else {
-                    /* note: the invoke id has not been cleared yet
-                       and this indicates a failed message:
-                       IDLE and a valid invoke id */
-                    TSM_List[i].state = TSM_STATE_IDLE;
-                }
-            }
-        }
+    TSM_Clock += milliseconds;
+    tick = TSM_Clock / TSM_TIMER_TICK;
+    /* a retry can land in the bucket of this tick, so it is
+       looked at again next time */
+    count = tick - TSM_Clock_Tick + 1;
+    if (count > TSM_TIMER_WHEEL_SIZE) {
+        count = TSM_TIMER_WHEEL_SIZE;
+    }
+    while (count) {
+        tsm_timer_bucket((tick - (count - 1)) % TSM_TIMER_WHEEL_SIZE);
+        count--;
     }
+    TSM_Clock_Tick = tick;
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+    tsm_segmented_timer();
+#endif
 }
 
 /* frees the invokeID and sets its state to IDLE */
@@ -276,8 +865,17 @@ void tsm_free_invoke_id(
 
     index = tsm_find_invokeID_index(invokeID);
     if (index < MAX_TSM_TRANSACTIONS) {
+        if (TSM_List[index].state == TSM_STATE_AWAIT_CONFIRMATION) {
+            tsm_timer_unlink(index);
+        }
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+        tsm_segmented_free(invokeID);
+#endif
         TSM_List[index].state = TSM_STATE_IDLE;
         TSM_List[index].InvokeID = 0;
+        TSM_Invoke_ID_Index[invokeID] = 0;
+        TSM_Free_List[TSM_Free_Count] = index;
+        TSM_Free_Count++;
     }
 }
 
@@ -313,7 +911,6 @@ bool tsm_invoke_id_failed(
     return status;
 }
 
-
 #ifdef TEST
 #include <assert.h>
 #include <string.h>
@@ -322,6 +919,11 @@ bool tsm_invoke_id_failed(
 /* flag to send an I-Am */
 bool I_Am_Request = true;
 
+static unsigned Send_Count = 0;
+/* the APDU of the last PDU sent */
+static uint8_t Send_APDU[MAX_APDU];
+static unsigned Send_APDU_Len = 0;
+
 /* dummy function stubs */
 int datalink_send_pdu(
     BACNET_ADDRESS * dest,
@@ -329,12 +931,20 @@ int datalink_send_pdu(
     uint8_t * pdu,
     unsigned pdu_len)
 {
+    BACNET_ADDRESS npdu_dest;
+    BACNET_ADDRESS npdu_src;
+    BACNET_NPDU_DATA decoded_npdu_data;
+    int len = 0;
+
     (void) dest;
     (void) npdu_data;
-    (void) pdu;
-    (void) pdu_len;
 
-    return 0;
+    Send_Count++;
+    len = npdu_decode(pdu, &npdu_dest, &npdu_src, &decoded_npdu_data);
+    Send_APDU_Len = pdu_len - len;
+    memcpy(Send_APDU, &pdu[len], Send_APDU_Len);
+
+    return (int) pdu_len;
 }
 
 /* dummy function stubs */
@@ -344,13 +954,314 @@ void datalink_get_broadcast_address(
     (void) dest;
 }
 
+/* dummy function stubs */
+void datalink_get_my_address(
+    BACNET_ADDRESS * my_address)
+{
+    my_address->mac_len = 0;
+    my_address->net = 0;
+    my_address->len = 0;
+}
+
 void testTSM(
     Test * pTest)
 {
-    /* FIXME: add some unit testing... */
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    uint8_t apdu[4] = { 0 };
+    uint8_t invoke_id[MAX_TSM_TRANSACTIONS] = { 0 };
+    unsigned i = 0;
+    unsigned j = 0;
+    uint8_t id = 0;
+
+    /* use up every spot */
+    ct_test(pTest, tsm_transaction_idle_count() == MAX_TSM_TRANSACTIONS);
+    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++) {
+        invoke_id[i] = tsm_next_free_invokeID();
+        ct_test(pTest, invoke_id[i] != 0);
+        ct_test(pTest, !tsm_invoke_id_free(invoke_id[i]));
+        for (j = 0; j < i; j++) {
+            ct_test(pTest, invoke_id[i] != invoke_id[j]);
+        }
+    }
+    ct_test(pTest, !tsm_transaction_available());
+    ct_test(pTest, tsm_transaction_idle_count() == 0);
+    ct_test(pTest, tsm_next_free_invokeID() == 0);
+    /* free one in the middle, and get it back */
+    id = invoke_id[MAX_TSM_TRANSACTIONS / 2];
+    tsm_free_invoke_id(id);
+    ct_test(pTest, tsm_invoke_id_free(id));
+    ct_test(pTest, tsm_transaction_available());
+    invoke_id[MAX_TSM_TRANSACTIONS / 2] = tsm_next_free_invokeID();
+    ct_test(pTest, invoke_id[MAX_TSM_TRANSACTIONS / 2] != 0);
+    ct_test(pTest, !tsm_transaction_available());
+    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++) {
+        tsm_free_invoke_id(invoke_id[i]);
+        ct_test(pTest, tsm_invoke_id_free(invoke_id[i]));
+    }
+    ct_test(pTest, tsm_transaction_idle_count() == MAX_TSM_TRANSACTIONS);
+
+    /* retries, then failure */
+    apdu_timeout_set(1000);
+    apdu_retries_set(3);
+    Send_Count = 0;
+    id = tsm_next_free_invokeID();
+    tsm_set_confirmed_unsegmented_transaction(id, &dest, &npdu_data,
+        &apdu[0], sizeof(apdu));
+    tsm_timer_milliseconds(999);
+    ct_test(pTest, Send_Count == 0);
+    tsm_timer_milliseconds(1);
+    ct_test(pTest, Send_Count == 1);
+    ct_test(pTest, !tsm_invoke_id_failed(id));
+    /* longer than the wheel goes around */
+    for (i = 0; i < 10; i++) {
+        tsm_timer_milliseconds(100);
+    }
+    ct_test(pTest, Send_Count == 2);
+    ct_test(pTest, !tsm_invoke_id_failed(id));
+    tsm_timer_milliseconds(60000);
+    ct_test(pTest, Send_Count == 2);
+    ct_test(pTest, tsm_invoke_id_failed(id));
+    ct_test(pTest, !tsm_invoke_id_free(id));
+    tsm_free_invoke_id(id);
+    ct_test(pTest, tsm_invoke_id_free(id));
+    /* a confirmed transaction doesn't time out */
+    Send_Count = 0;
+    id = tsm_next_free_invokeID();
+    tsm_set_confirmed_unsegmented_transaction(id, &dest, &npdu_data,
+        &apdu[0], sizeof(apdu));
+    tsm_free_invoke_id(id);
+    tsm_timer_milliseconds(60000);
+    ct_test(pTest, Send_Count == 0);
+
+    return;
+}
+
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+void testTSMSegmentedResponse(
+    Test * pTest)
+{
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    static uint8_t apdu[3 + 3000];
+    unsigned i = 0;
+
+    dest.mac_len = 1;
+    dest.mac[0] = 1;
+    apdu_timeout_set(1000);
+    apdu_retries_set(3);
+    apdu[0] = PDU_TYPE_COMPLEX_ACK;
+    apdu[1] = 5;
+    apdu[2] = SERVICE_CONFIRMED_READ_PROPERTY;
+    for (i = 3; i < sizeof(apdu); i++) {
+        apdu[i] = (uint8_t) i;
+    }
+    service_data.invoke_id = 5;
+    service_data.max_resp = 480;
+    /* the client has to take segments, and enough of them */
+    ct_test(pTest, !tsm_segmented_complex_ack_send(&dest, &npdu_data,
+            &service_data, &apdu[0], sizeof(apdu)));
+    service_data.segmented_response_accepted = true;
+    service_data.max_segs = 4;
+    ct_test(pTest, !tsm_segmented_complex_ack_send(&dest, &npdu_data,
+            &service_data, &apdu[0], sizeof(apdu)));
+    /* 475 octets in each of 7 segments - the first goes alone */
+    service_data.max_segs = 8;
+    Send_Count = 0;
+    ct_test(pTest, tsm_segmented_complex_ack_send(&dest, &npdu_data,
+            &service_data, &apdu[0], sizeof(apdu)));
+    ct_test(pTest, Send_Count == 1);
+    ct_test(pTest, Send_APDU[0] == (PDU_TYPE_COMPLEX_ACK | BIT3 | BIT2));
+    ct_test(pTest, Send_APDU[1] == 5);
+    ct_test(pTest, Send_APDU[2] == 0);
+    ct_test(pTest, Send_APDU[3] == MAX_SEGMENT_WINDOW);
+    ct_test(pTest, Send_APDU[4] == SERVICE_CONFIRMED_READ_PROPERTY);
+    ct_test(pTest, Send_APDU_Len == 480);
+    ct_test(pTest, memcmp(&Send_APDU[5], &apdu[3], 475) == 0);
+    /* the client's window is 4 */
+    tsm_segment_ack_received(&dest, 5, 0, 4, false);
+    ct_test(pTest, Send_Count == 5);
+    ct_test(pTest, Send_APDU[2] == 4);
+    /* a duplicate ACK sends nothing */
+    tsm_segment_ack_received(&dest, 0, 0, 4, false);
+    tsm_segment_ack_received(&dest, 5, 0, 4, false);
+    ct_test(pTest, Send_Count == 5);
+    /* the client got 1 and 2, so 3 on are sent again */
+    tsm_segment_ack_received(&dest, 5, 2, 4, true);
+    ct_test(pTest, Send_Count == 9);
+    ct_test(pTest, Send_APDU[2] == 6);
+    ct_test(pTest, Send_APDU[0] == (PDU_TYPE_COMPLEX_ACK | BIT3));
+    ct_test(pTest, Send_APDU_Len == (5 + 3000 - (6 * 475)));
+    /* nothing heard, so the window goes again */
+    tsm_timer_milliseconds(1000);
+    ct_test(pTest, Send_Count == 13);
+    tsm_segment_ack_received(&dest, 5, 6, 4, false);
+    tsm_timer_milliseconds(60000);
+    ct_test(pTest, Send_Count == 13);
+    /* all the retries, then it gives up */
+    Send_Count = 0;
+    ct_test(pTest, tsm_segmented_complex_ack_send(&dest, &npdu_data,
+            &service_data, &apdu[0], sizeof(apdu)));
+    for (i = 0; i < 10; i++) {
+        tsm_timer_milliseconds(1000);
+    }
+    ct_test(pTest, Send_Count == 4);
+    /* all the spots are free again */
+    for (i = 0; i < MAX_SEGMENTED_TRANSACTIONS; i++) {
+        service_data.invoke_id = (uint8_t) (10 + i);
+        ct_test(pTest, tsm_segmented_complex_ack_send(&dest, &npdu_data,
+                &service_data, &apdu[0], sizeof(apdu)));
+    }
+    service_data.invoke_id = 9;
+    ct_test(pTest, !tsm_segmented_complex_ack_send(&dest, &npdu_data,
+            &service_data, &apdu[0], sizeof(apdu)));
+    /* the client gives up */
+    for (i = 0; i < MAX_SEGMENTED_TRANSACTIONS; i++) {
+        tsm_segmented_abort_received(&dest, (uint8_t) (10 + i));
+    }
+    ct_test(pTest, tsm_segmented_complex_ack_send(&dest, &npdu_data,
+            &service_data, &apdu[0], sizeof(apdu)));
+    tsm_segmented_abort_received(&dest, 9);
+
     return;
 }
 
+void testTSMSegmentedReceive(
+    Test * pTest)
+{
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_CONFIRMED_SERVICE_ACK_DATA ack_data = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    uint8_t apdu[4] = { 0 };
+    uint8_t data[100] = { 0 };
+    uint8_t *service_request = NULL;
+    uint16_t service_len = 0;
+    uint8_t id = 0;
+    unsigned i = 0;
+
+    dest.mac_len = 1;
+    dest.mac[0] = 2;
+    apdu_timeout_set(1000);
+    apdu_retries_set(3);
+    id = tsm_next_free_invokeID();
+    tsm_set_confirmed_unsegmented_transaction(id, &dest, &npdu_data,
+        &apdu[0], sizeof(apdu));
+    ack_data.invoke_id = id;
+    ack_data.segmented_message = true;
+    ack_data.more_follows = true;
+    ack_data.proposed_window_number = 2;
+    /* the first segment is acknowledged */
+    Send_Count = 0;
+    memset(data, 0, sizeof(data));
+    service_request = &data[0];
+    service_len = sizeof(data);
+    ct_test(pTest, !tsm_segmented_complex_ack_received(&dest, &ack_data,
+            SERVICE_CONFIRMED_READ_PROPERTY, &service_request, &service_len));
+    ct_test(pTest, Send_Count == 1);
+    ct_test(pTest, Send_APDU[0] == PDU_TYPE_SEGMENT_ACK);
+    ct_test(pTest, Send_APDU[1] == id);
+    ct_test(pTest, Send_APDU[2] == 0);
+    ct_test(pTest, Send_APDU[3] == 2);
+    /* no request timeout while the segments come in */
+    tsm_timer_milliseconds(3500);
+    ct_test(pTest, Send_Count == 1);
+    ct_test(pTest, !tsm_invoke_id_failed(id));
+    /* the end of the window is acknowledged */
+    for (i = 1; i <= 2; i++) {
+        memset(data, i, sizeof(data));
+        ack_data.sequence_number = i;
+        service_request = &data[0];
+        service_len = sizeof(data);
+        ct_test(pTest, !tsm_segmented_complex_ack_received(&dest, &ack_data,
+                SERVICE_CONFIRMED_READ_PROPERTY, &service_request,
+                &service_len));
+    }
+    ct_test(pTest, Send_Count == 2);
+    ct_test(pTest, Send_APDU[2] == 2);
+    /* one out of order is a negative ACK */
+    ack_data.sequence_number = 4;
+    service_request = &data[0];
+    service_len = sizeof(data);
+    ct_test(pTest, !tsm_segmented_complex_ack_received(&dest, &ack_data,
+            SERVICE_CONFIRMED_READ_PROPERTY, &service_request, &service_len));
+    ct_test(pTest, Send_Count == 3);
+    ct_test(pTest, Send_APDU[0] == (PDU_TYPE_SEGMENT_ACK | BIT1));
+    ct_test(pTest, Send_APDU[2] == 2);
+    /* the last segment */
+    memset(data, 3, sizeof(data));
+    ack_data.sequence_number = 3;
+    ack_data.more_follows = false;
+    service_request = &data[0];
+    service_len = sizeof(data);
+    ct_test(pTest, tsm_segmented_complex_ack_received(&dest, &ack_data,
+            SERVICE_CONFIRMED_READ_PROPERTY, &service_request, &service_len));
+    ct_test(pTest, Send_Count == 4);
+    ct_test(pTest, Send_APDU[0] == PDU_TYPE_SEGMENT_ACK);
+    ct_test(pTest, Send_APDU[2] == 3);
+    ct_test(pTest, service_len == (4 * sizeof(data)));
+    for (i = 0; i < service_len; i++) {
+        ct_test(pTest, service_request[i] == (i / sizeof(data)));
+    }
+    ct_test(pTest, !ack_data.segmented_message);
+    tsm_free_invoke_id(id);
+    ct_test(pTest, tsm_invoke_id_free(id));
+
+    /* a server that stops sending fails the request */
+    id = tsm_next_free_invokeID();
+    tsm_set_confirmed_unsegmented_transaction(id, &dest, &npdu_data,
+        &apdu[0], sizeof(apdu));
+    ack_data.invoke_id = id;
+    ack_data.sequence_number = 0;
+    ack_data.more_follows = true;
+    service_request = &data[0];
+    service_len = sizeof(data);
+    ct_test(pTest, !tsm_segmented_complex_ack_received(&dest, &ack_data,
+            SERVICE_CONFIRMED_READ_PROPERTY, &service_request, &service_len));
+    tsm_timer_milliseconds(3999);
+    ct_test(pTest, !tsm_invoke_id_failed(id));
+    tsm_timer_milliseconds(1);
+    ct_test(pTest, tsm_invoke_id_failed(id));
+    tsm_free_invoke_id(id);
+
+    /* a segmented request is handed on in one piece */
+    service_data.invoke_id = 7;
+    service_data.segmented_message = true;
+    service_data.more_follows = true;
+    service_data.segmented_response_accepted = true;
+    service_data.max_resp = 480;
+    service_data.proposed_window_number = 4;
+    Send_Count = 0;
+    memset(data, 0, sizeof(data));
+    service_request = &data[0];
+    service_len = sizeof(data);
+    ct_test(pTest, !tsm_segmented_request_received(&dest, &service_data,
+            SERVICE_CONFIRMED_WRITE_PROPERTY, &service_request,
+            &service_len));
+    ct_test(pTest, Send_Count == 1);
+    ct_test(pTest, Send_APDU[0] == (PDU_TYPE_SEGMENT_ACK | BIT0));
+    ct_test(pTest, Send_APDU[1] == 7);
+    ct_test(pTest, Send_APDU[3] == 4);
+    memset(data, 1, sizeof(data));
+    service_data.sequence_number = 1;
+    service_data.more_follows = false;
+    service_request = &data[0];
+    service_len = 10;
+    ct_test(pTest, tsm_segmented_request_received(&dest, &service_data,
+            SERVICE_CONFIRMED_WRITE_PROPERTY, &service_request,
+            &service_len));
+    ct_test(pTest, Send_Count == 2);
+    ct_test(pTest, service_len == (sizeof(data) + 10));
+    ct_test(pTest, service_request[sizeof(data) - 1] == 0);
+    ct_test(pTest, service_request[sizeof(data)] == 1);
+    ct_test(pTest, !service_data.segmented_message);
+    ct_test(pTest, service_data.max_resp == 480);
+
+    return;
+}
+#endif
+
 #ifdef TEST_TSM
 int main(
     void)
@@ -362,6 +1273,12 @@ int main(
     /* individual tests */
     rc = ct_addTestFunction(pTest, testTSM);
     assert(rc);
+#if (MAX_SEGMENTS_ACCEPTED > 1)
+    rc = ct_addTestFunction(pTest, testTSMSegmentedResponse);
+    assert(rc);
+    rc = ct_addTestFunction(pTest, testTSMSegmentedReceive);
+    assert(rc);
+#endif
 
     ct_setStream(pTest, stdout);
     ct_run(pTest);
@@ -0,0 +1,827 @@
+/*####COPYRIGHTBEGIN####
+ -------------------------------------------
+ Copyright (C) 2026 agent <agent@local>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to:
+ The Free Software Foundation, Inc.
+ 59 Temple Place - Suite 330
+ Boston, MA  02111-1307, USA.
+
+ As a special exception, if other files instantiate templates or
+ use macros or inline functions from this file, or you compile
+ this file and link it with other works to produce a work based
+ on this file, this file does not by itself cause the resulting
+ work to be covered by the GNU General Public License. However
+ the source code for this file must still be made available in
+ accordance with section (3) of the GNU General Public License.
+
+ This exception does not invalidate any other reasons why a work
+ based on this file might be covered by the GNU General Public
+ License.
+ -------------------------------------------
+####COPYRIGHTEND####*/
+#include <stdint.h>
+#include "bacenum.h"
+#include "bacdcode.h"
+#include "bacdef.h"
+#include "bacapp.h"
+#include "memcopy.h"
+#include "wpm.h"
+
+/* encode the initial portion of the service */
+int wpm_encode_apdu_init(
+    uint8_t * apdu,
+    uint8_t invoke_id)
+{
+    int apdu_len = 0;   /* total length of the apdu, return value */
+
+    if (apdu) {
+        apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
+        apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU);
+        apdu[2] = invoke_id;
+        apdu[3] = SERVICE_CONFIRMED_WRITE_PROP_MULTIPLE;        /* service choice */
+        apdu_len = 4;
+    }
+
+    return apdu_len;
+}
+
+int wpm_encode_apdu_object_begin(
+    uint8_t * apdu,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    int apdu_len = 0;   /* total length of the apdu, return value */
+
+    if (apdu) {
+        apdu_len =
+            encode_context_object_id(&apdu[0], 0, object_type,
+            object_instance);
+        /* Tag 1: sequence of BACnetPropertyValue */
+        apdu_len += encode_opening_tag(&apdu[apdu_len], 1);
+    }
+
+    return apdu_len;
+}
+
+int wpm_encode_apdu_object_property(
+    uint8_t * apdu,
+    BACNET_WRITE_PROPERTY_DATA * wpdata)
+{
+    int apdu_len = 0;   /* total length of the apdu, return value */
+    int len = 0;
+
+    if (apdu && wpdata) {
+        apdu_len =
+            encode_context_enumerated(&apdu[0], 0, wpdata->object_property);
+        /* optional array index */
+        if (wpdata->array_index != BACNET_ARRAY_ALL) {
+            apdu_len +=
+                encode_context_unsigned(&apdu[apdu_len], 1,
+                wpdata->array_index);
+        }
+        apdu_len += encode_opening_tag(&apdu[apdu_len], 2);
+        for (len = 0; len < wpdata->application_data_len; len++) {
+            apdu[apdu_len + len] = wpdata->application_data[len];
+        }
+        apdu_len += wpdata->application_data_len;
+        apdu_len += encode_closing_tag(&apdu[apdu_len], 2);
+        /* optional priority - 0 if not set, 1..16 if set */
+        if (wpdata->priority != BACNET_NO_PRIORITY) {
+            apdu_len +=
+                encode_context_unsigned(&apdu[apdu_len], 3, wpdata->priority);
+        }
+    }
+
+    return apdu_len;
+}
+
+int wpm_encode_apdu_object_end(
+    uint8_t * apdu)
+{
+    int apdu_len = 0;   /* total length of the apdu, return value */
+
+    if (apdu) {
+        apdu_len = encode_closing_tag(&apdu[0], 1);
+    }
+
+    return apdu_len;
+}
+
+int wpm_encode_apdu(
+    uint8_t * apdu,
+    size_t max_apdu,
+    uint8_t invoke_id,
+    BACNET_WRITE_ACCESS_DATA * write_access_data)
+{
+    int apdu_len = 0;   /* total length of the apdu, return value */
+    int len = 0;        /* length of the data */
+    BACNET_WRITE_ACCESS_DATA *wpm_object;       /* current object */
+    BACNET_PROPERTY_VALUE *wpm_property;        /* current property */
+    BACNET_APPLICATION_DATA_VALUE *value;       /* current value */
+    uint8_t apdu_temp[16];      /* temp for data before copy */
+    BACNET_WRITE_PROPERTY_DATA wpdata;
+    /* the value is encoded here, then copied with its tags */
+    uint8_t value_temp[MAX_APDU + 16];
+
+    len = wpm_encode_apdu_init(&apdu_temp[0], invoke_id);
+    len =
+        (int) memcopy(&apdu[0], &apdu_temp[0], (size_t) apdu_len, (size_t) len,
+        (size_t) max_apdu);
+    if (len == 0) {
+        return 0;
+    }
+    apdu_len += len;
+    wpm_object = write_access_data;
+    while (wpm_object) {
+        len =
+            wpm_encode_apdu_object_begin(&apdu_temp[0],
+            wpm_object->object_type, wpm_object->object_instance);
+        len =
+            (int) memcopy(&apdu[0], &apdu_temp[0], (size_t) apdu_len,
+            (size_t) len, (size_t) max_apdu);
+        if (len == 0) {
+            return 0;
+        }
+        apdu_len += len;
+        wpm_property = wpm_object->listOfProperties;
+        while (wpm_property) {
+            wpdata.object_property = wpm_property->propertyIdentifier;
+            wpdata.array_index = wpm_property->propertyArrayIndex;
+            wpdata.priority = wpm_property->priority;
+            wpdata.application_data_len = 0;
+            value = &wpm_property->value;
+            while (value) {
+                len = bacapp_encode_data(&value_temp[0], value);
+                len =
+                    (int) memcopy(&wpdata.application_data[0], &value_temp[0],
+                    (size_t) wpdata.application_data_len, (size_t) len,
+                    sizeof(wpdata.application_data));
+                if (len == 0) {
+                    return 0;
+                }
+                wpdata.application_data_len += len;
+                value = value->next;
+            }
+            len = wpm_encode_apdu_object_property(&value_temp[0], &wpdata);
+            len =
+                (int) memcopy(&apdu[0], &value_temp[0], (size_t) apdu_len,
+                (size_t) len, (size_t) max_apdu);
+            if (len == 0) {
+                return 0;
+            }
+            apdu_len += len;
+            wpm_property = wpm_property->next;
+        }
+        len = wpm_encode_apdu_object_end(&apdu_temp[0]);
+        len =
+            (int) memcopy(&apdu[0], &apdu_temp[0], (size_t) apdu_len,
+            (size_t) len, (size_t) max_apdu);
+        if (len == 0) {
+            return 0;
+        }
+        apdu_len += len;
+        wpm_object = wpm_object->next;
+    }
+
+    return apdu_len;
+}
+
+/* returns the length of a tag with the tag number, whose value also
+   fits in apdu_len, or -1 */
+static int wpm_decode_tag(
+    uint8_t * apdu,
+    unsigned apdu_len,
+    bool context,
+    uint8_t tag_number,
+    uint32_t * len_value_type)
+{
+    int tag_len = 0;
+    uint8_t decoded_tag_number = 0;
+
+    if ((apdu_len == 0) || (IS_CONTEXT_SPECIFIC(apdu[0]) != context) ||
+        decode_is_opening_tag(apdu) || decode_is_closing_tag(apdu))
+        return -1;
+    tag_len =
+        decode_tag_number_and_value_safe(apdu, apdu_len, &decoded_tag_number,
+        len_value_type);
+    if ((tag_len <= 0) || (decoded_tag_number != tag_number) ||
+        (*len_value_type > 4) ||
+        ((tag_len + *len_value_type) > apdu_len))
+        return -1;
+
+    return tag_len;
+}
+
+/* true if apdu starts with the opening (or closing) tag with the tag
+   number, and the tag fits in apdu_len */
+static bool wpm_is_tag_number(
+    uint8_t * apdu,
+    unsigned apdu_len,
+    bool opening,
+    uint8_t tag_number)
+{
+    uint8_t decoded_tag_number = 0;
+    uint32_t len_value_type = 0;
+
+    if (decode_tag_number_and_value_safe(apdu, apdu_len,
+            &decoded_tag_number, &len_value_type) <= 0)
+        return false;
+    if (opening ? !decode_is_opening_tag(apdu) : !decode_is_closing_tag(apdu))
+        return false;
+
+    return (decoded_tag_number == tag_number);
+}
+
+/* returns the length of the property value up to the closing tag 2,
+   or -1 if it is malformed or runs past apdu_len */
+static int wpm_value_length(
+    uint8_t * apdu,
+    unsigned apdu_len)
+{
+    unsigned len = 0;
+    unsigned depth = 0;
+    int tag_len = 0;
+    uint8_t tag_number = 0;
+    uint32_t len_value_type = 0;
+
+    while (len < apdu_len) {
+        tag_len =
+            decode_tag_number_and_value_safe(&apdu[len], apdu_len - len,
+            &tag_number, &len_value_type);
+        if (tag_len <= 0)
+            return -1;
+        if (decode_is_opening_tag(&apdu[len])) {
+            depth++;
+        } else if (decode_is_closing_tag(&apdu[len])) {
+            if (depth == 0)
+                return (tag_number == 2) ? (int) len : -1;
+            depth--;
+        } else if (IS_CONTEXT_SPECIFIC(apdu[len]) ||
+            (tag_number != BACNET_APPLICATION_TAG_BOOLEAN)) {
+            /* application booleans carry the value in the tag */
+            if (len_value_type > (apdu_len - len - tag_len))
+                return -1;
+            tag_len += len_value_type;
+        }
+        len += tag_len;
+    }
+
+    return -1;
+}
+
+/* decode the object portion of the service request only */
+int wpm_decode_object_id(
+    uint8_t * apdu,
+    unsigned apdu_len,
+    BACNET_WRITE_PROPERTY_DATA * wpdata)
+{
+    unsigned len = 0;
+    int tag_len = 0;
+    uint32_t len_value_type = 0;
+    uint16_t type = 0;  /* for decoding */
+
+    /* check for value pointers */
+    if (apdu && apdu_len && wpdata) {
+        /* Tag 0: Object ID */
+        tag_len = wpm_decode_tag(&apdu[0], apdu_len, true, 0, &len_value_type);
+        if (tag_len < 0)
+            return -1;
+        len = tag_len;
+        /* the object id and the opening tag must be in the request */
+        if ((len + len_value_type) >= apdu_len)
+            return -1;
+        if (decode_object_id_safe(&apdu[len], len_value_type, &type,
+                &wpdata->object_instance) == 0)
+            return -1;
+        len += len_value_type;
+        wpdata->object_type = (BACNET_OBJECT_TYPE) type;
+        /* Tag 1: sequence of BACnetPropertyValue */
+        if (!wpm_is_tag_number(&apdu[len], apdu_len - len, true, 1))
+            return -1;
+        len++;  /* opening tag is only one octet */
+    }
+
+    return (int) len;
+}
+
+int wpm_decode_object_end(
+    uint8_t * apdu,
+    unsigned apdu_len)
+{
+    int len = 0;        /* total length of the apdu, return value */
+
+    if (apdu && apdu_len) {
+        if (wpm_is_tag_number(apdu, apdu_len, false, 1))
+            len = 1;
+    }
+
+    return len;
+}
+
+/* decode the object property portion of the service request only */
+int wpm_decode_object_property(
+    uint8_t * apdu,
+    unsigned apdu_len,
+    BACNET_WRITE_PROPERTY_DATA * wpdata)
+{
+    unsigned len = 0;
+    int tag_len = 0;
+    int data_len = 0;
+    uint32_t len_value_type = 0;
+    uint32_t property = 0;      /* for decoding */
+    uint32_t unsigned_value = 0;
+    int i = 0;  /* loop counter */
+
+    /* check for valid pointers */
+    if (apdu && apdu_len && wpdata) {
+        /* Tag 0: propertyIdentifier */
+        tag_len = wpm_decode_tag(&apdu[len], apdu_len, true, 0,
+            &len_value_type);
+        if (tag_len < 0)
+            return -1;
+        len += tag_len;
+        len += decode_enumerated(&apdu[len], len_value_type, &property);
+        wpdata->object_property = (BACNET_PROPERTY_ID) property;
+        /* Tag 1: Optional propertyArrayIndex */
+        wpdata->array_index = BACNET_ARRAY_ALL;
+        if ((len < apdu_len) && IS_CONTEXT_SPECIFIC(apdu[len]) &&
+            ((apdu[len] >> 4) == 1) && !decode_is_opening_tag(&apdu[len])) {
+            tag_len = wpm_decode_tag(&apdu[len], apdu_len - len, true, 1,
+                &len_value_type);
+            if (tag_len < 0)
+                return -1;
+            len += tag_len;
+            len +=
+                decode_unsigned(&apdu[len], len_value_type, &unsigned_value);
+            wpdata->array_index = unsigned_value;
+        }
+        /* Tag 2: opening context tag for the value */
+        if ((len >= apdu_len) ||
+            !wpm_is_tag_number(&apdu[len], apdu_len - len, true, 2))
+            return -1;
+        /* a tag number of 2 is not extended so only one octet */
+        len++;
+        /* determine the length of the data blob */
+        data_len = wpm_value_length(&apdu[len], apdu_len - len);
+        if ((data_len < 0) || (data_len > MAX_APDU))
+            return -1;
+        /* copy the data from the APDU */
+        for (i = 0; i < data_len; i++) {
+            wpdata->application_data[i] = apdu[len + i];
+        }
+        wpdata->application_data_len = data_len;
+        len += data_len;
+        /* the closing tag 2 is there, or the length would be -1 */
+        len++;
+        /* Tag 3: optional priority - assumed MAX if not explicitly set */
+        wpdata->priority = BACNET_MAX_PRIORITY;
+        if ((len < apdu_len) && IS_CONTEXT_SPECIFIC(apdu[len]) &&
+            ((apdu[len] >> 4) == 3) && !decode_is_closing_tag(&apdu[len])) {
+            tag_len = wpm_decode_tag(&apdu[len], apdu_len - len, true, 3,
+                &len_value_type);
+            if (tag_len < 0)
+                return -1;
+            len += tag_len;
+            len +=
+                decode_unsigned(&apdu[len], len_value_type, &unsigned_value);
+            if ((unsigned_value >= BACNET_MIN_PRIORITY)
+                && (unsigned_value <= BACNET_MAX_PRIORITY)) {
+                wpdata->priority = (uint8_t) unsigned_value;
+            } else
+                return -1;
+        }
+    }
+
+    return (int) len;
+}
+
+/* WritePropertyMultiple-Error: the error, followed by
+   the BACnetObjectPropertyReference of the first failed write */
+int wpm_error_ack_encode_apdu(
+    uint8_t * apdu,
+    uint8_t invoke_id,
+    BACNET_WRITE_PROPERTY_DATA * wpdata,
+    BACNET_ERROR_CLASS error_class,
+    BACNET_ERROR_CODE error_code)
+{
+    int apdu_len = 0;   /* total length of the apdu, return value */
+
+    if (apdu && wpdata) {
+        apdu[0] = PDU_TYPE_ERROR;
+        apdu[1] = invoke_id;
+        apdu[2] = SERVICE_CONFIRMED_WRITE_PROP_MULTIPLE;
+        apdu_len = 3;
+        /* Tag 0: errorType */
+        apdu_len += encode_opening_tag(&apdu[apdu_len], 0);
+        apdu_len += encode_application_enumerated(&apdu[apdu_len], error_class);
+        apdu_len += encode_application_enumerated(&apdu[apdu_len], error_code);
+        apdu_len += encode_closing_tag(&apdu[apdu_len], 0);
+        /* Tag 1: firstFailedWriteAttempt */
+        apdu_len += encode_opening_tag(&apdu[apdu_len], 1);
+        apdu_len +=
+            encode_context_object_id(&apdu[apdu_len], 0, wpdata->object_type,
+            wpdata->object_instance);
+        apdu_len +=
+            encode_context_enumerated(&apdu[apdu_len], 1,
+            wpdata->object_property);
+        if (wpdata->array_index != BACNET_ARRAY_ALL) {
+            apdu_len +=
+                encode_context_unsigned(&apdu[apdu_len], 2,
+                wpdata->array_index);
+        }
+        apdu_len += encode_closing_tag(&apdu[apdu_len], 1);
+    }
+
+    return apdu_len;
+}
+
+/* decodes a WritePropertyMultiple-Error after the service choice -
+   sets the object type and instance, property and array index of
+   wpdata to the first failed write */
+int wpm_error_ack_decode_service_request(
+    uint8_t * apdu,
+    unsigned apdu_len,
+    BACNET_WRITE_PROPERTY_DATA * wpdata,
+    BACNET_ERROR_CLASS * error_class,
+    BACNET_ERROR_CODE * error_code)
+{
+    unsigned len = 0;
+    int tag_len = 0;
+    uint32_t len_value_type = 0;
+    uint32_t value = 0;
+    uint16_t type = 0;  /* for decoding */
+
+    if (!apdu || !wpdata)
+        return -1;
+    /* Tag 0: errorType */
+    if (!wpm_is_tag_number(&apdu[len], apdu_len, true, 0))
+        return -1;
+    len++;
+    tag_len =
+        wpm_decode_tag(&apdu[len], apdu_len - len, false,
+        BACNET_APPLICATION_TAG_ENUMERATED, &len_value_type);
+    if (tag_len < 0)
+        return -1;
+    len += tag_len;
+    len += decode_enumerated(&apdu[len], len_value_type, &value);
+    if (error_class)
+        *error_class = (BACNET_ERROR_CLASS) value;
+    tag_len =
+        wpm_decode_tag(&apdu[len], apdu_len - len, false,
+        BACNET_APPLICATION_TAG_ENUMERATED, &len_value_type);
+    if (tag_len < 0)
+        return -1;
+    len += tag_len;
+    len += decode_enumerated(&apdu[len], len_value_type, &value);
+    if (error_code)
+        *error_code = (BACNET_ERROR_CODE) value;
+    if ((len >= apdu_len) ||
+        !wpm_is_tag_number(&apdu[len], apdu_len - len, false, 0))
+        return -1;
+    len++;
+    /* Tag 1: firstFailedWriteAttempt */
+    if ((len >= apdu_len) ||
+        !wpm_is_tag_number(&apdu[len], apdu_len - len, true, 1))
+        return -1;
+    len++;
+    tag_len = wpm_decode_tag(&apdu[len], apdu_len - len, true, 0,
+        &len_value_type);
+    if (tag_len < 0)
+        return -1;
+    len += tag_len;
+    if (decode_object_id_safe(&apdu[len], len_value_type, &type,
+            &wpdata->object_instance) == 0)
+        return -1;
+    wpdata->object_type = (BACNET_OBJECT_TYPE) type;
+    len += len_value_type;
+    tag_len = wpm_decode_tag(&apdu[len], apdu_len - len, true, 1,
+        &len_value_type);
+    if (tag_len < 0)
+        return -1;
+    len += tag_len;
+    len += decode_enumerated(&apdu[len], len_value_type, &value);
+    wpdata->object_property = (BACNET_PROPERTY_ID) value;
+    wpdata->array_index = BACNET_ARRAY_ALL;
+    if ((len < apdu_len) && IS_CONTEXT_SPECIFIC(apdu[len]) &&
+        ((apdu[len] >> 4) == 2)) {
+        tag_len = wpm_decode_tag(&apdu[len], apdu_len - len, true, 2,
+            &len_value_type);
+        if (tag_len < 0)
+            return -1;
+        len += tag_len;
+        len += decode_unsigned(&apdu[len], len_value_type, &value);
+        wpdata->array_index = value;
+    }
+    if ((len >= apdu_len) ||
+        !wpm_is_tag_number(&apdu[len], apdu_len - len, false, 1))
+        return -1;
+    len++;
+
+    return (int) len;
+}
+
+#ifdef TEST
+#include <assert.h>
+#include <string.h>
+#include "ctest.h"
+
+int wpm_decode_apdu(
+    uint8_t * apdu,
+    unsigned apdu_len,
+    uint8_t * invoke_id,
+    uint8_t ** service_request,
+    unsigned *service_request_len)
+{
+    unsigned offset = 0;
+
+    if (!apdu)
+        return -1;
+    /* optional checking - most likely was already done prior to this call */
+    if (apdu[0] != PDU_TYPE_CONFIRMED_SERVICE_REQUEST)
+        return -1;
+    /*  apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU); */
+    *invoke_id = apdu[2];       /* invoke id - filled in by net layer */
+    if (apdu[3] != SERVICE_CONFIRMED_WRITE_PROP_MULTIPLE)
+        return -1;
+    offset = 4;
+
+    if (apdu_len > offset) {
+        if (service_request)
+            *service_request = &apdu[offset];
+        if (service_request_len)
+            *service_request_len = apdu_len - offset;
+    }
+
+    return offset;
+}
+
+void testWritePropertyMultiple(
+    Test * pTest)
+{
+    uint8_t apdu[480] = { 0 };
+    uint8_t test_apdu[480] = { 0 };
+    int len = 0;
+    int test_len = 0;
+    int apdu_len = 0;
+    uint8_t invoke_id = 12;
+    uint8_t test_invoke_id = 0;
+    uint8_t *service_request = NULL;
+    unsigned service_request_len = 0;
+    BACNET_WRITE_PROPERTY_DATA wpdata = { 0 };
+    BACNET_WRITE_PROPERTY_DATA test_data = { 0 };
+    BACNET_APPLICATION_DATA_VALUE value = { 0 };
+    BACNET_ERROR_CLASS error_class = ERROR_CLASS_SERVICES;
+    BACNET_ERROR_CODE error_code = ERROR_CODE_OTHER;
+    BACNET_WRITE_ACCESS_DATA write_access[2];
+    BACNET_PROPERTY_VALUE property_value[3];
+
+    /* build it a piece at a time */
+    apdu_len = wpm_encode_apdu_init(&apdu[0], invoke_id);
+    apdu_len +=
+        wpm_encode_apdu_object_begin(&apdu[apdu_len], OBJECT_ANALOG_VALUE,
+        3);
+    wpdata.object_property = PROP_PRESENT_VALUE;
+    wpdata.array_index = BACNET_ARRAY_ALL;
+    wpdata.priority = 8;
+    value.tag = BACNET_APPLICATION_TAG_REAL;
+    value.type.Real = 42.5;
+    wpdata.application_data_len =
+        bacapp_encode_application_data(&wpdata.application_data[0], &value);
+    apdu_len += wpm_encode_apdu_object_property(&apdu[apdu_len], &wpdata);
+    wpdata.object_property = PROP_PRIORITY_ARRAY;
+    wpdata.array_index = 16;
+    wpdata.priority = BACNET_NO_PRIORITY;
+    value.tag = BACNET_APPLICATION_TAG_NULL;
+    wpdata.application_data_len =
+        bacapp_encode_application_data(&wpdata.application_data[0], &value);
+    apdu_len += wpm_encode_apdu_object_property(&apdu[apdu_len], &wpdata);
+    apdu_len += wpm_encode_apdu_object_end(&apdu[apdu_len]);
+    apdu_len +=
+        wpm_encode_apdu_object_begin(&apdu[apdu_len], OBJECT_BINARY_OUTPUT,
+        4194303);
+    wpdata.object_property = PROP_OUT_OF_SERVICE;
+    wpdata.array_index = BACNET_ARRAY_ALL;
+    wpdata.priority = BACNET_NO_PRIORITY;
+    value.tag = BACNET_APPLICATION_TAG_BOOLEAN;
+    value.type.Boolean = true;
+    wpdata.application_data_len =
+        bacapp_encode_application_data(&wpdata.application_data[0], &value);
+    apdu_len += wpm_encode_apdu_object_property(&apdu[apdu_len], &wpdata);
+    apdu_len += wpm_encode_apdu_object_end(&apdu[apdu_len]);
+    ct_test(pTest, apdu_len != 0);
+
+    test_len =
+        wpm_decode_apdu(&apdu[0], apdu_len, &test_invoke_id,
+        &service_request, &service_request_len);
+    ct_test(pTest, test_len != -1);
+    ct_test(pTest, test_invoke_id == invoke_id);
+    ct_test(pTest, service_request != NULL);
+    ct_test(pTest, service_request_len > 0);
+    /* first object */
+    test_len =
+        wpm_decode_object_id(service_request, service_request_len,
+        &test_data);
+    ct_test(pTest, test_len > 0);
+    ct_test(pTest, test_data.object_type == OBJECT_ANALOG_VALUE);
+    ct_test(pTest, test_data.object_instance == 3);
+    len = test_len;
+    test_len =
+        wpm_decode_object_property(&service_request[len],
+        service_request_len - len, &test_data);
+    ct_test(pTest, test_len > 0);
+    ct_test(pTest, test_data.object_property == PROP_PRESENT_VALUE);
+    ct_test(pTest, test_data.array_index == BACNET_ARRAY_ALL);
+    ct_test(pTest, test_data.priority == 8);
+    bacapp_decode_application_data(&test_data.application_data[0],
+        test_data.application_data_len, &value);
+    ct_test(pTest, value.tag == BACNET_APPLICATION_TAG_REAL);
+    ct_test(pTest, value.type.Real == 42.5);
+    len += test_len;
+    ct_test(pTest, wpm_decode_object_end(&service_request[len],
+            service_request_len - len) == 0);
+    test_len =
+        wpm_decode_object_property(&service_request[len],
+        service_request_len - len, &test_data);
+    ct_test(pTest, test_len > 0);
+    ct_test(pTest, test_data.object_property == PROP_PRIORITY_ARRAY);
+    ct_test(pTest, test_data.array_index == 16);
+    /* priority is assumed when missing */
+    ct_test(pTest, test_data.priority == BACNET_MAX_PRIORITY);
+    ct_test(pTest, test_data.application_data_len == 1);
+    len += test_len;
+    test_len =
+        wpm_decode_object_end(&service_request[len],
+        service_request_len - len);
+    ct_test(pTest, test_len == 1);
+    len += test_len;
+    /* second object */
+    test_len =
+        wpm_decode_object_id(&service_request[len],
+        service_request_len - len, &test_data);
+    ct_test(pTest, test_len > 0);
+    ct_test(pTest, test_data.object_type == OBJECT_BINARY_OUTPUT);
+    ct_test(pTest, test_data.object_instance == 4194303);
+    len += test_len;
+    test_len =
+        wpm_decode_object_property(&service_request[len],
+        service_request_len - len, &test_data);
+    ct_test(pTest, test_len > 0);
+    ct_test(pTest, test_data.object_property == PROP_OUT_OF_SERVICE);
+    bacapp_decode_application_data(&test_data.application_data[0],
+        test_data.application_data_len, &value);
+    ct_test(pTest, value.tag == BACNET_APPLICATION_TAG_BOOLEAN);
+    ct_test(pTest, value.type.Boolean == true);
+    len += test_len;
+    test_len =
+        wpm_decode_object_end(&service_request[len],
+        service_request_len - len);
+    ct_test(pTest, test_len == 1);
+    len += test_len;
+    ct_test(pTest, len == (int) service_request_len);
+    /* a truncated request must not decode */
+    test_len =
+        wpm_decode_object_property(&service_request[6], 4, &test_data);
+    ct_test(pTest, test_len == -1);
+    len =
+        wpm_decode_object_property(&service_request[6],
+        service_request_len - 6, &test_data);
+    /* up to the closing tag 2, then part way into the priority */
+    for (test_len = 1; test_len < (len - 2); test_len++) {
+        ct_test(pTest, wpm_decode_object_property(&service_request[6],
+                (unsigned) test_len, &test_data) == -1);
+    }
+    ct_test(pTest, wpm_decode_object_property(&service_request[6],
+            (unsigned) (len - 1), &test_data) == -1);
+    /* a value whose length runs past the end */
+    memcpy(&test_apdu[0], &service_request[6], len);
+    test_apdu[3] = 0x45;        /* real, extended length */
+    test_apdu[4] = 0xFE;
+    test_apdu[5] = 0xFF;
+    test_apdu[6] = 0xFF;
+    ct_test(pTest, wpm_decode_object_property(&test_apdu[0], len,
+            &test_data) == -1);
+
+    /* the same request from the linked lists */
+    write_access[0].object_type = OBJECT_ANALOG_VALUE;
+    write_access[0].object_instance = 3;
+    write_access[0].listOfProperties = &property_value[0];
+    write_access[0].next = &write_access[1];
+    property_value[0].propertyIdentifier = PROP_PRESENT_VALUE;
+    property_value[0].propertyArrayIndex = BACNET_ARRAY_ALL;
+    property_value[0].value.context_specific = false;
+    property_value[0].value.tag = BACNET_APPLICATION_TAG_REAL;
+    property_value[0].value.type.Real = 42.5;
+    property_value[0].value.next = NULL;
+    property_value[0].priority = 8;
+    property_value[0].next = &property_value[1];
+    property_value[1].propertyIdentifier = PROP_PRIORITY_ARRAY;
+    property_value[1].propertyArrayIndex = 16;
+    property_value[1].value.context_specific = false;
+    property_value[1].value.tag = BACNET_APPLICATION_TAG_NULL;
+    property_value[1].value.next = NULL;
+    property_value[1].priority = BACNET_NO_PRIORITY;
+    property_value[1].next = NULL;
+    write_access[1].object_type = OBJECT_BINARY_OUTPUT;
+    write_access[1].object_instance = 4194303;
+    write_access[1].listOfProperties = &property_value[2];
+    write_access[1].next = NULL;
+    property_value[2].propertyIdentifier = PROP_OUT_OF_SERVICE;
+    property_value[2].propertyArrayIndex = BACNET_ARRAY_ALL;
+    property_value[2].value.context_specific = false;
+    property_value[2].value.tag = BACNET_APPLICATION_TAG_BOOLEAN;
+    property_value[2].value.type.Boolean = true;
+    property_value[2].value.next = NULL;
+    property_value[2].priority = BACNET_NO_PRIORITY;
+    property_value[2].next = NULL;
+    test_len =
+        wpm_encode_apdu(&test_apdu[0], sizeof(test_apdu), invoke_id,
+        &write_access[0]);
+    ct_test(pTest, test_len == apdu_len);
+    ct_test(pTest, memcmp(&apdu[0], &test_apdu[0], apdu_len) == 0);
+    /* and it doesn't fit in anything smaller */
+    test_len =
+        wpm_encode_apdu(&test_apdu[0], apdu_len - 1, invoke_id,
+        &write_access[0]);
+    ct_test(pTest, test_len == 0);
+
+    /* the error names the write that failed */
+    test_data.object_type = OBJECT_ANALOG_VALUE;
+    test_data.object_instance = 3;
+    test_data.object_property = PROP_PRESENT_VALUE;
+    test_data.array_index = BACNET_ARRAY_ALL;
+    apdu_len =
+        wpm_error_ack_encode_apdu(&apdu[0], invoke_id, &test_data,
+        ERROR_CLASS_PROPERTY, ERROR_CODE_WRITE_ACCESS_DENIED);
+    ct_test(pTest, apdu_len == 18);
+    ct_test(pTest, apdu[0] == PDU_TYPE_ERROR);
+    ct_test(pTest, apdu[1] == invoke_id);
+    ct_test(pTest, apdu[2] == SERVICE_CONFIRMED_WRITE_PROP_MULTIPLE);
+    ct_test(pTest, decode_is_opening_tag_number(&apdu[3], 0));
+    ct_test(pTest, decode_is_closing_tag_number(&apdu[8], 0));
+    ct_test(pTest, decode_is_opening_tag_number(&apdu[9], 1));
+    ct_test(pTest, decode_is_closing_tag_number(&apdu[17], 1));
+    memset(&test_data, 0, sizeof(test_data));
+    test_len =
+        wpm_error_ack_decode_service_request(&apdu[3], apdu_len - 3,
+        &test_data, &error_class, &error_code);
+    ct_test(pTest, test_len == (apdu_len - 3));
+    ct_test(pTest, error_class == ERROR_CLASS_PROPERTY);
+    ct_test(pTest, error_code == ERROR_CODE_WRITE_ACCESS_DENIED);
+    ct_test(pTest, test_data.object_type == OBJECT_ANALOG_VALUE);
+    ct_test(pTest, test_data.object_instance == 3);
+    ct_test(pTest, test_data.object_property == PROP_PRESENT_VALUE);
+    ct_test(pTest, test_data.array_index == BACNET_ARRAY_ALL);
+    /* with an array index */
+    test_data.array_index = 5;
+    apdu_len =
+        wpm_error_ack_encode_apdu(&apdu[0], invoke_id, &test_data,
+        ERROR_CLASS_PROPERTY, ERROR_CODE_WRITE_ACCESS_DENIED);
+    test_data.array_index = BACNET_ARRAY_ALL;
+    test_len =
+        wpm_error_ack_decode_service_request(&apdu[3], apdu_len - 3,
+        &test_data, &error_class, &error_code);
+    ct_test(pTest, test_len == (apdu_len - 3));
+    ct_test(pTest, test_data.array_index == 5);
+    /* cut short anywhere */
+    for (len = 0; len < (apdu_len - 3); len++) {
+        test_len =
+            wpm_error_ack_decode_service_request(&apdu[3], (unsigned) len,
+            &test_data, &error_class, &error_code);
+        ct_test(pTest, test_len == -1);
+    }
+}
+
+#ifdef TEST_WRITE_PROPERTY_MULTIPLE
+int main(
+    void)
+{
+    Test *pTest;
+    bool rc;
+
+    pTest = ct_create("BACnet WritePropertyMultiple", NULL);
+    /* individual tests */
+    rc = ct_addTestFunction(pTest, testWritePropertyMultiple);
+    assert(rc);
+
+    ct_setStream(pTest, stdout);
+    ct_run(pTest);
+    (void) ct_report(pTest);
+    ct_destroy(pTest);
+
+    return 0;
+}
+#endif /* TEST_WRITE_PROPERTY_MULTIPLE */
+
+#endif /* TEST */